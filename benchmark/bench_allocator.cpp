@@ -39,12 +39,14 @@
 
 #include <time.h>
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -155,13 +157,82 @@ void bench() {
   LOG(INFO) << "usage: " << elapsed << " milliseconds";
 }
 
+static void* bench_malloc(size_t size) {
+#if defined(BENCH_SYSTEM)
+  return malloc(size);
+#elif defined(BENCH_JEMALLOC)
+  return vineyard_je_malloc(size);
+#else
+  return vineyard_malloc(size);
+#endif
+}
+
+static void bench_free(void* pointer) {
+#if defined(BENCH_SYSTEM)
+  free(pointer);
+#elif defined(BENCH_JEMALLOC)
+  vineyard_je_free(pointer);
+#else
+  vineyard_free(pointer);
+#endif
+}
+
+// The throughput of allocations when 1 - 64 threads allocate concurrently,
+// every thread churns a small working set of its own, see also Notes
+// [Concurrent Vineyard Allocator] in "client/allocator.h".
+void bench_threads() {
+  size_t iterCount = 1 << 22;  // per thread
+  size_t maxItems = 16;        // per thread
+  size_t maxItemSizeExp = 10;  // 1K
+
+  for (size_t threads = 1; threads <= 64; threads *= 2) {
+    size_t start = GetMillisecondCount();
+    std::vector<std::thread> workers;
+    for (size_t thread = 0; thread < threads; ++thread) {
+      workers.emplace_back([=]() {
+        PRNG rng(thread + 1);
+        std::vector<uint8_t*> items(maxItems, nullptr);
+        for (size_t j = 0; j < iterCount; ++j) {
+          size_t idx = rng.rng32() % maxItems;
+          if (items[idx]) {
+            bench_free(items[idx]);
+            items[idx] = nullptr;
+          } else {
+            size_t sz =
+                calcSizeWithStatsAdjustment(rng.rng64(), maxItemSizeExp);
+            items[idx] = reinterpret_cast<uint8_t*>(bench_malloc(sz));
+            memset(items[idx], static_cast<uint8_t>(sz), sz);
+          }
+        }
+        for (uint8_t* item : items) {
+          if (item) {
+            bench_free(item);
+          }
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    size_t elapsed = std::max(GetMillisecondCount() - start, size_t(1));
+    LOG(INFO) << threads << " threads: " << elapsed << " milliseconds, "
+              << (iterCount * threads / 1000.0 / elapsed) << " Mops/s";
+  }
+}
+
 int main(int argc, char** argv) {
   if (argc < 1) {
-    printf("usage ./bench_allocator");
+    printf("usage ./bench_allocator [all|single|threads]");
     return 1;
   }
+  std::string mode = argc > 1 ? argv[1] : "all";
 
-  bench();
+  if (mode == "all" || mode == "single") {
+    bench();
+  }
+  if (mode == "all" || mode == "threads") {
+    bench_threads();
+  }
 
   LOG(INFO) << "Finish allocator benchmarks...";
   return 0;
@@ -0,0 +1,105 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * Throughput benchmark of importing a local file into a blob, by reading the
+ * file into the memory of the client and then copying into the blob, and by
+ * `Client::CreateBlobFromFile`, see also Notes [Importing Files into Blobs]
+ * in "client/client.cc".
+ *
+ * Usage:
+ *
+ *    ./bench_blob_import <ipc_socket> <file> [rounds]
+ *
+ * Note that the page cache of the file should be dropped between runs for
+ * cold-read numbers.
+ */
+
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using clock_type = std::chrono::high_resolution_clock;
+
+static void import_buffered(Client& client, const std::string& path,
+                            const size_t size) {
+  std::vector<char> content(size);
+  std::ifstream in(path, std::ios::binary);
+  CHECK(in.read(content.data(), size));
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(size, writer));
+  memcpy(writer->data(), content.data(), size);
+  auto blob = writer->Seal(client);
+  VINEYARD_CHECK_OK(client.DelData(blob->id()));
+}
+
+static void import_from_file(Client& client, const std::string& path) {
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlobFromFile(path, writer));
+  auto blob = writer->Seal(client);
+  VINEYARD_CHECK_OK(client.DelData(blob->id()));
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "usage: ./bench_blob_import <ipc_socket> <file> [rounds]"
+              << std::endl;
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string path = std::string(argv[2]);
+  size_t rounds = 5;
+  if (argc > 3) {
+    rounds = std::strtoull(argv[3], nullptr, 10);
+  }
+  struct stat st;
+  CHECK_EQ(stat(path.c_str(), &st), 0);
+  size_t size = st.st_size;
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  std::cout << std::fixed << std::setprecision(2);
+  for (bool from_file : {false, true}) {
+    auto start = clock_type::now();
+    for (size_t round = 0; round < rounds; ++round) {
+      if (from_file) {
+        import_from_file(client, path);
+      } else {
+        import_buffered(client, path, size);
+      }
+    }
+    auto end = clock_type::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << (from_file ? "from file: " : "buffered: ")
+              << (size * rounds) / seconds / (1UL << 30) << " GB/s"
+              << std::endl;
+  }
+  client.Disconnect();
+  return 0;
+}
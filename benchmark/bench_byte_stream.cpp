@@ -0,0 +1,194 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * Throughput benchmark of writing and reading lines through a byte stream,
+ * with the zero-copy ByteStreamWriter/ByteStreamReader, and with the previous
+ * buffered approach (an arrow::BufferBuilder that is copied into the chunk on
+ * the producer side, and a std::stringstream over a copy of the chunk on the
+ * consumer side), see also Notes [Zero-copy Byte Stream] in
+ * "basic/stream/byte_stream.vineyard-mod".
+ *
+ * Usage:
+ *
+ *    ./bench_byte_stream <ipc_socket> [total_mb] [line_length] [chunk_kb]
+ *
+ * e.g.,
+ *
+ *    ./bench_byte_stream /var/run/vineyard.sock 4096 128 2048
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/builder.h"
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using clock_type = std::chrono::high_resolution_clock;
+
+static ObjectID create_stream(Client& client) {
+  ByteStreamBuilder builder(client);
+  builder.SetParams(std::unordered_map<std::string, std::string>{
+      {"kind", "bench"}, {"test_name", "bench_byte_stream"}});
+  return builder.Seal(client)->id();
+}
+
+static void produce_buffered(Client& client, const ObjectID stream_id,
+                             const std::string& line, const size_t lines,
+                             const size_t chunk_size) {
+  arrow::BufferBuilder builder;
+  auto flush = [&]() {
+    std::shared_ptr<arrow::Buffer> buffer;
+    CHECK(builder.Finish(&buffer).ok());
+    if (buffer->size() > 0) {
+      std::unique_ptr<arrow::MutableBuffer> chunk;
+      VINEYARD_CHECK_OK(
+          client.GetNextStreamChunk(stream_id, buffer->size(), chunk));
+      memcpy(chunk->mutable_data(), buffer->data(), buffer->size());
+    }
+  };
+  for (size_t index = 0; index < lines; ++index) {
+    if (builder.length() + line.size() > static_cast<int64_t>(chunk_size)) {
+      flush();
+    }
+    CHECK(builder.Append(line.data(), line.size()).ok());
+  }
+  flush();
+  VINEYARD_CHECK_OK(client.StopStream(stream_id, false));
+}
+
+static void produce_zero_copy(Client& client, const ObjectID stream_id,
+                              const std::string& line, const size_t lines,
+                              const size_t chunk_size) {
+  auto byte_stream = client.GetObject<ByteStream>(stream_id);
+  std::unique_ptr<ByteStreamWriter> writer;
+  VINEYARD_CHECK_OK(byte_stream->OpenWriter(client, writer));
+  writer->SetBufferSizeLimit(chunk_size);
+  for (size_t index = 0; index < lines; ++index) {
+    VINEYARD_CHECK_OK(writer->WriteLine(line));
+  }
+  VINEYARD_CHECK_OK(writer->Finish());
+}
+
+static void produce(const std::string& ipc_socket, const ObjectID stream_id,
+                    const std::string& line, const size_t lines,
+                    const size_t chunk_size, const bool zero_copy) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  if (zero_copy) {
+    produce_zero_copy(client, stream_id, line, lines, chunk_size);
+  } else {
+    VINEYARD_CHECK_OK(client.OpenStream(stream_id, OpenStreamMode::write));
+    produce_buffered(client, stream_id, line, lines, chunk_size);
+  }
+  client.Disconnect();
+}
+
+static size_t consume_buffered(Client& client, const ObjectID stream_id) {
+  size_t total = 0;
+  std::stringstream ss;
+  std::string line;
+  while (true) {
+    if (std::getline(ss, line)) {
+      total += line.size();
+      continue;
+    }
+    std::unique_ptr<arrow::Buffer> buffer;
+    if (!client.PullNextStreamChunk(stream_id, buffer).ok()) {
+      break;
+    }
+    ss.clear();
+    ss.str(std::string(reinterpret_cast<const char*>(buffer->data()),
+                       buffer->size()));
+  }
+  return total;
+}
+
+static size_t consume_zero_copy(std::unique_ptr<ByteStreamReader>& reader) {
+  size_t total = 0;
+  arrow::util::string_view line;
+  while (reader->ReadLine(line).ok()) {
+    total += line.size();
+  }
+  return total;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: ./bench_byte_stream <ipc_socket> [total_mb] "
+                 "[line_length] [chunk_kb]"
+              << std::endl;
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  size_t total_mb = 4096, line_length = 128, chunk_kb = 2048;
+  if (argc > 2) {
+    total_mb = std::strtoull(argv[2], nullptr, 10);
+  }
+  if (argc > 3) {
+    line_length = std::max(std::strtoull(argv[3], nullptr, 10), 1ULL);
+  }
+  if (argc > 4) {
+    chunk_kb = std::strtoull(argv[4], nullptr, 10);
+  }
+  std::string line = std::string(line_length - 1, 'x') + "\n";
+  size_t lines = (total_mb << 20) / line_length;
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  std::cout << std::fixed << std::setprecision(2);
+  for (bool zero_copy : {false, true}) {
+    ObjectID stream_id = create_stream(client);
+    std::unique_ptr<ByteStreamReader> reader;
+    if (zero_copy) {
+      auto byte_stream = client.GetObject<ByteStream>(stream_id);
+      VINEYARD_CHECK_OK(byte_stream->OpenReader(client, reader));
+    } else {
+      VINEYARD_CHECK_OK(client.OpenStream(stream_id, OpenStreamMode::read));
+    }
+
+    auto start = clock_type::now();
+    std::thread producer(produce, ipc_socket, stream_id, line, lines,
+                         chunk_kb << 10, zero_copy);
+    size_t total = zero_copy ? consume_zero_copy(reader)
+                             : consume_buffered(client, stream_id);
+    producer.join();
+    auto end = clock_type::now();
+
+    CHECK_EQ(total, lines * (line_length - 1));
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << (zero_copy ? "zero-copy: " : "buffered: ")
+              << (lines * line_length) / seconds / (1UL << 30) << " GB/s, "
+              << lines / seconds / 1e6 << " M lines/s" << std::endl;
+  }
+  client.Disconnect();
+  return 0;
+}
@@ -0,0 +1,133 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * Latency benchmark of IPC commands over the UNIX domain socket and over the
+ * shared memory command channel, see also Notes [Command Channel] in
+ * "common/memory/command_channel.h".
+ *
+ * Usage:
+ *
+ *    ./bench_command_channel <ipc_socket> [rounds]
+ *
+ * The same commands are issued by two clients, one of which opts into the
+ * command channel, and the p50/p99 latency of each command is reported.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "arrow/buffer.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/json.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using clock_type = std::chrono::high_resolution_clock;
+
+struct Latency {
+  double p50;
+  double p99;
+};
+
+static Latency measure(const size_t rounds, std::function<void()> fn) {
+  std::vector<double> latencies(rounds);
+  // warm up
+  for (size_t round = 0; round < std::min<size_t>(rounds, 1000); ++round) {
+    fn();
+  }
+  for (size_t round = 0; round < rounds; ++round) {
+    auto start = clock_type::now();
+    fn();
+    auto end = clock_type::now();
+    latencies[round] =
+        std::chrono::duration<double, std::micro>(end - start).count();
+  }
+  std::sort(latencies.begin(), latencies.end());
+  return Latency{latencies[rounds / 2], latencies[rounds * 99 / 100]};
+}
+
+static std::map<std::string, Latency> bench_commands(
+    const std::string& ipc_socket, const bool command_channel,
+    const size_t rounds) {
+  if (command_channel) {
+    setenv("VINEYARD_ENABLE_COMMAND_CHANNEL", "1", 1);
+  } else {
+    unsetenv("VINEYARD_ENABLE_COMMAND_CHANNEL");
+  }
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  std::unique_ptr<BlobWriter> blob_writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(64, blob_writer));
+  auto blob = blob_writer->Seal(client);
+  ObjectID blob_id = blob->id();
+
+  std::map<std::string, Latency> latencies;
+  latencies["Exists"] = measure(rounds, [&]() {
+    bool exists = false;
+    VINEYARD_CHECK_OK(client.Exists(blob_id, exists));
+  });
+  latencies["GetData"] = measure(rounds, [&]() {
+    json tree;
+    VINEYARD_CHECK_OK(client.GetData(blob_id, tree));
+  });
+  latencies["GetBuffers"] = measure(rounds, [&]() {
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    VINEYARD_CHECK_OK(client.GetBuffers({blob_id}, buffers));
+  });
+
+  VINEYARD_CHECK_OK(client.DelData(blob_id));
+  client.Disconnect();
+  return latencies;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: ./bench_command_channel <ipc_socket> [rounds]"
+              << std::endl;
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  size_t rounds = 100000;
+  if (argc > 2) {
+    rounds = std::strtoull(argv[2], nullptr, 10);
+  }
+
+  auto socket_latencies = bench_commands(ipc_socket, false, rounds);
+  auto channel_latencies = bench_commands(ipc_socket, true, rounds);
+
+  std::cout << std::fixed << std::setprecision(2);
+  for (auto const& item : socket_latencies) {
+    auto const& channel = channel_latencies[item.first];
+    std::cout << item.first << ":" << std::endl
+              << "    socket:  p50 = " << item.second.p50
+              << " us, p99 = " << item.second.p99 << " us" << std::endl
+              << "    channel: p50 = " << channel.p50
+              << " us, p99 = " << channel.p99 << " us" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,139 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * Benchmark of scanning the shared memory that is backed by regular (4 KiB)
+ * pages and by huge pages, see also Notes [Huge Pages] in
+ * "server/memory/malloc.h".
+ *
+ * Usage:
+ *
+ *    ./bench_huge_pages [size_in_mb] [rounds] [huge_pages...]
+ *
+ * e.g.,
+ *
+ *    ./bench_huge_pages 4096 5 thp memfd /dev/hugepages
+ *
+ * Both a sequential scan (bandwidth bound) and random 8-byte reads (TLB
+ * bound) are measured, the memory is populated before measuring.
+ */
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/status.h"
+#include "server/memory/malloc.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using clock_type = std::chrono::high_resolution_clock;
+
+static double measure(const size_t rounds, std::function<void()> fn) {
+  auto start = clock_type::now();
+  for (size_t round = 0; round < rounds; ++round) {
+    fn();
+  }
+  auto end = clock_type::now();
+  return std::chrono::duration<double>(end - start).count() / rounds;
+}
+
+static void bench_scan(const std::string& huge_pages, const int64_t size,
+                       const size_t rounds) {
+  auto status = memory::SetHugePages(huge_pages);
+  if (!status.ok()) {
+    std::cout << "'" << huge_pages << "': " << status.ToString() << std::endl;
+    return;
+  }
+  int64_t mapped_size = size;
+  void* pointer = nullptr;
+  int fd = memory::create_mapped_buffer(mapped_size, pointer, MAP_SHARED);
+  if (fd < 0) {
+    std::cout << "'" << huge_pages << "': failed to create the buffer"
+              << std::endl;
+    return;
+  }
+  // populate the pages
+  memset(pointer, 1, mapped_size);
+
+  const uint64_t* data = static_cast<const uint64_t*>(pointer);
+  const size_t length = size / sizeof(uint64_t);
+  volatile uint64_t sink = 0;
+
+  double sequential = measure(rounds, [&]() {
+    uint64_t sum = 0;
+    for (size_t index = 0; index < length; ++index) {
+      sum += data[index];
+    }
+    sink = sink + sum;
+  });
+
+  const size_t num_reads = 16 * 1024 * 1024;
+  std::vector<size_t> indices(num_reads);
+  std::mt19937_64 random(0);
+  for (auto& index : indices) {
+    index = random() % length;
+  }
+  double gather = measure(rounds, [&]() {
+    uint64_t sum = 0;
+    for (auto const index : indices) {
+      sum += data[index];
+    }
+    sink = sink + sum;
+  });
+
+  std::cout << "'" << (huge_pages.empty() ? "4k" : huge_pages)
+            << "' (page size " << memory::buffer_page_size() << "):"
+            << std::endl
+            << "    sequential scan: " << size / sequential / 1e9 << " GB/s"
+            << std::endl
+            << "    random reads:    " << gather * 1e9 / num_reads
+            << " ns/read" << std::endl;
+
+  munmap(pointer, mapped_size);
+  close(fd);
+}
+
+int main(int argc, char** argv) {
+  int64_t size = 1024;
+  size_t rounds = 5;
+  if (argc > 1) {
+    size = std::strtoll(argv[1], nullptr, 10);
+  }
+  if (argc > 2) {
+    rounds = std::strtoull(argv[2], nullptr, 10);
+  }
+  size = size * 1024 * 1024;
+
+  // the baseline: regular pages
+  bench_scan("", size, rounds);
+  if (argc > 3) {
+    for (int index = 3; index < argc; ++index) {
+      bench_scan(argv[index], size, rounds);
+    }
+  } else {
+    bench_scan("thp", size, rounds);
+  }
+  return 0;
+}
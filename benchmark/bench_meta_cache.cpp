@@ -0,0 +1,135 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * Latency benchmark of repeated `GetObject` with and without the client side
+ * metadata cache, see also Notes [Client Metadata Cache] in
+ * "client/meta_cache.h".
+ *
+ * Usage:
+ *
+ *    ./bench_meta_cache <ipc_socket> [rounds] [columns]
+ *
+ * A dataframe with `columns` columns is created, and then got `rounds` times
+ * by two clients, one of which disables the cache, and the p50/p99 latency is
+ * reported.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "basic/ds/dataframe.h"
+#include "basic/ds/tensor.h"
+#include "client/client.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using clock_type = std::chrono::high_resolution_clock;
+
+struct Latency {
+  double p50;
+  double p99;
+};
+
+static Latency measure(const size_t rounds, std::function<void()> fn) {
+  std::vector<double> latencies(rounds);
+  // warm up
+  for (size_t round = 0; round < std::min<size_t>(rounds, 1000); ++round) {
+    fn();
+  }
+  for (size_t round = 0; round < rounds; ++round) {
+    auto start = clock_type::now();
+    fn();
+    auto end = clock_type::now();
+    latencies[round] =
+        std::chrono::duration<double, std::micro>(end - start).count();
+  }
+  std::sort(latencies.begin(), latencies.end());
+  return Latency{latencies[rounds / 2], latencies[rounds * 99 / 100]};
+}
+
+static ObjectID make_dataframe(Client& client, const size_t columns) {
+  DataFrameBuilder builder(client);
+  for (size_t column = 0; column < columns; ++column) {
+    auto tensor = std::make_shared<TensorBuilder<int64_t>>(
+        client, std::vector<int64_t>{1024});
+    for (int64_t index = 0; index < 1024; ++index) {
+      tensor->data()[index] = index;
+    }
+    builder.AddColumn(json(column), tensor);
+  }
+  return builder.Seal(client)->id();
+}
+
+static Latency bench_get_object(const std::string& ipc_socket,
+                                const ObjectID id, const bool cached,
+                                const size_t rounds) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  if (!cached) {
+    client.GetMetaCache().SetCapacity(0);
+  }
+  auto latency = measure(rounds, [&]() {
+    std::shared_ptr<Object> object;
+    VINEYARD_CHECK_OK(client.GetObject(id, object));
+  });
+  if (cached) {
+    std::cout << "cache hits = " << client.GetMetaCache().Hits()
+              << ", misses = " << client.GetMetaCache().Misses() << std::endl;
+  }
+  client.Disconnect();
+  return latency;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: ./bench_meta_cache <ipc_socket> [rounds] [columns]"
+              << std::endl;
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  size_t rounds = 10000, columns = 16;
+  if (argc > 2) {
+    rounds = std::strtoull(argv[2], nullptr, 10);
+  }
+  if (argc > 3) {
+    columns = std::strtoull(argv[3], nullptr, 10);
+  }
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  ObjectID id = make_dataframe(client, columns);
+
+  auto uncached = bench_get_object(ipc_socket, id, false, rounds);
+  auto cached = bench_get_object(ipc_socket, id, true, rounds);
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "GetObject (" << columns << " columns):" << std::endl
+            << "    uncached: p50 = " << uncached.p50
+            << " us, p99 = " << uncached.p99 << " us" << std::endl
+            << "    cached:   p50 = " << cached.p50
+            << " us, p99 = " << cached.p99 << " us" << std::endl;
+
+  VINEYARD_CHECK_OK(client.DelData(id, true, true));
+  client.Disconnect();
+  return 0;
+}
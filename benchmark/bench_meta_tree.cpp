@@ -0,0 +1,157 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * Benchmark of the metadata queries in `meta_tree` on a tree with a large
+ * number of objects, with and without the index, see also
+ * Notes [Metadata Index] in "server/util/meta_index.h".
+ *
+ * Usage:
+ *
+ *    ./bench_meta_tree [num_objects] [rounds]
+ *
+ * Every object has a member blob, and refers to one of a few typenames.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/json.h"
+#include "common/util/uuid.h"
+#include "server/util/meta_index.h"
+#include "server/util/meta_tree.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using clock_type = std::chrono::high_resolution_clock;
+
+static const std::vector<std::string> type_names = {
+    "vineyard::Tensor<int64>", "vineyard::Tensor<double>",
+    "vineyard::DataFrame",     "vineyard::RecordBatch",
+    "vineyard::Array<int64>",  "vineyard::Hashmap<int64,int64>",
+};
+
+static double measure(const size_t rounds, std::function<void()> fn) {
+  auto start = clock_type::now();
+  for (size_t round = 0; round < rounds; ++round) {
+    fn();
+  }
+  auto end = clock_type::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         rounds;
+}
+
+static void make_tree(const size_t num_objects, json& tree,
+                      std::vector<ObjectID>& objects) {
+  for (size_t index = 0; index < num_objects; ++index) {
+    ObjectID id = (static_cast<ObjectID>(index) + 1) << 16;
+    ObjectID blob_id = GenerateBlobID(index * 64 + 64);
+    std::string name = ObjectIDToString(id);
+    json& object = tree["data"][name];
+    object["typename"] = "v" + type_names[index % type_names.size()];
+    object["instance_id"] = index % 4;
+    object["signature"] = index;
+    object["transient"] = true;
+    object["nbytes"] = 64;
+    object["buffer_"] =
+        "l" + ObjectIDToString(blob_id) + ".vineyard::Blob@" +
+        std::to_string(index % 4);
+    tree["signatures"]["i" + std::to_string(index % 4)]
+        [SignatureToString(index)] = name;
+    objects.emplace_back(id);
+  }
+}
+
+static void bench_queries(const json& tree,
+                          const std::vector<ObjectID>& objects,
+                          const size_t rounds) {
+  std::mt19937_64 random(0);
+  double list_wildcard = measure(rounds, [&]() {
+    json tree_group;
+    VINEYARD_DISCARD(meta_tree::ListData(tree, "i0", "vineyard::Tensor*",
+                                         false, 1000, tree_group));
+  });
+  double list_regex = measure(rounds, [&]() {
+    json tree_group;
+    VINEYARD_DISCARD(meta_tree::ListData(tree, "i0", ".*DataFrame.*", true,
+                                         1000, tree_group));
+  });
+  double exists = measure(rounds * 1000, [&]() {
+    bool exists = false;
+    VINEYARD_DISCARD(
+        meta_tree::Exists(tree, objects[random() % objects.size()], exists));
+  });
+  double get_data = measure(rounds * 1000, [&]() {
+    json sub_tree;
+    VINEYARD_DISCARD(meta_tree::GetData(
+        tree, "i0", objects[random() % objects.size()], sub_tree));
+  });
+  double filter = measure(rounds, [&]() {
+    std::vector<ObjectID> filtered;
+    VINEYARD_DISCARD(meta_tree::FilterAtInstance(tree, 1, filtered));
+  });
+  double equivalent = measure(rounds * 1000, [&]() {
+    ObjectID target = InvalidObjectID();
+    meta_tree::HasEquivalent(tree, objects[random() % objects.size()],
+                             target);
+  });
+
+  std::cout << "    ListData (wildcard, limit 1000): " << list_wildcard
+            << " us" << std::endl
+            << "    ListData (regex, limit 1000):    " << list_regex << " us"
+            << std::endl
+            << "    Exists:                          " << exists << " us"
+            << std::endl
+            << "    GetData:                         " << get_data << " us"
+            << std::endl
+            << "    FilterAtInstance:                " << filter << " us"
+            << std::endl
+            << "    HasEquivalent:                   " << equivalent << " us"
+            << std::endl;
+}
+
+int main(int argc, char** argv) {
+  size_t num_objects = 100000, rounds = 10;
+  if (argc > 1) {
+    num_objects = std::strtoull(argv[1], nullptr, 10);
+  }
+  if (argc > 2) {
+    rounds = std::strtoull(argv[2], nullptr, 10);
+  }
+
+  json tree;
+  std::vector<ObjectID> objects;
+  make_tree(num_objects, tree, objects);
+
+  std::cout << num_objects << " objects, without index:" << std::endl;
+  bench_queries(tree, objects, rounds);
+
+  {
+    meta_tree::MetaIndex index(tree);
+    auto start = clock_type::now();
+    index.Rebuild();
+    auto end = clock_type::now();
+    std::cout << num_objects << " objects, with index (built in "
+              << std::chrono::duration<double, std::milli>(end - start).count()
+              << " ms):" << std::endl;
+    bench_queries(tree, objects, rounds);
+  }
+  return 0;
+}
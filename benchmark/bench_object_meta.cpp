@@ -0,0 +1,242 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * Benchmark of constructing objects with many members from the metadata,
+ * see also Notes [Lazy Member Metadata] in "client/ds/object_meta.cc".
+ *
+ * Usage:
+ *
+ *    ./bench_object_meta [vertex_label_num] [edge_label_num] [rounds]
+ *
+ * The metadata has the same layout of members as the `ArrowFragment` (50
+ * vertex labels and 50 edge labels by default): vertex and edge tables,
+ * per-label vertex maps and, for every (vertex label, edge label) pair, the
+ * incoming and outgoing adjacent lists and their offsets. The construction
+ * mirrors `Object::Construct`: every object keeps a copy of its metadata,
+ * reads a few key-values, and constructs its members from `GetMemberMeta`
+ * recursively, down to blobs, which look up their buffers.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "client/ds/object_meta.h"
+#include "common/util/json.h"
+#include "common/util/uuid.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using clock_type = std::chrono::high_resolution_clock;
+
+static const size_t blob_size = 64;
+static uint8_t blob_data[blob_size];
+
+struct meta_builder_t {
+  std::vector<ObjectID> blobs;
+  ObjectID next_id = 1;
+
+  json blob() {
+    ObjectID id = GenerateBlobID(
+        reinterpret_cast<uintptr_t>(blob_data) + (blobs.size() << 8));
+    blobs.emplace_back(id);
+    json tree;
+    tree["id"] = VYObjectIDToString(id);
+    tree["typename"] = "vineyard::Blob";
+    tree["instance_id"] = 0;
+    tree["length"] = blob_size;
+    tree["nbytes"] = blob_size;
+    tree["transient"] = true;
+    return tree;
+  }
+
+  json object(const std::string& type_name) {
+    json tree;
+    tree["id"] = VYObjectIDToString((next_id++) << 16);
+    tree["typename"] = type_name;
+    tree["instance_id"] = 0;
+    tree["nbytes"] = blob_size;
+    tree["transient"] = true;
+    return tree;
+  }
+
+  json array() {
+    json tree = object("vineyard::NumericArray<int64>");
+    tree["length_"] = 8;
+    tree["null_count_"] = 0;
+    tree["offset_"] = 0;
+    tree["buffer_"] = blob();
+    tree["null_bitmap_"] = blob();
+    return tree;
+  }
+
+  json binary_array() {
+    json tree = object("vineyard::FixedSizeBinaryArray");
+    tree["length_"] = 8;
+    tree["null_count_"] = 0;
+    tree["offset_"] = 0;
+    tree["byte_width_"] = 16;
+    tree["buffer_"] = blob();
+    tree["null_bitmap_"] = blob();
+    return tree;
+  }
+
+  json table(const size_t num_columns) {
+    json batch = object("vineyard::RecordBatch");
+    batch["__columns_-size"] = num_columns;
+    for (size_t column = 0; column < num_columns; ++column) {
+      batch["__columns_-" + std::to_string(column)] = array();
+    }
+    json tree = object("vineyard::Table");
+    tree["schema_"] = std::string(256, 's');
+    tree["__batches_-size"] = 1;
+    tree["__batches_-0"] = batch;
+    return tree;
+  }
+
+  json hashmap() {
+    json tree = object("vineyard::Hashmap<int64,uint64>");
+    tree["num_slots_minus_one_"] = 7;
+    tree["max_lookups_"] = 1;
+    tree["num_elements_"] = 8;
+    tree["entries"] = array();
+    return tree;
+  }
+
+  json fragment(const size_t vertex_label_num, const size_t edge_label_num) {
+    json schema;
+    for (size_t label = 0; label < vertex_label_num + edge_label_num;
+         ++label) {
+      json entry;
+      entry["id"] = label;
+      entry["label"] = "label_" + std::to_string(label);
+      entry["type"] = label < vertex_label_num ? "VERTEX" : "EDGE";
+      entry["props"] = json::array({"weight", "date", "name", "value"});
+      schema["types"].push_back(entry);
+    }
+
+    json tree = object("vineyard::ArrowFragment<int64,uint64>");
+    tree["fid"] = 0;
+    tree["fnum"] = 1;
+    tree["directed"] = 1;
+    tree["vertex_label_num"] = vertex_label_num;
+    tree["edge_label_num"] = edge_label_num;
+    tree["schema"] = json_to_string(schema);
+    tree["ivnums"] = array();
+    tree["ovnums"] = array();
+    tree["tvnums"] = array();
+    for (size_t i = 0; i < vertex_label_num; ++i) {
+      std::string suffix = "_" + std::to_string(i);
+      tree["vertex_tables" + suffix] = table(4);
+      tree["ovgid_lists" + suffix] = array();
+      tree["ovg2l_maps" + suffix] = hashmap();
+    }
+    for (size_t j = 0; j < edge_label_num; ++j) {
+      tree["edge_tables_" + std::to_string(j)] = table(4);
+    }
+    for (size_t i = 0; i < vertex_label_num; ++i) {
+      for (size_t j = 0; j < edge_label_num; ++j) {
+        std::string suffix = "_" + std::to_string(i) + "_" + std::to_string(j);
+        tree["ie_lists" + suffix] = binary_array();
+        tree["oe_lists" + suffix] = binary_array();
+        tree["ie_offsets_lists" + suffix] = array();
+        tree["oe_offsets_lists" + suffix] = array();
+      }
+    }
+    json vertex_map = object("vineyard::ArrowVertexMap<int64,uint64>");
+    for (size_t i = 0; i < vertex_label_num; ++i) {
+      vertex_map["o2g_0_" + std::to_string(i)] = hashmap();
+      vertex_map["oid_arrays_0_" + std::to_string(i)] = array();
+    }
+    tree["vertex_map"] = vertex_map;
+    return tree;
+  }
+};
+
+static void construct(const ObjectMeta& meta, size_t& blobs, size_t& nbytes) {
+  // as `Object::Construct`, which keeps a copy of the metadata
+  ObjectMeta self = meta;
+  ObjectID id = self.GetId();
+  if (IsBlob(id)) {
+    std::shared_ptr<arrow::Buffer> buffer;
+    VINEYARD_CHECK_OK(self.GetBuffer(id, buffer));
+    blobs += 1;
+    return;
+  }
+  if (self.GetTypeName().empty()) {
+    return;
+  }
+  nbytes += self.GetNBytes();
+  for (auto const& item : self) {
+    if (item.value().is_object()) {
+      construct(self.GetMemberMeta(item.key()), blobs, nbytes);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t vertex_label_num = 50, edge_label_num = 50, rounds = 5;
+  if (argc > 1) {
+    vertex_label_num = std::strtoull(argv[1], nullptr, 10);
+  }
+  if (argc > 2) {
+    edge_label_num = std::strtoull(argv[2], nullptr, 10);
+  }
+  if (argc > 3) {
+    rounds = std::strtoull(argv[3], nullptr, 10);
+  }
+
+  meta_builder_t builder;
+  json tree = builder.fragment(vertex_label_num, edge_label_num);
+  std::vector<uintptr_t> pointers(builder.blobs.size(),
+                                  reinterpret_cast<uintptr_t>(blob_data));
+  std::vector<size_t> sizes(builder.blobs.size(), blob_size);
+  auto meta = ObjectMeta::Unsafe(tree, builder.blobs.size(),
+                                 builder.blobs.data(), pointers.data(),
+                                 sizes.data());
+  std::cout << vertex_label_num << " vertex labels, " << edge_label_num
+            << " edge labels, " << builder.blobs.size() << " blobs"
+            << std::endl;
+
+  double total = 0;
+  for (size_t round = 0; round < rounds; ++round) {
+    size_t blobs = 0, nbytes = 0;
+    auto start = clock_type::now();
+    {
+      ObjectMeta fragment = *meta;
+      // the graph schema is looked up for every label
+      for (size_t label = 0; label < vertex_label_num + edge_label_num;
+           ++label) {
+        json schema;
+        fragment.GetKeyValue("schema", schema);
+      }
+      construct(fragment, blobs, nbytes);
+    }
+    auto end = clock_type::now();
+    double elapsed =
+        std::chrono::duration<double, std::milli>(end - start).count();
+    total += elapsed;
+    std::cout << "round " << round << ": constructed " << blobs
+              << " blobs in " << elapsed << " ms" << std::endl;
+  }
+  std::cout << "construct: " << total / rounds << " ms on average"
+            << std::endl;
+  return 0;
+}
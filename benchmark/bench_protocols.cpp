@@ -0,0 +1,144 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * Microbenchmark for the per-call encoding cost of IPC commands, comparing
+ * the JSON encoding and the binary protocol, see also
+ * Notes [Binary Protocol] in "common/util/protocols.h".
+ *
+ * Usage:
+ *
+ *    ./bench_protocols [num_ids] [rounds]
+ *
+ * Each round encodes a request on the "client" side, decodes it on the
+ * "server" side, then encodes the reply and decodes it on the "client" side,
+ * which mirrors the JSON work done for one GetBuffers/CreateBuffer call.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "common/memory/payload.h"
+#include "common/util/json.h"
+#include "common/util/protocols.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using clock_type = std::chrono::high_resolution_clock;
+
+template <typename F>
+static double measure(const size_t rounds, F&& fn) {
+  auto start = clock_type::now();
+  for (size_t round = 0; round < rounds; ++round) {
+    fn();
+  }
+  auto end = clock_type::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         rounds;
+}
+
+static void bench_get_buffers(const size_t num_ids, const size_t rounds) {
+  std::set<ObjectID> ids;
+  std::vector<std::shared_ptr<Payload>> objects;
+  for (size_t index = 1; index <= num_ids; ++index) {
+    ids.emplace(GenerateBlobID(index * 64));
+    objects.emplace_back(std::make_shared<Payload>(
+        GenerateBlobID(index * 64), 64, nullptr, 3, 1024 * 1024 * 1024,
+        index * 64));
+  }
+
+  std::string request, reply;
+  double json_latency = measure(rounds, [&]() {
+    WriteGetBuffersRequest(ids, request);
+    std::vector<ObjectID> ids_get;
+    VINEYARD_DISCARD(ReadGetBuffersRequest(json::parse(request), ids_get));
+    WriteGetBuffersReply(objects, reply);
+    std::vector<Payload> objects_get;
+    VINEYARD_DISCARD(ReadGetBuffersReply(json::parse(reply), objects_get));
+  });
+  size_t json_bytes = request.size() + reply.size();
+
+  double binary_latency = measure(rounds, [&]() {
+    WriteGetBuffersRequestBinary(ids, request);
+    std::vector<ObjectID> ids_get;
+    BinaryDecoder request_decoder(request);
+    VINEYARD_DISCARD(ReadGetBuffersRequestBinary(request_decoder, ids_get));
+    WriteGetBuffersReplyBinary(objects, {3}, reply);
+    std::vector<Payload> objects_get;
+    std::vector<int> fds_get;
+    BinaryDecoder reply_decoder(reply);
+    VINEYARD_DISCARD(
+        ReadGetBuffersReplyBinary(reply_decoder, objects_get, fds_get));
+  });
+  size_t binary_bytes = request.size() + reply.size();
+
+  std::cout << "get_buffers with " << num_ids << " ids:" << std::endl
+            << "    json:   " << json_latency << " us/call, " << json_bytes
+            << " bytes" << std::endl
+            << "    binary: " << binary_latency << " us/call, "
+            << binary_bytes << " bytes" << std::endl;
+}
+
+static void bench_create_buffer(const size_t rounds) {
+  auto object = std::make_shared<Payload>(GenerateBlobID(64), 4096, nullptr, 3,
+                                          1024 * 1024 * 1024, 64);
+
+  std::string request, reply;
+  double json_latency = measure(rounds, [&]() {
+    size_t size = 0;
+    WriteCreateBufferRequest(4096, request);
+    VINEYARD_DISCARD(ReadCreateBufferRequest(json::parse(request), size));
+    WriteCreateBufferReply(object->object_id, object, reply);
+    ObjectID id = InvalidObjectID();
+    Payload payload;
+    VINEYARD_DISCARD(ReadCreateBufferReply(json::parse(reply), id, payload));
+  });
+
+  double binary_latency = measure(rounds, [&]() {
+    size_t size = 0;
+    WriteCreateBufferRequestBinary(4096, request);
+    BinaryDecoder request_decoder(request);
+    VINEYARD_DISCARD(ReadCreateBufferRequestBinary(request_decoder, size));
+    WriteCreateBufferReplyBinary(object->object_id, object, reply);
+    ObjectID id = InvalidObjectID();
+    Payload payload;
+    BinaryDecoder reply_decoder(reply);
+    VINEYARD_DISCARD(ReadCreateBufferReplyBinary(reply_decoder, id, payload));
+  });
+
+  std::cout << "create_buffer:" << std::endl
+            << "    json:   " << json_latency << " us/call" << std::endl
+            << "    binary: " << binary_latency << " us/call" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  size_t num_ids = 1000, rounds = 1000;
+  if (argc > 1) {
+    num_ids = std::strtoull(argv[1], nullptr, 10);
+  }
+  if (argc > 2) {
+    rounds = std::strtoull(argv[2], nullptr, 10);
+  }
+
+  bench_get_buffers(1, rounds * 100);
+  bench_get_buffers(num_ids, rounds);
+  bench_create_buffer(rounds * 100);
+  return 0;
+}
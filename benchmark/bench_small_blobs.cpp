@@ -0,0 +1,155 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * Benchmark of the footprint and the allocation latency of the bulk store
+ * for a mix of small objects, with and without slabs, see also Notes [Small
+ * Blob Allocator] in "server/memory/slab_allocator.h".
+ *
+ * Usage:
+ *
+ *    ./bench_small_blobs [small_blob_size] [memory_mb]
+ *
+ * e.g., compare
+ *
+ *    ./bench_small_blobs 0
+ *    ./bench_small_blobs 65536
+ *
+ * The mix resembles the blobs of graphs and dataframes: mostly scalars and
+ * short arrays, some hashmap metadata arrays, and a few large columns.
+ *
+ * The shared memory is filled with blobs until the allocation fails, and the
+ * utilization is the fraction of the shared memory that holds the requested
+ * bytes, i.e., what is not lost to the allocator. Then half of the blobs are
+ * deleted in random order and the memory is filled again, to measure the
+ * utilization under churn.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/memory/payload.h"
+#include "common/util/status.h"
+#include "server/memory/memory.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using clock_type = std::chrono::high_resolution_clock;
+
+static size_t next_size(std::mt19937_64& rng) {
+  std::uniform_real_distribution<double> kind(0, 1);
+  double p = kind(rng);
+  if (p < 0.6) {
+    // scalars and tiny arrays
+    return std::uniform_int_distribution<size_t>(8, 64)(rng);
+  } else if (p < 0.9) {
+    // short arrays, offsets and null bitmaps
+    return std::uniform_int_distribution<size_t>(64, 4096)(rng);
+  } else if (p < 0.99) {
+    // hashmap metadata arrays
+    return std::uniform_int_distribution<size_t>(4096, 65536)(rng);
+  } else {
+    // large columns
+    return std::uniform_int_distribution<size_t>(65536, 1 << 20)(rng);
+  }
+}
+
+static void report(const std::string& phase, const size_t blobs,
+                   const size_t requested, const double seconds,
+                   const size_t memory) {
+  std::cout << phase << ": " << blobs << " blobs, " << (requested >> 20)
+            << " MiB requested, utilization "
+            << static_cast<double>(requested) / memory * 100 << "%, "
+            << seconds * 1e9 / std::max(blobs, static_cast<size_t>(1))
+            << " ns/blob" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  size_t small_blob_size = 64 * 1024, memory_mb = 1024;
+  if (argc > 1) {
+    small_blob_size = std::strtoull(argv[1], nullptr, 10);
+  }
+  if (argc > 2) {
+    memory_mb = std::strtoull(argv[2], nullptr, 10);
+  }
+  size_t memory = memory_mb << 20;
+
+  BulkStore store;
+  VINEYARD_CHECK_OK(store.PreAllocate(memory));
+  VINEYARD_CHECK_OK(store.SetSmallBlobSize(small_blob_size));
+
+  std::mt19937_64 rng(20211016);
+  std::vector<ObjectID> ids;
+  std::vector<size_t> sizes;
+  size_t requested = 0;
+  // fill until the allocation fails, returns the number of new blobs
+  auto fill = [&]() -> size_t {
+    size_t count = 0;
+    while (true) {
+      size_t size = next_size(rng);
+      ObjectID id = InvalidObjectID();
+      std::shared_ptr<Payload> object;
+      if (!store.Create(size, id, object).ok()) {
+        return count;
+      }
+      ids.emplace_back(id);
+      sizes.emplace_back(size);
+      requested += size;
+      count += 1;
+    }
+  };
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "small blob size: " << small_blob_size << ", memory: "
+            << memory_mb << " MiB" << std::endl;
+
+  auto start = clock_type::now();
+  size_t count = fill();
+  report("fill", count, requested,
+         std::chrono::duration<double>(clock_type::now() - start).count(),
+         memory);
+
+  std::vector<size_t> victims(ids.size());
+  for (size_t index = 0; index < ids.size(); ++index) {
+    victims[index] = index;
+  }
+  std::shuffle(victims.begin(), victims.end(), rng);
+  victims.resize(victims.size() / 2);
+  std::sort(victims.begin(), victims.end(), std::greater<size_t>());
+  for (size_t index : victims) {
+    VINEYARD_CHECK_OK(store.Delete(ids[index]));
+    requested -= sizes[index];
+    ids[index] = ids.back();
+    ids.pop_back();
+    sizes[index] = sizes.back();
+    sizes.pop_back();
+  }
+  start = clock_type::now();
+  count = fill();
+  report("refill", count, requested,
+         std::chrono::duration<double>(clock_type::now() - start).count(),
+         memory);
+
+  std::cout << "allocator: " << store.AllocatorStats().dump() << std::endl;
+  return 0;
+}
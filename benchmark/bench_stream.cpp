@@ -0,0 +1,167 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * Throughput benchmark of streaming chunks from a producer to a consumer,
+ * chunk by chunk and in batches, see also Notes [Stream Chunk Batches] in
+ * "server/memory/stream_store.h".
+ *
+ * Usage:
+ *
+ *    ./bench_stream <ipc_socket> [total_mb] [chunk_kb] [batches...]
+ *
+ * e.g.,
+ *
+ *    ./bench_stream /var/run/vineyard.sock 8192 2048 1 4 16
+ *
+ * The producer fills every chunk and the consumer reads every byte, a batch
+ * of 1 uses the chunk-by-chunk requests.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/buffer.h"
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using clock_type = std::chrono::high_resolution_clock;
+
+static ObjectID create_stream(Client& client) {
+  ByteStreamBuilder builder(client);
+  builder.SetParams(std::unordered_map<std::string, std::string>{
+      {"kind", "bench"}, {"test_name", "bench_stream"}});
+  return builder.Seal(client)->id();
+}
+
+static void produce(const std::string& ipc_socket, const ObjectID stream_id,
+                    const size_t chunks, const size_t chunk_size,
+                    const size_t batch) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(client.OpenStream(stream_id, OpenStreamMode::write));
+  for (size_t chunk = 0; chunk < chunks; chunk += batch) {
+    size_t count = std::min(batch, chunks - chunk);
+    if (batch == 1) {
+      std::unique_ptr<arrow::MutableBuffer> buffer;
+      VINEYARD_CHECK_OK(
+          client.GetNextStreamChunk(stream_id, chunk_size, buffer));
+      memset(buffer->mutable_data(), static_cast<int>(chunk), chunk_size);
+    } else {
+      std::vector<std::unique_ptr<arrow::MutableBuffer>> buffers;
+      VINEYARD_CHECK_OK(client.GetNextStreamChunks(stream_id, chunk_size,
+                                                   count, buffers));
+      for (size_t index = 0; index < count; ++index) {
+        memset(buffers[index]->mutable_data(),
+               static_cast<int>(chunk + index), chunk_size);
+      }
+    }
+  }
+  VINEYARD_CHECK_OK(client.StopStream(stream_id, false));
+  client.Disconnect();
+}
+
+static uint64_t consume(Client& client, const ObjectID stream_id,
+                        const size_t batch) {
+  uint64_t checksum = 0;
+  auto scan = [&checksum](const arrow::Buffer& buffer) {
+    auto data = reinterpret_cast<const uint64_t*>(buffer.data());
+    for (int64_t index = 0; index < buffer.size() / 8; ++index) {
+      checksum += data[index];
+    }
+  };
+  while (true) {
+    Status status;
+    if (batch == 1) {
+      std::unique_ptr<arrow::Buffer> buffer;
+      status = client.PullNextStreamChunk(stream_id, buffer);
+      if (status.ok()) {
+        scan(*buffer);
+      }
+    } else {
+      std::vector<std::unique_ptr<arrow::Buffer>> buffers;
+      status = client.PullNextStreamChunks(stream_id, batch, buffers);
+      for (auto const& buffer : buffers) {
+        scan(*buffer);
+      }
+    }
+    if (!status.ok()) {
+      CHECK(status.IsStreamDrained());
+      break;
+    }
+  }
+  return checksum;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: ./bench_stream <ipc_socket> [total_mb] [chunk_kb] "
+                 "[batches...]"
+              << std::endl;
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  size_t total_mb = 4096, chunk_kb = 2048;
+  if (argc > 2) {
+    total_mb = std::strtoull(argv[2], nullptr, 10);
+  }
+  if (argc > 3) {
+    chunk_kb = std::strtoull(argv[3], nullptr, 10);
+  }
+  std::vector<size_t> batches;
+  for (int index = 4; index < argc; ++index) {
+    batches.emplace_back(std::strtoull(argv[index], nullptr, 10));
+  }
+  if (batches.empty()) {
+    batches = {1, 4, 16};
+  }
+  size_t chunk_size = chunk_kb << 10;
+  size_t chunks = (total_mb << 20) / chunk_size;
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  std::cout << std::fixed << std::setprecision(2);
+  for (auto batch : batches) {
+    ObjectID stream_id = create_stream(client);
+    VINEYARD_CHECK_OK(client.OpenStream(stream_id, OpenStreamMode::read));
+
+    auto start = clock_type::now();
+    std::thread producer(produce, ipc_socket, stream_id, chunks, chunk_size,
+                         batch);
+    uint64_t checksum = consume(client, stream_id, batch);
+    producer.join();
+    auto end = clock_type::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "batch = " << batch << ": "
+              << (chunks * chunk_size) / seconds / (1UL << 30) << " GB/s"
+              << " (checksum " << checksum << ")" << std::endl;
+  }
+  client.Disconnect();
+  return 0;
+}
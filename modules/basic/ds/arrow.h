@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -29,20 +30,102 @@ limitations under the License.
 
 namespace vineyard {
 
-#ifndef BUILD_NULL_BITMAP
-#define BUILD_NULL_BITMAP(builder, array)                                \
-  {                                                                      \
-    if (array->null_bitmap() && array->null_count() > 0) {               \
-      std::unique_ptr<BlobWriter> bitmap_buffer_writer;                  \
-      RETURN_ON_ERROR(client.CreateBlob(array->null_bitmap()->size(),    \
-                                        bitmap_buffer_writer));          \
-      memcpy(bitmap_buffer_writer->data(), array->null_bitmap()->data(), \
-             array->null_bitmap()->size());                              \
-      builder->set_null_bitmap_(                                         \
-          std::shared_ptr<BlobWriter>(std::move(bitmap_buffer_writer))); \
-    } else {                                                             \
-      builder->set_null_bitmap_(Blob::MakeEmpty(client));                \
-    }                                                                    \
+namespace detail {
+
+/**
+ * @brief BlobBatch collects the arrow buffers that will be copied into blobs,
+ * and creates the blobs of all of them in a single request once the first
+ * blob is taken, see also Notes [Creating Buffers in Bulk] in
+ * "common/util/protocols.h".
+ *
+ * The array builders register their buffers on construction, and the batch
+ * is shared by the builders of a table (and of its record batches), thus
+ * sealing a table costs a single round trip for creating blobs, rather than
+ * one per buffer.
+ */
+class BlobBatch {
+ public:
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  /**
+   * @brief Returns the given batch, or a new batch if it is nullptr.
+   */
+  static std::shared_ptr<BlobBatch> Ensure(
+      std::shared_ptr<BlobBatch> const& batch) {
+    return batch ? batch : std::make_shared<BlobBatch>();
+  }
+
+  size_t Add(std::shared_ptr<arrow::Buffer> const& buffer) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    buffers_.emplace_back(buffer);
+    blobs_.emplace_back(nullptr);
+    return buffers_.size() - 1;
+  }
+
+  /**
+   * @brief Returns `npos` if the array doesn't have any null.
+   */
+  size_t AddNullBitmap(std::shared_ptr<arrow::Array> const& array) {
+    if (array->null_bitmap() && array->null_count() > 0) {
+      return Add(array->null_bitmap());
+    }
+    return npos;
+  }
+
+  /**
+   * @brief Takes the blob of the buffer at `index`, an empty blob for `npos`.
+   */
+  Status Take(Client& client, size_t const index,
+              std::shared_ptr<ObjectBase>& blob) {
+    if (index == npos) {
+      blob = Blob::MakeEmpty(client);
+      return Status::OK();
+    }
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (index >= flushed_) {
+      RETURN_ON_ERROR(flush(client));
+    }
+    blob = blobs_[index];
+    return Status::OK();
+  }
+
+ private:
+  // creates the blobs of buffers that have been added since the last flush
+  Status flush(Client& client) {
+    std::vector<size_t> sizes;
+    for (size_t index = flushed_; index < buffers_.size(); ++index) {
+      // a missing buffer (e.g., of an empty array) is an empty blob
+      sizes.emplace_back(buffers_[index] ? buffers_[index]->size() : 0);
+    }
+    std::vector<std::unique_ptr<BlobWriter>> blobs;
+    RETURN_ON_ERROR(client.CreateBlobs(sizes, blobs));
+    for (size_t index = 0; index < blobs.size(); ++index) {
+      auto& buffer = buffers_[flushed_ + index];
+      if (sizes[index] > 0) {
+        memcpy(blobs[index]->data(), buffer->data(), sizes[index]);
+      }
+      buffer.reset();
+      blobs_[flushed_ + index] =
+          std::shared_ptr<BlobWriter>(std::move(blobs[index]));
+    }
+    flushed_ = buffers_.size();
+    return Status::OK();
+  }
+
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers_;
+  std::vector<std::shared_ptr<BlobWriter>> blobs_;
+  size_t flushed_ = 0;
+};
+
+}  // namespace detail
+
+#ifndef TAKE_BLOB
+#define TAKE_BLOB(builder, setter, index)                          \
+  {                                                                \
+    std::shared_ptr<ObjectBase> __blob;                            \
+    RETURN_ON_ERROR(builder->batch_->Take(client, index, __blob)); \
+    builder->setter(__blob);                                       \
   }
 #endif
 
@@ -56,27 +139,30 @@ class NumericArrayBuilder : public NumericArrayBaseBuilder<T> {
  public:
   using ArrayType = typename ConvertToArrowType<T>::ArrayType;
 
-  NumericArrayBuilder(Client& client, std::shared_ptr<ArrayType> array)
-      : NumericArrayBaseBuilder<T>(client), array_(array) {}
+  NumericArrayBuilder(Client& client, std::shared_ptr<ArrayType> array,
+                      std::shared_ptr<detail::BlobBatch> batch = nullptr)
+      : NumericArrayBaseBuilder<T>(client),
+        array_(array),
+        batch_(detail::BlobBatch::Ensure(batch)) {
+    buffer_index_ = batch_->Add(array_->values());
+    null_bitmap_index_ = batch_->AddNullBitmap(array_);
+  }
 
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
   Status Build(Client& client) override {
-    std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
-    memcpy(buffer_writer->data(), array_->values()->data(),
-           array_->values()->size());
-
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    BUILD_NULL_BITMAP(this, array_);
+    TAKE_BLOB(this, set_buffer_, buffer_index_);
+    TAKE_BLOB(this, set_null_bitmap_, null_bitmap_index_);
     return Status::OK();
   }
 
  private:
   std::shared_ptr<ArrayType> array_;
+  std::shared_ptr<detail::BlobBatch> batch_;
+  size_t buffer_index_, null_bitmap_index_;
 };
 
 /**
@@ -88,27 +174,30 @@ class BooleanArrayBuilder : public BooleanArrayBaseBuilder {
  public:
   using ArrayType = typename ConvertToArrowType<bool>::ArrayType;
 
-  BooleanArrayBuilder(Client& client, std::shared_ptr<ArrayType> array)
-      : BooleanArrayBaseBuilder(client), array_(array) {}
+  BooleanArrayBuilder(Client& client, std::shared_ptr<ArrayType> array,
+                      std::shared_ptr<detail::BlobBatch> batch = nullptr)
+      : BooleanArrayBaseBuilder(client),
+        array_(array),
+        batch_(detail::BlobBatch::Ensure(batch)) {
+    buffer_index_ = batch_->Add(array_->values());
+    null_bitmap_index_ = batch_->AddNullBitmap(array_);
+  }
 
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
   Status Build(Client& client) override {
-    std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
-    memcpy(buffer_writer->data(), array_->values()->data(),
-           array_->values()->size());
-
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    BUILD_NULL_BITMAP(this, array_);
+    TAKE_BLOB(this, set_buffer_, buffer_index_);
+    TAKE_BLOB(this, set_null_bitmap_, null_bitmap_index_);
     return Status::OK();
   }
 
  private:
   std::shared_ptr<ArrayType> array_;
+  std::shared_ptr<detail::BlobBatch> batch_;
+  size_t buffer_index_, null_bitmap_index_;
 };
 
 /**
@@ -119,41 +208,32 @@ class BooleanArrayBuilder : public BooleanArrayBaseBuilder {
 template <typename ArrayType>
 class BaseBinaryArrayBuilder : public BaseBinaryArrayBaseBuilder<ArrayType> {
  public:
-  BaseBinaryArrayBuilder(Client& client, std::shared_ptr<ArrayType> array)
-      : BaseBinaryArrayBaseBuilder<ArrayType>(client), array_(array) {}
+  BaseBinaryArrayBuilder(Client& client, std::shared_ptr<ArrayType> array,
+                         std::shared_ptr<detail::BlobBatch> batch = nullptr)
+      : BaseBinaryArrayBaseBuilder<ArrayType>(client),
+        array_(array),
+        batch_(detail::BlobBatch::Ensure(batch)) {
+    buffer_offsets_index_ = batch_->Add(array_->value_offsets());
+    buffer_data_index_ = batch_->Add(array_->value_data());
+    null_bitmap_index_ = batch_->AddNullBitmap(array_);
+  }
 
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
   Status Build(Client& client) override {
-    {
-      std::unique_ptr<BlobWriter> buffer_writer;
-      RETURN_ON_ERROR(
-          client.CreateBlob(array_->value_offsets()->size(), buffer_writer));
-      memcpy(buffer_writer->data(), array_->value_offsets()->data(),
-             array_->value_offsets()->size());
-
-      this->set_buffer_offsets_(
-          std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    }
-    {
-      std::unique_ptr<BlobWriter> buffer_writer;
-      RETURN_ON_ERROR(
-          client.CreateBlob(array_->value_data()->size(), buffer_writer));
-      memcpy(buffer_writer->data(), array_->value_data()->data(),
-             array_->value_data()->size());
-
-      this->set_buffer_data_(
-          std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    }
+    TAKE_BLOB(this, set_buffer_offsets_, buffer_offsets_index_);
+    TAKE_BLOB(this, set_buffer_data_, buffer_data_index_);
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    BUILD_NULL_BITMAP(this, array_);
+    TAKE_BLOB(this, set_null_bitmap_, null_bitmap_index_);
     return Status::OK();
   }
 
  private:
   std::shared_ptr<ArrayType> array_;
+  std::shared_ptr<detail::BlobBatch> batch_;
+  size_t buffer_offsets_index_, buffer_data_index_, null_bitmap_index_;
 };
 
 using BinaryArrayBuilder = BaseBinaryArrayBuilder<arrow::BinaryArray>;
@@ -169,8 +249,14 @@ using LargeStringArrayBuilder = BaseBinaryArrayBuilder<arrow::LargeStringArray>;
 class FixedSizeBinaryArrayBuilder : public FixedSizeBinaryArrayBaseBuilder {
  public:
   FixedSizeBinaryArrayBuilder(
-      Client& client, std::shared_ptr<arrow::FixedSizeBinaryArray> array)
-      : FixedSizeBinaryArrayBaseBuilder(client), array_(array) {}
+      Client& client, std::shared_ptr<arrow::FixedSizeBinaryArray> array,
+      std::shared_ptr<detail::BlobBatch> batch = nullptr)
+      : FixedSizeBinaryArrayBaseBuilder(client),
+        array_(array),
+        batch_(detail::BlobBatch::Ensure(batch)) {
+    buffer_index_ = batch_->Add(array_->values());
+    null_bitmap_index_ = batch_->AddNullBitmap(array_);
+  }
 
   std::shared_ptr<arrow::FixedSizeBinaryArray> GetArray() { return array_; }
 
@@ -178,22 +264,19 @@ class FixedSizeBinaryArrayBuilder : public FixedSizeBinaryArrayBaseBuilder {
     VINEYARD_ASSERT(array_->length() == 0 || array_->values()->size() != 0,
                     "Invalid array values");
 
-    std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
-    memcpy(buffer_writer->data(), array_->values()->data(),
-           array_->values()->size());
-
     this->set_byte_width_(array_->byte_width());
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    BUILD_NULL_BITMAP(this, array_);
+    TAKE_BLOB(this, set_buffer_, buffer_index_);
+    TAKE_BLOB(this, set_null_bitmap_, null_bitmap_index_);
     return Status::OK();
   }
 
  private:
   std::shared_ptr<arrow::FixedSizeBinaryArray> array_;
+  std::shared_ptr<detail::BlobBatch> batch_;
+  size_t buffer_index_, null_bitmap_index_;
 };
 
 /**
@@ -202,7 +285,8 @@ class FixedSizeBinaryArrayBuilder : public FixedSizeBinaryArrayBaseBuilder {
  */
 class NullArrayBuilder : public NullArrayBaseBuilder {
  public:
-  NullArrayBuilder(Client& client, std::shared_ptr<arrow::NullArray> array)
+  NullArrayBuilder(Client& client, std::shared_ptr<arrow::NullArray> array,
+                   std::shared_ptr<detail::BlobBatch> batch = nullptr)
       : NullArrayBaseBuilder(client), array_(array) {}
 
   std::shared_ptr<arrow::NullArray> GetArray() { return array_; }
@@ -221,74 +305,76 @@ namespace detail {
 template <typename T>
 inline std::shared_ptr<ObjectBuilder> BuildNumericArray(
     Client& client,
-    std::shared_ptr<typename ConvertToArrowType<T>::ArrayType> arr) {
-  return std::make_shared<NumericArrayBuilder<T>>(client, arr);
+    std::shared_ptr<typename ConvertToArrowType<T>::ArrayType> arr,
+    std::shared_ptr<BlobBatch> batch) {
+  return std::make_shared<NumericArrayBuilder<T>>(client, arr, batch);
 }
 
 inline std::shared_ptr<ObjectBuilder> BuildSimpleArray(
-    Client& client, std::shared_ptr<arrow::Array> array) {
+    Client& client, std::shared_ptr<arrow::Array> array,
+    std::shared_ptr<BlobBatch> batch = nullptr) {
   if (auto arr =
           std::dynamic_pointer_cast<ConvertToArrowType<int8_t>::ArrayType>(
               array)) {
-    return BuildNumericArray<int8_t>(client, arr);
+    return BuildNumericArray<int8_t>(client, arr, batch);
   }
   if (auto arr =
           std::dynamic_pointer_cast<ConvertToArrowType<uint8_t>::ArrayType>(
               array)) {
-    return BuildNumericArray<uint8_t>(client, arr);
+    return BuildNumericArray<uint8_t>(client, arr, batch);
   }
   if (auto arr =
           std::dynamic_pointer_cast<ConvertToArrowType<int16_t>::ArrayType>(
               array)) {
-    return BuildNumericArray<int16_t>(client, arr);
+    return BuildNumericArray<int16_t>(client, arr, batch);
   }
   if (auto arr =
           std::dynamic_pointer_cast<ConvertToArrowType<uint16_t>::ArrayType>(
               array)) {
-    return BuildNumericArray<uint16_t>(client, arr);
+    return BuildNumericArray<uint16_t>(client, arr, batch);
   }
   if (auto arr =
           std::dynamic_pointer_cast<ConvertToArrowType<int32_t>::ArrayType>(
               array)) {
-    return BuildNumericArray<int32_t>(client, arr);
+    return BuildNumericArray<int32_t>(client, arr, batch);
   }
   if (auto arr =
           std::dynamic_pointer_cast<ConvertToArrowType<uint32_t>::ArrayType>(
               array)) {
-    return BuildNumericArray<uint32_t>(client, arr);
+    return BuildNumericArray<uint32_t>(client, arr, batch);
   }
   if (auto arr =
           std::dynamic_pointer_cast<ConvertToArrowType<int64_t>::ArrayType>(
               array)) {
-    return BuildNumericArray<int64_t>(client, arr);
+    return BuildNumericArray<int64_t>(client, arr, batch);
   }
   if (auto arr =
           std::dynamic_pointer_cast<ConvertToArrowType<uint64_t>::ArrayType>(
               array)) {
-    return BuildNumericArray<uint64_t>(client, arr);
+    return BuildNumericArray<uint64_t>(client, arr, batch);
   }
   if (auto arr =
           std::dynamic_pointer_cast<ConvertToArrowType<float>::ArrayType>(
               array)) {
-    return BuildNumericArray<float>(client, arr);
+    return BuildNumericArray<float>(client, arr, batch);
   }
   if (auto arr =
           std::dynamic_pointer_cast<ConvertToArrowType<double>::ArrayType>(
               array)) {
-    return BuildNumericArray<double>(client, arr);
+    return BuildNumericArray<double>(client, arr, batch);
   }
   if (auto arr =
           std::dynamic_pointer_cast<arrow::FixedSizeBinaryArray>(array)) {
-    return std::make_shared<FixedSizeBinaryArrayBuilder>(client, arr);
+    return std::make_shared<FixedSizeBinaryArrayBuilder>(client, arr, batch);
   }
   if (auto arr = std::dynamic_pointer_cast<arrow::StringArray>(array)) {
-    return std::make_shared<StringArrayBuilder>(client, arr);
+    return std::make_shared<StringArrayBuilder>(client, arr, batch);
   }
   if (auto arr = std::dynamic_pointer_cast<arrow::LargeStringArray>(array)) {
-    return std::make_shared<LargeStringArrayBuilder>(client, arr);
+    return std::make_shared<LargeStringArrayBuilder>(client, arr, batch);
   }
   if (auto arr = std::dynamic_pointer_cast<arrow::NullArray>(array)) {
-    return std::make_shared<NullArrayBuilder>(client, arr);
+    return std::make_shared<NullArrayBuilder>(client, arr, batch);
   }
   VINEYARD_ASSERT(nullptr != nullptr,
                   "Unsupported array type: " + array->type()->ToString());
@@ -305,54 +391,52 @@ inline std::shared_ptr<ObjectBuilder> BuildSimpleArray(
 template <typename ArrayType>
 class BaseListArrayBuilder : public BaseListArrayBaseBuilder<ArrayType> {
  public:
-  BaseListArrayBuilder(Client& client, std::shared_ptr<ArrayType> array)
-      : BaseListArrayBaseBuilder<ArrayType>(client), array_(array) {}
+  BaseListArrayBuilder(Client& client, std::shared_ptr<ArrayType> array,
+                       std::shared_ptr<detail::BlobBatch> batch = nullptr)
+      : BaseListArrayBaseBuilder<ArrayType>(client),
+        array_(array),
+        batch_(detail::BlobBatch::Ensure(batch)) {
+    buffer_offsets_index_ = batch_->Add(array_->value_offsets());
+    // Assuming the list is not nested.
+    // We need to split the definition to .cc if someday we need to consider
+    // nested list in list case.
+    values_ = detail::BuildSimpleArray(client, array_->values(), batch_);
+    null_bitmap_index_ = batch_->AddNullBitmap(array_);
+  }
 
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
   Status Build(Client& client) override {
-    {
-      std::unique_ptr<BlobWriter> buffer_writer;
-      RETURN_ON_ERROR(
-          client.CreateBlob(array_->value_offsets()->size(), buffer_writer));
-      memcpy(buffer_writer->data(), array_->value_offsets()->data(),
-             array_->value_offsets()->size());
-
-      this->set_buffer_offsets_(
-          std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    }
-    {
-      // Assuming the list is not nested.
-      // We need to split the definition to .cc if someday we need to consider
-      // nested list in list case.
-      this->set_values_(detail::BuildSimpleArray(client, array_->values()));
-    }
+    TAKE_BLOB(this, set_buffer_offsets_, buffer_offsets_index_);
+    this->set_values_(values_);
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    BUILD_NULL_BITMAP(this, array_);
+    TAKE_BLOB(this, set_null_bitmap_, null_bitmap_index_);
     return Status::OK();
   }
 
  private:
   std::shared_ptr<ArrayType> array_;
+  std::shared_ptr<detail::BlobBatch> batch_;
+  size_t buffer_offsets_index_, null_bitmap_index_;
+  std::shared_ptr<ObjectBuilder> values_;
 };
 
 using ListArrayBuilder = BaseListArrayBuilder<arrow::ListArray>;
 using LargeListArrayBuilder = BaseListArrayBuilder<arrow::LargeListArray>;
 
-#undef BUILD_NULL_BITMAP
-
 namespace detail {
 inline std::shared_ptr<ObjectBuilder> BuildArray(
-    Client& client, std::shared_ptr<arrow::Array> array) {
+    Client& client, std::shared_ptr<arrow::Array> array,
+    std::shared_ptr<BlobBatch> batch = nullptr) {
   if (auto arr = std::dynamic_pointer_cast<arrow::ListArray>(array)) {
-    return std::make_shared<ListArrayBuilder>(client, arr);
+    return std::make_shared<ListArrayBuilder>(client, arr, batch);
   }
   if (auto arr = std::dynamic_pointer_cast<arrow::LargeListArray>(array)) {
-    return std::make_shared<LargeListArrayBuilder>(client, arr);
+    return std::make_shared<LargeListArrayBuilder>(client, arr, batch);
   }
-  return BuildSimpleArray(client, array);
+  return BuildSimpleArray(client, array, batch);
 }
 }  // namespace detail
 
@@ -362,36 +446,51 @@ inline std::shared_ptr<ObjectBuilder> BuildArray(
  */
 class SchemaProxyBuilder : public SchemaProxyBaseBuilder {
  public:
-  SchemaProxyBuilder(Client& client, std::shared_ptr<arrow::Schema> schema)
-      : SchemaProxyBaseBuilder(client), schema_(schema) {}
+  SchemaProxyBuilder(Client& client, std::shared_ptr<arrow::Schema> schema,
+                     std::shared_ptr<detail::BlobBatch> batch = nullptr)
+      : SchemaProxyBaseBuilder(client),
+        schema_(schema),
+        batch_(detail::BlobBatch::Ensure(batch)) {
+    std::shared_ptr<arrow::Buffer> schema_buffer;
+    status_ = serialize(schema_, schema_buffer);
+    if (status_.ok()) {
+      buffer_index_ = batch_->Add(schema_buffer);
+    }
+  }
 
  public:
   Status Build(Client& client) override {
-    std::shared_ptr<arrow::Buffer> schema_buffer;
+    RETURN_ON_ERROR(status_);
+    TAKE_BLOB(this, set_buffer_, buffer_index_);
+    return Status::OK();
+  }
+
+ private:
+  static Status serialize(std::shared_ptr<arrow::Schema> const& schema,
+                          std::shared_ptr<arrow::Buffer>& schema_buffer) {
 #if defined(ARROW_VERSION) && ARROW_VERSION < 17000
     RETURN_ON_ARROW_ERROR(arrow::ipc::SerializeSchema(
-        *schema_, nullptr, arrow::default_memory_pool(), &schema_buffer));
+        *schema, nullptr, arrow::default_memory_pool(), &schema_buffer));
 #elif defined(ARROW_VERSION) && ARROW_VERSION < 2000000
     RETURN_ON_ARROW_ERROR_AND_ASSIGN(
         schema_buffer, arrow::ipc::SerializeSchema(
-                           *schema_, nullptr, arrow::default_memory_pool()));
+                           *schema, nullptr, arrow::default_memory_pool()));
 #else
     RETURN_ON_ARROW_ERROR_AND_ASSIGN(
         schema_buffer,
-        arrow::ipc::SerializeSchema(*schema_, arrow::default_memory_pool()));
+        arrow::ipc::SerializeSchema(*schema, arrow::default_memory_pool()));
 #endif
-    std::unique_ptr<BlobWriter> schema_writer;
-    RETURN_ON_ERROR(client.CreateBlob(schema_buffer->size(), schema_writer));
-    memcpy(schema_writer->data(), schema_buffer->data(), schema_buffer->size());
-
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(schema_writer)));
     return Status::OK();
   }
 
- private:
   std::shared_ptr<arrow::Schema> schema_;
+  std::shared_ptr<detail::BlobBatch> batch_;
+  Status status_;
+  size_t buffer_index_ = detail::BlobBatch::npos;
 };
 
+#undef TAKE_BLOB
+
 /**
  * @brief RecordBatchBuilder is used for generating the batch of rows of columns
  * of equal length
@@ -399,22 +498,32 @@ class SchemaProxyBuilder : public SchemaProxyBaseBuilder {
  */
 class RecordBatchBuilder : public RecordBatchBaseBuilder {
  public:
-  RecordBatchBuilder(Client& client, std::shared_ptr<arrow::RecordBatch> batch)
-      : RecordBatchBaseBuilder(client), batch_(batch) {}
+  RecordBatchBuilder(Client& client, std::shared_ptr<arrow::RecordBatch> batch,
+                     std::shared_ptr<detail::BlobBatch> blobs = nullptr)
+      : RecordBatchBaseBuilder(client), batch_(batch) {
+    blobs = detail::BlobBatch::Ensure(blobs);
+    schema_ = std::make_shared<SchemaProxyBuilder>(client, batch_->schema(),
+                                                   blobs);
+    for (int64_t idx = 0; idx < batch_->num_columns(); ++idx) {
+      columns_.emplace_back(
+          detail::BuildArray(client, batch_->column(idx), blobs));
+    }
+  }
 
   Status Build(Client& client) override {
     this->set_column_num_(batch_->num_columns());
     this->set_row_num_(batch_->num_rows());
-    this->set_schema_(
-        std::make_shared<SchemaProxyBuilder>(client, batch_->schema()));
-    for (int64_t idx = 0; idx < batch_->num_columns(); ++idx) {
-      this->add_columns_(detail::BuildArray(client, batch_->column(idx)));
+    this->set_schema_(schema_);
+    for (auto const& column : columns_) {
+      this->add_columns_(column);
     }
     return Status::OK();
   }
 
  private:
   std::shared_ptr<arrow::RecordBatch> batch_;
+  std::shared_ptr<SchemaProxyBuilder> schema_;
+  std::vector<std::shared_ptr<ObjectBuilder>> columns_;
 };
 
 /**
@@ -424,8 +533,10 @@ class RecordBatchBuilder : public RecordBatchBaseBuilder {
  */
 class RecordBatchExtender : public RecordBatchBaseBuilder {
  public:
-  RecordBatchExtender(Client& client, std::shared_ptr<RecordBatch> batch)
-      : RecordBatchBaseBuilder(client) {
+  RecordBatchExtender(Client& client, std::shared_ptr<RecordBatch> batch,
+                      std::shared_ptr<detail::BlobBatch> blobs = nullptr)
+      : RecordBatchBaseBuilder(client),
+        blobs_(detail::BlobBatch::Ensure(blobs)) {
     row_num_ = batch->num_rows();
     column_num_ = batch->num_columns();
     schema_ = batch->schema();
@@ -453,7 +564,7 @@ class RecordBatchExtender : public RecordBatchBaseBuilder {
         schema_, schema_->AddField(schema_->num_fields(), field));
 #endif
     // extend columns
-    arrow_columns_.push_back(column);
+    column_builders_.push_back(detail::BuildArray(client, column, blobs_));
     column_num_ += 1;
     return Status::OK();
   }
@@ -462,9 +573,10 @@ class RecordBatchExtender : public RecordBatchBaseBuilder {
   Status Build(Client& client) override {
     this->set_row_num_(row_num_);
     this->set_column_num_(column_num_);
-    this->set_schema_(std::make_shared<SchemaProxyBuilder>(client, schema_));
-    for (size_t idx = 0; idx < arrow_columns_.size(); ++idx) {
-      this->add_columns_(detail::BuildArray(client, arrow_columns_[idx]));
+    this->set_schema_(
+        std::make_shared<SchemaProxyBuilder>(client, schema_, blobs_));
+    for (auto const& column_builder : column_builders_) {
+      this->add_columns_(column_builder);
     }
     return Status::OK();
   }
@@ -472,7 +584,8 @@ class RecordBatchExtender : public RecordBatchBaseBuilder {
  private:
   size_t row_num_ = 0, column_num_ = 0;
   std::shared_ptr<arrow::Schema> schema_;
-  std::vector<std::shared_ptr<arrow::Array>> arrow_columns_;
+  std::shared_ptr<detail::BlobBatch> blobs_;
+  std::vector<std::shared_ptr<ObjectBuilder>> column_builders_;
 };
 
 /**
@@ -482,8 +595,11 @@ class RecordBatchExtender : public RecordBatchBaseBuilder {
  */
 class TableBuilder : public TableBaseBuilder {
  public:
-  TableBuilder(Client& client, std::shared_ptr<arrow::Table> table)
-      : TableBaseBuilder(client), table_(table) {}
+  TableBuilder(Client& client, std::shared_ptr<arrow::Table> table,
+               std::shared_ptr<detail::BlobBatch> blobs = nullptr)
+      : TableBaseBuilder(client),
+        table_(table),
+        blobs_(detail::BlobBatch::Ensure(blobs)) {}
 
  public:
   Status Build(Client& client) override {
@@ -492,16 +608,20 @@ class TableBuilder : public TableBaseBuilder {
     this->set_batch_num_(batches.size());
     this->set_num_rows_(table_->num_rows());
     this->set_num_columns_(table_->num_columns());
+    // the blobs of all batches are created at once when the first batch is
+    // sealed, see also: detail::BlobBatch
     for (auto const& batch : batches) {
-      this->add_batches_(std::make_shared<RecordBatchBuilder>(client, batch));
+      this->add_batches_(
+          std::make_shared<RecordBatchBuilder>(client, batch, blobs_));
     }
     this->set_schema_(
-        std::make_shared<SchemaProxyBuilder>(client, table_->schema()));
+        std::make_shared<SchemaProxyBuilder>(client, table_->schema(), blobs_));
     return Status::OK();
   }
 
  private:
   std::shared_ptr<arrow::Table> table_;
+  std::shared_ptr<detail::BlobBatch> blobs_;
 };
 
 /**
@@ -510,14 +630,15 @@ class TableBuilder : public TableBaseBuilder {
  */
 class TableExtender : public TableBaseBuilder {
  public:
-  TableExtender(Client& client, std::shared_ptr<Table> table)
-      : TableBaseBuilder(client) {
+  TableExtender(Client& client, std::shared_ptr<Table> table,
+                std::shared_ptr<detail::BlobBatch> blobs = nullptr)
+      : TableBaseBuilder(client), blobs_(detail::BlobBatch::Ensure(blobs)) {
     row_num_ = table->num_rows();
     column_num_ = table->num_columns();
     schema_ = table->schema();
     for (auto const& batch : table->batches()) {
       record_batch_extenders_.push_back(
-          std::make_shared<RecordBatchExtender>(client, batch));
+          std::make_shared<RecordBatchExtender>(client, batch, blobs_));
     }
   }
 
@@ -587,13 +708,15 @@ class TableExtender : public TableBaseBuilder {
     for (auto const& extender : record_batch_extenders_) {
       this->add_batches_(extender);
     }
-    this->set_schema_(std::make_shared<SchemaProxyBuilder>(client, schema_));
+    this->set_schema_(
+        std::make_shared<SchemaProxyBuilder>(client, schema_, blobs_));
     return Status::OK();
   }
 
  private:
   size_t row_num_ = 0, column_num_ = 0;
   std::shared_ptr<arrow::Schema> schema_;
+  std::shared_ptr<detail::BlobBatch> blobs_;
   std::vector<std::shared_ptr<RecordBatchExtender>> record_batch_extenders_;
 };
 
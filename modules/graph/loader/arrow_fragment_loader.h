@@ -17,6 +17,8 @@ limitations under the License.
 #define MODULES_GRAPH_LOADER_ARROW_FRAGMENT_LOADER_H_
 
 #include <algorithm>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -392,6 +394,8 @@ class ArrowFragmentLoader {
   using vertex_table_info_t =
       std::map<std::string, std::shared_ptr<arrow::Table>>;
   using edge_table_info_t = std::vector<InputTable>;
+  using io_adaptor_t =
+      std::unique_ptr<IIOAdaptor, std::function<void(IIOAdaptor*)>>;
 
  public:
   /**
@@ -462,6 +466,13 @@ class ArrowFragmentLoader {
 
   ~ArrowFragmentLoader() = default;
 
+  /**
+   * @brief Read at most `read_ahead` files in background ahead of the one
+   * that is being processed (at least one file is always being read), thus
+   * the memory of raw tables is bounded when loading many files.
+   */
+  void SetReadAhead(const size_t read_ahead) { read_ahead_ = read_ahead; }
+
   boost::leaf::result<ObjectID> LoadFragment() {
     BOOST_LEAF_CHECK(initPartitioner());
 
@@ -612,18 +623,38 @@ class ArrowFragmentLoader {
     auto label_num = static_cast<label_id_t>(files.size());
     std::vector<std::shared_ptr<arrow::Table>> tables(label_num);
 
+    // read files in background to overlap with the schema synchronization,
+    // in a window of `read_ahead_` files
+    std::vector<io_adaptor_t> io_adaptors;
+    std::vector<Status> opened(label_num);
+    std::vector<std::shared_ptr<arrow::Table>> raw_tables(label_num);
+    std::vector<std::future<Status>> reads(label_num);
     for (label_id_t label_id = 0; label_id < label_num; ++label_id) {
-      std::unique_ptr<IIOAdaptor, std::function<void(IIOAdaptor*)>> io_adaptor(
+      io_adaptors.emplace_back(
           IOFactory::CreateIOAdaptor(files[label_id] + "#header_row=true")
               .release(),
           io_deleter_);
+    }
+    auto window = static_cast<label_id_t>(
+        std::max(read_ahead_, static_cast<size_t>(1)));
+    auto start_read = [&](label_id_t label_id) {
+      if (label_id < label_num) {
+        readTableAsync(io_adaptors[label_id], index, total_parts,
+                       opened[label_id], raw_tables[label_id],
+                       reads[label_id]);
+      }
+    };
+    for (label_id_t label_id = 0; label_id < window; ++label_id) {
+      start_read(label_id);
+    }
+
+    for (label_id_t label_id = 0; label_id < label_num; ++label_id) {
+      auto& io_adaptor = io_adaptors[label_id];
       auto read_procedure =
           [&]() -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
-        VY_OK_OR_RAISE(io_adaptor->SetPartialRead(index, total_parts));
-        VY_OK_OR_RAISE(io_adaptor->Open());
-        std::shared_ptr<arrow::Table> table;
-        VY_OK_OR_RAISE(io_adaptor->ReadTable(&table));
-        return table;
+        VY_OK_OR_RAISE(opened[label_id]);
+        VY_OK_OR_RAISE(reads[label_id].get());
+        return raw_tables[label_id];
       };
 
       BOOST_LEAF_AUTO(table, sync_gs_error(comm_spec_, read_procedure));
@@ -654,6 +685,11 @@ class ArrowFragmentLoader {
 #endif
 
       tables[label_id] = normalized_table->ReplaceSchemaMetadata(meta);
+
+      // release the raw table and the file before reading the next one
+      raw_tables[label_id] = nullptr;
+      io_adaptor.reset();
+      start_read(label_id + window);
     }
     return tables;
   }
@@ -669,19 +705,38 @@ class ArrowFragmentLoader {
         std::vector<std::string> sub_label_files;
         boost::split(sub_label_files, files[label_id], boost::is_any_of(";"));
 
-        for (size_t j = 0; j < sub_label_files.size(); ++j) {
-          std::unique_ptr<IIOAdaptor, std::function<void(IIOAdaptor*)>>
-              io_adaptor(IOFactory::CreateIOAdaptor(sub_label_files[j] +
-                                                    "#header_row=true")
-                             .release(),
-                         io_deleter_);
+        // read files in background to overlap with the schema synchronization,
+        // in a window of `read_ahead_` files
+        size_t file_num = sub_label_files.size();
+        std::vector<io_adaptor_t> io_adaptors;
+        std::vector<Status> opened(file_num);
+        std::vector<std::shared_ptr<arrow::Table>> raw_tables(file_num);
+        std::vector<std::future<Status>> reads(file_num);
+        for (size_t j = 0; j < file_num; ++j) {
+          io_adaptors.emplace_back(
+              IOFactory::CreateIOAdaptor(sub_label_files[j] +
+                                         "#header_row=true")
+                  .release(),
+              io_deleter_);
+        }
+        size_t window = std::max(read_ahead_, static_cast<size_t>(1));
+        auto start_read = [&](size_t j) {
+          if (j < file_num) {
+            readTableAsync(io_adaptors[j], index, total_parts, opened[j],
+                           raw_tables[j], reads[j]);
+          }
+        };
+        for (size_t j = 0; j < window; ++j) {
+          start_read(j);
+        }
+
+        for (size_t j = 0; j < file_num; ++j) {
+          auto& io_adaptor = io_adaptors[j];
           auto read_procedure =
               [&]() -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
-            VY_OK_OR_RAISE(io_adaptor->SetPartialRead(index, total_parts));
-            VY_OK_OR_RAISE(io_adaptor->Open());
-            std::shared_ptr<arrow::Table> table;
-            VY_OK_OR_RAISE(io_adaptor->ReadTable(&table));
-            return table;
+            VY_OK_OR_RAISE(opened[j]);
+            VY_OK_OR_RAISE(reads[j].get());
+            return raw_tables[j];
           };
           BOOST_LEAF_AUTO(table, sync_gs_error(comm_spec_, read_procedure));
 
@@ -732,6 +787,11 @@ class ArrowFragmentLoader {
 
           tables[label_id].emplace_back(
               normalized_table->ReplaceSchemaMetadata(meta));
+
+          // release the raw table and the file before reading the next one
+          raw_tables[j] = nullptr;
+          io_adaptor.reset();
+          start_read(j + window);
         }
       }
     } catch (std::exception& e) {
@@ -812,6 +872,20 @@ class ArrowFragmentLoader {
     return std::make_pair(vertex_tables_with_label, edge_tables_with_label);
   }
 
+  // open the file and start reading the table in background, see also Notes
+  // [Prefetching Reader] in "io/io/prefetch_reader.h".
+  void readTableAsync(io_adaptor_t& io_adaptor, int index, int total_parts,
+                      Status& opened, std::shared_ptr<arrow::Table>& table,
+                      std::future<Status>& read) {
+    opened = io_adaptor->SetPartialRead(index, total_parts);
+    if (opened.ok()) {
+      opened = io_adaptor->Open();
+    }
+    if (opened.ok()) {
+      read = io_adaptor->ReadTableAsync(&table);
+    }
+  }
+
   Client& client_;
   grape::CommSpec comm_spec_;
   std::vector<std::string> efiles_, vfiles_;
@@ -825,6 +899,8 @@ class ArrowFragmentLoader {
 
   bool directed_;
   bool generate_eid_;
+  // see also `SetReadAhead()`
+  size_t read_ahead_ = 2;
 
   std::function<void(IIOAdaptor*)> io_deleter_ = [](IIOAdaptor* adaptor) {
     VINEYARD_CHECK_OK(adaptor->Close());
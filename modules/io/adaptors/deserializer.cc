@@ -13,6 +13,16 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 #include "basic/stream/byte_stream.h"
 #include "basic/stream/parallel_stream.h"
 #include "client/client.h"
@@ -20,6 +30,7 @@ limitations under the License.
 #include "common/util/json.h"
 #include "common/util/logging.h"
 #include "common/util/status.h"
+#include "io/io/serialization_utils.h"
 #include "io/io/utils.h"
 
 using namespace vineyard;  // NOLINT(build/namespaces)
@@ -76,6 +87,105 @@ Status deserialize_helper(
   return Status::OK();
 }
 
+/// Restore blobs from chunks in the packed format, see also Notes
+/// [Serialization Chunk Format] in "io/io/serialization_utils.h".
+///
+/// Chunks are pulled in batches, and the blobs in a batch are copied out of
+/// the chunks by multiple threads.
+static Status deserialize_packed_blobs(
+    Client& client, std::unique_ptr<ByteStreamReader>& reader,
+    std::vector<ObjectID> const& ordered_blobs,
+    std::vector<size_t> const& blobs_size,
+    std::unordered_map<ObjectID, std::shared_ptr<Blob>>& blobs) {
+  if (ordered_blobs.size() != blobs_size.size()) {
+    return Status::Invalid("The number of blobs and blob sizes mismatch");
+  }
+  // "ordered_blobs" may list a blob more than once (the empty blob, or a blob
+  // shared by members of a global object), thus count the restored indices
+  // rather than the restored blobs.
+  std::vector<bool> restored(ordered_blobs.size(), false);
+  size_t restored_count = 0;
+  for (size_t i = 0; i < ordered_blobs.size(); ++i) {
+    if (blobs_size[i] == 0) {
+      blobs.emplace(ordered_blobs[i], Blob::MakeEmpty(client));
+      restored[i] = true;
+      restored_count += 1;
+    }
+  }
+
+  int concurrency =
+      std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+  auto start = std::chrono::steady_clock::now();
+  size_t total_bytes = 0;
+  while (true) {
+    std::vector<std::unique_ptr<arrow::Buffer>> chunks;
+    auto status = reader->GetNext(concurrency, chunks);
+    if (status.IsStreamDrained()) {
+      break;
+    }
+    RETURN_ON_ERROR(status);
+
+    // the blobs of all chunks are created in a single request
+    std::vector<size_t> indices, sizes;
+    std::vector<const uint8_t*> sources;
+    std::unordered_set<ObjectID> restoring;
+    for (auto const& chunk : chunks) {
+      size_t chunk_size = static_cast<size_t>(chunk->size());
+      const uint64_t* header = reinterpret_cast<const uint64_t*>(chunk->data());
+      if (chunk_size < PackedChunkHeaderSize(0) ||
+          header[0] > chunk_size / PackedChunkHeaderSize(1) ||
+          chunk_size < PackedChunkHeaderSize(header[0])) {
+        return Status::Invalid("Invalid chunk header in the byte stream");
+      }
+      size_t count = header[0];
+      size_t offset = PackedChunkHeaderSize(count);
+      for (size_t i = 0; i < count; ++i) {
+        size_t index = header[1 + 2 * i], size = header[2 + 2 * i];
+        if (index >= ordered_blobs.size() || size != blobs_size[index] ||
+            offset + size > chunk_size || restored[index]) {
+          return Status::Invalid("Invalid blob entry in the byte stream");
+        }
+        restored[index] = true;
+        restored_count += 1;
+        if (blobs.find(ordered_blobs[index]) != blobs.end() ||
+            !restoring.emplace(ordered_blobs[index]).second) {
+          // another copy of a blob that has already been restored
+          offset += size;
+          continue;
+        }
+        indices.emplace_back(index);
+        sizes.emplace_back(size);
+        sources.emplace_back(chunk->data() + offset);
+        offset += size;
+      }
+      total_bytes += chunk_size;
+    }
+    std::vector<std::unique_ptr<BlobWriter>> writers;
+    RETURN_ON_ERROR(client.CreateBlobs(sizes, writers));
+    std::vector<CopyTask> tasks;
+    for (size_t i = 0; i < writers.size(); ++i) {
+      tasks.push_back(CopyTask{reinterpret_cast<uint8_t*>(writers[i]->data()),
+                               sources[i], sizes[i]});
+    }
+    ParallelMemcpy(tasks, concurrency);
+    for (size_t i = 0; i < writers.size(); ++i) {
+      auto blob = std::dynamic_pointer_cast<Blob>(writers[i]->Seal(client));
+      blobs.emplace(ordered_blobs[indices[i]], blob);
+    }
+  }
+  if (restored_count != ordered_blobs.size()) {
+    return Status::Invalid("Some blobs are missing in the byte stream");
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  LOG(INFO) << "Restored " << ordered_blobs.size() << " blobs: "
+            << total_bytes << " bytes in " << seconds << "s ("
+            << (seconds > 0 ? total_bytes / seconds / (1UL << 30) : 0)
+            << " GB/s)";
+  return Status::OK();
+}
+
 /// Restore meta and blobs from stream
 /// If is a global object, then only restore local object
 /// Return local object's id,
@@ -92,18 +202,25 @@ Status Deserialize(Client& client, ObjectID stream_id, std::string& out_id) {
       json::parse(params["blobs"]).get<std::vector<ObjectID>>();
   auto blobs_size =
       json::parse(params["blobs_size"]).get<std::vector<size_t>>();
-  std::unique_ptr<BlobWriter> blob_writer;
   std::unordered_map<ObjectID, std::shared_ptr<Blob>> blobs;
-  for (size_t i = 0; i < ordered_blobs.size(); ++i) {
-    if (blobs_size[i] > 0) {
-      std::unique_ptr<arrow::Buffer> buffer = nullptr;
-      RETURN_ON_ERROR(reader->GetNext(buffer));
-      RETURN_ON_ERROR(client.CreateBlob(buffer->size(), blob_writer));
-      memcpy(blob_writer->data(), buffer->data(), buffer->size());
-      auto blob = std::dynamic_pointer_cast<Blob>(blob_writer->Seal(client));
-      blobs.emplace(ordered_blobs[i], blob);
-    } else {
-      blobs.emplace(ordered_blobs[i], Blob::MakeEmpty(client));
+  if (params["chunk_format"] == kPackedChunkFormat) {
+    RETURN_ON_ERROR(
+        deserialize_packed_blobs(client, reader, ordered_blobs, blobs_size,
+                                 blobs));
+  } else {
+    std::unique_ptr<BlobWriter> blob_writer;
+    for (size_t i = 0; i < ordered_blobs.size(); ++i) {
+      if (blobs_size[i] > 0) {
+        std::unique_ptr<arrow::Buffer> buffer = nullptr;
+        RETURN_ON_ERROR(reader->GetNext(buffer));
+        RETURN_ON_ERROR(client.CreateBlob(buffer->size(), blob_writer));
+        memcpy(blob_writer->data(), buffer->data(), buffer->size());
+        auto blob =
+            std::dynamic_pointer_cast<Blob>(blob_writer->Seal(client));
+        blobs.emplace(ordered_blobs[i], blob);
+      } else {
+        blobs.emplace(ordered_blobs[i], Blob::MakeEmpty(client));
+      }
     }
   }
   json meta = json::parse(params["meta"]);
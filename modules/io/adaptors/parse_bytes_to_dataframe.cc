@@ -13,8 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "arrow/api.h"
 #include "arrow/csv/api.h"
@@ -35,25 +40,20 @@ limitations under the License.
 
 using namespace vineyard;  // NOLINT(build/namespaces)
 
+// The chunk is parsed in place (the csv reader converts the values into
+// newly-allocated arrays, the parsed table doesn't refer to the chunk), and
+// the chunks in a batch are parsed in parallel, thus the reader of each chunk
+// doesn't use threads itself.
 Status ParseTable(std::shared_ptr<arrow::Table>* table,
-                  std::unique_ptr<arrow::Buffer>& buffer, char delimiter,
+                  std::shared_ptr<arrow::Buffer> const& buffer, char delimiter,
                   bool header_row, std::vector<std::string> columns,
                   std::vector<std::string> column_types,
                   std::vector<std::string> original_columns,
                   bool include_all_columns) {
-  // FIXME IF NO NEED TO COPY
-  std::shared_ptr<arrow::Buffer> copied_buffer;
-#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
-  CHECK_ARROW_ERROR(buffer->Copy(0, buffer->size(), &copied_buffer));
-#else
-  CHECK_ARROW_ERROR_AND_ASSIGN(copied_buffer,
-                               buffer->CopySlice(0, buffer->size()));
-#endif
-  auto buffer_reader = std::make_shared<arrow::io::BufferReader>(copied_buffer);
+  auto buffer_reader = std::make_shared<arrow::io::BufferReader>(buffer);
 
   std::shared_ptr<arrow::io::InputStream> input =
-      arrow::io::RandomAccessFile::GetStream(buffer_reader, 0,
-                                             copied_buffer->size());
+      arrow::io::RandomAccessFile::GetStream(buffer_reader, 0, buffer->size());
 
   arrow::MemoryPool* pool = arrow::default_memory_pool();
 
@@ -61,6 +61,7 @@ Status ParseTable(std::shared_ptr<arrow::Table>* table,
   auto parse_options = arrow::csv::ParseOptions::Defaults();
 
   read_options.column_names = original_columns;
+  read_options.use_threads = false;
   parse_options.delimiter = delimiter;
 
   auto convert_options = arrow::csv::ConvertOptions::Defaults();
@@ -226,21 +227,51 @@ int main(int argc, const char** argv) {
   CHECK_AND_REPORT(ls->OpenReader(client, reader));
   CHECK_AND_REPORT(bs->OpenWriter(client, writer));
 
+  // parse a batch of chunks in parallel, and write the tables in order
+  int thread_num = std::max(
+      static_cast<int>(std::thread::hardware_concurrency()) / proc_num, 1);
+  auto start = std::chrono::steady_clock::now();
+  size_t total_bytes = 0;
   while (true) {
-    std::unique_ptr<arrow::Buffer> buffer;
-    auto status = reader->GetNext(buffer);
+    std::vector<std::unique_ptr<arrow::Buffer>> chunks;
+    auto status = reader->GetNext(thread_num, chunks);
     if (status.ok()) {
-      VLOG(10) << "consumer: buffer size = " << buffer->size();
-      std::shared_ptr<arrow::Table> table;
-      Status st =
-          ParseTable(&table, buffer, delimiter[0], header_row, columns,
-                     column_types, original_columns, include_all_columns);
-      if (!st.ok()) {
-        ReportStatus("error", st.ToString());
+      int task_num = static_cast<int>(chunks.size());
+      std::vector<std::shared_ptr<arrow::Buffer>> buffers(task_num);
+      for (int i = 0; i < task_num; ++i) {
+        VLOG(10) << "consumer: buffer size = " << chunks[i]->size();
+        total_bytes += chunks[i]->size();
+        buffers[i] = std::move(chunks[i]);
+      }
+      std::vector<std::shared_ptr<arrow::Table>> tables(task_num);
+      std::vector<Status> statuses(task_num);
+      std::atomic<int> task_id(0);
+      std::vector<std::thread> threads(std::min(thread_num, task_num));
+      for (auto& thread : threads) {
+        thread = std::thread([&]() {
+          while (true) {
+            int got_task_id = task_id.fetch_add(1);
+            if (got_task_id >= task_num) {
+              break;
+            }
+            statuses[got_task_id] = ParseTable(
+                &tables[got_task_id], buffers[got_task_id], delimiter[0],
+                header_row, columns, column_types, original_columns,
+                include_all_columns);
+          }
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
       }
-      st = writer->WriteTable(table);
-      if (!st.ok()) {
-        ReportStatus("error", st.ToString());
+      for (int i = 0; i < task_num; ++i) {
+        if (!statuses[i].ok()) {
+          ReportStatus("error", statuses[i].ToString());
+        }
+        Status st = writer->WriteTable(tables[i]);
+        if (!st.ok()) {
+          ReportStatus("error", st.ToString());
+        }
       }
     } else {
       if (status.IsStreamDrained()) {
@@ -249,6 +280,14 @@ int main(int argc, const char** argv) {
       }
     }
   }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  LOG(INFO) << "Parsed " << total_bytes << " bytes in " << seconds << "s ("
+            << (seconds > 0 ? total_bytes / seconds / (1 << 20) / thread_num
+                            : 0)
+            << " MB/s per thread, " << thread_num << " threads) at "
+            << proc_index;
   auto status = writer->Finish();
   if (status.ok()) {
     ReportStatus("exit", "");
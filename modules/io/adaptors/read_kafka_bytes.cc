@@ -20,6 +20,7 @@ limitations under the License.
 #include "client/client.h"
 #include "io/io/io_factory.h"
 #include "io/io/kafka_io_adaptor.h"
+#include "io/io/prefetch_reader.h"
 #include "io/io/utils.h"
 
 using namespace vineyard;  // NOLINT(build/namespaces)
@@ -58,12 +59,33 @@ int main(int argc, char** argv) {
   CHECK_AND_REPORT(bstream->OpenWriter(client, writer));
   writer->SetBufferSizeLimit(2 * 1024 * 1024);
 
-  std::string line;
-  while (kafka_io_adaptor->ReadLine(line).ok()) {
-    auto st = writer->WriteLine(line + "\n");
-    if (!st.ok()) {
-      ReportStatus("error", st.ToString());
-      CHECK_AND_REPORT(st);
+  // poll messages in a background I/O thread, to overlap with writing to the
+  // stream, see also Notes [Prefetching Reader] in "io/io/prefetch_reader.h".
+  size_t read_ahead = 4;
+  auto params = kafka_io_adaptor->GetMeta();
+  if (params.find("read_ahead") != params.end()) {
+    read_ahead = std::stoull(params.find("read_ahead")->second);
+  }
+  if (read_ahead > 0) {
+    PrefetchReader prefetcher(kafka_io_adaptor.get(),
+                              writer->GetBufferSizeLimit(), read_ahead);
+    CHECK_AND_REPORT(prefetcher.Start());
+    std::string block;
+    while (prefetcher.Next(block).ok()) {
+      auto st = writer->WriteBytes(block.data(), block.size());
+      if (!st.ok()) {
+        ReportStatus("error", st.ToString());
+        CHECK_AND_REPORT(st);
+      }
+    }
+  } else {
+    std::string line;
+    while (kafka_io_adaptor->ReadLine(line).ok()) {
+      auto st = writer->WriteLine(line + "\n");
+      if (!st.ok()) {
+        ReportStatus("error", st.ToString());
+        CHECK_AND_REPORT(st);
+      }
     }
   }
 
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
+#include <chrono>
 #include <string>
 
 #include "arrow/table.h"
@@ -21,6 +23,7 @@ limitations under the License.
 #include "client/client.h"
 #include "io/io/i_io_adaptor.h"
 #include "io/io/io_factory.h"
+#include "io/io/prefetch_reader.h"
 
 #include "io/io/utils.h"
 
@@ -64,14 +67,77 @@ int main(int argc, const char** argv) {
   CHECK_AND_REPORT(lstream->OpenWriter(client, writer));
   writer->SetBufferSizeLimit(2 * 1024 * 1024);
 
-  std::string line;
-  while (local_io_adaptor->ReadLine(line).ok()) {
-    auto st = writer->WriteLine(line);
+  // with "read_ahead", blocks are read by a background I/O thread and then
+  // copied into the chunks, see also Notes [Prefetching Reader] in
+  // "io/io/prefetch_reader.h".
+  size_t read_ahead = 0;
+  if (params.find("read_ahead") != params.end()) {
+    read_ahead = std::stoull(params.find("read_ahead")->second);
+  }
+
+  // otherwise read blocks of complete lines into the mapped chunks directly,
+  // and fallback to read line by line if the adaptor doesn't support that.
+  auto start = std::chrono::steady_clock::now();
+  size_t total_bytes = 0;
+  bool block_read = read_ahead == 0;
+  size_t block_size = writer->GetBufferSizeLimit();
+  if (read_ahead > 0) {
+    PrefetchReader prefetcher(local_io_adaptor.get(), block_size, read_ahead);
+    CHECK_AND_REPORT(prefetcher.Start());
+    std::string block;
+    Status st;
+    while ((st = prefetcher.Next(block)).ok()) {
+      CHECK_AND_REPORT(writer->WriteBytes(block.data(), block.size()));
+      total_bytes += block.size();
+    }
+    if (!st.IsEndOfFile()) {
+      ReportStatus("error", st.ToString());
+      CHECK_AND_REPORT(st);
+    }
+  }
+  while (block_read) {
+    char* data = nullptr;
+    size_t capacity = 0, size = 0;
+    CHECK_AND_REPORT(writer->Reserve(block_size, data, capacity));
+    auto st = local_io_adaptor->ReadLines(data, capacity, size);
+    if (st.IsNotImplemented()) {
+      block_read = false;
+      break;
+    }
+    if (st.IsEndOfFile()) {
+      break;
+    }
     if (!st.ok()) {
       ReportStatus("error", st.ToString());
       CHECK_AND_REPORT(st);
     }
+    if (size == 0) {
+      // a line is longer than the block, retry with a larger block
+      block_size = std::max(block_size, capacity) * 2;
+      continue;
+    }
+    CHECK_AND_REPORT(writer->Commit(size));
+    total_bytes += size;
+    block_size = writer->GetBufferSizeLimit();
+  }
+  if (!block_read) {
+    std::string line;
+    while (local_io_adaptor->ReadLine(line).ok()) {
+      line.push_back('\n');
+      auto st = writer->WriteLine(line);
+      if (!st.ok()) {
+        ReportStatus("error", st.ToString());
+        CHECK_AND_REPORT(st);
+      }
+      total_bytes += line.size();
+    }
   }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  LOG(INFO) << "Read " << total_bytes << " bytes in " << seconds << "s ("
+            << (seconds > 0 ? total_bytes / seconds / (1 << 20) : 0)
+            << " MB/s) at " << proc;
 
   {
     auto st = local_io_adaptor->Close();
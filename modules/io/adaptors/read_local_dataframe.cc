@@ -0,0 +1,92 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+
+#include "arrow/table.h"
+#include "basic/stream/dataframe_stream.h"
+#include "client/client.h"
+#include "io/io/i_io_adaptor.h"
+#include "io/io/io_factory.h"
+
+#include "io/io/utils.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Read the part of a local parquet, ORC or arrow file as a table (without
+// being parsed as text) to a dataframe stream, see also Notes [Columnar
+// File Formats] in "io/io/local_io_adaptor.cc".
+int main(int argc, const char** argv) {
+  if (argc < 5) {
+    printf(
+        "usage ./read_local_dataframe <ipc_socket> <efile> <proc_num> "
+        "<proc_index>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string efile = std::string(argv[2]);
+  int pnum = std::stoi(argv[3]);
+  int proc = std::stoi(argv[4]);
+
+  Client client;
+  CHECK_AND_REPORT(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  auto local_io_adaptor = IOFactory::CreateIOAdaptor(efile.c_str());
+
+  CHECK_AND_REPORT(local_io_adaptor->SetPartialRead(proc, pnum));
+
+  CHECK_AND_REPORT(local_io_adaptor->Open());
+
+  auto params = local_io_adaptor->GetMeta();
+  DataframeStreamBuilder builder(client);
+  builder.SetParams(params);
+  auto dfstream =
+      std::dynamic_pointer_cast<DataframeStream>(builder.Seal(client));
+  CHECK_AND_REPORT(client.Persist(dfstream->id()));
+  LOG(INFO) << "Create dataframe stream: " << dfstream->id();
+  ReportStatus("return", VYObjectIDToString(dfstream->id()));
+
+  std::unique_ptr<DataframeStreamWriter> writer;
+  CHECK_AND_REPORT(dfstream->OpenWriter(client, writer));
+
+  std::shared_ptr<arrow::Table> table;
+  {
+    auto st = local_io_adaptor->ReadTable(&table);
+    if (!st.ok()) {
+      ReportStatus("error", st.ToString());
+      CHECK_AND_REPORT(st);
+    }
+  }
+  if (table != nullptr && table->num_rows() > 0) {
+    auto st = writer->WriteTable(table);
+    if (!st.ok()) {
+      ReportStatus("error", st.ToString());
+      CHECK_AND_REPORT(st);
+    }
+  }
+
+  {
+    auto st = local_io_adaptor->Close();
+    if (!st.ok()) {
+      ReportStatus("error", st.ToString());
+      CHECK_AND_REPORT(st);
+    }
+  }
+  CHECK_AND_REPORT(writer->Finish());
+
+  return 0;
+}
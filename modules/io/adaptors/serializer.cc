@@ -13,23 +13,43 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "basic/stream/byte_stream.h"
 #include "client/client.h"
 #include "client/ds/blob.h"
 #include "common/util/json.h"
 #include "common/util/logging.h"
 #include "common/util/status.h"
+#include "io/io/serialization_utils.h"
 #include "io/io/utils.h"
 
 using namespace vineyard;  // NOLINT(build/namespaces)
 
 /// Put meta in streams' params,
-/// And put all local blobs into ByteStream.
+/// And put all local blobs into ByteStream, see also Notes [Serialization
+/// Chunk Format] in "io/io/serialization_utils.h".
 Status Serialize(Client& client, ObjectID in_id, ObjectID* stream_id) {
+  // buffers of blobs are fetched in batch together with the metadata
   ObjectMeta meta;
   RETURN_ON_ERROR(client.GetMetaData(in_id, meta, true));
   VLOG(10) << meta.MetaData().dump(4);
   std::vector<ObjectID> all_blobs;
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+  auto collect_blobs = [&](ObjectMeta const& target) -> Status {
+    for (auto const& blob_id : target.GetBufferSet()->AllBufferIds()) {
+      std::shared_ptr<arrow::Buffer> buffer;
+      RETURN_ON_ERROR(target.GetBuffer(blob_id, buffer));
+      all_blobs.emplace_back(blob_id);
+      buffers.emplace_back(buffer);
+    }
+    return Status::OK();
+  };
   // Store meta
   ByteStreamBuilder builder(client);
   builder.SetParam("meta", meta.MetaData().dump());
@@ -40,45 +60,87 @@ Status Serialize(Client& client, ObjectID in_id, ObjectID* stream_id) {
         ObjectMeta sub_meta = meta.GetMemberMeta(kv.key());
         if (sub_meta.GetInstanceId() == client.instance_id()) {
           sub_metas.push_back(sub_meta.MetaData());
-          for (auto const& blob_id : sub_meta.GetBufferSet()->AllBufferIds()) {
-            all_blobs.emplace_back(blob_id);
-          }
+          RETURN_ON_ERROR(collect_blobs(sub_meta));
         }
       }
     }
     builder.SetParam("sub_metas", json(sub_metas).dump());
   } else {
-    for (auto const& blob_id : meta.GetBufferSet()->AllBufferIds()) {
-      all_blobs.emplace_back(blob_id);
-    }
+    RETURN_ON_ERROR(collect_blobs(meta));
   }
 
   std::vector<size_t> blobs_size;
-  std::vector<std::shared_ptr<Blob>> blobs;
-  for (auto blob_id : all_blobs) {
-    blobs.push_back(client.GetObject<Blob>(blob_id));
-    blobs_size.push_back(blobs.back()->size());
+  for (auto const& buffer : buffers) {
+    blobs_size.push_back(buffer == nullptr ? 0 : buffer->size());
   }
   builder.SetParam("blobs", json(all_blobs).dump());
   builder.SetParam("blobs_size", json(blobs_size).dump());
+  builder.SetParam("chunk_format", kPackedChunkFormat);
 
   *stream_id =
       std::dynamic_pointer_cast<ByteStream>(builder.Seal(client))->id();
   VINEYARD_CHECK_OK(client.Persist(*stream_id));
   auto byte_stream = client.GetObject<ByteStream>(*stream_id);
 
+  // pack blobs into chunks
+  std::vector<std::vector<size_t>> chunks(1);
+  size_t chunk_bytes = 0;
+  for (size_t index = 0; index < blobs_size.size(); ++index) {
+    if (blobs_size[index] == 0) {
+      continue;
+    }
+    if (!chunks.back().empty() &&
+        PackedChunkHeaderSize(chunks.back().size() + 1) + chunk_bytes +
+                blobs_size[index] >
+            kSerializationChunkSize) {
+      chunks.emplace_back();
+      chunk_bytes = 0;
+    }
+    chunks.back().emplace_back(index);
+    chunk_bytes += blobs_size[index];
+  }
+
   std::unique_ptr<ByteStreamWriter> writer;
   RETURN_ON_ERROR(byte_stream->OpenWriter(client, writer));
   // Store blobs
-  for (const auto& blob : blobs) {
-    if (blob->size() > 0) {
-      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
-      RETURN_ON_ERROR(writer->GetNext(blob->size(), buffer));
-      memcpy(buffer->mutable_data(), blob->data(), blob->size());
+  int concurrency =
+      std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+  auto start = std::chrono::steady_clock::now();
+  size_t total_bytes = 0;
+  for (auto const& chunk : chunks) {
+    if (chunk.empty()) {
+      continue;
+    }
+    size_t size = PackedChunkHeaderSize(chunk.size());
+    for (size_t index : chunk) {
+      size += blobs_size[index];
+    }
+    std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+    RETURN_ON_ERROR(writer->GetNext(size, buffer));
+    uint64_t* header = reinterpret_cast<uint64_t*>(buffer->mutable_data());
+    header[0] = chunk.size();
+    uint8_t* data =
+        buffer->mutable_data() + PackedChunkHeaderSize(chunk.size());
+    std::vector<CopyTask> tasks;
+    for (size_t i = 0; i < chunk.size(); ++i) {
+      size_t index = chunk[i];
+      header[1 + 2 * i] = index;
+      header[2 + 2 * i] = blobs_size[index];
+      tasks.push_back(
+          CopyTask{data, buffers[index]->data(), blobs_size[index]});
+      data += blobs_size[index];
     }
+    ParallelMemcpy(tasks, concurrency);
+    total_bytes += size;
   }
   RETURN_ON_ERROR(writer->Finish());
-  LOG(INFO) << "Serialized object " << in_id << " to stream " << *stream_id;
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  LOG(INFO) << "Serialized object " << in_id << " to stream " << *stream_id
+            << ": " << total_bytes << " bytes in " << seconds << "s ("
+            << (seconds > 0 ? total_bytes / seconds / (1UL << 30) : 0)
+            << " GB/s)";
   return Status::OK();
 }
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef MODULES_IO_IO_I_IO_ADAPTOR_H_
 #define MODULES_IO_IO_I_IO_ADAPTOR_H_
 
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -70,6 +71,21 @@ class IIOAdaptor {
   virtual Status ReadLine(std::string& line) = 0;
   virtual Status WriteLine(const std::string& line) = 0;
 
+  /**
+   * Read a block of complete lines (including the trailing '\n') into the
+   * buffer, as many as fit into the buffer, i.e., a line never spans two
+   * blocks.
+   *
+   * @param  buffer   [the buffer to read into]
+   * @param  capacity [the size of the buffer]
+   * @param  size     [the number of bytes that have been read, 0 if a line
+   *                   is longer than the capacity]
+   * @return          [EndOfFile when no more lines]
+   */
+  virtual Status ReadLines(char* buffer, size_t capacity, size_t& size) {
+    return Status::NotImplemented("ReadLines");
+  }
+
   virtual Status Read(void* buffer, size_t size) = 0;
   virtual Status Write(void* buffer, size_t size) = 0;
 
@@ -79,6 +95,17 @@ class IIOAdaptor {
     return Status::OK();
   }
 
+  /**
+   * Read the table in a background thread, the adaptor shouldn't be used
+   * until the returned future is ready, see also Notes [Prefetching Reader]
+   * in "io/io/prefetch_reader.h".
+   */
+  virtual std::future<Status> ReadTableAsync(
+      std::shared_ptr<arrow::Table>* table) {
+    return std::async(std::launch::async,
+                      [this, table]() { return this->ReadTable(table); });
+  }
+
   virtual Status WriteTable(std::shared_ptr<arrow::Table> table) {
     return Status::OK();
   }
@@ -20,18 +20,35 @@ limitations under the License.
 #include <sys/types.h>
 
 #include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "arrow/csv/api.h"
 #include "arrow/filesystem/api.h"
 #include "arrow/io/api.h"
+#include "arrow/ipc/api.h"
 #include "arrow/result.h"
 #include "arrow/status.h"
 #include "arrow/util/config.h"
 #include "arrow/util/uri.h"
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 1000000
+#include "arrow/compute/api.h"
+#endif
+#if defined(ORC_ENABLED)
+#include "arrow/adapters/orc/adapter.h"
+#endif
+#if defined(PARQUET_ENABLED)
+#include "parquet/arrow/reader.h"
+#include "parquet/file_reader.h"
+#include "parquet/statistics.h"
+#endif
 
 #include "boost/algorithm/string.hpp"
 #include "glog/logging.h"
@@ -59,6 +76,12 @@ LocalIOAdaptor::LocalIOAdaptor(const std::string& location)
     std::string location_args = location.substr(arg_pos + 1);
     ::boost::split(config_list, location_args, ::boost::is_any_of("&#"));
     for (auto& iter : config_list) {
+      if (::boost::algorithm::starts_with(iter, "filter=")) {
+        // predicates contains '=', e.g., "filter=weight>=0.5,label==a", and
+        // will be parsed when opening the file.
+        meta_.emplace("filter", iter.substr(strlen("filter=")));
+        continue;
+      }
       std::vector<std::string> kv_pair;
       ::boost::split(kv_pair, iter, ::boost::is_any_of("="));
       if (kv_pair[0] == "schema") {
@@ -87,6 +110,12 @@ LocalIOAdaptor::LocalIOAdaptor(const std::string& location)
             (boost::algorithm::to_lower_copy(kv_pair[1]) == "true");
         meta_.emplace("include_all_columns",
                       std::to_string(include_all_columns_));
+      } else if (kv_pair[0] == "format" && kv_pair.size() > 1) {
+        format_ = boost::algorithm::to_lower_copy(kv_pair[1]);
+        if (format_ == "ipc" || format_ == "feather") {
+          format_ = "arrow";
+        }
+        meta_.emplace("format", format_);
       } else if (kv_pair.size() > 1) {
         meta_.emplace(kv_pair[0], kv_pair[1]);
       }
@@ -127,6 +156,19 @@ LocalIOAdaptor::LocalIOAdaptor(const std::string& location)
   };
   location_ = urlDecode(location_);
 #endif
+
+  // detect columnar formats by the file extension
+  if (meta_.find("format") == meta_.end()) {
+    if (boost::algorithm::iends_with(location_, ".parquet")) {
+      format_ = "parquet";
+    } else if (boost::algorithm::iends_with(location_, ".orc")) {
+      format_ = "orc";
+    } else if (boost::algorithm::iends_with(location_, ".arrow") ||
+               boost::algorithm::iends_with(location_, ".feather") ||
+               boost::algorithm::iends_with(location_, ".ipc")) {
+      format_ = "arrow";
+    }
+  }
 }
 
 LocalIOAdaptor::~LocalIOAdaptor() {
@@ -162,6 +204,22 @@ Status LocalIOAdaptor::Open(const char* mode) {
   } else {
     RETURN_ON_ARROW_ERROR_AND_ASSIGN(ifp_, fs_->OpenInputFile(location_));
 
+    predicates_.clear();
+    auto filter = meta_.find("filter");
+    if (filter != meta_.end()) {
+      std::vector<std::string> predicates;
+      ::boost::split(predicates, filter->second, ::boost::is_any_of(","));
+      for (auto const& predicate : predicates) {
+        RETURN_ON_ERROR(parsePredicate(predicate));
+      }
+    }
+
+    // columnar files are split by row groups (or stripes, record batches)
+    // when reading, rather than by line breaks.
+    if (format_ != "csv") {
+      return Status::OK();
+    }
+
     // check the partial read flag
     if (enable_partial_read_) {
       RETURN_ON_ERROR(setPartialReadImpl());
@@ -308,6 +366,9 @@ Status LocalIOAdaptor::ReadPartialTable(std::shared_ptr<arrow::Table>* table,
     return Status::IOError("The file hasn't been opened in read mode: " +
                            location_);
   }
+  if (format_ != "csv") {
+    return readColumnarTable(table, index);
+  }
   int64_t offset = partial_read_offset_[index];
   int64_t nbytes =
       partial_read_offset_[index + 1] - partial_read_offset_[index];
@@ -394,6 +455,7 @@ Status LocalIOAdaptor::ReadPartialTable(std::shared_ptr<arrow::Table>* table,
     }
   }
   *table = result.ValueOrDie();
+  RETURN_ON_ERROR(filterAndSelectColumns(table, {}));
 
   RETURN_ON_ARROW_ERROR((*table)->Validate());
 
@@ -403,6 +465,392 @@ Status LocalIOAdaptor::ReadPartialTable(std::shared_ptr<arrow::Table>* table,
   return Status::OK();
 }
 
+/**
+ * Notes [Columnar File Formats]:
+ *
+ * Parquet, ORC and arrow (IPC file format) files are read into arrow tables
+ * directly, without being parsed as delimited text. The format is given by
+ * the "format" argument, or detected by the file extension.
+ *
+ * For partial read, the units of the file (row groups of parquet, stripes of
+ * ORC, and record batches of arrow files) are split evenly across the parts.
+ *
+ * Only the columns in "schema" (names or indices, all columns if not given,
+ * or when "include_all_columns" is set) are read, and columns types are
+ * taken from the file (i.e., "column_types" is ignored).
+ *
+ * The "filter" argument is a comma-separated conjunction of predicates
+ * "<column><op><literal>" (op is one of ==, !=, <, <=, >, >=). Row groups of
+ * parquet files are pruned by the min/max statistics of numeric columns, and
+ * the rows are filtered after reading, which requires arrow >= 1.0.0.
+ *
+ * Parquet and ORC are supported only when vineyard_io is built with
+ * libparquet and an arrow that is built with ORC, respectively.
+ */
+Status LocalIOAdaptor::parsePredicate(const std::string& filter) {
+  static const std::vector<std::pair<std::string, std::string>> operators = {
+      {"<=", "less_equal"}, {">=", "greater_equal"}, {"!=", "not_equal"},
+      {"==", "equal"},      {"<", "less"},           {">", "greater"},
+      {"=", "equal"}};
+  size_t pos = filter.find_first_of("<>=!");
+  if (pos != std::string::npos && pos > 0) {
+    for (auto const& op : operators) {
+      if (filter.compare(pos, op.first.size(), op.first) == 0) {
+        Predicate predicate;
+        predicate.column =
+            ::boost::algorithm::trim_copy(filter.substr(0, pos));
+        predicate.op = op.second;
+        predicate.literal = ::boost::algorithm::trim_copy(
+            filter.substr(pos + op.first.size()));
+        predicates_.emplace_back(predicate);
+        return Status::OK();
+      }
+    }
+  }
+  return Status::Invalid("Invalid filter predicate: '" + filter + "'");
+}
+
+static Status MakeTable(
+    const std::shared_ptr<arrow::Schema>& schema,
+    const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
+    std::shared_ptr<arrow::Table>* table) {
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ARROW_ERROR(
+      arrow::Table::FromRecordBatches(schema, batches, table));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      *table, arrow::Table::FromRecordBatches(schema, batches));
+#endif
+  return Status::OK();
+}
+
+#if defined(PARQUET_ENABLED)
+static bool ParseLiteral(const std::string& literal, int64_t& value) {
+  char* endptr = nullptr;
+  errno = 0;
+  value = std::strtoll(literal.c_str(), &endptr, 10);
+  return endptr != literal.c_str() && *endptr == '\0' && errno != ERANGE;
+}
+
+static bool ParseLiteral(const std::string& literal, double& value) {
+  char* endptr = nullptr;
+  value = std::strtod(literal.c_str(), &endptr);
+  return endptr != literal.c_str() && *endptr == '\0';
+}
+
+// whether no value in [min, max] satisfies the predicate, the literal is
+// compared in the type of the column (integers are not converted to double,
+// which is lossy beyond 2^53), and literals that cannot be parsed as the type
+// (e.g., "1.5" for integers) never prune.
+template <typename T>
+static bool ExcludedByStatistics(const std::string& op,
+                                 const std::string& value, const T min,
+                                 const T max) {
+  T literal;
+  if (!ParseLiteral(value, literal)) {
+    return false;
+  }
+  return (op == "equal" && (literal < min || literal > max)) ||
+         (op == "not_equal" && min == literal && max == literal) ||
+         (op == "less" && min >= literal) ||
+         (op == "less_equal" && min > literal) ||
+         (op == "greater" && max <= literal) ||
+         (op == "greater_equal" && max < literal);
+}
+#endif
+
+Status LocalIOAdaptor::readColumnarTable(std::shared_ptr<arrow::Table>* table,
+                                         int index) {
+  int total_parts = enable_partial_read_ ? total_parts_ : 1;
+  if (!enable_partial_read_) {
+    index = 0;
+  }
+  if (format_ == "parquet") {
+    RETURN_ON_ERROR(readParquetTable(table, index, total_parts));
+  } else if (format_ == "orc") {
+    RETURN_ON_ERROR(readORCTable(table, index, total_parts));
+  } else if (format_ == "arrow") {
+    RETURN_ON_ERROR(readIPCTable(table, index, total_parts));
+  } else {
+    return Status::Invalid("Unsupported file format '" + format_ +
+                           "': " + location_);
+  }
+  RETURN_ON_ARROW_ERROR((*table)->Validate());
+
+  VLOG(2) << "[file-" << location_ << "] contains: " << (*table)->num_rows()
+          << " rows, " << (*table)->num_columns() << " columns";
+  VLOG(2) << (*table)->schema()->ToString();
+  return Status::OK();
+}
+
+Status LocalIOAdaptor::readParquetTable(std::shared_ptr<arrow::Table>* table,
+                                        int index, int total_parts) {
+#if defined(PARQUET_ENABLED)
+  std::unique_ptr<parquet::arrow::FileReader> reader;
+  RETURN_ON_ARROW_ERROR(
+      parquet::arrow::OpenFile(ifp_, arrow::default_memory_pool(), &reader));
+  std::shared_ptr<arrow::Schema> schema;
+  RETURN_ON_ARROW_ERROR(reader->GetSchema(&schema));
+  std::vector<std::string> names;
+  std::vector<int> read_indices;
+  RETURN_ON_ERROR(projectColumns(schema, names, read_indices));
+
+  // prune row groups by the min/max statistics of numeric columns, which is
+  // only applicable for flat schemas, where columns chunks are fields.
+  auto metadata = reader->parquet_reader()->metadata();
+  bool flat = metadata->num_columns() == schema->num_fields();
+  auto may_match = [&](int row_group) -> bool {
+    auto row_group_metadata = metadata->RowGroup(row_group);
+    for (auto const& predicate : predicates_) {
+      int column = schema->GetFieldIndex(predicate.column);
+      auto chunk = row_group_metadata->ColumnChunk(column);
+      if (!chunk->is_stats_set()) {
+        continue;
+      }
+      auto stats = chunk->statistics();
+      if (stats == nullptr || !stats->HasMinMax()) {
+        continue;
+      }
+      bool pruned = false;
+      switch (schema->field(column)->type()->id()) {
+      case arrow::Type::INT8:
+      case arrow::Type::INT16:
+      case arrow::Type::INT32: {
+        auto typed = std::static_pointer_cast<parquet::Int32Statistics>(stats);
+        pruned = ExcludedByStatistics<int64_t>(
+            predicate.op, predicate.literal, typed->min(), typed->max());
+      } break;
+      case arrow::Type::INT64: {
+        auto typed = std::static_pointer_cast<parquet::Int64Statistics>(stats);
+        pruned = ExcludedByStatistics<int64_t>(
+            predicate.op, predicate.literal, typed->min(), typed->max());
+      } break;
+      case arrow::Type::FLOAT: {
+        auto typed = std::static_pointer_cast<parquet::FloatStatistics>(stats);
+        pruned = ExcludedByStatistics<double>(
+            predicate.op, predicate.literal, typed->min(), typed->max());
+      } break;
+      case arrow::Type::DOUBLE: {
+        auto typed = std::static_pointer_cast<parquet::DoubleStatistics>(stats);
+        pruned = ExcludedByStatistics<double>(
+            predicate.op, predicate.literal, typed->min(), typed->max());
+      } break;
+      default:
+        continue;
+      }
+      if (pruned) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  int num_row_groups = reader->num_row_groups();
+  int begin = static_cast<int64_t>(num_row_groups) * index / total_parts;
+  int end = static_cast<int64_t>(num_row_groups) * (index + 1) / total_parts;
+  std::vector<int> row_groups;
+  for (int row_group = begin; row_group < end; ++row_group) {
+    if (!flat || may_match(row_group)) {
+      row_groups.push_back(row_group);
+    }
+  }
+  VLOG(2) << "[file-" << location_ << "] reads " << row_groups.size()
+          << " of row groups [" << begin << ", " << end << ")";
+
+  if (row_groups.empty()) {
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    for (int column : read_indices) {
+      fields.push_back(schema->field(column));
+    }
+    RETURN_ON_ERROR(MakeTable(arrow::schema(fields), {}, table));
+  } else {
+    reader->set_use_threads(true);
+    RETURN_ON_ARROW_ERROR(
+        reader->ReadRowGroups(row_groups, read_indices, table));
+  }
+  return filterAndSelectColumns(table, names);
+#else
+  return Status::NotImplemented(
+      "vineyard_io is built without parquet support: " + location_);
+#endif
+}
+
+Status LocalIOAdaptor::readORCTable(std::shared_ptr<arrow::Table>* table,
+                                    int index, int total_parts) {
+#if defined(ORC_ENABLED)
+  arrow::MemoryPool* pool = arrow::default_memory_pool();
+  std::unique_ptr<arrow::adapters::orc::ORCFileReader> reader;
+  std::shared_ptr<arrow::Schema> schema;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 6000000
+  RETURN_ON_ARROW_ERROR(
+      arrow::adapters::orc::ORCFileReader::Open(ifp_, pool, &reader));
+  RETURN_ON_ARROW_ERROR(reader->ReadSchema(&schema));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      reader, arrow::adapters::orc::ORCFileReader::Open(ifp_, pool));
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(schema, reader->ReadSchema());
+#endif
+  std::vector<std::string> names;
+  std::vector<int> read_indices;
+  RETURN_ON_ERROR(projectColumns(schema, names, read_indices));
+
+  int64_t num_stripes = reader->NumberOfStripes();
+  int64_t begin = num_stripes * index / total_parts;
+  int64_t end = num_stripes * (index + 1) / total_parts;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  for (int64_t stripe = begin; stripe < end; ++stripe) {
+    std::shared_ptr<arrow::RecordBatch> batch;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 6000000
+    RETURN_ON_ARROW_ERROR(reader->ReadStripe(stripe, read_indices, &batch));
+#else
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(batch,
+                                     reader->ReadStripe(stripe, read_indices));
+#endif
+    batches.emplace_back(batch);
+  }
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  for (int column : read_indices) {
+    fields.push_back(schema->field(column));
+  }
+  RETURN_ON_ERROR(MakeTable(arrow::schema(fields), batches, table));
+  return filterAndSelectColumns(table, names);
+#else
+  return Status::NotImplemented("vineyard_io is built without ORC support: " +
+                                location_);
+#endif
+}
+
+Status LocalIOAdaptor::readIPCTable(std::shared_ptr<arrow::Table>* table,
+                                    int index, int total_parts) {
+  std::shared_ptr<arrow::ipc::RecordBatchFileReader> reader;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ARROW_ERROR(
+      arrow::ipc::RecordBatchFileReader::Open(ifp_.get(), &reader));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      reader, arrow::ipc::RecordBatchFileReader::Open(ifp_.get()));
+#endif
+  std::vector<std::string> names;
+  std::vector<int> read_indices;
+  RETURN_ON_ERROR(projectColumns(reader->schema(), names, read_indices));
+
+  // record batches are read as a whole, the columns are selected later
+  int num_batches = reader->num_record_batches();
+  int begin = static_cast<int64_t>(num_batches) * index / total_parts;
+  int end = static_cast<int64_t>(num_batches) * (index + 1) / total_parts;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  for (int i = begin; i < end; ++i) {
+    std::shared_ptr<arrow::RecordBatch> batch;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+    RETURN_ON_ARROW_ERROR(reader->ReadRecordBatch(i, &batch));
+#else
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(batch, reader->ReadRecordBatch(i));
+#endif
+    batches.emplace_back(batch);
+  }
+  RETURN_ON_ERROR(MakeTable(reader->schema(), batches, table));
+  return filterAndSelectColumns(table, names);
+}
+
+Status LocalIOAdaptor::projectColumns(
+    const std::shared_ptr<arrow::Schema>& schema,
+    std::vector<std::string>& names, std::vector<int>& read_indices) {
+  names.clear();
+  for (auto const& column : columns_) {
+    if (!column.empty() &&
+        ::boost::algorithm::all(column, ::boost::algorithm::is_digit())) {
+      int index = std::stoi(column);
+      if (index >= schema->num_fields()) {
+        return Status::Invalid("Index out of range: " + column);
+      }
+      names.push_back(schema->field(index)->name());
+    } else if (schema->GetFieldIndex(column) != -1) {
+      names.push_back(column);
+    } else {
+      return Status::Invalid("Column not found: " + column);
+    }
+  }
+  if (columns_.empty() || include_all_columns_) {
+    for (auto const& field : schema->fields()) {
+      if (std::find(names.begin(), names.end(), field->name()) ==
+          names.end()) {
+        names.push_back(field->name());
+      }
+    }
+  }
+
+  // columns in predicates are read as well, and dropped after filtering
+  std::set<int> indices;
+  for (auto const& name : names) {
+    indices.insert(schema->GetFieldIndex(name));
+  }
+  for (auto const& predicate : predicates_) {
+    int index = schema->GetFieldIndex(predicate.column);
+    if (index == -1) {
+      return Status::Invalid("Column in filter not found: " + predicate.column);
+    }
+    indices.insert(index);
+  }
+  read_indices.assign(indices.begin(), indices.end());
+  return Status::OK();
+}
+
+Status LocalIOAdaptor::filterAndSelectColumns(
+    std::shared_ptr<arrow::Table>* table,
+    const std::vector<std::string>& names) {
+  if (*table == nullptr) {
+    return Status::OK();
+  }
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 1000000
+  arrow::Datum mask;
+  // e.g., all row groups have been pruned
+  bool empty = (*table)->num_rows() == 0;
+  for (auto const& predicate : predicates_) {
+    auto column = (*table)->GetColumnByName(predicate.column);
+    if (column == nullptr) {
+      return Status::Invalid("Column in filter not found: " + predicate.column);
+    }
+    if (empty) {
+      continue;
+    }
+    std::shared_ptr<arrow::Scalar> literal;
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        literal, arrow::Scalar::Parse(column->type(), predicate.literal));
+    arrow::Datum matches;
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        matches, arrow::compute::CallFunction(predicate.op, {column, literal}));
+    if (mask.kind() == arrow::Datum::NONE) {
+      mask = matches;
+    } else {
+      RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+          mask, arrow::compute::CallFunction("and", {mask, matches}));
+    }
+  }
+  if (mask.kind() != arrow::Datum::NONE) {
+    arrow::Datum filtered;
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(filtered,
+                                     arrow::compute::Filter(*table, mask));
+    *table = filtered.table();
+  }
+#else
+  if (!predicates_.empty()) {
+    return Status::NotImplemented("Filter requires apache-arrow >= 1.0.0");
+  }
+#endif
+  if (!names.empty()) {
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+    for (auto const& name : names) {
+      int index = (*table)->schema()->GetFieldIndex(name);
+      fields.push_back((*table)->schema()->field(index));
+      columns.push_back((*table)->column(index));
+    }
+    *table = arrow::Table::Make(
+        arrow::schema(fields, (*table)->schema()->metadata()), columns);
+  }
+  return Status::OK();
+}
+
 // TODO: sub-optimal, requires further optimization
 int64_t LocalIOAdaptor::getDistanceToLineBreak(const int index) {
   VINEYARD_CHECK_OK(seek(partial_read_offset_[index], kFileLocationBegin));
@@ -477,6 +925,44 @@ Status LocalIOAdaptor::ReadLine(std::string& line) {
   return Status::OK();
 }
 
+Status LocalIOAdaptor::ReadLines(char* buffer, size_t capacity,
+                                 size_t& size) {
+  size = 0;
+  if (ifp_ == nullptr) {
+    return Status::IOError("The file hasn't been opened in read mode: " +
+                           location_);
+  }
+  int64_t position = tell();
+  int64_t end = enable_partial_read_ ? partial_read_offset_[index_ + 1]
+                                     : GetFullSize();
+  if (position < 0 || end < 0) {
+    return Status::IOError("Fail to tell the read range: " + location_);
+  }
+  if (position >= end) {
+    return Status::EndOfFile();
+  }
+  int64_t nbytes = std::min(static_cast<int64_t>(capacity), end - position);
+  auto r = ifp_->ReadAt(position, nbytes, buffer);
+  if (!r.ok()) {
+    return Status::ArrowError(r.status());
+  }
+  int64_t read_size = r.ValueUnsafe();
+  if (read_size == 0) {
+    return Status::EndOfFile();
+  }
+  if (position + read_size < end) {
+    // the vectorized memrchr finds the last line break of the block
+    auto endofline = static_cast<const char*>(memrchr(buffer, '\n', read_size));
+    if (endofline == nullptr) {
+      // the line doesn't fit into the buffer, read nothing
+      return Status::OK();
+    }
+    read_size = endofline - buffer + 1;
+  }
+  size = read_size;
+  return Status::ArrowError(ifp_->Seek(position + read_size));
+}
+
 Status LocalIOAdaptor::WriteLine(const std::string& line) {
   if (ofp_ == nullptr) {
     return Status::IOError("The file hasn't been opened in write mode: " +
@@ -63,6 +63,11 @@ class LocalIOAdaptor : public IIOAdaptor {
 
   Status ReadLine(std::string& line) override;
 
+  /** Read large blocks of the file (within the part for partial read), the
+   * partial line at the end of the block is left for the next read.
+   */
+  Status ReadLines(char* buffer, size_t capacity, size_t& size) override;
+
   /** Read the part of file given index and total_parts.
    * first cut the file into several parts with given
    * <total_part>, looking backwards for the nearest
@@ -104,6 +109,11 @@ class LocalIOAdaptor : public IIOAdaptor {
 
   Status ReadTable(std::shared_ptr<arrow::Table>* table) override;
 
+  /** Read the part of the file as a table, the csv file is split by
+   * line breaks, and the columnar files (parquet, orc, and arrow) are split
+   * by row groups, stripes and record batches respectively, see also Notes
+   * [Columnar File Formats] in "local_io_adaptor.cc".
+   */
   Status ReadPartialTable(std::shared_ptr<arrow::Table>* table, int index);
 
   Status Seek(const int64_t offset);
@@ -122,6 +132,28 @@ class LocalIOAdaptor : public IIOAdaptor {
 
   std::string trimBOM(const std::string& line);
 
+  // a predicate "<column><op><literal>", where op is the name of the arrow
+  // compare function, e.g., "greater_equal"
+  struct Predicate {
+    std::string column;
+    std::string op;
+    std::string literal;
+  };
+
+  Status parsePredicate(const std::string& filter);
+  Status readColumnarTable(std::shared_ptr<arrow::Table>* table, int index);
+  Status readParquetTable(std::shared_ptr<arrow::Table>* table, int index,
+                          int total_parts);
+  Status readORCTable(std::shared_ptr<arrow::Table>* table, int index,
+                      int total_parts);
+  Status readIPCTable(std::shared_ptr<arrow::Table>* table, int index,
+                      int total_parts);
+  Status projectColumns(const std::shared_ptr<arrow::Schema>& schema,
+                        std::vector<std::string>& names,
+                        std::vector<int>& read_indices);
+  Status filterAndSelectColumns(std::shared_ptr<arrow::Table>* table,
+                                const std::vector<std::string>& names);
+
   std::string location_;
   char buff[LINESIZE];
   std::shared_ptr<arrow::fs::FileSystem> fs_;
@@ -138,6 +170,10 @@ class LocalIOAdaptor : public IIOAdaptor {
   // schema of header row
   std::vector<std::string> original_columns_;
 
+  // "csv", "parquet", "orc" or "arrow"
+  std::string format_ = "csv";
+  std::vector<Predicate> predicates_;
+
   bool enable_partial_read_;
   std::vector<int64_t> partial_read_offset_;
   int total_parts_;
@@ -0,0 +1,133 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/prefetch_reader.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "glog/logging.h"
+
+namespace vineyard {
+
+PrefetchReader::PrefetchReader(IIOAdaptor* adaptor, size_t const block_size,
+                               size_t const read_ahead)
+    : adaptor_(adaptor),
+      block_size_(std::max(block_size, static_cast<size_t>(1))),
+      read_ahead_(std::max(read_ahead, static_cast<size_t>(1))) {}
+
+PrefetchReader::~PrefetchReader() { Stop(); }
+
+Status PrefetchReader::Start() {
+  if (thread_.joinable()) {
+    return Status::Invalid("The prefetching reader has been started");
+  }
+  thread_ = std::thread(&PrefetchReader::run, this);
+  return Status::OK();
+}
+
+Status PrefetchReader::Next(std::string& block) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() { return !blocks_.empty() || finished_; });
+  if (blocks_.empty()) {
+    return status_;
+  }
+  block = std::move(blocks_.front());
+  blocks_.pop_front();
+  cv_.notify_all();
+  return Status::OK();
+}
+
+void PrefetchReader::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+    blocks_.clear();
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void PrefetchReader::run() {
+  Status status;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock,
+               [this]() { return blocks_.size() < read_ahead_ || stopped_; });
+      if (stopped_) {
+        status = Status::EndOfFile();
+        break;
+      }
+    }
+    std::string block;
+    status = readBlock(block);
+    if (!status.ok()) {
+      break;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      blocks_.emplace_back(std::move(block));
+    }
+    cv_.notify_all();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    status_ = status;
+    finished_ = true;
+  }
+  cv_.notify_all();
+}
+
+Status PrefetchReader::readBlock(std::string& block) {
+  if (!read_by_line_) {
+    size_t capacity = block_size_, size = 0;
+    while (true) {
+      block.resize(capacity);
+      auto status = adaptor_->ReadLines(&block[0], capacity, size);
+      if (status.IsNotImplemented()) {
+        read_by_line_ = true;
+        break;
+      }
+      RETURN_ON_ERROR(status);
+      if (size > 0) {
+        block.resize(size);
+        return Status::OK();
+      }
+      // a line is longer than the block, retry with a larger block
+      capacity *= 2;
+    }
+  }
+
+  block.clear();
+  std::string line;
+  while (block.size() < block_size_) {
+    // as loops over `ReadLine`, any failure ends the input
+    if (!adaptor_->ReadLine(line).ok()) {
+      if (block.empty()) {
+        return Status::EndOfFile();
+      }
+      break;
+    }
+    block.append(line);
+    block.push_back('\n');
+  }
+  return Status::OK();
+}
+
+}  // namespace vineyard
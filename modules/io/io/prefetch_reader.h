@@ -0,0 +1,95 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_PREFETCH_READER_H_
+#define MODULES_IO_IO_PREFETCH_READER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "common/util/status.h"
+#include "io/io/i_io_adaptor.h"
+
+namespace vineyard {
+
+/**
+ * Notes [Prefetching Reader]:
+ *
+ * The I/O adaptors are synchronous, a loader that reads a block and then
+ * processes (parses, or writes to a stream) it waits for the I/O on every
+ * block. The prefetching reader reads blocks of complete lines from the
+ * adaptor in a background I/O thread into a bounded read-ahead queue, thus
+ * the I/O overlaps with the processing of the previous blocks.
+ *
+ * Blocks are read by `IIOAdaptor::ReadLines` (or assembled by `ReadLine`
+ * when the adaptor doesn't support that), every block consists of complete
+ * lines (including the trailing '\n'), and is at most `block_size` bytes
+ * unless a single line is longer than that. At most `read_ahead` blocks are
+ * buffered, the I/O thread waits when the queue is full.
+ *
+ * The adaptor is owned by the I/O thread once the reader is started, and
+ * shouldn't be used until the reader is stopped. For tables, see also
+ * `IIOAdaptor::ReadTableAsync`.
+ */
+class PrefetchReader {
+ public:
+  PrefetchReader(IIOAdaptor* adaptor, size_t const block_size,
+                 size_t const read_ahead);
+
+  ~PrefetchReader();
+
+  /**
+   * Start the background I/O thread.
+   */
+  Status Start();
+
+  /**
+   * Get the next block, block until it has been read. Returns EndOfFile when
+   * the input has been drained, or the error of the I/O thread.
+   */
+  Status Next(std::string& block);
+
+  /**
+   * Stop the I/O thread, the blocks that haven't been consumed are dropped.
+   */
+  void Stop();
+
+ private:
+  void run();
+
+  Status readBlock(std::string& block);
+
+  IIOAdaptor* adaptor_;
+  size_t block_size_;
+  size_t read_ahead_;
+  // the adaptor doesn't implement `ReadLines`.
+  bool read_by_line_ = false;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::string> blocks_;
+  // the status of the I/O thread when finished, EndOfFile when drained.
+  Status status_;
+  bool finished_ = false;
+  bool stopped_ = false;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_PREFETCH_READER_H_
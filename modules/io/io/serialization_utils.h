@@ -0,0 +1,103 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_SERIALIZATION_UTILS_H_
+#define MODULES_IO_IO_SERIALIZATION_UTILS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace vineyard {
+
+/**
+ * Notes [Serialization Chunk Format]:
+ *
+ * The serializer puts the metadata into the params of the byte stream, with
+ * "blobs" and "blobs_size" the ids and sizes of all (local) blobs in order.
+ * In the "packed" chunk format (the "chunk_format" param), a chunk contains
+ * multiple blobs, prefixed with a compact index header:
+ *
+ *    | uint64_t count | count x (uint64_t index, uint64_t size) | data ... |
+ *
+ * where `index` is the position of the blob in "blobs", and the data of the
+ * blobs follows the header contiguously. A blob that is larger than the
+ * chunk size occupies a chunk by itself, and empty blobs are not written.
+ *
+ * Without the "chunk_format" param, every chunk is a single blob, in the
+ * order of "blobs", except empty ones.
+ *
+ * Blobs are copied into and out of chunks in slices by multiple threads.
+ */
+constexpr const char* kPackedChunkFormat = "packed";
+
+constexpr size_t kSerializationChunkSize = 64 * 1024 * 1024;
+
+inline size_t PackedChunkHeaderSize(size_t const count) {
+  return sizeof(uint64_t) + count * 2 * sizeof(uint64_t);
+}
+
+struct CopyTask {
+  uint8_t* dst;
+  const uint8_t* src;
+  size_t size;
+};
+
+/**
+ * Run memcpy tasks with multiple threads, large tasks are split into slices.
+ */
+inline void ParallelMemcpy(std::vector<CopyTask> const& tasks,
+                           int const concurrency) {
+  constexpr size_t slice_size = 4 * 1024 * 1024;
+  std::vector<CopyTask> slices;
+  for (auto const& task : tasks) {
+    for (size_t offset = 0; offset < task.size; offset += slice_size) {
+      slices.push_back(CopyTask{task.dst + offset, task.src + offset,
+                                std::min(slice_size, task.size - offset)});
+    }
+  }
+  int task_num = static_cast<int>(slices.size());
+  int thread_num = std::min(concurrency, task_num);
+  if (thread_num <= 1) {
+    for (auto const& slice : slices) {
+      memcpy(slice.dst, slice.src, slice.size);
+    }
+    return;
+  }
+  std::atomic<int> task_id(0);
+  std::vector<std::thread> threads(thread_num);
+  for (auto& thread : threads) {
+    thread = std::thread([&]() {
+      while (true) {
+        int got_task_id = task_id.fetch_add(1);
+        if (got_task_id >= task_num) {
+          break;
+        }
+        auto const& slice = slices[got_task_id];
+        memcpy(slice.dst, slice.src, slice.size);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_SERIALIZATION_UTILS_H_
@@ -72,6 +72,51 @@ def test_seriarialize_round_trip(vineyard_ipc_socket, vineyard_endpoint, global_
     print('new meta', new_meta)
 
 
+@pytest.fixture(scope='module')
+def global_obj_with_shared_blobs(vineyard_ipc_socket):
+    client = vineyard.connect(vineyard_ipc_socket)
+
+    data = np.arange(120, dtype=np.int64).reshape((2, 3, 4, 5))
+    o1 = client.put(data)
+    o2 = client.put(np.zeros((0, ), dtype=np.int64))
+    o3 = client.put(np.zeros((0, 3), dtype=np.float64))
+    for o in [o1, o2, o3]:
+        client.persist(o)
+
+    # members share the same blob and more than one member holds an empty blob
+    elements = [o1, o2, o1, o3]
+    meta = vineyard.ObjectMeta()
+    meta['typename'] = 'vineyard::Tuple'
+    meta['size_'] = len(elements)
+    meta.set_global(True)
+    for index, element in enumerate(elements):
+        meta.add_member('__elements_-%d' % index, element)
+    meta['__elements_-size'] = len(elements)
+    tup = client.create_metadata(meta)
+    client.persist(tup)
+    return tup.id, [data, np.zeros((0, ), dtype=np.int64), data, np.zeros((0, 3), dtype=np.float64)]
+
+
+def test_seriarialize_round_trip_with_shared_blobs(vineyard_ipc_socket, vineyard_endpoint,
+                                                   global_obj_with_shared_blobs):
+    global_obj, expected = global_obj_with_shared_blobs
+    vineyard.io.serialize('/tmp/seri-test-shared',
+                          global_obj,
+                          vineyard_ipc_socket=vineyard_ipc_socket,
+                          vineyard_endpoint=vineyard_endpoint)
+    ret = vineyard.io.deserialize('/tmp/seri-test-shared',
+                                  vineyard_ipc_socket=vineyard_ipc_socket,
+                                  vineyard_endpoint=vineyard_endpoint)
+    client = vineyard.connect(vineyard_ipc_socket)
+    new_meta = client.get_meta(ret)
+    assert new_meta['__elements_-size'] == len(expected)
+    for index, value in enumerate(expected):
+        member = new_meta.get_member('__elements_-%d' % index)
+        restored = client.get(member.id)
+        assert restored.dtype == value.dtype
+        np.testing.assert_array_equal(restored, value)
+
+
 @pytest.mark.skip("require oss")
 def test_seriarialize_round_trip_on_oss(vineyard_ipc_socket, vineyard_endpoint, global_obj):
     accessKeyID = os.environ["ACCESS_KEY_ID"]
@@ -34,6 +34,8 @@ static VineyardAllocator<void>& _DefaultAllocator() {
   return *default_allocator;
 }
 
+// serializes finalizing, freezing is thread-safe on its own, see also
+// Notes [Concurrent Vineyard Allocator] in "client/allocator.h".
 static std::mutex allocator_mutex;
 
 }  // namespace detail
@@ -57,7 +59,6 @@ void vineyard_free(void* pointer) {
 }
 
 void vineyard_freeze(void* pointer) {
-  std::lock_guard<std::mutex> lock(vineyard::detail::allocator_mutex);
   vineyard::detail::_DefaultAllocator().Freeze(pointer);
 }
 
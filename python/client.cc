@@ -347,6 +347,9 @@ void bind_client(py::module& mod) {
       .def_property_readonly(
           "memory_limit",
           [](InstanceStatus* status) { return status->memory_limit; })
+      .def_property_readonly(
+          "memory_in_use",
+          [](InstanceStatus* status) { return status->memory_in_use; })
       .def_property_readonly(
           "deferred_requests",
           [](InstanceStatus* status) { return status->deferred_requests; })
@@ -367,6 +370,8 @@ void bind_client(py::module& mod) {
                 << std::endl;
              ss << "    memory_limit: " << status->memory_limit << ","
                 << std::endl;
+             ss << "    memory_in_use: " << status->memory_in_use << ","
+                << std::endl;
              ss << "    deferred_requests: " << status->deferred_requests << ","
                 << std::endl;
              ss << "    ipc_connections: " << status->ipc_connections << ","
@@ -383,6 +388,7 @@ void bind_client(py::module& mod) {
         ss << "    deployment: " << status->deployment << std::endl;
         ss << "    memory_usage: " << status->memory_usage << std::endl;
         ss << "    memory_limit: " << status->memory_limit << std::endl;
+        ss << "    memory_in_use: " << status->memory_in_use << std::endl;
         ss << "    deferred_requests: " << status->deferred_requests
            << std::endl;
         ss << "    ipc_connections: " << status->ipc_connections << std::endl;
@@ -18,9 +18,14 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <array>
 #include <limits>
 #include <memory>
-#include <set>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "client/client.h"
@@ -29,6 +34,23 @@ limitations under the License.
 
 namespace vineyard {
 
+/**
+ * Notes [Concurrent Vineyard Allocator]:
+ *
+ * The allocator is shared by all threads of the client (e.g., the default
+ * allocator behind `vineyard_malloc()`), thus
+ *
+ * - allocations of each thread are served by a jemalloc arena of its own, up
+ *   to one arena per hardware thread, see also Notes [Thread Arenas of
+ *   Jemalloc] in "common/memory/jemalloc.h";
+ * - frozen pointers are recorded in stripes selected by the address, each
+ *   stripe with a lock of its own, thus threads freezing different pointers
+ *   rarely wait for each other, and the stripes are only merged when the
+ *   arena is released.
+ *
+ * `Release()` and `Renew()` must not run concurrently with other operations
+ * of the allocator.
+ */
 template <typename T>
 struct VineyardAllocator : public memory::Jemalloc {
  public:
@@ -61,7 +83,8 @@ struct VineyardAllocator : public memory::Jemalloc {
   }
 
   void deallocate(T* ptr, size_t size) {
-    if (freezed_.find(reinterpret_cast<uintptr_t>(ptr)) != freezed_.end()) {
+    // frozen pointers are owned by blobs
+    if (!_is_frozen(reinterpret_cast<uintptr_t>(ptr))) {
       Jemalloc::Free(ptr, size);
     }
   }
@@ -69,22 +92,30 @@ struct VineyardAllocator : public memory::Jemalloc {
   std::shared_ptr<Blob> Freeze(T* ptr) {
     size_t allocated_size = Jemalloc::GetAllocatedSize(ptr);
     VLOG(10) << "freeze the pointer " << ptr << " of size " << allocated_size;
-    offsets_.emplace_back(reinterpret_cast<uintptr_t>(ptr) - space_);
-    sizes_.emplace_back(allocated_size);
-    freezed_.emplace(reinterpret_cast<uintptr_t>(ptr));
-    ObjectID id = base_ + (reinterpret_cast<uintptr_t>(ptr) - space_);
-    return Blob::FromBuffer(client_, id, reinterpret_cast<uintptr_t>(ptr),
-                            allocated_size);
+    uintptr_t pointer = reinterpret_cast<uintptr_t>(ptr);
+    {
+      freeze_stripe_t& stripe = _stripe(pointer);
+      std::lock_guard<std::mutex> guard(stripe.mutex);
+      stripe.frozen[pointer] = allocated_size;
+    }
+    ObjectID id = base_ + (pointer - space_);
+    return Blob::FromBuffer(client_, id, pointer, allocated_size);
   }
 
   Status Release() {
-    VLOG(10) << "jemalloc arena finalized: of " << offsets_.size()
+    if (fd_ == -1) {
+      return Status::OK();
+    }
+    std::vector<size_t> offsets, sizes;
+    _collect_frozen(offsets, sizes);
+    VLOG(10) << "jemalloc arena finalized: of " << offsets.size()
              << " blocks are in use.";
-    return client_.ReleaseArena(fd_, offsets_, sizes_);
+    Jemalloc::Reset();
+    return client_.ReleaseArena(std::exchange(fd_, -1), offsets, sizes);
   }
 
   Status Renew() {
-    RETURN_ON_ERROR(client_.ReleaseArena(fd_, offsets_, sizes_));
+    RETURN_ON_ERROR(Release());
     return _initialize_arena(available_size_);
   }
 
@@ -95,24 +126,60 @@ struct VineyardAllocator : public memory::Jemalloc {
 
  private:
   Client& client_;
-  int fd_;
+  int fd_ = -1;
   uintptr_t base_, space_;
   size_t available_size_;
-  std::vector<size_t> offsets_, sizes_;
-  std::set<uintptr_t> freezed_;
+
+  // see also: Notes [Concurrent Vineyard Allocator]
+  static constexpr size_t kFreezeStripes = 64;
+  struct alignas(64) freeze_stripe_t {
+    std::mutex mutex;
+    std::unordered_map<uintptr_t /* pointer */, size_t /* size */> frozen;
+  };
+  std::array<freeze_stripe_t, kFreezeStripes> stripes_;
+
+  freeze_stripe_t& _stripe(const uintptr_t pointer) {
+    // allocations are at least 1 MB (see `Jemalloc::Allocate()`), thus live
+    // pointers differ in the bits above the lowest 20 bits.
+    return stripes_[(pointer >> 20) % kFreezeStripes];
+  }
+
+  bool _is_frozen(const uintptr_t pointer) {
+    freeze_stripe_t& stripe = _stripe(pointer);
+    std::lock_guard<std::mutex> guard(stripe.mutex);
+    return stripe.frozen.find(pointer) != stripe.frozen.end();
+  }
+
+  void _collect_frozen(std::vector<size_t>& offsets,
+                       std::vector<size_t>& sizes) {
+    for (auto& stripe : stripes_) {
+      std::lock_guard<std::mutex> guard(stripe.mutex);
+      for (auto const& item : stripe.frozen) {
+        offsets.emplace_back(item.first - space_);
+        sizes.emplace_back(item.second);
+      }
+    }
+  }
 
   Status _initialize_arena(size_t size) {
     VLOG(2) << "make arena: " << size;
     RETURN_ON_ERROR(
         client_.CreateArena(size, fd_, available_size_, base_, space_));
-    Jemalloc::Init(reinterpret_cast<void*>(space_), available_size_);
+    if (Jemalloc::Init(reinterpret_cast<void*>(space_), available_size_,
+                       std::max(std::thread::hardware_concurrency(), 1u)) ==
+        nullptr) {
+      VINEYARD_DISCARD(client_.ReleaseArena(std::exchange(fd_, -1), {}, {}));
+      return Status::NotEnoughMemory(
+          "Failed to initialize the jemalloc arenas for the allocator");
+    }
     VLOG(2) << "jemalloc arena initialized: " << available_size_ << ", at "
             << reinterpret_cast<void*>(space_);
 
     // reset the context
-    offsets_.clear();
-    sizes_.clear();
-    freezed_.clear();
+    for (auto& stripe : stripes_) {
+      std::lock_guard<std::mutex> guard(stripe.mutex);
+      stripe.frozen.clear();
+    }
     return Status::OK();
   }
 };
@@ -15,12 +15,18 @@ limitations under the License.
 
 #include "client/client.h"
 
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <cerrno>
+#include <cstring>
 #include <limits>
 #include <map>
 #include <mutex>
 #include <set>
+#include <string>
 #include <unordered_map>
 #include <utility>
 
@@ -31,6 +37,7 @@ limitations under the License.
 #include "client/utils.h"
 #include "common/memory/fling.h"
 #include "common/util/boost.h"
+#include "common/util/env.h"
 #include "common/util/protocols.h"
 
 namespace vineyard {
@@ -105,15 +112,40 @@ Status Client::Connect(const std::string& ipc_socket) {
   ipc_socket_ = ipc_socket;
   RETURN_ON_ERROR(connect_ipc_socket_retry(ipc_socket, vineyard_conn_));
   std::string message_out;
-  WriteRegisterRequest(message_out);
+  // the binary protocol and the shared memory pool can be turned off for
+  // debugging and benchmarking
+  bool binary_protocol =
+      read_env("VINEYARD_DISABLE_BINARY_PROTOCOL").empty();
+  bool shared_pool = read_env("VINEYARD_DISABLE_SHARED_POOL").empty();
+  // the command channel is opt-in, see also Notes [Command Channel]
+  bool command_channel = !read_env("VINEYARD_ENABLE_COMMAND_CHANNEL").empty();
+  WriteRegisterRequest(binary_protocol, shared_pool, command_channel,
+                       message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
   std::string ipc_socket_value, rpc_endpoint_value;
-  RETURN_ON_ERROR(ReadRegisterReply(message_in, ipc_socket_value,
-                                    rpc_endpoint_value, instance_id_,
-                                    server_version_));
+  size_t command_channel_capacity = 0;
+  RETURN_ON_ERROR(ReadRegisterReply(
+      message_in, ipc_socket_value, rpc_endpoint_value, instance_id_,
+      server_version_, binary_protocol_, shared_pool_fd_, shared_pool_size_,
+      command_channel_capacity));
   rpc_endpoint_ = rpc_endpoint_value;
+  if (shared_pool_fd_ != -1) {
+    // the fd of the shared memory pool follows the reply, see also
+    // Notes [Shared Memory Pool] in "server/memory/memory.cc".
+    uint8_t* shared = nullptr;
+    RETURN_ON_ERROR(mmapToClient(shared_pool_fd_, shared_pool_size_, true,
+                                 true, &shared));
+  }
+  if (command_channel_capacity != 0) {
+    int channel_fd = recv_fd(vineyard_conn_);
+    if (channel_fd < 0) {
+      return Status::IOError("Failed to receive the command channel");
+    }
+    RETURN_ON_ERROR(CommandChannel::Map(channel_fd, command_channel_capacity,
+                                        false, channel_));
+  }
   connected_ = true;
 
   if (!compatible_server(server_version_)) {
@@ -201,6 +233,113 @@ Status Client::CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob) {
   return Status::OK();
 }
 
+Status Client::CreateBlobs(const std::vector<size_t>& sizes,
+                           std::vector<std::unique_ptr<BlobWriter>>& blobs) {
+  ENSURE_CONNECTED(this);
+
+  std::vector<ObjectID> object_ids;
+  std::vector<Payload> objects;
+  std::vector<std::shared_ptr<arrow::MutableBuffer>> buffers;
+  RETURN_ON_ERROR(CreateBuffers(sizes, object_ids, objects, buffers));
+  blobs.clear();
+  for (size_t index = 0; index < sizes.size(); ++index) {
+    blobs.emplace_back(
+        new BlobWriter(object_ids[index], objects[index], buffers[index]));
+  }
+  return Status::OK();
+}
+
+/**
+ * Notes [Importing Files into Blobs]:
+ *
+ * Importing a file by reading it into the memory of the client and then
+ * copying into a blob costs two copies. Instead, the blob is allocated first,
+ * and the file is loaded into the shared memory (at `data_offset` of the
+ * received store fd) by `copy_file_range`, which copies inside the kernel.
+ * When that is not supported, e.g., the store fd lives on another filesystem
+ * (tmpfs, hugetlbfs), the rest of the file is read with `pread` into the
+ * mapped blob, i.e., from the page cache to the shared memory directly.
+ *
+ * An arrow IPC file imported this way can be read without further copies,
+ * by opening a `RecordBatchFileReader` over an `arrow::io::BufferReader` of
+ * the blob.
+ */
+static Status load_file_to_blob(int fd, size_t offset, size_t size,
+                                int store_fd, size_t store_offset,
+                                uint8_t* pointer) {
+  size_t loaded = 0;
+#if defined(__linux__)
+  posix_fadvise(fd, offset, size, POSIX_FADV_SEQUENTIAL);
+#if defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+  loff_t off_in = offset, off_out = store_offset;
+  while (loaded < size) {
+    ssize_t nbytes =
+        copy_file_range(fd, &off_in, store_fd, &off_out, size - loaded, 0);
+    if (nbytes <= 0) {
+      break;
+    }
+    loaded += nbytes;
+  }
+#endif
+#endif
+  while (loaded < size) {
+    ssize_t nbytes =
+        pread(fd, pointer + loaded, size - loaded, offset + loaded);
+    if (nbytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nbytes < 0) {
+      return Status::IOError("Failed to read the file: " +
+                             std::string(strerror(errno)));
+    }
+    if (nbytes == 0) {
+      return Status::IOError("Unexpected end of file at offset " +
+                             std::to_string(offset + loaded));
+    }
+    loaded += nbytes;
+  }
+  return Status::OK();
+}
+
+Status Client::CreateBlobFromFile(std::string const& path,
+                                  std::unique_ptr<BlobWriter>& blob) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return Status::IOError("Failed to stat '" + path +
+                           "': " + std::string(strerror(errno)));
+  }
+  return CreateBlobFromFile(path, 0, st.st_size, blob);
+}
+
+Status Client::CreateBlobFromFile(std::string const& path,
+                                  size_t const offset, size_t const size,
+                                  std::unique_ptr<BlobWriter>& blob) {
+  ENSURE_CONNECTED(this);
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    return Status::IOError("Failed to open '" + path +
+                           "': " + std::string(strerror(errno)));
+  }
+
+  ObjectID object_id = InvalidObjectID();
+  Payload object;
+  std::shared_ptr<arrow::MutableBuffer> buffer = nullptr;
+  auto status = CreateBuffer(size, object_id, object, buffer);
+  if (status.ok() && size > 0) {
+    int store_fd = mmap_table_.at(object.store_fd)->fd();
+    status = load_file_to_blob(fd, offset, size, store_fd, object.data_offset,
+                               buffer->mutable_data());
+    if (!status.ok()) {
+      VINEYARD_DISCARD(DropBuffer(object_id, object.store_fd));
+    }
+  }
+  close(fd);
+  RETURN_ON_ERROR(status);
+  blob.reset(new BlobWriter(object_id, object, buffer));
+  return Status::OK();
+}
+
 Status Client::CreateStream(const ObjectID& id) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -227,12 +366,20 @@ Status Client::GetNextStreamChunk(ObjectID const id, size_t const size,
                                   std::unique_ptr<arrow::MutableBuffer>& blob) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteGetNextStreamChunkRequest(id, size, message_out);
+  if (binary_protocol_) {
+    WriteGetNextStreamChunkRequestBinary(id, size, message_out);
+  } else {
+    WriteGetNextStreamChunkRequest(id, size, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
   Payload object;
-  RETURN_ON_ERROR(ReadGetNextStreamChunkReply(message_in, object));
+  RETURN_ON_ERROR(doReadReply(
+      [&](const json& root) {
+        return ReadGetNextStreamChunkReply(root, object);
+      },
+      [&](BinaryDecoder& decoder) {
+        return ReadGetNextStreamChunkReplyBinary(decoder, object);
+      }));
   RETURN_ON_ASSERT(size == static_cast<size_t>(object.data_size),
                    "The size of returned chunk doesn't match");
   uint8_t *mmapped_ptr = nullptr, *dist = nullptr;
@@ -249,12 +396,20 @@ Status Client::PullNextStreamChunk(ObjectID const id,
                                    std::unique_ptr<arrow::Buffer>& blob) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WritePullNextStreamChunkRequest(id, message_out);
+  if (binary_protocol_) {
+    WritePullNextStreamChunkRequestBinary(id, message_out);
+  } else {
+    WritePullNextStreamChunkRequest(id, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
   Payload object;
-  RETURN_ON_ERROR(ReadPullNextStreamChunkReply(message_in, object));
+  RETURN_ON_ERROR(doReadReply(
+      [&](const json& root) {
+        return ReadPullNextStreamChunkReply(root, object);
+      },
+      [&](BinaryDecoder& decoder) {
+        return ReadPullNextStreamChunkReplyBinary(decoder, object);
+      }));
   uint8_t *mmapped_ptr = nullptr, *dist = nullptr;
   if (object.data_size > 0) {
     RETURN_ON_ERROR(mmapToClient(object.store_fd, object.map_size, true, true,
@@ -265,6 +420,65 @@ Status Client::PullNextStreamChunk(ObjectID const id,
   return Status::OK();
 }
 
+Status Client::GetNextStreamChunks(
+    ObjectID const id, size_t const size, size_t const count,
+    std::vector<std::unique_ptr<arrow::MutableBuffer>>& blobs) {
+  return GetNextStreamChunks(id, {}, size, count, blobs);
+}
+
+Status Client::GetNextStreamChunks(
+    ObjectID const id, std::vector<size_t> const& used, size_t const size,
+    size_t const count,
+    std::vector<std::unique_ptr<arrow::MutableBuffer>>& blobs) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteGetNextStreamChunksRequest(id, size, count, used, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  std::vector<Payload> objects;
+  RETURN_ON_ERROR(ReadGetNextStreamChunksReply(message_in, objects));
+  RETURN_ON_ASSERT(objects.size() == count,
+                   "The number of returned chunks doesn't match");
+  blobs.clear();
+  for (auto const& object : objects) {
+    RETURN_ON_ASSERT(size == static_cast<size_t>(object.data_size),
+                     "The size of returned chunk doesn't match");
+    uint8_t *mmapped_ptr = nullptr, *dist = nullptr;
+    if (object.data_size > 0) {
+      RETURN_ON_ERROR(mmapToClient(object.store_fd, object.map_size, false,
+                                   true, &mmapped_ptr));
+      dist = mmapped_ptr + object.data_offset;
+    }
+    blobs.emplace_back(new arrow::MutableBuffer(dist, object.data_size));
+  }
+  return Status::OK();
+}
+
+Status Client::PullNextStreamChunks(
+    ObjectID const id, size_t const count,
+    std::vector<std::unique_ptr<arrow::Buffer>>& blobs) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WritePullNextStreamChunksRequest(id, count, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  std::vector<Payload> objects;
+  RETURN_ON_ERROR(ReadPullNextStreamChunksReply(message_in, objects));
+  blobs.clear();
+  for (auto const& object : objects) {
+    uint8_t *mmapped_ptr = nullptr, *dist = nullptr;
+    if (object.data_size > 0) {
+      RETURN_ON_ERROR(mmapToClient(object.store_fd, object.map_size, true,
+                                   true, &mmapped_ptr));
+      dist = mmapped_ptr + object.data_offset;
+    }
+    blobs.emplace_back(new arrow::Buffer(dist, object.data_size));
+  }
+  return Status::OK();
+}
+
 Status Client::StopStream(ObjectID const id, const bool failed) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -276,9 +490,21 @@ Status Client::StopStream(ObjectID const id, const bool failed) {
   return Status::OK();
 }
 
+Status Client::StopStream(ObjectID const id, const bool failed,
+                          std::vector<size_t> const& used) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteStopStreamRequest(id, failed, used, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadStopStreamReply(message_in));
+  return Status::OK();
+}
+
 std::shared_ptr<Object> Client::GetObject(const ObjectID id) {
   ObjectMeta meta;
-  VINEYARD_CHECK_OK(this->GetMetaData(id, meta, true));
+  VINEYARD_CHECK_OK(this->getCachedMetaData(id, meta));
   VINEYARD_ASSERT(!meta.MetaData().empty());
   auto object = ObjectFactory::Create(meta.GetTypeName());
   if (object == nullptr) {
@@ -290,7 +516,7 @@ std::shared_ptr<Object> Client::GetObject(const ObjectID id) {
 
 Status Client::GetObject(const ObjectID id, std::shared_ptr<Object>& object) {
   ObjectMeta meta;
-  RETURN_ON_ERROR(this->GetMetaData(id, meta, true));
+  RETURN_ON_ERROR(this->getCachedMetaData(id, meta));
   RETURN_ON_ASSERT(!meta.MetaData().empty());
   object = ObjectFactory::Create(meta.GetTypeName());
   if (object == nullptr) {
@@ -303,7 +529,7 @@ Status Client::GetObject(const ObjectID id, std::shared_ptr<Object>& object) {
 std::vector<std::shared_ptr<Object>> Client::GetObjects(
     const std::vector<ObjectID>& ids) {
   std::vector<ObjectMeta> metas;
-  VINEYARD_CHECK_OK(this->GetMetaData(ids, metas, true));
+  VINEYARD_CHECK_OK(this->getCachedMetaData(ids, metas));
   for (auto const& meta : metas) {
     if (meta.MetaData().empty()) {
       VINEYARD_ASSERT(!meta.MetaData().empty());
@@ -390,10 +616,21 @@ Status Client::CreateArena(const size_t size, int& fd, size_t& available_size,
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
-  RETURN_ON_ERROR(ReadMakeArenaReply(message_in, fd, available_size, base));
+  ptrdiff_t offset = -1;
+  RETURN_ON_ERROR(
+      ReadMakeArenaReply(message_in, fd, available_size, base, offset));
   VINEYARD_ASSERT(size == std::numeric_limits<size_t>::max() ||
                   size == available_size);
   uint8_t* mmapped_ptr = nullptr;
+  if (offset != -1) {
+    // the arena lives in the shared memory pool
+    RETURN_ON_ASSERT(shared_pool_fd_ != -1,
+                     "The shared memory pool hasn't been mapped");
+    VINEYARD_CHECK_OK(mmapToClient(shared_pool_fd_, shared_pool_size_, false,
+                                   true, &mmapped_ptr));
+    space = reinterpret_cast<uintptr_t>(mmapped_ptr + offset);
+    return Status::OK();
+  }
   VINEYARD_CHECK_OK(
       mmapToClient(fd, available_size, false, false, &mmapped_ptr));
   space = reinterpret_cast<uintptr_t>(mmapped_ptr);
@@ -412,15 +649,43 @@ Status Client::ReleaseArena(const int fd, std::vector<size_t> const& offsets,
   return Status::OK();
 }
 
-Status Client::CreateBuffer(const size_t size, ObjectID& id, Payload& payload,
-                            std::shared_ptr<arrow::MutableBuffer>& buffer) {
+Status Client::Release(const std::set<ObjectID>& ids) {
   ENSURE_CONNECTED(this);
+  if (ids.empty()) {
+    return Status::OK();
+  }
+  // the cached objects may refer to the released blobs
+  meta_cache_.Invalidate(std::vector<ObjectID>(ids.begin(), ids.end()));
   std::string message_out;
-  WriteCreateBufferRequest(size, message_out);
+  WriteReleaseBuffersRequest(ids, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
-  RETURN_ON_ERROR(ReadCreateBufferReply(message_in, id, payload));
+  RETURN_ON_ERROR(ReadReleaseBuffersReply(message_in));
+  return Status::OK();
+}
+
+Status Client::Release(const ObjectID id) {
+  return Release(std::set<ObjectID>{id});
+}
+
+Status Client::CreateBuffer(const size_t size, ObjectID& id, Payload& payload,
+                            std::shared_ptr<arrow::MutableBuffer>& buffer) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  if (binary_protocol_) {
+    WriteCreateBufferRequestBinary(size, message_out);
+  } else {
+    WriteCreateBufferRequest(size, message_out);
+  }
+  RETURN_ON_ERROR(doWrite(message_out));
+  RETURN_ON_ERROR(doReadReply(
+      [&](const json& root) {
+        return ReadCreateBufferReply(root, id, payload);
+      },
+      [&](BinaryDecoder& decoder) {
+        return ReadCreateBufferReplyBinary(decoder, id, payload);
+      }));
   RETURN_ON_ASSERT(static_cast<size_t>(payload.data_size) == size);
 
   uint8_t *shared = nullptr, *dist = nullptr;
@@ -433,6 +698,49 @@ Status Client::CreateBuffer(const size_t size, ObjectID& id, Payload& payload,
   return Status::OK();
 }
 
+Status Client::CreateBuffers(
+    const std::vector<size_t>& sizes, std::vector<ObjectID>& ids,
+    std::vector<Payload>& payloads,
+    std::vector<std::shared_ptr<arrow::MutableBuffer>>& buffers) {
+  ENSURE_CONNECTED(this);
+  if (sizes.empty()) {
+    return Status::OK();
+  }
+  std::string message_out;
+  if (binary_protocol_) {
+    WriteCreateBuffersRequestBinary(sizes, message_out);
+  } else {
+    WriteCreateBuffersRequest(sizes, message_out);
+  }
+  RETURN_ON_ERROR(doWrite(message_out));
+  std::vector<int> fds;
+  RETURN_ON_ERROR(doReadReply(
+      [&](const json& root) {
+        return ReadCreateBuffersReply(root, ids, payloads, fds);
+      },
+      [&](BinaryDecoder& decoder) {
+        return ReadCreateBuffersReplyBinary(decoder, ids, payloads, fds);
+      }));
+  // see also: Notes [Creating Buffers in Bulk]
+  RETURN_ON_ERROR(recvStoreFds(fds, payloads, false));
+  RETURN_ON_ASSERT(payloads.size() == sizes.size(),
+                   "The number of created buffers doesn't match");
+
+  for (size_t index = 0; index < sizes.size(); ++index) {
+    auto const& payload = payloads[index];
+    RETURN_ON_ASSERT(static_cast<size_t>(payload.data_size) == sizes[index]);
+    uint8_t *shared = nullptr, *dist = nullptr;
+    if (payload.data_size > 0) {
+      RETURN_ON_ERROR(mmapToClient(payload.store_fd, payload.map_size, false,
+                                   true, &shared));
+      dist = shared + payload.data_offset;
+    }
+    buffers.emplace_back(
+        std::make_shared<arrow::MutableBuffer>(dist, payload.data_size));
+  }
+  return Status::OK();
+}
+
 Status Client::GetBuffer(const ObjectID id,
                          std::shared_ptr<arrow::Buffer>& buffer) {
   std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
@@ -453,12 +761,20 @@ Status Client::GetBuffers(
   }
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteGetBuffersRequest(ids, message_out);
+  if (binary_protocol_) {
+    WriteGetBuffersRequestBinary(ids, message_out);
+  } else {
+    WriteGetBuffersRequest(ids, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
   std::vector<Payload> payloads;
-  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads));
+  std::vector<int> fds;
+  RETURN_ON_ERROR(doReadReply(
+      [&](const json& root) { return ReadGetBuffersReply(root, payloads); },
+      [&](BinaryDecoder& decoder) {
+        return ReadGetBuffersReplyBinary(decoder, payloads, fds);
+      }));
+  RETURN_ON_ERROR(recvStoreFds(fds, payloads, true));
   for (auto const& item : payloads) {
     std::shared_ptr<arrow::Buffer> buffer = nullptr;
     uint8_t *shared = nullptr, *dist = nullptr;
@@ -480,12 +796,20 @@ Status Client::GetBufferSizes(const std::set<ObjectID>& ids,
   }
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteGetBuffersRequest(ids, message_out);
+  if (binary_protocol_) {
+    WriteGetBuffersRequestBinary(ids, message_out);
+  } else {
+    WriteGetBuffersRequest(ids, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
   std::vector<Payload> payloads;
-  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads));
+  std::vector<int> fds;
+  RETURN_ON_ERROR(doReadReply(
+      [&](const json& root) { return ReadGetBuffersReply(root, payloads); },
+      [&](BinaryDecoder& decoder) {
+        return ReadGetBuffersReplyBinary(decoder, payloads, fds);
+      }));
+  RETURN_ON_ERROR(recvStoreFds(fds, payloads, true));
   for (auto const& item : payloads) {
     uint8_t* shared = nullptr;
     if (item.data_size > 0) {
@@ -500,19 +824,27 @@ Status Client::GetBufferSizes(const std::set<ObjectID>& ids,
 Status Client::DropBuffer(const ObjectID id, const int fd) {
   ENSURE_CONNECTED(this);
 
-  // unmap from client
-  auto entry = mmap_table_.find(fd);
-  if (entry != mmap_table_.end()) {
-    mmap_table_.erase(entry);
+  // unmap from client, the shared memory pool is kept until disconnected
+  if (fd != shared_pool_fd_) {
+    auto entry = mmap_table_.find(fd);
+    if (entry != mmap_table_.end()) {
+      mmap_table_.erase(entry);
+    }
   }
 
   // free on server
   std::string message_out;
-  WriteDropBufferRequest(id, message_out);
+  if (binary_protocol_) {
+    WriteDropBufferRequestBinary(id, message_out);
+  } else {
+    WriteDropBufferRequest(id, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
-  RETURN_ON_ERROR(ReadDropBufferReply(message_in));
+  RETURN_ON_ERROR(doReadReply(
+      [&](const json& root) { return ReadDropBufferReply(root); },
+      [&](BinaryDecoder& decoder) {
+        return ReadDropBufferReplyBinary(decoder);
+      }));
   return Status::OK();
 }
 
@@ -543,6 +875,38 @@ Status Client::mmapToClient(int fd, int64_t map_size, bool readonly,
   return Status::OK();
 }
 
+Status Client::recvStoreFds(const std::vector<int>& fds,
+                            const std::vector<Payload>& payloads,
+                            bool readonly) {
+  if (fds.empty()) {
+    return Status::OK();
+  }
+  // every fd is the store fd of (at least) one of the payloads
+  RETURN_ON_ASSERT(fds.size() <= payloads.size(),
+                   "Unexpected number of file descriptors in the reply");
+  std::vector<int> client_fds(fds.size(), -1);
+  if (recv_fds(vineyard_conn_, client_fds.data(), client_fds.size()) < 0) {
+    return Status::IOError(
+        "Failed to receieve file descriptors from the socket");
+  }
+  std::unordered_map<int, int64_t> map_sizes;
+  for (auto const& payload : payloads) {
+    map_sizes.emplace(payload.store_fd, payload.map_size);
+  }
+  for (size_t index = 0; index < fds.size(); ++index) {
+    auto map_size = map_sizes.find(fds[index]);
+    if (map_size == map_sizes.end() ||
+        mmap_table_.find(fds[index]) != mmap_table_.end()) {
+      close(client_fds[index]);
+      continue;
+    }
+    auto mmap_entry = std::unique_ptr<MmapEntry>(new MmapEntry(
+        client_fds[index], map_size->second, readonly, true));
+    mmap_table_.emplace(fds[index], std::move(mmap_entry));
+  }
+  return Status::OK();
+}
+
 Client::~Client() { Disconnect(); }
 
 }  // namespace vineyard
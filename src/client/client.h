@@ -139,7 +139,7 @@ class Client : public ClientBase {
    * @return Status that indicates whether the get action has succeeded.
    */
   Status GetMetaData(const std::vector<ObjectID>& id, std::vector<ObjectMeta>&,
-                     const bool sync_remote = false);
+                     const bool sync_remote = false) override;
 
   /**
    * @brief Create a blob in vineyard server. When creating a blob, vineyard
@@ -153,6 +153,42 @@ class Client : public ClientBase {
    */
   Status CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob);
 
+  /**
+   * @brief Create a list of blobs in vineyard server in a single request,
+   * rather than a request for each blob, see also Notes [Creating Buffers in
+   * Bulk] in "common/util/protocols.h".
+   *
+   * @param sizes The sizes of requested blobs.
+   * @param blobs The result mutable blobs, in the same order of `sizes`.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateBlobs(const std::vector<size_t>& sizes,
+                     std::vector<std::unique_ptr<BlobWriter>>& blobs);
+
+  /**
+   * @brief Create a blob with the content of a local file. The file is
+   * loaded into the shared memory by the kernel (`copy_file_range`), or by
+   * reading into the mapped blob directly, without being staged in the
+   * memory of the client process, see also Notes [Importing Files into
+   * Blobs] in "client.cc".
+   *
+   * @param path The path of the local file.
+   * @param blob The result mutable blob will be set in `blob`.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateBlobFromFile(std::string const& path,
+                            std::unique_ptr<BlobWriter>& blob);
+
+  /**
+   * @brief Create a blob with `size` bytes of a local file starting from
+   * `offset`.
+   */
+  Status CreateBlobFromFile(std::string const& path, size_t const offset,
+                            size_t const size,
+                            std::unique_ptr<BlobWriter>& blob);
+
   /**
    * @brief Get a blob from vineyard server. When obtaining blobs from vineyard
    * server, the memory address in the server process will be mmapped to the
@@ -189,7 +225,11 @@ class Client : public ClientBase {
 
   /**
    * @brief open a stream on vineyard. Failed if the stream is already opened on
-   * the given mode.
+   * the given mode by this client, or opened for writing by others.
+   *
+   * Every client that opens the stream for reading is a consumer of the
+   * stream, and reads all chunks by its own, see also Notes [Stream Fan-out]
+   * in "server/memory/stream_store.h".
    *
    * @param id The id of stream to mark.
    * @param mode The mode, OpenStreamMode::read or OpenStreamMode::write.
@@ -217,7 +257,9 @@ class Client : public ClientBase {
    * @brief Poll a chunk from a stream. When there's no more chunk available in
    * the stream, i.e., the stream has been stoped, a status code
    * `kStreamDrained` or `kStreamFinish` will be returned, otherwise the reader
-   * will be blocked until writer creates a new chunk in the stream.
+   * will be blocked until writer creates a new chunk in the stream. The chunk
+   * is pinned for the reader (thus won't be spilled) until it is released or
+   * the reader disconnects.
    *
    * @param id The id of the stream.
    * @param blob The immutable chunk generated by the writer of the stream.
@@ -227,6 +269,53 @@ class Client : public ClientBase {
   Status PullNextStreamChunk(ObjectID const id,
                              std::unique_ptr<arrow::Buffer>& blob);
 
+  /**
+   * @brief Allocate a window of chunks of given size for a stream. The chunks
+   * that have been allocated by the previous call are sealed, thus the writer
+   * should fill every chunk in the window before asking for more, or before
+   * stopping the stream. See also Notes [Stream Chunk Batches] in
+   * "server/memory/stream_store.h".
+   *
+   * @param id The id of the stream.
+   * @param size The size of each chunk.
+   * @param count The number of chunks to allocate.
+   * @param blobs The allocated mutable buffers will be set in `blobs`.
+   *
+   * @return Status that indicates whether the allocation has succeeded.
+   */
+  Status GetNextStreamChunks(
+      ObjectID const id, size_t const size, size_t const count,
+      std::vector<std::unique_ptr<arrow::MutableBuffer>>& blobs);
+
+  /**
+   * @brief Allocate a window of chunks as above, and the chunks that are
+   * sealed are shrunk to the number of bytes that have been written into them
+   * (empty chunks are dropped), thus the writer could fill the chunks
+   * partially.
+   *
+   * @param used The number of bytes that have been written into each chunk
+   * allocated by the previous call.
+   */
+  Status GetNextStreamChunks(
+      ObjectID const id, std::vector<size_t> const& used, size_t const size,
+      size_t const count,
+      std::vector<std::unique_ptr<arrow::MutableBuffer>>& blobs);
+
+  /**
+   * @brief Poll at most `count` chunks from a stream in one round trip, which
+   * are valid until the next poll. The reader will be blocked until at least
+   * one chunk is available, or the stream is stopped.
+   *
+   * @param id The id of the stream.
+   * @param count The maximum number of chunks to poll.
+   * @param blobs The immutable chunks generated by the writer of the stream.
+   *
+   * @return Status that indicates whether the polling has succeeded.
+   */
+  Status PullNextStreamChunks(
+      ObjectID const id, size_t const count,
+      std::vector<std::unique_ptr<arrow::Buffer>>& blobs);
+
   /**
    * @brief Stop a stream, mark it as finished or aborted.
    *
@@ -238,10 +327,20 @@ class Client : public ClientBase {
    */
   Status StopStream(ObjectID const id, bool failed);
 
+  /**
+   * @brief Stop a stream as above, and the chunks that are sealed are shrunk
+   * to the `used` sizes, see also `GetNextStreamChunks`.
+   */
+  Status StopStream(ObjectID const id, bool failed,
+                    std::vector<size_t> const& used);
+
   /**
    * @brief Get an object from vineyard. The ObjectFactory will be used to
    * resolve the constructor of the object.
    *
+   * The metadata and buffers of the object are cached by the client, see
+   * also Notes [Client Metadata Cache] in "client/meta_cache.h".
+   *
    * @param id The object id to get.
    *
    * @return A std::shared_ptr<Object> that can be safely cast to the underlying
@@ -345,10 +444,30 @@ class Client : public ClientBase {
   Status ReleaseArena(const int fd, std::vector<size_t> const& offsets,
                       std::vector<size_t> const& sizes);
 
+  /**
+   * @brief Release the blobs that this client has created or got, the
+   * vineyard server is free to spill them once no client holds them, see
+   * also Notes [Blob Reference Counting] in "server/memory/memory.cc".
+   *
+   * The blobs (and the objects that refer to them) shouldn't be accessed
+   * through this client after being released, until they are got again.
+   * Otherwise, the blobs are released when the client disconnects.
+   *
+   * @param ids The IDs of the blobs to release.
+   */
+  Status Release(const std::set<ObjectID>& ids);
+
+  Status Release(const ObjectID id);
+
  protected:
   Status CreateBuffer(const size_t size, ObjectID& id, Payload& payload,
                       std::shared_ptr<arrow::MutableBuffer>& buffer);
 
+  Status CreateBuffers(
+      const std::vector<size_t>& sizes, std::vector<ObjectID>& ids,
+      std::vector<Payload>& payloads,
+      std::vector<std::shared_ptr<arrow::MutableBuffer>>& buffers);
+
   Status GetBuffer(const ObjectID id, std::shared_ptr<arrow::Buffer>& buffer);
 
   Status GetBuffers(
@@ -371,8 +490,20 @@ class Client : public ClientBase {
   Status mmapToClient(int fd, int64_t map_size, bool readonly, bool realign,
                       uint8_t** ptr);
 
+  /**
+   * @brief Receive the store fds that follow a reply at once, see also
+   * Notes [Creating Buffers in Bulk] in "common/util/protocols.h".
+   */
+  Status recvStoreFds(const std::vector<int>& fds,
+                      const std::vector<Payload>& payloads, bool readonly);
+
   std::unordered_map<int, std::unique_ptr<MmapEntry>> mmap_table_;
 
+  // the (server side) fd and size of the shared memory pool, the fd is -1
+  // if the shared memory pool is not used.
+  int shared_pool_fd_ = -1;
+  int64_t shared_pool_size_ = 0;
+
  private:
   friend class Blob;
   friend class BlobWriter;
@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "client/client_base.h"
 
+#include <sys/socket.h>
+
+#include <chrono>
 #include <future>
+#include <limits>
 #include <utility>
 
 #include "boost/range/combine.hpp"
@@ -24,21 +28,41 @@ limitations under the License.
 #include "client/io.h"
 #include "client/rpc_client.h"
 #include "client/utils.h"
+#include "common/util/env.h"
 #include "common/util/protocols.h"
 
 namespace vineyard {
 
-ClientBase::ClientBase() : connected_(false), vineyard_conn_(0) {}
+ClientBase::ClientBase()
+    : connected_(false),
+      vineyard_conn_(0),
+      binary_protocol_(false),
+      deleted_sequence_(std::numeric_limits<uint64_t>::max()) {
+  std::string cache_size = read_env("VINEYARD_META_CACHE_SIZE");
+  if (!cache_size.empty()) {
+    meta_cache_.SetCapacity(std::stoull(cache_size));
+  }
+  std::string sync_interval = read_env("VINEYARD_META_CACHE_SYNC_INTERVAL");
+  if (!sync_interval.empty()) {
+    meta_cache_.SetSyncInterval(std::stoll(sync_interval));
+  }
+}
 
 Status ClientBase::GetData(const ObjectID id, json& tree,
                            const bool sync_remote, const bool wait) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteGetDataRequest(id, sync_remote, wait, message_out);
+  if (binary_protocol_) {
+    WriteGetDataRequestBinary({id}, sync_remote, wait, message_out);
+  } else {
+    WriteGetDataRequest(id, sync_remote, wait, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
-  RETURN_ON_ERROR(ReadGetDataReply(message_in, tree));
+  RETURN_ON_ERROR(doReadReply(
+      [&](const json& root) { return ReadGetDataReply(root, tree); },
+      [&](BinaryDecoder& decoder) {
+        return ReadGetDataReplyBinary(decoder, tree);
+      }));
   return Status::OK();
 }
 
@@ -47,12 +71,18 @@ Status ClientBase::GetData(const std::vector<ObjectID>& ids,
                            const bool wait) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteGetDataRequest(ids, sync_remote, wait, message_out);
+  if (binary_protocol_) {
+    WriteGetDataRequestBinary(ids, sync_remote, wait, message_out);
+  } else {
+    WriteGetDataRequest(ids, sync_remote, wait, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
   std::unordered_map<ObjectID, json> meta_trees;
-  RETURN_ON_ERROR(ReadGetDataReply(message_in, meta_trees));
+  RETURN_ON_ERROR(doReadReply(
+      [&](const json& root) { return ReadGetDataReply(root, meta_trees); },
+      [&](BinaryDecoder& decoder) {
+        return ReadGetDataReplyBinary(decoder, meta_trees);
+      }));
   trees.reserve(ids.size());
   for (auto const& id : ids) {
     trees.emplace_back(meta_trees.at(id));
@@ -64,11 +94,19 @@ Status ClientBase::CreateData(const json& tree, ObjectID& id,
                               Signature& signature, InstanceID& instance_id) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteCreateDataRequest(tree, message_out);
+  if (binary_protocol_) {
+    WriteCreateDataRequestBinary(tree, message_out);
+  } else {
+    WriteCreateDataRequest(tree, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
-  RETURN_ON_ERROR(ReadCreateDataReply(message_in, id, signature, instance_id));
+  RETURN_ON_ERROR(doReadReply(
+      [&](const json& root) {
+        return ReadCreateDataReply(root, id, signature, instance_id);
+      },
+      [&](BinaryDecoder& decoder) {
+        return ReadCreateDataReplyBinary(decoder, id, signature, instance_id);
+      }));
   return Status::OK();
 }
 
@@ -116,6 +154,7 @@ Status ClientBase::DelData(const ObjectID id, const bool force,
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
   RETURN_ON_ERROR(ReadDelDataReply(message_in));
+  meta_cache_.Invalidate({id});
   return Status::OK();
 }
 
@@ -128,6 +167,7 @@ Status ClientBase::DelData(const std::vector<ObjectID>& ids, const bool force,
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
   RETURN_ON_ERROR(ReadDelDataReply(message_in));
+  meta_cache_.Invalidate(ids);
   return Status::OK();
 }
 
@@ -352,24 +392,73 @@ void ClientBase::Disconnect() {
   WriteExitRequest(message_out);
   VINEYARD_SUPPRESS(doWrite(message_out));
   close(vineyard_conn_);
+  channel_.reset();
+  meta_cache_.Clear();
+  deleted_sequence_ = std::numeric_limits<uint64_t>::max();
   connected_ = false;
 }
 
 Status ClientBase::doWrite(const std::string& message_out) {
-  auto status = send_message(vineyard_conn_, message_out);
+  Status status;
+  if (channel_ != nullptr &&
+      channel_->requests().Push(message_out.data(), message_out.size())) {
+    // see also: Notes [Command Channel]
+    if (channel_->requests().ClearWaiting()) {
+      channel_->requests().Wake();
+    }
+  } else {
+    status = send_message(vineyard_conn_, message_out);
+  }
   if (!status.ok()) {
     connected_ = false;
   }
   return status;
 }
 
+Status ClientBase::doReceive(std::string& message_in) {
+  if (channel_ == nullptr) {
+    return recv_message(vineyard_conn_, message_in);
+  }
+  // see also: Notes [Command Channel]
+  auto& replies = channel_->replies();
+  bool popped = false;
+  auto spin_until =
+      std::chrono::steady_clock::now() + std::chrono::microseconds(50);
+  while (true) {
+    uint32_t sequence = replies.Sequence();
+    RETURN_ON_ERROR(replies.Pop(message_in, popped));
+    if (popped) {
+      break;
+    }
+    if (std::chrono::steady_clock::now() < spin_until) {
+      continue;
+    }
+    if (replies.MarkWaiting()) {
+      replies.Wait(sequence, 10 * 1000 /* 10ms */);
+      replies.ClearWaiting();
+    }
+    // the server may have gone away
+    char peek;
+    if (recv(vineyard_conn_, &peek, 1, MSG_PEEK | MSG_DONTWAIT) == 0) {
+      return Status::IOError("The connection has been closed by the server");
+    }
+  }
+  if (message_in.empty()) {
+    // the reply doesn't fit into the ring and follows on the socket
+    return recv_message(vineyard_conn_, message_in);
+  }
+  // keep the same layout as `recv_message`
+  message_in.push_back('\0');
+  return Status::OK();
+}
+
 Status ClientBase::doRead(std::string& message_in) {
-  return recv_message(vineyard_conn_, message_in);
+  return doReceive(message_in);
 }
 
 Status ClientBase::doRead(json& root) {
   std::string message_in;
-  auto status = recv_message(vineyard_conn_, message_in);
+  auto status = doReceive(message_in);
   if (!status.ok()) {
     connected_ = false;
     return status;
@@ -384,6 +473,31 @@ Status ClientBase::doRead(json& root) {
   return status;
 }
 
+Status ClientBase::doReadReply(
+    std::function<Status(const json&)> json_reader,
+    std::function<Status(BinaryDecoder&)> binary_reader) {
+  std::string message_in;
+  auto status = doReceive(message_in);
+  if (!status.ok()) {
+    connected_ = false;
+    return status;
+  }
+  if (IsBinaryMessage(message_in)) {
+    BinaryDecoder decoder(message_in);
+    return binary_reader(decoder);
+  }
+  json root;
+  status = CATCH_JSON_ERROR([&]() -> Status {
+    root = json::parse(message_in);
+    return Status::OK();
+  }());
+  if (!status.ok()) {
+    connected_ = false;
+    return status;
+  }
+  return json_reader(root);
+}
+
 Status ClientBase::ClusterInfo(std::map<InstanceID, json>& meta) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -443,11 +557,72 @@ Status ClientBase::Debug(const json& debug, json& result) {
   return Status::OK();
 }
 
+Status ClientBase::syncMetaCache() {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteGetDeletedObjectsRequest(deleted_sequence_, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  uint64_t sequence = 0;
+  std::vector<ObjectID> ids;
+  bool overflow = false;
+  RETURN_ON_ERROR(
+      ReadGetDeletedObjectsReply(message_in, sequence, ids, overflow));
+  if (overflow) {
+    meta_cache_.Clear();
+  } else {
+    meta_cache_.Invalidate(ids);
+  }
+  deleted_sequence_ = sequence;
+  meta_cache_.MarkSynced();
+  return Status::OK();
+}
+
+Status ClientBase::getCachedMetaData(const ObjectID id, ObjectMeta& meta) {
+  std::vector<ObjectMeta> metas;
+  RETURN_ON_ERROR(getCachedMetaData(std::vector<ObjectID>{id}, metas));
+  meta = metas[0];
+  return Status::OK();
+}
+
+Status ClientBase::getCachedMetaData(const std::vector<ObjectID>& ids,
+                                     std::vector<ObjectMeta>& metas) {
+  std::lock_guard<std::recursive_mutex> __guard(this->client_mutex_);
+  if (meta_cache_.Capacity() == 0) {
+    return GetMetaData(ids, metas, true);
+  }
+  // see also Notes [Client Metadata Cache] for the sync interval
+  if (meta_cache_.NeedsSync()) {
+    RETURN_ON_ERROR(syncMetaCache());
+  }
+  metas.resize(ids.size());
+  std::vector<ObjectID> missing_ids;
+  std::vector<size_t> missing_indices;
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    if (!meta_cache_.Get(ids[idx], metas[idx])) {
+      missing_ids.emplace_back(ids[idx]);
+      missing_indices.emplace_back(idx);
+    }
+  }
+  if (missing_ids.empty()) {
+    return Status::OK();
+  }
+  std::vector<ObjectMeta> missing_metas;
+  RETURN_ON_ERROR(GetMetaData(missing_ids, missing_metas, true));
+  for (size_t idx = 0; idx < missing_ids.size(); ++idx) {
+    meta_cache_.Put(missing_ids[idx], missing_metas[idx]);
+    metas[missing_indices[idx]] = std::move(missing_metas[idx]);
+  }
+  return Status::OK();
+}
+
 InstanceStatus::InstanceStatus(const json& tree)
     : instance_id(tree["instance_id"].get<InstanceID>()),
       deployment(tree["deployment"].get_ref<const std::string&>()),
       memory_usage(tree["memory_usage"].get<size_t>()),
       memory_limit(tree["memory_limit"].get<size_t>()),
+      memory_in_use(tree.value("memory_in_use", static_cast<size_t>(0))),
       deferred_requests(tree["deferred_requests"].get<size_t>()),
       ipc_connections(tree["ipc_connections"].get<size_t>()),
       rpc_connections(tree["rpc_connections"].get<size_t>()) {}
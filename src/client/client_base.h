@@ -17,6 +17,7 @@ limitations under the License.
 #define SRC_CLIENT_CLIENT_BASE_H_
 
 #include <sys/mman.h>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -25,6 +26,8 @@ limitations under the License.
 #include <vector>
 
 #include "client/ds/object_meta.h"
+#include "client/meta_cache.h"
+#include "common/memory/command_channel.h"
 #include "common/util/boost.h"
 #include "common/util/status.h"
 #include "common/util/uuid.h"
@@ -33,6 +36,7 @@ limitations under the License.
 namespace vineyard {
 
 struct InstanceStatus;
+class BinaryDecoder;
 
 /**
  * @brief ClientBase is the base class for vineyard IPC and RPC client.
@@ -118,6 +122,19 @@ class ClientBase {
   virtual Status GetMetaData(const ObjectID id, ObjectMeta& meta_data,
                              const bool sync_remote = false) = 0;
 
+  /**
+   * @brief Get the meta-data of the requested objects
+   *
+   * @param ids The IDs of the requested objects
+   * @param meta_data The returned metadata of the requested objects
+   * @param sync_remote Whether trigger remote sync
+   *
+   * @return Status that indicates whether the get action has succeeded.
+   */
+  virtual Status GetMetaData(const std::vector<ObjectID>& ids,
+                             std::vector<ObjectMeta>& meta_data,
+                             const bool sync_remote = false) = 0;
+
   /**
    * Sync remote metadata from etcd to the connected vineyardd.
    *
@@ -392,6 +409,15 @@ class ClientBase {
    */
   Status Debug(const json& debug, json& tree);
 
+  /**
+   * @brief The cache of object metadata used by `GetObject` and `GetObjects`,
+   * see also Notes [Client Metadata Cache] in "client/meta_cache.h".
+   *
+   * @return The metadata cache of this client, which also counts the hits
+   * and misses.
+   */
+  MetaCache& GetMetaCache() { return meta_cache_; }
+
  protected:
   Status doWrite(const std::string& message_out);
 
@@ -399,6 +425,19 @@ class ClientBase {
 
   Status doRead(json& root);
 
+  /**
+   * @brief Read a reply that could be encoded either as JSON or in the
+   * binary protocol, see also Notes [Binary Protocol].
+   */
+  Status doReadReply(std::function<Status(const json&)> json_reader,
+                     std::function<Status(BinaryDecoder&)> binary_reader);
+
+  /**
+   * @brief Receive a reply, either from the command channel or from the
+   * socket, see also Notes [Command Channel].
+   */
+  Status doReceive(std::string& message_in);
+
   /**
    * @brief Implementation for migrate remote object to local.
    *
@@ -413,12 +452,36 @@ class ClientBase {
                       std::string const& peer,
                       std::string const& peer_rpc_endpoint);
 
+  /**
+   * @brief Drop the cached metadata of objects that have been deleted since
+   * the last synchronization, see also Notes [Client Metadata Cache].
+   */
+  Status syncMetaCache();
+
+  /**
+   * @brief Get the (remote synchronized) metadata of objects, from the
+   * metadata cache if possible.
+   */
+  Status getCachedMetaData(const ObjectID id, ObjectMeta& meta);
+
+  Status getCachedMetaData(const std::vector<ObjectID>& ids,
+                           std::vector<ObjectMeta>& metas);
+
   mutable bool connected_;
   std::string ipc_socket_;
   std::string rpc_endpoint_;
   int vineyard_conn_;
   InstanceID instance_id_;
   std::string server_version_;
+  // whether the binary protocol has been negotiated with the server
+  bool binary_protocol_;
+  // the request/reply rings, if negotiated with the server
+  std::unique_ptr<CommandChannel> channel_;
+
+  MetaCache meta_cache_;
+  // the sequence number of deletions that the metadata cache has caught up
+  // with, the max value means not synchronized yet.
+  uint64_t deleted_sequence_;
 
   // A mutex which protects the client.
   std::recursive_mutex client_mutex_;
@@ -433,6 +496,9 @@ struct InstanceStatus {
   const size_t memory_usage;
   /// The memory upper bound of this vineyard server, in bytes.
   const size_t memory_limit;
+  /// The memory of blobs that are held by clients, in bytes, the rest of
+  /// `memory_usage` is cached by the vineyard server.
+  const size_t memory_in_use;
   /// How many requests are deferred in the queue.
   const size_t deferred_requests;
   /// How many Client connects to this vineyard server.
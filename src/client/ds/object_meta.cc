@@ -15,27 +15,66 @@ limitations under the License.
 
 #include "client/ds/object_meta.h"
 
+#include <mutex>
+#include <utility>
+
 #include "client/client.h"
 #include "client/ds/blob.h"
 
 namespace vineyard {
 
-ObjectMeta::ObjectMeta() : buffer_set_(std::make_shared<BufferSet>()) {}
+/**
+ * Notes [Lazy Member Metadata]:
+ *
+ * Objects with many members (e.g., fragments with many labels) copy their
+ * metadata, and the metadata of every member, many times during `Construct`:
+ * the object keeps a copy of its metadata, `GetMemberMeta` copies the subtree
+ * of the member and scans blobs of the subtree to build a new buffer set, and
+ * the members do the same recursively, which is quadratic in the number of
+ * members.
+ *
+ * Thus the metadata is a view of a (sub-)tree of a shared json tree:
+ *
+ * - copying the metadata, or getting the metadata of a member, only refers
+ *   to the same tree, and the tree is copied when it is modified while
+ *   shared with others (i.e., copy-on-write);
+ * - the metadata of a member looks up its blobs in the buffer set of the
+ *   enclosing metadata, and its own buffer set is only resolved when asked
+ *   by `GetBufferSet()`, or modified;
+ * - json values that are stored as strings are parsed once, and cached until
+ *   the metadata is modified.
+ */
+
+struct ObjectMeta::json_cache_t {
+  std::mutex mutex;
+  std::unordered_map<std::string, json> values;
+};
+
+ObjectMeta::ObjectMeta()
+    : tree_(std::make_shared<json>()),
+      meta_(tree_.get()),
+      buffer_set_(std::make_shared<BufferSet>()) {}
 
 ObjectMeta::~ObjectMeta() {}
 
 ObjectMeta::ObjectMeta(const ObjectMeta& other) {
   this->client_ = other.client_;
+  this->tree_ = other.tree_;
   this->meta_ = other.meta_;
-  this->buffer_set_ = other.buffer_set_;
+  this->buffer_set_ = std::atomic_load(&other.buffer_set_);
+  this->shared_buffers_ = other.shared_buffers_;
+  this->json_cache_ = std::atomic_load(&other.json_cache_);
   this->incomplete_ = other.incomplete_;
   this->force_local_ = other.force_local_;
 }
 
 ObjectMeta& ObjectMeta::operator=(ObjectMeta const& other) {
   this->client_ = other.client_;
+  this->tree_ = other.tree_;
   this->meta_ = other.meta_;
-  this->buffer_set_ = other.buffer_set_;
+  this->buffer_set_ = std::atomic_load(&other.buffer_set_);
+  this->shared_buffers_ = other.shared_buffers_;
+  this->json_cache_ = std::atomic_load(&other.json_cache_);
   this->incomplete_ = other.incomplete_;
   this->force_local_ = other.force_local_;
   return *this;
@@ -46,35 +85,39 @@ void ObjectMeta::SetClient(ClientBase* client) { this->client_ = client; }
 ClientBase* ObjectMeta::GetClient() const { return client_; }
 
 void ObjectMeta::SetId(const ObjectID& id) {
-  meta_["id"] = VYObjectIDToString(id);
+  MutMetaData()["id"] = VYObjectIDToString(id);
 }
 
 const ObjectID ObjectMeta::GetId() const {
-  return VYObjectIDFromString(meta_["id"].get_ref<std::string const&>());
+  return VYObjectIDFromString(MetaData()["id"].get_ref<std::string const&>());
 }
 
 const Signature ObjectMeta::GetSignature() const {
-  return meta_["signature"].get<Signature>();
+  return MetaData()["signature"].get<Signature>();
 }
 
 void ObjectMeta::ResetSignature() { this->ResetKey("signature"); }
 
-void ObjectMeta::SetGlobal(bool global) { meta_["global"] = global; }
+void ObjectMeta::SetGlobal(bool global) { MutMetaData()["global"] = global; }
 
-const bool ObjectMeta::IsGlobal() const { return meta_.value("global", false); }
+const bool ObjectMeta::IsGlobal() const {
+  return meta_->value("global", false);
+}
 
 void ObjectMeta::SetTypeName(const std::string& type_name) {
-  meta_["typename"] = type_name;
+  MutMetaData()["typename"] = type_name;
 }
 
 std::string const& ObjectMeta::GetTypeName() const {
-  return meta_["typename"].get_ref<std::string const&>();
+  return MetaData()["typename"].get_ref<std::string const&>();
 }
 
-void ObjectMeta::SetNBytes(const size_t nbytes) { meta_["nbytes"] = nbytes; }
+void ObjectMeta::SetNBytes(const size_t nbytes) {
+  MutMetaData()["nbytes"] = nbytes;
+}
 
 size_t const ObjectMeta::GetNBytes() const {
-  auto nbytes = meta_["nbytes"];
+  auto nbytes = MetaData()["nbytes"];
   if (nbytes.is_null()) {
     // return 0 to indicate such objects has no nbytes, e.g., global objects
     return 0;
@@ -84,14 +127,14 @@ size_t const ObjectMeta::GetNBytes() const {
 }
 
 InstanceID const ObjectMeta::GetInstanceId() const {
-  return meta_["instance_id"].get<InstanceID>();
+  return MetaData()["instance_id"].get<InstanceID>();
 }
 
 bool const ObjectMeta::IsLocal() const {
   if (this->force_local_) {
     return true;
   }
-  auto instance_id = meta_["instance_id"];
+  auto instance_id = MetaData()["instance_id"];
   if (instance_id.is_null()) {
     // it is a newly created metadata
     return true;
@@ -107,36 +150,31 @@ bool const ObjectMeta::IsLocal() const {
 void ObjectMeta::ForceLocal() const { this->force_local_ = true; }
 
 bool const ObjectMeta::Haskey(std::string const& key) const {
-  return meta_.contains(key);
+  return meta_->contains(key);
 }
 
 void ObjectMeta::ResetKey(std::string const& key) {
-  if (meta_.contains(key)) {
-    meta_.erase(key);
+  if (meta_->contains(key)) {
+    MutMetaData().erase(key);
   }
 }
 
 void ObjectMeta::AddKeyValue(const std::string& key, const std::string& value) {
-  meta_[key] = value;
+  MutMetaData()[key] = value;
 }
 
 void ObjectMeta::AddKeyValue(const std::string& key, const json& value) {
-  meta_[key] = json_to_string(value);
+  MutMetaData()[key] = json_to_string(value);
 }
 
 void ObjectMeta::GetKeyValue(const std::string& key, json& value) const {
-  try {
-    value = json::parse(meta_[key].get_ref<const std::string&>());
-  } catch (nlohmann::json::parse_error const&) {
-    throw std::out_of_range("Invalid json value at key '" + key +
-                            "': " + meta_[key].get_ref<const std::string&>());
-  }
+  value = parsedKeyValue(key);
 }
 
 void ObjectMeta::AddMember(const std::string& name, const ObjectMeta& member) {
-  VINEYARD_ASSERT(!meta_.contains(name));
-  meta_[name] = member.meta_;
-  this->buffer_set_->Extend(member.buffer_set_);
+  VINEYARD_ASSERT(!meta_->contains(name));
+  MutMetaData()[name] = member.MetaData();
+  this->GetBufferSet()->Extend(member.GetBufferSet());
 }
 
 void ObjectMeta::AddMember(const std::string& name, const Object& member) {
@@ -153,10 +191,10 @@ void ObjectMeta::AddMember(const std::string& name,
 }
 
 void ObjectMeta::AddMember(const std::string& name, const ObjectID member_id) {
-  VINEYARD_ASSERT(!meta_.contains(name));
+  VINEYARD_ASSERT(!meta_->contains(name));
   json member_node;
   member_node["id"] = VYObjectIDToString(member_id);
-  meta_[name] = member_node;
+  MutMetaData()[name] = member_node;
   // mark the meta_ as incomplete
   incomplete_ = true;
 }
@@ -172,19 +210,20 @@ std::shared_ptr<Object> ObjectMeta::GetMember(const std::string& name) const {
 }
 
 ObjectMeta ObjectMeta::GetMemberMeta(const std::string& name) const {
-  ObjectMeta ret;
-  auto const& child_meta = meta_[name];
+  auto const& child_meta = MetaData()[name];
   VINEYARD_ASSERT(!child_meta.is_null(), "Failed to get member " + name);
 
-  ret.SetMetaData(this->client_, child_meta);
-  auto const& all_blobs = buffer_set_->AllBuffers();
-  for (auto const& blob : ret.buffer_set_->AllBuffers()) {
-    auto iter = all_blobs.find(blob.first);
-    // for remote object, the blob may not present here
-    if (iter != all_blobs.end()) {
-      ret.SetBuffer(blob.first, iter->second);
-    }
+  // see also: Notes [Lazy Member Metadata]
+  ObjectMeta ret(*this);
+  // n.b.: the shared tree won't be modified, see also `MutMetaData()`.
+  ret.meta_ = const_cast<json*>(&child_meta);
+  ret.shared_buffers_ = std::atomic_load(&buffer_set_);
+  if (ret.shared_buffers_ == nullptr) {
+    ret.shared_buffers_ = shared_buffers_;
   }
+  ret.buffer_set_ = nullptr;
+  ret.json_cache_ = nullptr;
+  ret.incomplete_ = false;
   if (this->force_local_) {
     ret.ForceLocal();
   }
@@ -193,7 +232,12 @@ ObjectMeta ObjectMeta::GetMemberMeta(const std::string& name) const {
 
 Status ObjectMeta::GetBuffer(const ObjectID blob_id,
                              std::shared_ptr<arrow::Buffer>& buffer) const {
-  if (buffer_set_->Get(blob_id, buffer)) {
+  auto buffer_set = std::atomic_load(&buffer_set_);
+  if (buffer_set == nullptr) {
+    // for remote object, the blob may not present here
+    buffer_set = shared_buffers_;
+  }
+  if (buffer_set->Get(blob_id, buffer)) {
     return Status::OK();
   } else {
     return Status::ObjectNotExists(
@@ -205,29 +249,46 @@ void ObjectMeta::SetBuffer(const ObjectID& id,
                            const std::shared_ptr<arrow::Buffer>& buffer) {
   // After `findAllBlobs` we know the buffer set of this object. If the given id
   // is not present in the buffer set, it should be an error.
-  VINEYARD_ASSERT(buffer_set_->Contains(id));
-  VINEYARD_CHECK_OK(buffer_set_->EmplaceBuffer(id, buffer));
+  auto const& buffer_set = GetBufferSet();
+  VINEYARD_ASSERT(buffer_set->Contains(id));
+  VINEYARD_CHECK_OK(buffer_set->EmplaceBuffer(id, buffer));
 }
 
 void ObjectMeta::Reset() {
   client_ = nullptr;
-  meta_ = json::object();
+  tree_ = std::make_shared<json>(json::object());
+  meta_ = tree_.get();
   buffer_set_.reset(new BufferSet());
+  shared_buffers_ = nullptr;
+  json_cache_ = nullptr;
   incomplete_ = false;
 }
 
-void ObjectMeta::PrintMeta() const { LOG(INFO) << meta_.dump(4); }
+void ObjectMeta::PrintMeta() const { LOG(INFO) << meta_->dump(4); }
 
 const bool ObjectMeta::incomplete() const { return incomplete_; }
 
-const json& ObjectMeta::MetaData() const { return meta_; }
+const json& ObjectMeta::MetaData() const { return *meta_; }
 
-json& ObjectMeta::MutMetaData() { return meta_; }
+json& ObjectMeta::MutMetaData() {
+  // copy-on-write, see also Notes [Lazy Member Metadata]
+  if (tree_.use_count() > 1) {
+    tree_ = std::make_shared<json>(*meta_);
+    meta_ = tree_.get();
+  }
+  json_cache_ = nullptr;
+  return *meta_;
+}
 
 void ObjectMeta::SetMetaData(ClientBase* client, const json& meta) {
   this->client_ = client;
-  this->meta_ = meta;
-  findAllBlobs(meta_);
+  this->tree_ = std::make_shared<json>(meta);
+  this->meta_ = tree_.get();
+  this->json_cache_ = nullptr;
+  if (this->buffer_set_ == nullptr) {
+    this->buffer_set_ = std::make_shared<BufferSet>();
+  }
+  findAllBlobs(*meta_, *buffer_set_);
 }
 
 std::unique_ptr<ObjectMeta> ObjectMeta::Unsafe(std::string meta,
@@ -256,10 +317,25 @@ std::unique_ptr<ObjectMeta> ObjectMeta::Unsafe(json meta, size_t nobjects,
 }
 
 const std::shared_ptr<BufferSet>& ObjectMeta::GetBufferSet() const {
+  if (std::atomic_load(&buffer_set_) == nullptr) {
+    // resolve the buffer set of members on demand
+    auto buffer_set = std::make_shared<BufferSet>();
+    findAllBlobs(*meta_, *buffer_set);
+    auto const& all_blobs = shared_buffers_->AllBuffers();
+    for (auto const& blob : buffer_set->AllBuffers()) {
+      auto iter = all_blobs.find(blob.first);
+      // for remote object, the blob may not present here
+      if (iter != all_blobs.end() && iter->second != nullptr) {
+        VINEYARD_CHECK_OK(buffer_set->EmplaceBuffer(blob.first, iter->second));
+      }
+    }
+    std::shared_ptr<BufferSet> expected = nullptr;
+    std::atomic_compare_exchange_strong(&buffer_set_, &expected, buffer_set);
+  }
   return buffer_set_;
 }
 
-void ObjectMeta::findAllBlobs(const json& tree) {
+void ObjectMeta::findAllBlobs(const json& tree, BufferSet& buffer_set) const {
   if (tree.empty()) {
     return;
   }
@@ -268,33 +344,51 @@ void ObjectMeta::findAllBlobs(const json& tree) {
   if (IsBlob(member_id)) {
     if (client_ == nullptr /* traverse to account blobs */ ||
         tree["instance_id"].get<InstanceID>() == client_->instance_id()) {
-      VINEYARD_CHECK_OK(buffer_set_->EmplaceBuffer(member_id));
+      VINEYARD_CHECK_OK(buffer_set.EmplaceBuffer(member_id));
     }
   } else {
     for (auto& item : tree) {
       if (item.is_object()) {
-        this->findAllBlobs(item);
+        this->findAllBlobs(item, buffer_set);
       }
     }
   }
 }
 
+const json& ObjectMeta::parsedKeyValue(const std::string& key) const {
+  auto json_cache = std::atomic_load(&json_cache_);
+  if (json_cache == nullptr) {
+    auto cache = std::make_shared<json_cache_t>();
+    if (std::atomic_compare_exchange_strong(&json_cache_, &json_cache,
+                                            cache)) {
+      json_cache = cache;
+    }
+  }
+  std::lock_guard<std::mutex> guard(json_cache->mutex);
+  auto iter = json_cache->values.find(key);
+  if (iter != json_cache->values.end()) {
+    return iter->second;
+  }
+  auto const& value = MetaData()[key].get_ref<const std::string&>();
+  try {
+    return json_cache->values.emplace(key, json::parse(value)).first->second;
+  } catch (nlohmann::json::parse_error const&) {
+    throw std::out_of_range("Invalid json value at key '" + key +
+                            "': " + value);
+  }
+}
+
 void ObjectMeta::SetInstanceId(const InstanceID instance_id) {
-  meta_["instance_id"] = instance_id;
+  MutMetaData()["instance_id"] = instance_id;
 }
 
 void ObjectMeta::SetSignature(const Signature signature) {
-  meta_["signature"] = signature;
+  MutMetaData()["signature"] = signature;
 }
 
 template <>
 const json ObjectMeta::GetKeyValue<json>(const std::string& key) const {
-  try {
-    return json::parse(meta_[key].get_ref<const std::string&>());
-  } catch (nlohmann::json::parse_error const&) {
-    throw std::out_of_range("Invalid json value at key '" + key +
-                            "': " + meta_[key].get_ref<const std::string&>());
-  }
+  return parsedKeyValue(key);
 }
 
 }  // namespace vineyard
@@ -164,7 +164,7 @@ class ObjectMeta {
    */
   template <typename T>
   void AddKeyValue(const std::string& key, T const& value) {
-    meta_[key] = value;
+    MutMetaData()[key] = value;
   }
 
   /**
@@ -177,7 +177,7 @@ class ObjectMeta {
    */
   template <typename T>
   void AddKeyValue(const std::string& key, std::set<T> const& values) {
-    meta_[key] = json_to_string(json(values));
+    MutMetaData()[key] = json_to_string(json(values));
   }
 
   /**
@@ -190,7 +190,7 @@ class ObjectMeta {
    */
   template <typename T>
   void AddKeyValue(const std::string& key, std::vector<T> const& values) {
-    meta_[key] = json_to_string(json(values));
+    MutMetaData()[key] = json_to_string(json(values));
   }
 
   /**
@@ -277,7 +277,7 @@ class ObjectMeta {
    * @param key The key of metadata.
    */
   const std::string GetKeyValue(const std::string& key) const {
-    return meta_[key].get_ref<const std::string&>();
+    return MetaData()[key].get_ref<const std::string&>();
   }
 
   /**
@@ -288,7 +288,7 @@ class ObjectMeta {
    */
   template <typename T>
   const T GetKeyValue(const std::string& key) const {
-    return meta_[key].get<typename std::remove_cv<T>::type>();
+    return MetaData()[key].get<typename std::remove_cv<T>::type>();
   }
 
   /**
@@ -301,7 +301,7 @@ class ObjectMeta {
    */
   template <typename T>
   void GetKeyValue(const std::string& key, T& value) const {
-    value = meta_[key].get<typename std::remove_cv<T>::type>();
+    value = MetaData()[key].get<typename std::remove_cv<T>::type>();
   }
 
   /**
@@ -314,7 +314,7 @@ class ObjectMeta {
    */
   template <typename T>
   void GetKeyValue(const std::string& key, std::set<T>& values) const {
-    get_container(meta_, key, values);
+    get_container(MetaData(), key, values);
   }
 
   /**
@@ -328,7 +328,7 @@ class ObjectMeta {
    */
   template <typename T>
   void GetKeyValue(const std::string& key, std::vector<T>& values) const {
-    get_container(meta_, key, values);
+    get_container(MetaData(), key, values);
   }
 
   /**
@@ -343,8 +343,7 @@ class ObjectMeta {
   template <typename Value>
   void GetKeyValue(const std::string& key,
                    std::map<std::string, Value>& values) const {
-    json tree;
-    GetKeyValue(key, tree);
+    json const& tree = parsedKeyValue(key);
     for (auto const& kv : json::iterator_wrapper(tree)) {
       values.emplace(kv.key(), kv.value().get<Value>());
     }
@@ -362,8 +361,7 @@ class ObjectMeta {
   template <typename Value>
   void GetKeyValue(const std::string& key,
                    std::map<json, Value>& values) const {
-    json tree;
-    GetKeyValue(key, tree);
+    json const& tree = parsedKeyValue(key);
     for (auto const& kv : json::iterator_wrapper(tree)) {
       values.emplace(json::parse(kv.key()), kv.value().get<Value>());
     }
@@ -381,8 +379,7 @@ class ObjectMeta {
   template <typename Value>
   void GetKeyValue(const std::string& key,
                    std::unordered_map<std::string, Value>& values) const {
-    json tree;
-    GetKeyValue(key, tree);
+    json const& tree = parsedKeyValue(key);
     for (auto const& kv : json::iterator_wrapper(tree)) {
       values.emplace(kv.key(), kv.value().get<Value>());
     }
@@ -400,8 +397,7 @@ class ObjectMeta {
   template <typename Value>
   void GetKeyValue(const std::string& key,
                    std::unordered_map<json, Value>& values) const {
-    json tree;
-    GetKeyValue(key, tree);
+    json const& tree = parsedKeyValue(key);
     for (auto const& kv : json::iterator_wrapper(tree)) {
       values.emplace(json::parse(kv.key()), kv.value().get<Value>());
     }
@@ -516,13 +512,23 @@ class ObjectMeta {
 
   using const_iterator =
       nlohmann::detail::iteration_proxy_value<json::const_iterator>;
-  const_iterator begin() const { return json::iterator_wrapper(meta_).begin(); }
-  const_iterator end() const { return json::iterator_wrapper(meta_).end(); }
+  const_iterator begin() const {
+    return json::iterator_wrapper(MetaData()).begin();
+  }
+  const_iterator end() const {
+    return json::iterator_wrapper(MetaData()).end();
+  }
 
   const std::shared_ptr<BufferSet>& GetBufferSet() const;
 
  private:
-  void findAllBlobs(const json& tree);
+  void findAllBlobs(const json& tree, BufferSet& buffer_set) const;
+
+  /**
+   * @brief The parsed json value of a string value, parsed once and cached
+   * until the metadata is modified.
+   */
+  const json& parsedKeyValue(const std::string& key) const;
 
   void SetInstanceId(const InstanceID instance_id);
 
@@ -531,9 +537,20 @@ class ObjectMeta {
   // hold a client_ reference, since we already hold blobs in metadata, which,
   // depends on that the "client_" should be valid.
   ClientBase* client_ = nullptr;
-  json meta_;
-  // associated blobs
-  std::shared_ptr<BufferSet> buffer_set_ = nullptr;
+
+  // the metadata is a view of the (sub-)tree `meta_` in `tree_`, which may be
+  // shared with copies and members, see also Notes [Lazy Member Metadata].
+  std::shared_ptr<json> tree_ = nullptr;
+  json* meta_ = nullptr;
+
+  // associated blobs, resolved on demand for the metadata of members
+  mutable std::shared_ptr<BufferSet> buffer_set_ = nullptr;
+  // the buffers of the enclosing metadata, where blobs of members are found
+  std::shared_ptr<BufferSet> shared_buffers_ = nullptr;
+
+  // parsed json values
+  struct json_cache_t;
+  mutable std::shared_ptr<json_cache_t> json_cache_ = nullptr;
 
   // incomplete: whether the metadata has incomplete member, introduced by
   // `AddMember(name, member_id)`.
@@ -0,0 +1,151 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "client/meta_cache.h"
+
+#include "client/ds/blob.h"
+
+namespace vineyard {
+
+MetaCache::MetaCache(const size_t capacity) : capacity_(capacity) {}
+
+void MetaCache::SetCapacity(const size_t capacity) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  capacity_ = capacity;
+  while (entries_.size() > capacity_) {
+    evict(lru_.back());
+  }
+}
+
+void MetaCache::SetSyncInterval(const int64_t interval) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  sync_interval_ = interval;
+}
+
+int64_t MetaCache::SyncInterval() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return sync_interval_;
+}
+
+bool MetaCache::NeedsSync() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!synced_ || sync_interval_ <= 0) {
+    return true;
+  }
+  return std::chrono::steady_clock::now() - last_sync_ >=
+         std::chrono::milliseconds(sync_interval_);
+}
+
+void MetaCache::MarkSynced() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  synced_ = true;
+  last_sync_ = std::chrono::steady_clock::now();
+}
+
+size_t MetaCache::Size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entries_.size();
+}
+
+size_t MetaCache::Hits() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return hits_;
+}
+
+size_t MetaCache::Misses() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return misses_;
+}
+
+bool MetaCache::Get(const ObjectID id, ObjectMeta& meta) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = entries_.find(id);
+  if (iter == entries_.end()) {
+    misses_ += 1;
+    return false;
+  }
+  hits_ += 1;
+  lru_.splice(lru_.begin(), lru_, iter->second.lru);
+  meta = iter->second.meta;
+  return true;
+}
+
+void MetaCache::Put(const ObjectID id, const ObjectMeta& meta) {
+  if (meta.incomplete() || meta.MetaData().empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (capacity_ == 0) {
+    return;
+  }
+  if (entries_.find(id) != entries_.end()) {
+    evict(id);
+  }
+  while (entries_.size() >= capacity_) {
+    evict(lru_.back());
+  }
+  lru_.emplace_front(id);
+  Entry& entry = entries_[id];
+  entry.meta = meta;
+  entry.lru = lru_.begin();
+  for (auto const& buffer_id : meta.GetBufferSet()->AllBufferIds()) {
+    entry.buffers.emplace_back(buffer_id);
+    referrers_.emplace(buffer_id, id);
+  }
+}
+
+void MetaCache::Invalidate(const std::vector<ObjectID>& ids) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto const id : ids) {
+    if (entries_.find(id) != entries_.end()) {
+      evict(id);
+    }
+    auto range = referrers_.equal_range(id);
+    std::vector<ObjectID> referrers;
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      referrers.emplace_back(iter->second);
+    }
+    for (auto const referrer : referrers) {
+      if (entries_.find(referrer) != entries_.end()) {
+        evict(referrer);
+      }
+    }
+  }
+}
+
+void MetaCache::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+  lru_.clear();
+  referrers_.clear();
+  synced_ = false;
+}
+
+void MetaCache::evict(const ObjectID id) {
+  auto iter = entries_.find(id);
+  for (auto const buffer_id : iter->second.buffers) {
+    auto range = referrers_.equal_range(buffer_id);
+    for (auto referrer = range.first; referrer != range.second; ++referrer) {
+      if (referrer->second == id) {
+        referrers_.erase(referrer);
+        break;
+      }
+    }
+  }
+  lru_.erase(iter->second.lru);
+  entries_.erase(iter);
+}
+
+}  // namespace vineyard
@@ -0,0 +1,147 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_CLIENT_META_CACHE_H_
+#define SRC_CLIENT_META_CACHE_H_
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "client/ds/object_meta.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * Notes [Client Metadata Cache]:
+ *
+ * Objects are immutable once they have been created, thus `GetObject` and
+ * `GetObjects` keep the metadata (together with the resolved buffers) of the
+ * objects they have got in a bounded LRU cache, rather than asking vineyardd
+ * (which synchronizes with etcd first) and mapping the buffers again for
+ * every call.
+ *
+ * Objects could still be deleted, by any client. vineyardd records every
+ * deleted object and blob in a log, and numbers them by a sequence. The
+ * client polls the deletions after the sequence number it has caught up with
+ * (`get_deleted_objects_request`, a cheap request that doesn't touch the
+ * metadata), and drops the cached objects that either have been deleted or
+ * refer to a deleted blob. A client that has fallen behind the log drops the
+ * whole cache.
+ *
+ * The deletions are polled before a lookup only when the sync interval has
+ * elapsed since the last poll, thus hits within the interval are served
+ * without any round trip, and deletions made by other clients are observed
+ * at most one interval later. Deletions made by the client itself are
+ * observed immediately.
+ *
+ * The capacity (in number of objects) is configured by the environment
+ * variable `VINEYARD_META_CACHE_SIZE`, and 0 disables the cache. The sync
+ * interval (in milliseconds) is configured by the environment variable
+ * `VINEYARD_META_CACHE_SYNC_INTERVAL`, and 0 polls before every lookup.
+ * `GetMetaData` is never cached.
+ */
+class MetaCache {
+ public:
+  static constexpr size_t kDefaultCapacity = 1024;
+  static constexpr int64_t kDefaultSyncInterval = 100;  // milliseconds
+
+  explicit MetaCache(const size_t capacity = kDefaultCapacity);
+
+  size_t Capacity() const { return capacity_; }
+
+  /**
+   * @brief Change the capacity, 0 disables the cache.
+   */
+  void SetCapacity(const size_t capacity);
+
+  /**
+   * @brief Change the sync interval (in milliseconds), 0 polls the deletions
+   * before every lookup.
+   */
+  void SetSyncInterval(const int64_t interval);
+
+  int64_t SyncInterval() const;
+
+  /**
+   * @brief Whether the deletions should be polled before the next lookup,
+   * i.e., never polled, or the sync interval has elapsed since the last poll.
+   */
+  bool NeedsSync() const;
+
+  /**
+   * @brief Record that the deletions have just been polled.
+   */
+  void MarkSynced();
+
+  size_t Size() const;
+
+  size_t Hits() const;
+
+  size_t Misses() const;
+
+  /**
+   * @brief Lookup the metadata of the given object, and count the hit (or
+   * the miss).
+   */
+  bool Get(const ObjectID id, ObjectMeta& meta);
+
+  /**
+   * @brief Cache the metadata of the given object, incomplete metadata is
+   * ignored.
+   */
+  void Put(const ObjectID id, const ObjectMeta& meta);
+
+  /**
+   * @brief Drop the cached objects that are (or refer to) the given objects
+   * or blobs.
+   */
+  void Invalidate(const std::vector<ObjectID>& ids);
+
+  /**
+   * @brief Drop all cached objects, and the next lookup polls the deletions.
+   */
+  void Clear();
+
+ private:
+  struct Entry {
+    ObjectMeta meta;
+    std::list<ObjectID>::iterator lru;
+    // the buffers that the object refers to
+    std::vector<ObjectID> buffers;
+  };
+
+  void evict(const ObjectID id);
+
+  mutable std::mutex mutex_;
+  size_t capacity_;
+  size_t hits_ = 0, misses_ = 0;
+  int64_t sync_interval_ = kDefaultSyncInterval;
+  bool synced_ = false;
+  std::chrono::steady_clock::time_point last_sync_;
+
+  std::unordered_map<ObjectID, Entry> entries_;
+  // the most recently used object is in the front
+  std::list<ObjectID> lru_;
+  // buffer -> cached objects that refer to it
+  std::unordered_multimap<ObjectID, ObjectID> referrers_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_CLIENT_META_CACHE_H_
@@ -67,7 +67,7 @@ Status RPCClient::Connect(const std::string& host, uint32_t port) {
   std::string ipc_socket_value, rpc_endpoint_value;
   RETURN_ON_ERROR(ReadRegisterReply(message_in, ipc_socket_value,
                                     rpc_endpoint_value, remote_instance_id_,
-                                    server_version_));
+                                    server_version_, binary_protocol_));
   ipc_socket_ = ipc_socket_value;
   connected_ = true;
 
@@ -117,7 +117,7 @@ Status RPCClient::GetMetaData(const std::vector<ObjectID>& ids,
 
 std::shared_ptr<Object> RPCClient::GetObject(const ObjectID id) {
   ObjectMeta meta;
-  VINEYARD_CHECK_OK(this->GetMetaData(id, meta, true));
+  VINEYARD_CHECK_OK(this->getCachedMetaData(id, meta));
   VINEYARD_ASSERT(!meta.MetaData().empty());
   auto object = ObjectFactory::Create(meta.GetTypeName());
   if (object == nullptr) {
@@ -130,7 +130,7 @@ std::shared_ptr<Object> RPCClient::GetObject(const ObjectID id) {
 Status RPCClient::GetObject(const ObjectID id,
                             std::shared_ptr<Object>& object) {
   ObjectMeta meta;
-  RETURN_ON_ERROR(this->GetMetaData(id, meta, true));
+  RETURN_ON_ERROR(this->getCachedMetaData(id, meta));
   RETURN_ON_ASSERT(!meta.MetaData().empty());
   object = ObjectFactory::Create(meta.GetTypeName());
   if (object == nullptr) {
@@ -143,7 +143,7 @@ Status RPCClient::GetObject(const ObjectID id,
 std::vector<std::shared_ptr<Object>> RPCClient::GetObjects(
     const std::vector<ObjectID>& ids) {
   std::vector<ObjectMeta> metas;
-  VINEYARD_CHECK_OK(this->GetMetaData(ids, metas, true));
+  VINEYARD_CHECK_OK(this->getCachedMetaData(ids, metas));
   for (auto const& meta : metas) {
     VINEYARD_ASSERT(!meta.MetaData().empty());
   }
@@ -95,7 +95,7 @@ class RPCClient : public ClientBase {
    */
   Status GetMetaData(const std::vector<ObjectID>& id,
                      std::vector<ObjectMeta>& meta_data,
-                     const bool sync_remote = false);
+                     const bool sync_remote = false) override;
 
   /**
    * @brief Get an object from vineyard. The ObjectFactory will be used to
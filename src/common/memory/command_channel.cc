@@ -0,0 +1,222 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/memory/command_channel.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <thread>
+
+namespace vineyard {
+
+namespace detail {
+
+struct alignas(64) ChannelHeader {
+  uint64_t magic;
+  uint64_t capacity;
+};
+
+// "vineyard" in ASCII
+constexpr uint64_t kCommandChannelMagic = 0x64726179656e6976ULL;
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "The futex word must be a plain 32-bit integer");
+
+}  // namespace detail
+
+void MessageRing::Attach(void* control, const size_t capacity,
+                         const bool initialize) {
+  control_ = static_cast<Control*>(control);
+  data_ = static_cast<char*>(control) + sizeof(Control);
+  capacity_ = capacity;
+  if (initialize) {
+    control_->head.store(0);
+    control_->tail.store(0);
+    control_->sequence.store(0);
+    control_->waiting.store(0);
+  }
+}
+
+bool MessageRing::Push(const char* data, const size_t size) {
+  uint64_t head = control_->head.load(std::memory_order_acquire);
+  uint64_t tail = control_->tail.load(std::memory_order_relaxed);
+  if (capacity_ - (tail - head) < sizeof(uint64_t) + size) {
+    return false;
+  }
+  uint64_t length = size;
+  copy_in(tail, reinterpret_cast<const char*>(&length), sizeof(uint64_t));
+  copy_in(tail + sizeof(uint64_t), data, size);
+  control_->tail.store(tail + sizeof(uint64_t) + size,
+                       std::memory_order_release);
+  control_->sequence.fetch_add(1, std::memory_order_seq_cst);
+  return true;
+}
+
+Status MessageRing::Pop(std::string& message, bool& popped) {
+  popped = false;
+  uint64_t tail = control_->tail.load(std::memory_order_acquire);
+  uint64_t head = control_->head.load(std::memory_order_relaxed);
+  if (head == tail) {
+    return Status::OK();
+  }
+  uint64_t length = 0;
+  // the peer may be malicious, don't trust the content of the ring
+  if (tail - head < sizeof(uint64_t) || tail - head > capacity_) {
+    return Status::IOError("The message ring has been corrupted");
+  }
+  copy_out(head, reinterpret_cast<char*>(&length), sizeof(uint64_t));
+  if (length > tail - head - sizeof(uint64_t)) {
+    return Status::IOError("The message ring has been corrupted");
+  }
+  message.resize(length);
+  if (length > 0) {
+    copy_out(head + sizeof(uint64_t), &message[0], length);
+  }
+  control_->head.store(head + sizeof(uint64_t) + length,
+                       std::memory_order_release);
+  popped = true;
+  return Status::OK();
+}
+
+bool MessageRing::Empty() const {
+  return control_->head.load(std::memory_order_acquire) ==
+         control_->tail.load(std::memory_order_acquire);
+}
+
+uint32_t MessageRing::Sequence() const {
+  return control_->sequence.load(std::memory_order_acquire);
+}
+
+bool MessageRing::MarkWaiting() {
+  control_->waiting.store(1, std::memory_order_seq_cst);
+  if (!Empty()) {
+    control_->waiting.store(0, std::memory_order_seq_cst);
+    return false;
+  }
+  return true;
+}
+
+bool MessageRing::ClearWaiting() {
+  return control_->waiting.exchange(0, std::memory_order_seq_cst) == 1;
+}
+
+void MessageRing::Wait(const uint32_t sequence, const int64_t timeout_us) {
+#if defined(__linux__)
+  struct timespec timeout;
+  timeout.tv_sec = timeout_us / 1000000;
+  timeout.tv_nsec = (timeout_us % 1000000) * 1000;
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&control_->sequence),
+          FUTEX_WAIT, sequence, &timeout, nullptr, 0);
+#else
+  // no futex: fallback to a short sleep
+  if (Sequence() == sequence) {
+    std::this_thread::sleep_for(
+        std::chrono::microseconds(std::min<int64_t>(timeout_us, 50)));
+  }
+#endif
+}
+
+void MessageRing::Wake() {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&control_->sequence),
+          FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+void MessageRing::copy_in(uint64_t position, const char* data, size_t size) {
+  size_t offset = position & (capacity_ - 1);
+  size_t first = std::min(size, capacity_ - offset);
+  memcpy(data_ + offset, data, first);
+  if (first < size) {
+    memcpy(data_, data + first, size - first);
+  }
+}
+
+void MessageRing::copy_out(uint64_t position, char* data, size_t size) const {
+  size_t offset = position & (capacity_ - 1);
+  size_t first = std::min(size, capacity_ - offset);
+  memcpy(data, data_ + offset, first);
+  if (first < size) {
+    memcpy(data + first, data_, size - first);
+  }
+}
+
+CommandChannel::CommandChannel(const int fd, void* segment,
+                               const size_t capacity)
+    : fd_(fd), segment_(segment), capacity_(capacity) {}
+
+CommandChannel::~CommandChannel() {
+  if (segment_) {
+    munmap(segment_, SegmentSize(capacity_));
+  }
+  if (fd_ != -1) {
+    close(fd_);
+  }
+}
+
+size_t CommandChannel::SegmentSize(const size_t capacity) {
+  return sizeof(detail::ChannelHeader) + 2 * MessageRing::SegmentSize(capacity);
+}
+
+Status CommandChannel::Map(const int fd, const size_t capacity,
+                           const bool initialize,
+                           std::unique_ptr<CommandChannel>& channel) {
+  if (capacity < 4096 || (capacity & (capacity - 1)) != 0) {
+    close(fd);
+    return Status::Invalid(
+        "The capacity of the command channel should be a power of 2, and "
+        "no less than 4096, but got " +
+        std::to_string(capacity));
+  }
+  size_t segment_size = SegmentSize(capacity);
+  void* segment = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+  if (segment == MAP_FAILED) {
+    int err = errno;
+    close(fd);
+    return Status::IOError("Failed to map the command channel: " +
+                           std::string(strerror(err)));
+  }
+  auto header = static_cast<detail::ChannelHeader*>(segment);
+  if (initialize) {
+    header->magic = detail::kCommandChannelMagic;
+    header->capacity = capacity;
+  } else if (header->magic != detail::kCommandChannelMagic ||
+             header->capacity != capacity) {
+    munmap(segment, segment_size);
+    close(fd);
+    return Status::Invalid("The command channel is malformed");
+  }
+  channel.reset(new CommandChannel(fd, segment, capacity));
+  char* rings = static_cast<char*>(segment) + sizeof(detail::ChannelHeader);
+  channel->requests_.Attach(rings, capacity, initialize);
+  channel->replies_.Attach(rings + MessageRing::SegmentSize(capacity),
+                           capacity, initialize);
+  return Status::OK();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,167 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_MEMORY_COMMAND_CHANNEL_H_
+#define SRC_COMMON_MEMORY_COMMAND_CHANNEL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * Notes [Command Channel]:
+ *
+ * The command channel is an optional transport for IPC requests and replies.
+ * It consists of two single-producer single-consumer rings in a shared memory
+ * segment: the request ring is written by the client and read by the server,
+ * and the reply ring the opposite way. The segment is created by the server
+ * during registration, and its fd follows the register reply.
+ *
+ * The UNIX domain socket is still kept for:
+ *
+ * - passing fds, which are always sent after the reply that refers to them,
+ * - requests and replies that are larger than the capacity of the rings: an
+ *   empty message is pushed into the reply ring to tell the client that the
+ *   reply follows on the socket,
+ * - telling that the peer has gone away.
+ *
+ * The request ring is served by a dedicated thread of the server rather than
+ * the I/O threads, thus polling never occupies the shared `io_context`. The
+ * thread spins on the ring for a while after each request, then marks itself
+ * as waiting and sleeps on the futex in the shared segment, and a client that
+ * observes the waiting mark after pushing a request wakes it up. The client
+ * waits for replies on the reply ring in the same way.
+ */
+
+/**
+ * @brief A single-producer single-consumer ring of length-prefixed messages
+ * in shared memory.
+ */
+class MessageRing {
+ public:
+  struct Control {
+    alignas(64) std::atomic<uint64_t> head;  // written by the consumer
+    alignas(64) std::atomic<uint64_t> tail;  // written by the producer
+    // bumped on every push, used as the futex word
+    alignas(64) std::atomic<uint32_t> sequence;
+    // whether the consumer is waiting for new messages
+    std::atomic<uint32_t> waiting;
+  };
+
+  MessageRing() : control_(nullptr), data_(nullptr), capacity_(0) {}
+
+  void Attach(void* control, const size_t capacity, const bool initialize);
+
+  /**
+   * @brief Push a message, returns false if there's no enough space.
+   */
+  bool Push(const char* data, const size_t size);
+
+  /**
+   * @brief Pop a message, `popped` is false if the ring is empty.
+   */
+  Status Pop(std::string& message, bool& popped);
+
+  bool Empty() const;
+
+  /**
+   * @brief The maximum size of a message that can ever fit into the ring.
+   */
+  size_t MaximumMessageSize() const { return capacity_ - sizeof(uint64_t); }
+
+  uint32_t Sequence() const;
+
+  /**
+   * @brief Mark the consumer as waiting, returns false (and leaves the mark
+   * unset) if there are messages in the ring.
+   */
+  bool MarkWaiting();
+
+  /**
+   * @brief Clear the waiting mark, returns true if the consumer was waiting,
+   * i.e., the producer is responsible for waking it up.
+   */
+  bool ClearWaiting();
+
+  /**
+   * @brief Block until the sequence changes from `sequence`, or timeout.
+   */
+  void Wait(const uint32_t sequence, const int64_t timeout_us);
+
+  void Wake();
+
+  static size_t SegmentSize(const size_t capacity) {
+    return sizeof(Control) + capacity;
+  }
+
+ private:
+  Control* control_;
+  char* data_;
+  size_t capacity_;  // power of 2
+
+  void copy_in(uint64_t position, const char* data, size_t size);
+
+  void copy_out(uint64_t position, char* data, size_t size) const;
+};
+
+/**
+ * @brief CommandChannel is the shared memory segment that holds the request
+ * ring and the reply ring of a connection, see also Notes [Command Channel].
+ */
+class CommandChannel {
+ public:
+  ~CommandChannel();
+
+  /**
+   * @brief The size of the shared memory segment for rings of `capacity`.
+   */
+  static size_t SegmentSize(const size_t capacity);
+
+  /**
+   * @brief Map the shared memory segment, the channel takes the ownership of
+   * the `fd`.
+   *
+   * @param initialize The server initializes the layout of the segment, and
+   *        the client validates it.
+   */
+  static Status Map(const int fd, const size_t capacity, const bool initialize,
+                    std::unique_ptr<CommandChannel>& channel);
+
+  int fd() const { return fd_; }
+
+  size_t capacity() const { return capacity_; }
+
+  MessageRing& requests() { return requests_; }
+
+  MessageRing& replies() { return replies_; }
+
+ private:
+  CommandChannel(const int fd, void* segment, const size_t capacity);
+
+  int fd_;
+  void* segment_;
+  size_t capacity_;
+  MessageRing requests_, replies_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_MEMORY_COMMAND_CHANNEL_H_
@@ -29,6 +29,9 @@
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
 
 #include "common/util/logging.h"
 
@@ -148,3 +151,117 @@ int recv_fd(int conn) {
 
   return found_fd;
 }
+
+int send_fds(int conn, const int* fds, size_t nfds) {
+  char buf[CMSG_SPACE(sizeof(int) * FLING_MAX_FDS)];
+  for (size_t sent = 0; sent < nfds; sent += FLING_MAX_FDS) {
+    size_t count = std::min(nfds - sent, static_cast<size_t>(FLING_MAX_FDS));
+    memset(&buf, 0, sizeof(buf));
+
+    // a single byte of data goes along with the file descriptors
+    struct msghdr msg;
+    struct iovec iov;
+    char data = '\0';
+    iov.iov_base = &data;
+    iov.iov_len = 1;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = buf;
+    msg.msg_controllen =
+        static_cast<socklen_t>(CMSG_SPACE(sizeof(int) * count));
+    msg.msg_name = NULL;
+    msg.msg_namelen = 0;
+    msg.msg_flags = 0;
+
+    struct cmsghdr* header = CMSG_FIRSTHDR(&msg);
+    if (header == nullptr) {
+      LOG(ERROR) << "Error in send_fds: header is NULL";
+      return -1;
+    }
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int) * count);
+    memcpy(CMSG_DATA(header), fds + sent, sizeof(int) * count);
+
+    while (true) {
+      ssize_t r = sendmsg(conn, &msg, 0);
+      if (r < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+          continue;
+        }
+        LOG(ERROR) << "Error in send_fds (errno = " << errno << ": "
+                   << strerror(errno) << ")";
+        return static_cast<int>(r);
+      } else if (r == 0) {
+        LOG(ERROR) << "Encountered unexpected EOF";
+        return -1;
+      }
+      break;
+    }
+  }
+  return static_cast<int>(nfds);
+}
+
+int recv_fds(int conn, int* fds, size_t nfds) {
+  char buf[CMSG_SPACE(sizeof(int) * FLING_MAX_FDS)];
+  size_t received = 0;
+  while (received < nfds) {
+    struct msghdr msg;
+    struct iovec iov;
+    char data = '\0';
+    iov.iov_base = &data;
+    iov.iov_len = 1;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = buf;
+    msg.msg_controllen = static_cast<socklen_t>(sizeof(buf));
+    msg.msg_name = NULL;
+    msg.msg_namelen = 0;
+    msg.msg_flags = 0;
+
+    ssize_t r = recvmsg(conn, &msg, 0);
+    if (r == -1 &&
+        (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      continue;
+    }
+    if (r <= 0) {
+      LOG(ERROR) << "Error in recv_fds (errno = " << errno << ")";
+      break;
+    }
+    bool overflow = false;
+    for (struct cmsghdr* header = CMSG_FIRSTHDR(&msg); header != NULL;
+         header = CMSG_NXTHDR(&msg, header)) {
+      if (header->cmsg_level != SOL_SOCKET ||
+          header->cmsg_type != SCM_RIGHTS) {
+        continue;
+      }
+      size_t count =
+          (header->cmsg_len -
+           (CMSG_DATA(header) - reinterpret_cast<unsigned char*>(header))) /
+          sizeof(int);
+      for (size_t i = 0; i < count; ++i) {
+        int fd = (reinterpret_cast<int*>(CMSG_DATA(header)))[i];
+        if (received < nfds) {
+          fds[received++] = fd;
+        } else {
+          close(fd);
+          overflow = true;
+        }
+      }
+    }
+    if (overflow || (msg.msg_flags & MSG_CTRUNC)) {
+      // The sender sent us more file descriptors than expected, or some of
+      // them have been discarded by the kernel.
+      errno = EBADMSG;
+      LOG(ERROR) << "Error in recv_fds: unexpected file descriptors received";
+      break;
+    }
+  }
+  if (received < nfds) {
+    for (size_t i = 0; i < received; ++i) {
+      close(fds[i]);
+    }
+    return -1;
+  }
+  return static_cast<int>(nfds);
+}
@@ -62,4 +62,26 @@ int send_fd(int conn, int fd);
 // @return File descriptor or a value < 0 on failure.
 int recv_fd(int conn);
 
+// The maximum number of file descriptors in a single message, i.e., the
+// SCM_MAX_FD of Linux.
+#define FLING_MAX_FDS 253
+
+// Send a set of file descriptors over a unix domain socket, in as few
+// messages as possible (at most FLING_MAX_FDS file descriptors per message).
+//
+// @param conn Unix domain socket to send the file descriptors over.
+// @param fds File descriptors to send over.
+// @param nfds The number of file descriptors.
+// @return Status code which is < 0 on failure.
+int send_fds(int conn, const int* fds, size_t nfds);
+
+// Receive a set of file descriptors that are sent by send_fds.
+//
+// @param conn Unix domain socket to receive the file descriptors from.
+// @param fds The received file descriptors, in the order of being sent.
+// @param nfds The number of file descriptors to receive.
+// @return Status code which is < 0 on failure, in which case the received
+//         file descriptors have been closed.
+int recv_fds(int conn, int* fds, size_t nfds);
+
 #endif  // SRC_COMMON_MEMORY_FLING_H_
@@ -13,7 +13,10 @@ limitations under the License.
 #if defined(WITH_JEMALLOC)
 
 #include <algorithm>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #define JEMALLOC_NO_DEMANGLE
 #include "jemalloc/include/jemalloc/jemalloc.h"
@@ -29,6 +32,9 @@ namespace vineyard {
 namespace memory {
 
 Jemalloc::arena_t Jemalloc::arenas_[Jemalloc::MAXIMUM_ARENAS];
+unsigned Jemalloc::regions_[Jemalloc::MAXIMUM_ARENAS];
+std::mutex Jemalloc::arenas_mutex_;
+std::atomic<uint64_t> Jemalloc::generations_{0};
 
 Jemalloc::Jemalloc() {
   extent_hooks_ = static_cast<extent_hooks_t*>(malloc(sizeof(extent_hooks_t)));
@@ -40,7 +46,10 @@ Jemalloc::~Jemalloc() {
   }
 }
 
-void* Jemalloc::Init(void* space, const size_t size) {
+void* Jemalloc::Init(void* space, const size_t size,
+                     const size_t max_arenas) {
+  Reset();
+  std::unique_lock<std::mutex> guard(arenas_mutex_);
   // obtain the current arena numbers
   unsigned narenas = -1;
   size_t size_of_narenas = sizeof(unsigned);
@@ -67,53 +76,158 @@ void* Jemalloc::Init(void* space, const size_t size) {
   *extent_hooks_ = je_ehooks_default_extent_hooks;
   extent_hooks_->alloc = &theAllocHook;
 
+  if (!createArena(arena_index_, arena_index_)) {
+    return nullptr;
+  }
+  LOG(INFO) << "arena index = " << arena_index_;
+
+  flags_ = MALLOCX_ARENA(arena_index_) | MALLOCX_TCACHE_NONE;
+  guard.unlock();
+
+  // see also: Notes [Thread Arenas of Jemalloc]
+  size_t budget = (MAXIMUM_ARENAS - narenas) / kArenaBudgetRatio;
+  {
+    std::lock_guard<std::mutex> thread_guard(thread_arenas_mutex_);
+    thread_arenas_.assign(1, arena_index_);
+    threads_ = 0;
+    max_arenas_.store(
+        std::max(std::min(max_arenas, budget), static_cast<size_t>(1)),
+        std::memory_order_release);
+    generation_.store(++generations_, std::memory_order_release);
+    ready_.store(true, std::memory_order_release);
+  }
+  return space;
+}
+
+void Jemalloc::Reset() {
+  std::lock_guard<std::mutex> thread_guard(thread_arenas_mutex_);
+  ready_.store(false, std::memory_order_release);
+  // threads re-assign their arenas after the next `Init()`
+  generation_.store(++generations_, std::memory_order_release);
+  thread_arenas_.clear();
+  max_arenas_.store(1, std::memory_order_release);
+}
+
+bool Jemalloc::createArena(const unsigned region, unsigned& arena_index) {
+  unsigned narenas = -1;
+  size_t size_of_narenas = sizeof(unsigned);
+  if (auto ret = vineyard_je_mallctl("arenas.narenas", &narenas,
+                                     &size_of_narenas, nullptr, 0)) {
+    int err = std::exchange(errno, ret);
+    PLOG(ERROR) << "Failed to get narenas";
+    errno = err;
+    return false;
+  }
+  if (narenas >= MAXIMUM_ARENAS) {
+    LOG(ERROR) << "There can be " << MAXIMUM_ARENAS << " arenas at most";
+    return false;
+  }
+  // the extent hook may be invoked during creating the arena
+  regions_[narenas] = region;
+
   // create arenas
-  size_t arena_index_size = sizeof(arena_index_);
+  size_t arena_index_size = sizeof(arena_index);
   if (auto ret =
-          vineyard_je_mallctl("arenas.create", &arena_index_, &arena_index_size,
+          vineyard_je_mallctl("arenas.create", &arena_index, &arena_index_size,
                               &extent_hooks_, sizeof(extent_hooks_))) {
     int err = std::exchange(errno, ret);
     PLOG(ERROR) << "Failed to create arena";
     errno = err;
-    return nullptr;
+    return false;
+  }
+  if (arena_index != narenas) {
+    LOG(ERROR) << "Unexpected arena index " << arena_index << ", expects "
+               << narenas;
+    return false;
   }
-  LOG(INFO) << "arena index = " << arena_index_;
 
   // set muzzy decay time to -1 to prevent jemalloc freeing the memory to the
   // pool, but leave dirty decay time untouched to still give the memory back
   // to the os kernel.
   // ssize_t decay_ms = 1;
   // std::string dirty_decay_key =
-  //     "arena." + std::to_string(arena_index_) + ".dirty_decay_ms";
+  //     "arena." + std::to_string(arena_index) + ".dirty_decay_ms";
   // if (auto ret = vineyard_je_mallctl(dirty_decay_key.c_str(), nullptr,
   // nullptr,
   //                           &decay_ms, sizeof(decay_ms))) {
   //   int err = std::exchange(errno, ret);
   //   PLOG(ERROR) << "Failed to set the dirty decay time";
   //   errno = err;
-  //   return nullptr;
+  //   return false;
   // }
   ssize_t decay_ms = -1;
   std::string muzzy_decay_key =
-      "arena." + std::to_string(arena_index_) + ".muzzy_decay_ms";
+      "arena." + std::to_string(arena_index) + ".muzzy_decay_ms";
   if (auto ret = vineyard_je_mallctl(muzzy_decay_key.c_str(), nullptr, nullptr,
                                      &decay_ms, sizeof(decay_ms))) {
     int err = std::exchange(errno, ret);
     PLOG(ERROR) << "Failed to set the muzzy decay time";
     errno = err;
-    return nullptr;
+    return false;
   }
+  return true;
+}
 
-  flags_ = MALLOCX_ARENA(arena_index_) | MALLOCX_TCACHE_NONE;
-  return space;
+int Jemalloc::threadFlags() {
+  // read once, as the allocator may be re-initialized concurrently
+  const uint64_t generation = generation_.load(std::memory_order_acquire);
+  if (max_arenas_.load(std::memory_order_acquire) <= 1) {
+    return flags_;
+  }
+  // (generation, flags), stale entries are left by re-initialized allocators
+  static thread_local std::vector<std::pair<uint64_t, int>> thread_flags;
+  for (auto const& item : thread_flags) {
+    if (item.first == generation) {
+      return item.second;
+    }
+  }
+
+  int flags = flags_;
+  {
+    std::lock_guard<std::mutex> guard(thread_arenas_mutex_);
+    if (generation_.load(std::memory_order_relaxed) != generation) {
+      // re-initialized meanwhile, the arena is assigned by the next call
+      return flags;
+    }
+    size_t slot = threads_++ % max_arenas_.load(std::memory_order_relaxed);
+    if (slot < thread_arenas_.size()) {
+      flags = MALLOCX_ARENA(thread_arenas_[slot]) | MALLOCX_TCACHE_NONE;
+    } else {
+      std::lock_guard<std::mutex> arenas_guard(arenas_mutex_);
+      unsigned arena_index = 0;
+      if (createArena(regions_[arena_index_], arena_index)) {
+        thread_arenas_.emplace_back(arena_index);
+        flags = MALLOCX_ARENA(arena_index) | MALLOCX_TCACHE_NONE;
+      }
+      // otherwise the thread shares the first arena
+    }
+  }
+  if (thread_flags.size() >= 16) {
+    thread_flags.erase(thread_flags.begin());
+  }
+  thread_flags.emplace_back(generation, flags);
+  return flags;
 }
 
 void* Jemalloc::Allocate(const size_t bytes, const size_t alignment) {
-  return vineyard_je_mallocx(std::max(bytes, alignment), flags_);
+  if (!ready_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return vineyard_je_mallocx(std::max(bytes, alignment), threadFlags());
 }
 
 void* Jemalloc::Reallocate(void* pointer, size_t size) {
-  return vineyard_je_rallocx(pointer, size, flags_);
+  if (!ready_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return vineyard_je_rallocx(pointer, size, threadFlags());
+}
+
+size_t Jemalloc::ReallocateInPlace(void* pointer, size_t size) {
+  if (!ready_.load(std::memory_order_acquire)) {
+    return GetAllocatedSize(pointer);
+  }
+  return vineyard_je_xallocx(pointer, size, 0, flags_);
 }
 
 void Jemalloc::Free(void* pointer, size_t) {
@@ -123,12 +237,15 @@ void Jemalloc::Free(void* pointer, size_t) {
 }
 
 void Jemalloc::Recycle(const bool /* unused currently */) {
-  std::string decay_key = "arena." + std::to_string(arena_index_) + ".decay";
-  if (auto ret = vineyard_je_mallctl(decay_key.c_str(), nullptr, nullptr,
-                                     nullptr, 0)) {
-    int err = std::exchange(errno, ret);
-    PLOG(ERROR) << "Failed to recycle arena " << arena_index_;
-    errno = err;
+  std::lock_guard<std::mutex> guard(thread_arenas_mutex_);
+  for (unsigned arena_index : thread_arenas_) {
+    std::string decay_key = "arena." + std::to_string(arena_index) + ".decay";
+    if (auto ret = vineyard_je_mallctl(decay_key.c_str(), nullptr, nullptr,
+                                       nullptr, 0)) {
+      int err = std::exchange(errno, ret);
+      PLOG(ERROR) << "Failed to recycle arena " << arena_index;
+      errno = err;
+    }
   }
 }
 
@@ -141,26 +258,34 @@ size_t Jemalloc::EstimateAllocatedSize(const size_t size) {
 }
 
 void Jemalloc::Traverse() {
-  std::string traverse_key =
-      "arena." + std::to_string(arena_index_) + ".traverse";
-  if (auto ret = vineyard_je_mallctl(traverse_key.c_str(), nullptr, nullptr,
-                                     nullptr, 0)) {
-    int err = std::exchange(errno, ret);
-    PLOG(ERROR) << "Failed to traverse arena";
-    errno = err;
+  std::lock_guard<std::mutex> guard(thread_arenas_mutex_);
+  for (unsigned arena_index : thread_arenas_) {
+    std::string traverse_key =
+        "arena." + std::to_string(arena_index) + ".traverse";
+    if (auto ret = vineyard_je_mallctl(traverse_key.c_str(), nullptr, nullptr,
+                                       nullptr, 0)) {
+      int err = std::exchange(errno, ret);
+      PLOG(ERROR) << "Failed to traverse arena";
+      errno = err;
+    }
   }
 }
 
 void* Jemalloc::theAllocHook(extent_hooks_t* extent_hooks, void* new_addr,
                              size_t size, size_t alignment, bool* zero,
                              bool* commit, unsigned arena_index) {
-  // align
-  arena_t& arena = arenas_[arena_index];
-  uintptr_t ret = (arena.pre_alloc_ + alignment - 1) & ~(alignment - 1);
-  if (ret + size > arena.base_end_pointer_) {
-    return nullptr;
-  }
-  arena.pre_alloc_ = ret + size;
+  // the space may be shared by the arenas of many threads, see also
+  // Notes [Thread Arenas of Jemalloc]
+  arena_t& arena = arenas_[regions_[arena_index]];
+  uintptr_t pre_alloc = arena.pre_alloc_.load(std::memory_order_relaxed);
+  uintptr_t ret;
+  do {
+    // align
+    ret = (pre_alloc + alignment - 1) & ~(alignment - 1);
+    if (ret + size > arena.base_end_pointer_) {
+      return nullptr;
+    }
+  } while (!arena.pre_alloc_.compare_exchange_weak(pre_alloc, ret + size));
   // N.B. the shared memory is not pre-committed.
   *commit = false;
   return reinterpret_cast<void*>(ret);
@@ -18,6 +18,11 @@ limitations under the License.
 
 #if defined(WITH_JEMALLOC)
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
 #include "server/memory/malloc.h"
 
 // forward declarations, to avoid include jemalloc/jemalloc.h.
@@ -28,17 +33,63 @@ namespace vineyard {
 
 namespace memory {
 
+/**
+ * Notes [Thread Arenas of Jemalloc]:
+ *
+ * A jemalloc arena serializes the allocations on it, and a single arena over
+ * the shared memory becomes the bottleneck when many threads of a client
+ * allocate concurrently.
+ *
+ * With `max_arenas > 1`, every thread that allocates is assigned an arena of
+ * its own when it allocates for the first time, until there are `max_arenas`
+ * arenas, and then the threads share arenas in a round-robin manner. All
+ * these arenas draw extents from the same space, by bumping a shared pointer
+ * atomically in the extent hook, thus
+ *
+ * - threads don't contend with each other on the arena locks, and a thread
+ *   that never allocates doesn't cost an arena;
+ * - pointers can be freed, resized and frozen from any thread, as jemalloc
+ *   finds the owner arena of an allocation itself;
+ * - the space is not partitioned between threads in advance, but memory
+ *   freed to one arena can only be reused by the threads of that arena.
+ *
+ * Arenas are never destroyed, re-initializing the allocator (e.g., renewing
+ * the client side allocator) allocates new arenas as well, and `Init()` must
+ * not run concurrently with allocations. As there are at most
+ * `MAXIMUM_ARENAS` arenas in the process, an `Init()` takes no more than
+ * 1/`kArenaBudgetRatio` of the arenas that are left, thus frequent renewals
+ * end up with fewer arenas per thread rather than running out of arenas
+ * quickly. Once `Init()` fails or `Reset()` is called, allocations fail
+ * rather than drawing from the previous space, which may have been released.
+ */
 class Jemalloc {
  public:
   Jemalloc();
   ~Jemalloc();
 
-  void* Init(void* space, const size_t size);
+  /**
+   * @brief Initialize the arenas over the given space, the allocations of
+   * different threads are spread over at most `max_arenas` arenas, see also
+   * Notes [Thread Arenas of Jemalloc].
+   */
+  void* Init(void* space, const size_t size, const size_t max_arenas = 1);
+
+  /**
+   * @brief Stop allocating from the current space (e.g., before the space is
+   * released), allocations fail until the next successful `Init()`.
+   */
+  void Reset();
 
   void* Allocate(const size_t bytes, const size_t alignment = Alignment);
 
   void* Reallocate(void* pointer, size_t size);
 
+  /**
+   * @brief Resize the allocation without moving it, returns the real size of
+   * the allocation after resizing.
+   */
+  size_t ReallocateInPlace(void* pointer, size_t size);
+
   void Free(void* pointer, size_t = 0);
 
   void Recycle(const bool force = false);
@@ -54,14 +105,33 @@ class Jemalloc {
   struct arena_t {
     uintptr_t base_pointer_ = reinterpret_cast<uintptr_t>(nullptr);
     uintptr_t base_end_pointer_ = reinterpret_cast<uintptr_t>(nullptr);
-    uintptr_t pre_alloc_ = reinterpret_cast<uintptr_t>(nullptr);
+    std::atomic<uintptr_t> pre_alloc_{reinterpret_cast<uintptr_t>(nullptr)};
   };
 
  private:
+  // the flags of the arena for the calling thread
+  int threadFlags();
+
+  // n.b.: the caller holds `arenas_mutex_`.
+  bool createArena(const unsigned region, unsigned& arena_index);
+
   unsigned arena_index_;
   int flags_ = 0;
+  // whether the arenas are backed by a space that is still owned
+  //
+  // `ready_`, `max_arenas_` and `generation_` are read without locks by the
+  // allocating threads, and are written (with release ordering) while
+  // holding `thread_arenas_mutex_`.
+  std::atomic<bool> ready_{false};
   extent_hooks_t* extent_hooks_ = nullptr;
 
+  std::atomic<size_t> max_arenas_{1};
+  // identifies the arenas of an `Init()`, unique among all instances
+  std::atomic<uint64_t> generation_{0};
+  std::mutex thread_arenas_mutex_;
+  std::vector<unsigned> thread_arenas_;
+  size_t threads_ = 0;
+
   static void* theAllocHook(extent_hooks_t* extent_hooks, void* new_addr,
                             size_t size, size_t alignment, bool* zero,
                             bool* commit, unsigned arena_index);
@@ -69,8 +139,14 @@ class Jemalloc {
   // maximum supported arenas, a global static array is used to record status
   // of memory allocation for each arenas for being used in the c-style
   // callback.
-  static constexpr size_t MAXIMUM_ARENAS = 128;
+  static constexpr size_t MAXIMUM_ARENAS = 1024;
+  // see also: Notes [Thread Arenas of Jemalloc]
+  static constexpr size_t kArenaBudgetRatio = 8;
   static arena_t arenas_[MAXIMUM_ARENAS];
+  // the arena in `arenas_` whose space is shared by each arena
+  static unsigned regions_[MAXIMUM_ARENAS];
+  static std::mutex arenas_mutex_;
+  static std::atomic<uint64_t> generations_;
 };
 
 }  // namespace memory
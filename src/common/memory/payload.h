@@ -32,6 +32,11 @@ struct Payload {
   int64_t map_size;
   uint8_t* pointer;
 
+  // the following fields are only used by the bulk store in vineyardd, and
+  // won't be serialized to clients.
+  bool is_spilled;
+  int64_t ref_cnt;
+
   Payload()
       : object_id(EmptyBlobID()),
         store_fd(-1),
@@ -39,7 +44,9 @@ struct Payload {
         data_offset(0),
         data_size(0),
         map_size(0),
-        pointer(nullptr) {}
+        pointer(nullptr),
+        is_spilled(false),
+        ref_cnt(0) {}
 
   Payload(ObjectID object_id, int64_t size, uint8_t* ptr, int fd, int64_t msize,
           ptrdiff_t offset)
@@ -49,7 +56,9 @@ struct Payload {
         data_offset(offset),
         data_size(size),
         map_size(msize),
-        pointer(ptr) {}
+        pointer(ptr),
+        is_spilled(false),
+        ref_cnt(0) {}
 
   Payload(ObjectID object_id, int64_t size, uint8_t* ptr, int fd, int arena_fd,
           int64_t msize, ptrdiff_t offset)
@@ -59,7 +68,9 @@ struct Payload {
         data_offset(offset),
         data_size(size),
         map_size(msize),
-        pointer(ptr) {}
+        pointer(ptr),
+        is_spilled(false),
+        ref_cnt(0) {}
 
   static std::shared_ptr<Payload> MakeEmpty() {
     static std::shared_ptr<Payload> payload = std::make_shared<Payload>();
@@ -72,6 +72,10 @@ CommandType ParseCommandType(const std::string& str_type) {
     return CommandType::GetNextStreamChunkRequest;
   } else if (str_type == "pull_next_stream_chunk_request") {
     return CommandType::PullNextStreamChunkRequest;
+  } else if (str_type == "get_next_stream_chunks_request") {
+    return CommandType::GetNextStreamChunksRequest;
+  } else if (str_type == "pull_next_stream_chunks_request") {
+    return CommandType::PullNextStreamChunksRequest;
   } else if (str_type == "stop_stream_request") {
     return CommandType::StopStreamRequest;
   } else if (str_type == "put_name_request") {
@@ -98,10 +102,16 @@ CommandType ParseCommandType(const std::string& str_type) {
     return CommandType::GetRemoteBuffersRequest;
   } else if (str_type == "drop_buffer_request") {
     return CommandType::DropBufferRequest;
+  } else if (str_type == "release_buffers_request") {
+    return CommandType::ReleaseBuffersRequest;
+  } else if (str_type == "create_buffers_request") {
+    return CommandType::CreateBuffersRequest;
   } else if (str_type == "make_arena_request") {
     return CommandType::MakeArenaRequest;
   } else if (str_type == "finalize_arena_request") {
     return CommandType::FinalizeArenaRequest;
+  } else if (str_type == "get_deleted_objects_request") {
+    return CommandType::GetDeletedObjectsRequest;
   } else if (str_type == "debug_command") {
     return CommandType::DebugCommand;
   } else {
@@ -113,42 +123,213 @@ static inline void encode_msg(const json& root, std::string& msg) {
   msg = json_to_string(root);
 }
 
+bool IsBinaryMessage(const std::string& msg) {
+  return msg.size() >= 2 && msg[0] == kBinaryMessageMagic;
+}
+
+BinaryEncoder::BinaryEncoder(std::string& buffer, const CommandType type)
+    : buffer_(buffer) {
+  buffer_.clear();
+  buffer_.push_back(kBinaryMessageMagic);
+  buffer_.push_back(static_cast<char>(type));
+}
+
+void BinaryEncoder::Put(const std::string& value) {
+  Put<uint64_t>(value.size());
+  buffer_.append(value);
+}
+
+void BinaryEncoder::Put(const json& tree) {
+  std::vector<uint8_t> content = json::to_msgpack(tree);
+  Put<uint64_t>(content.size());
+  buffer_.append(reinterpret_cast<const char*>(content.data()),
+                 content.size());
+}
+
+void BinaryEncoder::Put(const Payload& payload) {
+  Put<ObjectID>(payload.object_id);
+  Put<int32_t>(payload.store_fd);
+  Put<int64_t>(payload.data_offset);
+  Put<int64_t>(payload.data_size);
+  Put<int64_t>(payload.map_size);
+}
+
+BinaryDecoder::BinaryDecoder(const std::string& buffer)
+    : data_(buffer.data()),
+      size_(buffer.size()),
+      offset_(2),
+      type_(CommandType::NullCommand) {
+  if (IsBinaryMessage(buffer)) {
+    type_ = static_cast<CommandType>(static_cast<int8_t>(buffer[1]));
+  } else {
+    offset_ = size_;
+  }
+}
+
+Status BinaryDecoder::Get(std::string& value) {
+  uint64_t length = 0;
+  RETURN_ON_ERROR(Get<uint64_t>(length));
+  if (length > size_ - offset_) {
+    return Status::Invalid("Malformed binary message: unexpected end");
+  }
+  value.assign(data_ + offset_, length);
+  offset_ += length;
+  return Status::OK();
+}
+
+Status BinaryDecoder::Get(json& tree) {
+  uint64_t length = 0;
+  RETURN_ON_ERROR(Get<uint64_t>(length));
+  if (length > size_ - offset_) {
+    return Status::Invalid("Malformed binary message: unexpected end");
+  }
+  const uint8_t* begin = reinterpret_cast<const uint8_t*>(data_ + offset_);
+  try {
+    tree = json::from_msgpack(begin, begin + length);
+  } catch (json::exception const& err) {
+    return Status::Invalid("Malformed binary message: " +
+                           std::string(err.what()));
+  }
+  offset_ += length;
+  return Status::OK();
+}
+
+Status BinaryDecoder::Get(Payload& payload) {
+  int32_t store_fd = -1;
+  RETURN_ON_ERROR(Get<ObjectID>(payload.object_id));
+  RETURN_ON_ERROR(Get<int32_t>(store_fd));
+  RETURN_ON_ERROR(Get<int64_t>(payload.data_offset));
+  RETURN_ON_ERROR(Get<int64_t>(payload.data_size));
+  RETURN_ON_ERROR(Get<int64_t>(payload.map_size));
+  payload.store_fd = store_fd;
+  payload.pointer = nullptr;
+  return Status::OK();
+}
+
+Status BinaryDecoder::GetCount(uint64_t& num, const size_t element_size) {
+  RETURN_ON_ERROR(Get<uint64_t>(num));
+  if (num > (size_ - offset_) / element_size) {
+    return Status::Invalid(
+        "Malformed binary message: too many elements: " +
+        std::to_string(num));
+  }
+  return Status::OK();
+}
+
+constexpr size_t BinaryDecoder::kPayloadSize;
+
+#define CHECK_BINARY_TYPE(decoder, type)                           \
+  RETURN_ON_ASSERT((decoder).Type() == (type),                     \
+                   "Unexpected command type in binary message: " + \
+                       std::to_string(static_cast<int>((decoder).Type())))
+
+// the store fds that are sent after a reply, see also
+// Notes [Creating Buffers in Bulk] in "protocols.h".
+static inline Status readFdsBinary(BinaryDecoder& decoder,
+                                   std::vector<int>& fds) {
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.GetCount(num, sizeof(int32_t)));
+  fds.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    int32_t fd = -1;
+    RETURN_ON_ERROR(decoder.Get<int32_t>(fd));
+    fds[i] = fd;
+  }
+  return Status::OK();
+}
+
 void WriteErrorReply(Status const& status, std::string& msg) {
   encode_msg(status.ToJSON(), msg);
 }
 
 void WriteRegisterRequest(std::string& msg) {
+  WriteRegisterRequest(false, false, msg);
+}
+
+void WriteRegisterRequest(const bool binary_protocol, std::string& msg) {
+  WriteRegisterRequest(binary_protocol, false, msg);
+}
+
+void WriteRegisterRequest(const bool binary_protocol, const bool shared_pool,
+                          std::string& msg) {
+  WriteRegisterRequest(binary_protocol, shared_pool, false, msg);
+}
+
+void WriteRegisterRequest(const bool binary_protocol, const bool shared_pool,
+                          const bool command_channel, std::string& msg) {
   json root;
   root["type"] = "register_request";
   root["version"] = vineyard_version();
+  root["binary_protocol"] = binary_protocol;
+  root["shared_pool"] = shared_pool;
+  root["command_channel"] = command_channel;
 
   encode_msg(root, msg);
 }
 
-Status ReadRegisterRequest(const json& root, std::string& version) {
+Status ReadRegisterRequest(const json& root, std::string& version,
+                           bool& binary_protocol, bool& shared_pool,
+                           bool& command_channel) {
   RETURN_ON_ASSERT(root["type"] == "register_request");
 
   // When the "version" field is missing from the client, we treat it
   // as default unknown version number: 0.0.0.
   version = root.value<std::string>("version", "0.0.0");
+  binary_protocol = root.value("binary_protocol", false);
+  shared_pool = root.value("shared_pool", false);
+  command_channel = root.value("command_channel", false);
   return Status::OK();
 }
 
 void WriteRegisterReply(const std::string& ipc_socket,
                         const std::string& rpc_endpoint,
-                        const InstanceID instance_id, std::string& msg) {
+                        const InstanceID instance_id,
+                        const bool binary_protocol, const int shared_pool_fd,
+                        const int64_t shared_pool_size,
+                        const size_t command_channel_capacity,
+                        std::string& msg) {
   json root;
   root["type"] = "register_reply";
   root["ipc_socket"] = ipc_socket;
   root["rpc_endpoint"] = rpc_endpoint;
   root["instance_id"] = instance_id;
   root["version"] = vineyard_version();
+  root["binary_protocol"] = binary_protocol;
+  if (shared_pool_fd != -1) {
+    root["shared_pool_fd"] = shared_pool_fd;
+    root["shared_pool_size"] = shared_pool_size;
+  }
+  if (command_channel_capacity != 0) {
+    root["command_channel_capacity"] = command_channel_capacity;
+  }
   encode_msg(root, msg);
 }
 
 Status ReadRegisterReply(const json& root, std::string& ipc_socket,
                          std::string& rpc_endpoint, InstanceID& instance_id,
-                         std::string& version) {
+                         std::string& version, bool& binary_protocol) {
+  int shared_pool_fd = -1;
+  int64_t shared_pool_size = 0;
+  return ReadRegisterReply(root, ipc_socket, rpc_endpoint, instance_id,
+                           version, binary_protocol, shared_pool_fd,
+                           shared_pool_size);
+}
+
+Status ReadRegisterReply(const json& root, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, bool& binary_protocol,
+                         int& shared_pool_fd, int64_t& shared_pool_size) {
+  size_t command_channel_capacity = 0;
+  return ReadRegisterReply(root, ipc_socket, rpc_endpoint, instance_id,
+                           version, binary_protocol, shared_pool_fd,
+                           shared_pool_size, command_channel_capacity);
+}
+
+Status ReadRegisterReply(const json& root, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, bool& binary_protocol,
+                         int& shared_pool_fd, int64_t& shared_pool_size,
+                         size_t& command_channel_capacity) {
   CHECK_IPC_ERROR(root, "register_reply");
   ipc_socket = root["ipc_socket"].get_ref<std::string const&>();
   rpc_endpoint = root["rpc_endpoint"].get_ref<std::string const&>();
@@ -157,6 +338,12 @@ Status ReadRegisterReply(const json& root, std::string& ipc_socket,
   // When the "version" field is missing from the server, we treat it
   // as default unknown version number: 0.0.0.
   version = root.value<std::string>("version", "0.0.0");
+  // Servers that don't know the binary protocol will always reply JSON.
+  binary_protocol = root.value("binary_protocol", false);
+  shared_pool_fd = root.value("shared_pool_fd", -1);
+  shared_pool_size = root.value("shared_pool_size", static_cast<int64_t>(0));
+  command_channel_capacity =
+      root.value("command_channel_capacity", static_cast<size_t>(0));
   return Status::OK();
 }
 
@@ -283,6 +470,56 @@ Status ReadCreateBufferReply(const json& root, ObjectID& id, Payload& object) {
   return Status::OK();
 }
 
+void WriteCreateBuffersRequest(const std::vector<size_t>& sizes,
+                               std::string& msg) {
+  json root;
+  root["type"] = "create_buffers_request";
+  root["sizes"] = sizes;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBuffersRequest(const json& root, std::vector<size_t>& sizes) {
+  RETURN_ON_ASSERT(root["type"] == "create_buffers_request");
+  root["sizes"].get_to(sizes);
+  return Status::OK();
+}
+
+void WriteCreateBuffersReply(
+    const std::vector<ObjectID>& ids,
+    const std::vector<std::shared_ptr<Payload>>& objects,
+    const std::vector<int>& fds, std::string& msg) {
+  json root;
+  root["type"] = "create_buffers_reply";
+  root["ids"] = ids;
+  json created = json::array();
+  for (auto const& object : objects) {
+    json tree;
+    object->ToJSON(tree);
+    created.push_back(tree);
+  }
+  root["created"] = created;
+  root["fds"] = fds;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBuffersReply(const json& root, std::vector<ObjectID>& ids,
+                              std::vector<Payload>& objects,
+                              std::vector<int>& fds) {
+  CHECK_IPC_ERROR(root, "create_buffers_reply");
+  root["ids"].get_to(ids);
+  for (auto const& tree : root["created"]) {
+    Payload object;
+    object.FromJSON(tree);
+    objects.emplace_back(object);
+  }
+  root["fds"].get_to(fds);
+  RETURN_ON_ASSERT(ids.size() == objects.size(),
+                   "Malformed create_buffers_reply");
+  return Status::OK();
+}
+
 void WriteCreateRemoteBufferRequest(const size_t size, std::string& msg) {
   json root;
   root["type"] = "create_remote_buffer_request";
@@ -392,6 +629,34 @@ Status ReadDropBufferReply(const json& root) {
   return Status::OK();
 }
 
+void WriteReleaseBuffersRequest(const std::set<ObjectID>& ids,
+                                std::string& msg) {
+  json root;
+  root["type"] = "release_buffers_request";
+  root["ids"] = std::vector<ObjectID>(ids.begin(), ids.end());
+
+  encode_msg(root, msg);
+}
+
+Status ReadReleaseBuffersRequest(const json& root,
+                                 std::vector<ObjectID>& ids) {
+  RETURN_ON_ASSERT(root["type"] == "release_buffers_request");
+  root["ids"].get_to(ids);
+  return Status::OK();
+}
+
+void WriteReleaseBuffersReply(std::string& msg) {
+  json root;
+  root["type"] = "release_buffers_reply";
+
+  encode_msg(root, msg);
+}
+
+Status ReadReleaseBuffersReply(const json& root) {
+  CHECK_IPC_ERROR(root, "release_buffers_reply");
+  return Status::OK();
+}
+
 void WriteCreateDataRequest(const json& content, std::string& msg) {
   json root;
   root["type"] = "create_data_request";
@@ -607,6 +872,41 @@ Status ReadInstanceStatusReply(const json& root, json& meta) {
   return Status::OK();
 }
 
+void WriteGetDeletedObjectsRequest(const uint64_t since, std::string& msg) {
+  json root;
+  root["type"] = "get_deleted_objects_request";
+  root["since"] = since;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetDeletedObjectsRequest(const json& root, uint64_t& since) {
+  RETURN_ON_ASSERT(root["type"] == "get_deleted_objects_request");
+  since = root["since"].get<uint64_t>();
+  return Status::OK();
+}
+
+void WriteGetDeletedObjectsReply(const uint64_t sequence,
+                                 const std::vector<ObjectID>& ids,
+                                 const bool overflow, std::string& msg) {
+  json root;
+  root["type"] = "get_deleted_objects_reply";
+  root["sequence"] = sequence;
+  root["ids"] = ids;
+  root["overflow"] = overflow;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetDeletedObjectsReply(const json& root, uint64_t& sequence,
+                                  std::vector<ObjectID>& ids, bool& overflow) {
+  CHECK_IPC_ERROR(root, "get_deleted_objects_reply");
+  sequence = root["sequence"].get<uint64_t>();
+  ids = root["ids"].get_to(ids);
+  overflow = root.value("overflow", false);
+  return Status::OK();
+}
+
 void WritePutNameRequest(const ObjectID object_id, const std::string& name,
                          std::string& msg) {
   json root;
@@ -859,6 +1159,99 @@ Status ReadPullNextStreamChunkReply(const json& root, Payload& object) {
   return Status::OK();
 }
 
+void WriteGetNextStreamChunksRequest(const ObjectID stream_id,
+                                     const size_t size, const size_t count,
+                                     std::vector<size_t> const& used,
+                                     std::string& msg) {
+  json root;
+  root["type"] = "get_next_stream_chunks_request";
+  root["id"] = stream_id;
+  root["size"] = size;
+  root["count"] = count;
+  root["used"] = used;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetNextStreamChunksRequest(const json& root, ObjectID& stream_id,
+                                      size_t& size, size_t& count,
+                                      std::vector<size_t>& used) {
+  RETURN_ON_ASSERT(root["type"] == "get_next_stream_chunks_request");
+  stream_id = root["id"].get<ObjectID>();
+  size = root["size"].get<size_t>();
+  count = root["count"].get<size_t>();
+  used = root.value("used", std::vector<size_t>{});
+  return Status::OK();
+}
+
+void WriteGetNextStreamChunksReply(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg) {
+  json root;
+  root["type"] = "get_next_stream_chunks_reply";
+  for (size_t i = 0; i < objects.size(); ++i) {
+    json tree;
+    objects[i]->ToJSON(tree);
+    root[std::to_string(i)] = tree;
+  }
+  root["num"] = objects.size();
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetNextStreamChunksReply(const json& root,
+                                    std::vector<Payload>& objects) {
+  CHECK_IPC_ERROR(root, "get_next_stream_chunks_reply");
+  for (size_t i = 0; i < root["num"]; ++i) {
+    Payload object;
+    object.FromJSON(root[std::to_string(i)]);
+    objects.emplace_back(object);
+  }
+  return Status::OK();
+}
+
+void WritePullNextStreamChunksRequest(const ObjectID stream_id,
+                                      const size_t count, std::string& msg) {
+  json root;
+  root["type"] = "pull_next_stream_chunks_request";
+  root["id"] = stream_id;
+  root["count"] = count;
+
+  encode_msg(root, msg);
+}
+
+Status ReadPullNextStreamChunksRequest(const json& root, ObjectID& stream_id,
+                                       size_t& count) {
+  RETURN_ON_ASSERT(root["type"] == "pull_next_stream_chunks_request");
+  stream_id = root["id"].get<ObjectID>();
+  count = root["count"].get<size_t>();
+  return Status::OK();
+}
+
+void WritePullNextStreamChunksReply(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg) {
+  json root;
+  root["type"] = "pull_next_stream_chunks_reply";
+  for (size_t i = 0; i < objects.size(); ++i) {
+    json tree;
+    objects[i]->ToJSON(tree);
+    root[std::to_string(i)] = tree;
+  }
+  root["num"] = objects.size();
+
+  encode_msg(root, msg);
+}
+
+Status ReadPullNextStreamChunksReply(const json& root,
+                                     std::vector<Payload>& objects) {
+  CHECK_IPC_ERROR(root, "pull_next_stream_chunks_reply");
+  for (size_t i = 0; i < root["num"]; ++i) {
+    Payload object;
+    object.FromJSON(root[std::to_string(i)]);
+    objects.emplace_back(object);
+  }
+  return Status::OK();
+}
+
 void WriteStopStreamRequest(const ObjectID stream_id, const bool failed,
                             std::string& msg) {
   json root;
@@ -869,11 +1262,23 @@ void WriteStopStreamRequest(const ObjectID stream_id, const bool failed,
   encode_msg(root, msg);
 }
 
+void WriteStopStreamRequest(const ObjectID stream_id, const bool failed,
+                            std::vector<size_t> const& used, std::string& msg) {
+  json root;
+  root["type"] = "stop_stream_request";
+  root["id"] = stream_id;
+  root["failed"] = failed;
+  root["used"] = used;
+
+  encode_msg(root, msg);
+}
+
 Status ReadStopStreamRequest(const json& root, ObjectID& stream_id,
-                             bool& failed) {
+                             bool& failed, std::vector<size_t>& used) {
   RETURN_ON_ASSERT(root["type"] == "stop_stream_request");
   stream_id = root["id"].get<ObjectID>();
   failed = root["failed"].get<bool>();
+  used = root.value("used", std::vector<size_t>{});
   return Status::OK();
 }
 
@@ -981,21 +1386,36 @@ Status ReadMakeArenaRequest(const json& root, size_t& size) {
 
 void WriteMakeArenaReply(const int fd, const size_t size, const uintptr_t base,
                          std::string& msg) {
+  WriteMakeArenaReply(fd, size, base, -1, msg);
+}
+
+void WriteMakeArenaReply(const int fd, const size_t size, const uintptr_t base,
+                         const ptrdiff_t offset, std::string& msg) {
   json root;
   root["type"] = "make_arena_reply";
   root["fd"] = fd;
   root["size"] = size;
   root["base"] = base;
+  if (offset != -1) {
+    root["offset"] = offset;
+  }
 
   encode_msg(root, msg);
 }
 
 Status ReadMakeArenaReply(const json& root, int& fd, size_t& size,
                           uintptr_t& base) {
+  ptrdiff_t offset = -1;
+  return ReadMakeArenaReply(root, fd, size, base, offset);
+}
+
+Status ReadMakeArenaReply(const json& root, int& fd, size_t& size,
+                          uintptr_t& base, ptrdiff_t& offset) {
   CHECK_IPC_ERROR(root, "make_arena_reply");
   fd = root["fd"].get<int>();
   size = root["size"].get<size_t>();
   base = root["base"].get<uintptr_t>();
+  offset = root.value("offset", static_cast<ptrdiff_t>(-1));
   return Status::OK();
 }
 
@@ -1058,4 +1478,298 @@ Status ReadDebugReply(const json& root, json& result) {
   return Status::OK();
 }
 
+void WriteGetDataRequestBinary(const std::vector<ObjectID>& ids,
+                               const bool sync_remote, const bool wait,
+                               std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::GetDataRequest);
+  encoder.Put<uint64_t>(ids.size());
+  for (auto const id : ids) {
+    encoder.Put<ObjectID>(id);
+  }
+  encoder.Put<uint8_t>(sync_remote);
+  encoder.Put<uint8_t>(wait);
+}
+
+Status ReadGetDataRequestBinary(BinaryDecoder& decoder,
+                                std::vector<ObjectID>& ids, bool& sync_remote,
+                                bool& wait) {
+  CHECK_BINARY_TYPE(decoder, CommandType::GetDataRequest);
+  uint64_t num = 0;
+  uint8_t sync_remote_flag = 0, wait_flag = 0;
+  RETURN_ON_ERROR(decoder.GetCount(num, sizeof(ObjectID)));
+  ids.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    RETURN_ON_ERROR(decoder.Get<ObjectID>(ids[i]));
+  }
+  RETURN_ON_ERROR(decoder.Get<uint8_t>(sync_remote_flag));
+  RETURN_ON_ERROR(decoder.Get<uint8_t>(wait_flag));
+  sync_remote = sync_remote_flag;
+  wait = wait_flag;
+  return Status::OK();
+}
+
+void WriteGetDataReplyBinary(const json& content, std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::GetDataRequest);
+  encoder.Put(content);
+}
+
+Status ReadGetDataReplyBinary(BinaryDecoder& decoder, json& content) {
+  CHECK_BINARY_TYPE(decoder, CommandType::GetDataRequest);
+  json content_group;
+  RETURN_ON_ERROR(decoder.Get(content_group));
+  // should be only one item
+  if (content_group.size() != 1) {
+    return Status::ObjectNotExists("failed to read get_data reply: " +
+                                   content_group.dump());
+  }
+  content = *content_group.begin();
+  return Status::OK();
+}
+
+Status ReadGetDataReplyBinary(BinaryDecoder& decoder,
+                              std::unordered_map<ObjectID, json>& content) {
+  CHECK_BINARY_TYPE(decoder, CommandType::GetDataRequest);
+  json content_group;
+  RETURN_ON_ERROR(decoder.Get(content_group));
+  for (auto const& kv : json::iterator_wrapper(content_group)) {
+    content.emplace(ObjectIDFromString(kv.key()), kv.value());
+  }
+  return Status::OK();
+}
+
+void WriteCreateDataRequestBinary(const json& content, std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::CreateDataRequest);
+  encoder.Put(content);
+}
+
+Status ReadCreateDataRequestBinary(BinaryDecoder& decoder, json& content) {
+  CHECK_BINARY_TYPE(decoder, CommandType::CreateDataRequest);
+  return decoder.Get(content);
+}
+
+void WriteCreateDataReplyBinary(const ObjectID& id, const Signature& signature,
+                                const InstanceID& instance_id,
+                                std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::CreateDataRequest);
+  encoder.Put<ObjectID>(id);
+  encoder.Put<Signature>(signature);
+  encoder.Put<InstanceID>(instance_id);
+}
+
+Status ReadCreateDataReplyBinary(BinaryDecoder& decoder, ObjectID& id,
+                                 Signature& signature,
+                                 InstanceID& instance_id) {
+  CHECK_BINARY_TYPE(decoder, CommandType::CreateDataRequest);
+  RETURN_ON_ERROR(decoder.Get<ObjectID>(id));
+  RETURN_ON_ERROR(decoder.Get<Signature>(signature));
+  RETURN_ON_ERROR(decoder.Get<InstanceID>(instance_id));
+  return Status::OK();
+}
+
+void WriteCreateBufferRequestBinary(const size_t size, std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::CreateBufferRequest);
+  encoder.Put<uint64_t>(size);
+}
+
+Status ReadCreateBufferRequestBinary(BinaryDecoder& decoder, size_t& size) {
+  CHECK_BINARY_TYPE(decoder, CommandType::CreateBufferRequest);
+  uint64_t value = 0;
+  RETURN_ON_ERROR(decoder.Get<uint64_t>(value));
+  size = value;
+  return Status::OK();
+}
+
+void WriteCreateBufferReplyBinary(const ObjectID id,
+                                  const std::shared_ptr<Payload>& object,
+                                  std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::CreateBufferRequest);
+  encoder.Put<ObjectID>(id);
+  encoder.Put(*object);
+}
+
+Status ReadCreateBufferReplyBinary(BinaryDecoder& decoder, ObjectID& id,
+                                   Payload& object) {
+  CHECK_BINARY_TYPE(decoder, CommandType::CreateBufferRequest);
+  RETURN_ON_ERROR(decoder.Get<ObjectID>(id));
+  RETURN_ON_ERROR(decoder.Get(object));
+  return Status::OK();
+}
+
+void WriteCreateBuffersRequestBinary(const std::vector<size_t>& sizes,
+                                     std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::CreateBuffersRequest);
+  encoder.Put<uint64_t>(sizes.size());
+  for (auto const size : sizes) {
+    encoder.Put<uint64_t>(size);
+  }
+}
+
+Status ReadCreateBuffersRequestBinary(BinaryDecoder& decoder,
+                                      std::vector<size_t>& sizes) {
+  CHECK_BINARY_TYPE(decoder, CommandType::CreateBuffersRequest);
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.GetCount(num, sizeof(uint64_t)));
+  sizes.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    uint64_t value = 0;
+    RETURN_ON_ERROR(decoder.Get<uint64_t>(value));
+    sizes[i] = value;
+  }
+  return Status::OK();
+}
+
+void WriteCreateBuffersReplyBinary(
+    const std::vector<ObjectID>& ids,
+    const std::vector<std::shared_ptr<Payload>>& objects,
+    const std::vector<int>& fds, std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::CreateBuffersRequest);
+  encoder.Put<uint64_t>(objects.size());
+  for (size_t i = 0; i < objects.size(); ++i) {
+    encoder.Put<ObjectID>(ids[i]);
+    encoder.Put(*objects[i]);
+  }
+  encoder.Put<uint64_t>(fds.size());
+  for (auto const fd : fds) {
+    encoder.Put<int32_t>(fd);
+  }
+}
+
+Status ReadCreateBuffersReplyBinary(BinaryDecoder& decoder,
+                                    std::vector<ObjectID>& ids,
+                                    std::vector<Payload>& objects,
+                                    std::vector<int>& fds) {
+  CHECK_BINARY_TYPE(decoder, CommandType::CreateBuffersRequest);
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.GetCount(
+      num, sizeof(ObjectID) + BinaryDecoder::kPayloadSize));
+  ids.resize(num);
+  objects.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    RETURN_ON_ERROR(decoder.Get<ObjectID>(ids[i]));
+    RETURN_ON_ERROR(decoder.Get(objects[i]));
+  }
+  return readFdsBinary(decoder, fds);
+}
+
+void WriteGetBuffersRequestBinary(const std::set<ObjectID>& ids,
+                                  std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::GetBuffersRequest);
+  encoder.Put<uint64_t>(ids.size());
+  for (auto const id : ids) {
+    encoder.Put<ObjectID>(id);
+  }
+}
+
+Status ReadGetBuffersRequestBinary(BinaryDecoder& decoder,
+                                   std::vector<ObjectID>& ids) {
+  CHECK_BINARY_TYPE(decoder, CommandType::GetBuffersRequest);
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.GetCount(num, sizeof(ObjectID)));
+  ids.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    RETURN_ON_ERROR(decoder.Get<ObjectID>(ids[i]));
+  }
+  return Status::OK();
+}
+
+void WriteGetBuffersReplyBinary(
+    const std::vector<std::shared_ptr<Payload>>& objects,
+    const std::vector<int>& fds, std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::GetBuffersRequest);
+  encoder.Put<uint64_t>(objects.size());
+  for (auto const& object : objects) {
+    encoder.Put(*object);
+  }
+  encoder.Put<uint64_t>(fds.size());
+  for (auto const fd : fds) {
+    encoder.Put<int32_t>(fd);
+  }
+}
+
+Status ReadGetBuffersReplyBinary(BinaryDecoder& decoder,
+                                 std::vector<Payload>& objects,
+                                 std::vector<int>& fds) {
+  CHECK_BINARY_TYPE(decoder, CommandType::GetBuffersRequest);
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.GetCount(num, BinaryDecoder::kPayloadSize));
+  objects.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    RETURN_ON_ERROR(decoder.Get(objects[i]));
+  }
+  return readFdsBinary(decoder, fds);
+}
+
+void WriteDropBufferRequestBinary(const ObjectID id, std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::DropBufferRequest);
+  encoder.Put<ObjectID>(id);
+}
+
+Status ReadDropBufferRequestBinary(BinaryDecoder& decoder, ObjectID& id) {
+  CHECK_BINARY_TYPE(decoder, CommandType::DropBufferRequest);
+  return decoder.Get<ObjectID>(id);
+}
+
+void WriteDropBufferReplyBinary(std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::DropBufferRequest);
+}
+
+Status ReadDropBufferReplyBinary(BinaryDecoder& decoder) {
+  CHECK_BINARY_TYPE(decoder, CommandType::DropBufferRequest);
+  return Status::OK();
+}
+
+void WriteGetNextStreamChunkRequestBinary(const ObjectID stream_id,
+                                          const size_t size,
+                                          std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::GetNextStreamChunkRequest);
+  encoder.Put<ObjectID>(stream_id);
+  encoder.Put<uint64_t>(size);
+}
+
+Status ReadGetNextStreamChunkRequestBinary(BinaryDecoder& decoder,
+                                           ObjectID& stream_id, size_t& size) {
+  CHECK_BINARY_TYPE(decoder, CommandType::GetNextStreamChunkRequest);
+  uint64_t value = 0;
+  RETURN_ON_ERROR(decoder.Get<ObjectID>(stream_id));
+  RETURN_ON_ERROR(decoder.Get<uint64_t>(value));
+  size = value;
+  return Status::OK();
+}
+
+void WriteGetNextStreamChunkReplyBinary(std::shared_ptr<Payload>& object,
+                                        std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::GetNextStreamChunkRequest);
+  encoder.Put(*object);
+}
+
+Status ReadGetNextStreamChunkReplyBinary(BinaryDecoder& decoder,
+                                         Payload& object) {
+  CHECK_BINARY_TYPE(decoder, CommandType::GetNextStreamChunkRequest);
+  return decoder.Get(object);
+}
+
+void WritePullNextStreamChunkRequestBinary(const ObjectID stream_id,
+                                           std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::PullNextStreamChunkRequest);
+  encoder.Put<ObjectID>(stream_id);
+}
+
+Status ReadPullNextStreamChunkRequestBinary(BinaryDecoder& decoder,
+                                            ObjectID& stream_id) {
+  CHECK_BINARY_TYPE(decoder, CommandType::PullNextStreamChunkRequest);
+  return decoder.Get<ObjectID>(stream_id);
+}
+
+void WritePullNextStreamChunkReplyBinary(std::shared_ptr<Payload>& object,
+                                         std::string& msg) {
+  BinaryEncoder encoder(msg, CommandType::PullNextStreamChunkRequest);
+  encoder.Put(*object);
+}
+
+Status ReadPullNextStreamChunkReplyBinary(BinaryDecoder& decoder,
+                                          Payload& object) {
+  CHECK_BINARY_TYPE(decoder, CommandType::PullNextStreamChunkRequest);
+  return decoder.Get(object);
+}
+
 }  // namespace vineyard
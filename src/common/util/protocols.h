@@ -16,10 +16,12 @@ limitations under the License.
 #ifndef SRC_COMMON_UTIL_PROTOCOLS_H_
 #define SRC_COMMON_UTIL_PROTOCOLS_H_
 
+#include <cstring>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -67,23 +69,162 @@ enum class CommandType {
   MakeArenaRequest = 33,
   FinalizeArenaRequest = 34,
   DeepCopyRequest = 35,
+  GetDeletedObjectsRequest = 36,
+  GetNextStreamChunksRequest = 37,
+  PullNextStreamChunksRequest = 38,
+  ReleaseBuffersRequest = 39,
+  CreateBuffersRequest = 40,
 };
 
 CommandType ParseCommandType(const std::string& str_type);
 
+/**
+ * Notes [Binary Protocol]:
+ *
+ * Besides JSON, the hot-path commands (buffers, streams and metadata) can be
+ * encoded in a compact binary format, once the client and the server have
+ * agreed on that during registering. The message framing is unchanged (a
+ * `size_t` length prefix followed by the body), and a binary message body
+ * looks like:
+ *
+ *     | magic (1 byte) | command type (1 byte) | fields ... |
+ *
+ * The magic byte `\0` can never start a JSON document, thus both kinds of
+ * messages can be told apart by the first byte. Integers are encoded in the
+ * host byte order as the peers of IPC live on the same host, strings are
+ * length-prefixed, and metadata trees are encoded as MessagePack.
+ *
+ * A reply carries the command type of its request. Error replies are always
+ * encoded as JSON.
+ */
+constexpr char kBinaryMessageMagic = '\0';
+
+bool IsBinaryMessage(const std::string& msg);
+
+class BinaryEncoder {
+ public:
+  BinaryEncoder(std::string& buffer, const CommandType type);
+
+  template <typename T>
+  void Put(const T value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable types can be encoded directly");
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void Put(const std::string& value);
+
+  void Put(const json& tree);
+
+  void Put(const Payload& payload);
+
+ private:
+  std::string& buffer_;
+};
+
+class BinaryDecoder {
+ public:
+  explicit BinaryDecoder(const std::string& buffer);
+
+  CommandType Type() const { return type_; }
+
+  template <typename T>
+  Status Get(T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable types can be decoded directly");
+    if (offset_ + sizeof(T) > size_) {
+      return Status::Invalid("Malformed binary message: unexpected end");
+    }
+    memcpy(&value, data_ + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return Status::OK();
+  }
+
+  Status Get(std::string& value);
+
+  Status Get(json& tree);
+
+  Status Get(Payload& payload);
+
+  /**
+   * @brief Get the number of elements of a list that follows, every element
+   * takes (at least) `element_size` bytes. The number comes from the peer,
+   * thus it is checked against the remaining bytes before being used to
+   * allocate anything.
+   */
+  Status GetCount(uint64_t& num, const size_t element_size);
+
+  // the size of an encoded `Payload`
+  static constexpr size_t kPayloadSize = sizeof(ObjectID) + sizeof(int32_t) +
+                                         sizeof(int64_t) * 3;
+
+ private:
+  const char* data_;
+  size_t size_;
+  size_t offset_;
+  CommandType type_;
+};
+
 void WriteErrorReply(Status const& status, std::string& msg);
 
 void WriteRegisterRequest(std::string& msg);
 
-Status ReadRegisterRequest(const json& msg, std::string& version);
+/**
+ * @brief Register with the server, and ask for the binary protocol, see also
+ * Notes [Binary Protocol].
+ */
+void WriteRegisterRequest(const bool binary_protocol, std::string& msg);
+
+/**
+ * @brief Register with the server, and ask for the binary protocol and the
+ * shared memory pool, see also Notes [Shared Memory Pool] in
+ * "server/memory/memory.cc".
+ */
+void WriteRegisterRequest(const bool binary_protocol, const bool shared_pool,
+                          std::string& msg);
 
+/**
+ * @brief Register with the server, and additionally ask for the command
+ * channel, see also Notes [Command Channel] in
+ * "common/memory/command_channel.h".
+ */
+void WriteRegisterRequest(const bool binary_protocol, const bool shared_pool,
+                          const bool command_channel, std::string& msg);
+
+Status ReadRegisterRequest(const json& msg, std::string& version,
+                           bool& binary_protocol, bool& shared_pool,
+                           bool& command_channel);
+
+/**
+ * @brief The `shared_pool_fd` is -1 if the shared memory pool won't be used
+ * by the connection, otherwise the fd will be sent after the reply.
+ *
+ * The `command_channel_capacity` is 0 if the command channel won't be used,
+ * otherwise the fd of the channel will be sent after the reply (and after
+ * the fd of the shared memory pool).
+ */
 void WriteRegisterReply(const std::string& ipc_socket,
                         const std::string& rpc_endpoint,
-                        const InstanceID instance_id, std::string& msg);
+                        const InstanceID instance_id,
+                        const bool binary_protocol, const int shared_pool_fd,
+                        const int64_t shared_pool_size,
+                        const size_t command_channel_capacity,
+                        std::string& msg);
+
+Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, bool& binary_protocol);
+
+Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, bool& binary_protocol,
+                         int& shared_pool_fd, int64_t& shared_pool_size);
 
 Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
                          std::string& rpc_endpoint, InstanceID& instance_id,
-                         std::string& version);
+                         std::string& version, bool& binary_protocol,
+                         int& shared_pool_fd, int64_t& shared_pool_size,
+                         size_t& command_channel_capacity);
 
 void WriteExitRequest(std::string& msg);
 
@@ -174,6 +315,21 @@ void WriteInstanceStatusReply(const json& content, std::string& msg);
 
 Status ReadInstanceStatusReply(const json& root, json& content);
 
+void WriteGetDeletedObjectsRequest(const uint64_t since, std::string& msg);
+
+Status ReadGetDeletedObjectsRequest(const json& root, uint64_t& since);
+
+/**
+ * @brief `overflow` means the deletions after `since` are no longer kept by
+ * the server, thus `ids` is incomplete.
+ */
+void WriteGetDeletedObjectsReply(const uint64_t sequence,
+                                 const std::vector<ObjectID>& ids,
+                                 const bool overflow, std::string& msg);
+
+Status ReadGetDeletedObjectsReply(const json& root, uint64_t& sequence,
+                                  std::vector<ObjectID>& ids, bool& overflow);
+
 void WriteCreateBufferRequest(const size_t size, std::string& msg);
 
 Status ReadCreateBufferRequest(const json& root, size_t& size);
@@ -184,6 +340,39 @@ void WriteCreateBufferReply(const ObjectID id,
 
 Status ReadCreateBufferReply(const json& root, ObjectID& id, Payload& object);
 
+/**
+ * Notes [Creating Buffers in Bulk]:
+ *
+ * Creating the blobs of an object one by one costs a round trip per blob,
+ * and a `sendmsg` per new store fd. `CreateBuffersRequest` allocates a list
+ * of blobs at once, and the reply carries all the payloads, as well as the
+ * (deduplicated) store fds that the client hasn't received yet, in the order
+ * of being sent. The server sends these fds right after the reply by
+ * `send_fds`, i.e., in a single message (unless there are more than
+ * `FLING_MAX_FDS` of them), and the client receives them by `recv_fds` at
+ * once, before mapping any of the payloads.
+ *
+ * The binary reply of `GetBuffersRequest` carries the list of fds as well
+ * and sends the fds in the same way, while the JSON reply keeps sending an
+ * fd per message for clients of other languages.
+ *
+ * If any of the blobs cannot be created, the created ones are dropped and
+ * an error is replied.
+ */
+void WriteCreateBuffersRequest(const std::vector<size_t>& sizes,
+                               std::string& msg);
+
+Status ReadCreateBuffersRequest(const json& root, std::vector<size_t>& sizes);
+
+void WriteCreateBuffersReply(
+    const std::vector<ObjectID>& ids,
+    const std::vector<std::shared_ptr<Payload>>& objects,
+    const std::vector<int>& fds, std::string& msg);
+
+Status ReadCreateBuffersReply(const json& root, std::vector<ObjectID>& ids,
+                              std::vector<Payload>& objects,
+                              std::vector<int>& fds);
+
 void WriteCreateRemoteBufferRequest(const size_t size, std::string& msg);
 
 Status ReadCreateRemoteBufferRequest(const json& root, size_t& size);
@@ -211,6 +400,19 @@ void WriteDropBufferReply(std::string& msg);
 
 Status ReadDropBufferReply(const json& root);
 
+/**
+ * @brief Release the pins of the connection on the given blobs, see also
+ * Notes [Blob Reference Counting] in "server/memory/memory.cc".
+ */
+void WriteReleaseBuffersRequest(const std::set<ObjectID>& ids,
+                                std::string& msg);
+
+Status ReadReleaseBuffersRequest(const json& root, std::vector<ObjectID>& ids);
+
+void WriteReleaseBuffersReply(std::string& msg);
+
+Status ReadReleaseBuffersReply(const json& root);
+
 void WritePutNameRequest(const ObjectID object_id, const std::string& name,
                          std::string& msg);
 
@@ -290,11 +492,57 @@ void WritePullNextStreamChunkReply(std::shared_ptr<Payload>& object,
 
 Status ReadPullNextStreamChunkReply(const json& root, Payload& object);
 
+/**
+ * @brief Seal the chunks that are being written, and allocate `count` chunks
+ * for writing.
+ *
+ * The optional `used` is the number of bytes that have been written into each
+ * chunk being sealed, the chunks will be shrunk to the used sizes before
+ * being sealed, and empty chunks are dropped.
+ */
+void WriteGetNextStreamChunksRequest(const ObjectID stream_id,
+                                     const size_t size, const size_t count,
+                                     std::vector<size_t> const& used,
+                                     std::string& msg);
+
+Status ReadGetNextStreamChunksRequest(const json& root, ObjectID& stream_id,
+                                      size_t& size, size_t& count,
+                                      std::vector<size_t>& used);
+
+void WriteGetNextStreamChunksReply(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg);
+
+Status ReadGetNextStreamChunksReply(const json& root,
+                                    std::vector<Payload>& objects);
+
+/**
+ * @brief Release the chunks that are being read, and read at most `count`
+ * chunks.
+ */
+void WritePullNextStreamChunksRequest(const ObjectID stream_id,
+                                      const size_t count, std::string& msg);
+
+Status ReadPullNextStreamChunksRequest(const json& root, ObjectID& stream_id,
+                                       size_t& count);
+
+void WritePullNextStreamChunksReply(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg);
+
+Status ReadPullNextStreamChunksReply(const json& root,
+                                     std::vector<Payload>& objects);
+
 void WriteStopStreamRequest(const ObjectID stream_id, const bool failed,
                             std::string& msg);
 
+/**
+ * @brief Stop the stream, the chunks that are being written are shrunk to the
+ * `used` sizes before being sealed, see also `WriteGetNextStreamChunksRequest`.
+ */
+void WriteStopStreamRequest(const ObjectID stream_id, const bool failed,
+                            std::vector<size_t> const& used, std::string& msg);
+
 Status ReadStopStreamRequest(const json& root, ObjectID& stream_id,
-                             bool& failed);
+                             bool& failed, std::vector<size_t>& used);
 
 void WriteStopStreamReply(std::string& msg);
 
@@ -330,9 +578,19 @@ Status ReadMakeArenaRequest(const json& root, size_t& size);
 void WriteMakeArenaReply(const int fd, const size_t size, const uintptr_t base,
                          std::string& msg);
 
+/**
+ * @brief The `offset` is the offset of the arena in the shared memory pool,
+ * or -1 if the arena has its own memory file.
+ */
+void WriteMakeArenaReply(const int fd, const size_t size, const uintptr_t base,
+                         const ptrdiff_t offset, std::string& msg);
+
 Status ReadMakeArenaReply(const json& root, int& fd, size_t& size,
                           uintptr_t& base);
 
+Status ReadMakeArenaReply(const json& root, int& fd, size_t& size,
+                          uintptr_t& base, ptrdiff_t& offset);
+
 void WriteFinalizeArenaRequest(const int fd, std::vector<size_t> const& offsets,
                                std::vector<size_t> const& sizes,
                                std::string& msg);
@@ -353,6 +611,112 @@ void WriteDebugReply(const json& result, std::string& msg);
 
 Status ReadDebugReply(const json& root, json& result);
 
+// The binary variants of the hot-path commands, see also
+// Notes [Binary Protocol].
+
+void WriteGetDataRequestBinary(const std::vector<ObjectID>& ids,
+                               const bool sync_remote, const bool wait,
+                               std::string& msg);
+
+Status ReadGetDataRequestBinary(BinaryDecoder& decoder,
+                                std::vector<ObjectID>& ids, bool& sync_remote,
+                                bool& wait);
+
+void WriteGetDataReplyBinary(const json& content, std::string& msg);
+
+Status ReadGetDataReplyBinary(BinaryDecoder& decoder, json& content);
+
+Status ReadGetDataReplyBinary(BinaryDecoder& decoder,
+                              std::unordered_map<ObjectID, json>& content);
+
+void WriteCreateDataRequestBinary(const json& content, std::string& msg);
+
+Status ReadCreateDataRequestBinary(BinaryDecoder& decoder, json& content);
+
+void WriteCreateDataReplyBinary(const ObjectID& id, const Signature& signature,
+                                const InstanceID& instance_id,
+                                std::string& msg);
+
+Status ReadCreateDataReplyBinary(BinaryDecoder& decoder, ObjectID& id,
+                                 Signature& signature, InstanceID& instance_id);
+
+void WriteCreateBufferRequestBinary(const size_t size, std::string& msg);
+
+Status ReadCreateBufferRequestBinary(BinaryDecoder& decoder, size_t& size);
+
+void WriteCreateBufferReplyBinary(const ObjectID id,
+                                  const std::shared_ptr<Payload>& object,
+                                  std::string& msg);
+
+Status ReadCreateBufferReplyBinary(BinaryDecoder& decoder, ObjectID& id,
+                                   Payload& object);
+
+void WriteCreateBuffersRequestBinary(const std::vector<size_t>& sizes,
+                                     std::string& msg);
+
+Status ReadCreateBuffersRequestBinary(BinaryDecoder& decoder,
+                                      std::vector<size_t>& sizes);
+
+void WriteCreateBuffersReplyBinary(
+    const std::vector<ObjectID>& ids,
+    const std::vector<std::shared_ptr<Payload>>& objects,
+    const std::vector<int>& fds, std::string& msg);
+
+Status ReadCreateBuffersReplyBinary(BinaryDecoder& decoder,
+                                    std::vector<ObjectID>& ids,
+                                    std::vector<Payload>& objects,
+                                    std::vector<int>& fds);
+
+void WriteGetBuffersRequestBinary(const std::set<ObjectID>& ids,
+                                  std::string& msg);
+
+Status ReadGetBuffersRequestBinary(BinaryDecoder& decoder,
+                                   std::vector<ObjectID>& ids);
+
+/**
+ * @brief `fds` are the store fds that will be sent after the reply, see also
+ * Notes [Creating Buffers in Bulk].
+ */
+void WriteGetBuffersReplyBinary(
+    const std::vector<std::shared_ptr<Payload>>& objects,
+    const std::vector<int>& fds, std::string& msg);
+
+Status ReadGetBuffersReplyBinary(BinaryDecoder& decoder,
+                                 std::vector<Payload>& objects,
+                                 std::vector<int>& fds);
+
+void WriteDropBufferRequestBinary(const ObjectID id, std::string& msg);
+
+Status ReadDropBufferRequestBinary(BinaryDecoder& decoder, ObjectID& id);
+
+void WriteDropBufferReplyBinary(std::string& msg);
+
+Status ReadDropBufferReplyBinary(BinaryDecoder& decoder);
+
+void WriteGetNextStreamChunkRequestBinary(const ObjectID stream_id,
+                                          const size_t size, std::string& msg);
+
+Status ReadGetNextStreamChunkRequestBinary(BinaryDecoder& decoder,
+                                           ObjectID& stream_id, size_t& size);
+
+void WriteGetNextStreamChunkReplyBinary(std::shared_ptr<Payload>& object,
+                                        std::string& msg);
+
+Status ReadGetNextStreamChunkReplyBinary(BinaryDecoder& decoder,
+                                         Payload& object);
+
+void WritePullNextStreamChunkRequestBinary(const ObjectID stream_id,
+                                           std::string& msg);
+
+Status ReadPullNextStreamChunkRequestBinary(BinaryDecoder& decoder,
+                                            ObjectID& stream_id);
+
+void WritePullNextStreamChunkReplyBinary(std::shared_ptr<Payload>& object,
+                                         std::string& msg);
+
+Status ReadPullNextStreamChunkReplyBinary(BinaryDecoder& decoder,
+                                          Payload& object);
+
 }  // namespace vineyard
 
 #endif  // SRC_COMMON_UTIL_PROTOCOLS_H_
@@ -15,9 +15,11 @@ limitations under the License.
 
 #include "server/async/socket_server.h"
 
+#include <chrono>
 #include <limits>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -25,6 +27,7 @@ limitations under the License.
 #include "common/util/callback.h"
 #include "common/util/functions.h"
 #include "common/util/json.h"
+#include "server/memory/malloc.h"
 #include "server/util/metrics.h"
 
 namespace vineyard {
@@ -35,7 +38,10 @@ SocketConnection::SocketConnection(stream_protocol::socket socket,
     : socket_(std::move(socket)),
       server_ptr_(server_ptr),
       socket_server_ptr_(socket_server_ptr),
-      conn_id_(conn_id) {}
+      conn_id_(conn_id),
+      binary_protocol_(false),
+      shared_pool_(false),
+      channel_spin_us_(0) {}
 
 bool SocketConnection::Start() {
   running_.store(true);
@@ -49,12 +55,20 @@ bool SocketConnection::Stop() {
     // already stopped, or haven't started
     return false;
   }
+  if (channel_ != nullptr) {
+    // the poller thread exits once woken up
+    channel_->requests().Wake();
+  }
 
   // do cleanup: clean up streams associated with this client
-  for (auto stream_id : associated_streams_) {
-    VINEYARD_SUPPRESS(server_ptr_->GetStreamStore()->Drop(stream_id));
+  for (auto const& item : stream_consumers_) {
+    VINEYARD_SUPPRESS(
+        server_ptr_->GetStreamStore()->Drop(item.first, item.second));
   }
 
+  // release blobs that pinned by this client
+  server_ptr_->GetBulkStore()->UnpinAll(conn_id_);
+
   // On Mac the state of socket may be "not connected" after the client has
   // already closed the socket, hence there will be an exception.
   boost::system::error_code ec;
@@ -107,6 +121,46 @@ void SocketConnection::doReadBody() {
                    });
 }
 
+void SocketConnection::pollChannel() {
+  // wake up periodically to check whether the connection has been stopped
+  constexpr int64_t kWaitTimeoutUs = 10 * 1000;  // 10ms
+  auto& requests = channel_->requests();
+  auto spin_until = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds(channel_spin_us_);
+  while (running_.load()) {
+    uint32_t sequence = requests.Sequence();
+    std::string message;
+    bool popped = false;
+    auto status = requests.Pop(message, popped);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to read from the command channel: "
+                 << status.ToString();
+      doStop();
+      return;
+    }
+    if (popped) {
+      // keep the same layout as `read_msg_body_`
+      message.push_back('\0');
+      if (processMessage(message)) {
+        doStop();
+        return;
+      }
+      spin_until = std::chrono::steady_clock::now() +
+                   std::chrono::microseconds(channel_spin_us_);
+      continue;
+    }
+    if (std::chrono::steady_clock::now() < spin_until) {
+      continue;
+    }
+    // the client wakes the futex once it observes the waiting mark, and
+    // requests that arrived meanwhile have bumped the sequence
+    if (requests.MarkWaiting()) {
+      requests.Wait(sequence, kWaitTimeoutUs);
+      requests.ClearWaiting();
+    }
+  }
+}
+
 #ifndef __REPORT_JSON_ERROR
 #ifndef NDEBUG
 #define __REPORT_JSON_ERROR(err, data) \
@@ -165,7 +219,24 @@ void SocketConnection::doReadBody() {
   } while (0)
 #endif  // RESPONSE_ON_ERROR
 
+#ifndef TRY_READ_BINARY_REQUEST
+#define TRY_READ_BINARY_REQUEST(operation, decoder, ...)    \
+  do {                                                      \
+    Status read_status = operation(decoder, ##__VA_ARGS__); \
+    if (!read_status.ok()) {                                \
+      std::string error_message_out;                        \
+      WriteErrorReply(read_status, error_message_out);      \
+      self->doWrite(error_message_out);                     \
+      return false;                                         \
+    }                                                       \
+  } while (0)
+#endif  // TRY_READ_BINARY_REQUEST
+
 bool SocketConnection::processMessage(const std::string& message_in) {
+  if (IsBinaryMessage(message_in)) {
+    return processBinaryMessage(message_in);
+  }
+
   json root;
   std::istringstream is(message_in);
 
@@ -187,12 +258,18 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::CreateBufferRequest: {
     return doCreateBuffer(root);
   }
+  case CommandType::CreateBuffersRequest: {
+    return doCreateBuffers(root);
+  }
   case CommandType::CreateRemoteBufferRequest: {
     return doCreateRemoteBuffer(root);
   }
   case CommandType::DropBufferRequest: {
     return doDropBuffer(root);
   }
+  case CommandType::ReleaseBuffersRequest: {
+    return doReleaseBuffers(root);
+  }
   case CommandType::GetDataRequest: {
     return doGetData(root);
   }
@@ -232,6 +309,12 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::PullNextStreamChunkRequest: {
     return doPullNextStreamChunk(root);
   }
+  case CommandType::GetNextStreamChunksRequest: {
+    return doGetNextStreamChunks(root);
+  }
+  case CommandType::PullNextStreamChunksRequest: {
+    return doPullNextStreamChunks(root);
+  }
   case CommandType::StopStreamRequest: {
     return doStopStream(root);
   }
@@ -253,6 +336,9 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::InstanceStatusRequest: {
     return doInstanceStatus(root);
   }
+  case CommandType::GetDeletedObjectsRequest: {
+    return doGetDeletedObjects(root);
+  }
   case CommandType::MakeArenaRequest: {
     return doMakeArena(root);
   }
@@ -272,25 +358,142 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   }
 }
 
+bool SocketConnection::processBinaryMessage(const std::string& message_in) {
+  auto self(shared_from_this());
+  if (!binary_protocol_) {
+    RESPONSE_ON_ERROR(Status::Invalid(
+        "The binary protocol hasn't been negotiated during registering"));
+  }
+  BinaryDecoder decoder(message_in);
+  switch (decoder.Type()) {
+  case CommandType::GetBuffersRequest: {
+    return doGetBuffers(decoder);
+  }
+  case CommandType::CreateBufferRequest: {
+    return doCreateBuffer(decoder);
+  }
+  case CommandType::CreateBuffersRequest: {
+    return doCreateBuffers(decoder);
+  }
+  case CommandType::DropBufferRequest: {
+    return doDropBuffer(decoder);
+  }
+  case CommandType::GetDataRequest: {
+    return doGetData(decoder);
+  }
+  case CommandType::CreateDataRequest: {
+    return doCreateData(decoder);
+  }
+  case CommandType::GetNextStreamChunkRequest: {
+    return doGetNextStreamChunk(decoder);
+  }
+  case CommandType::PullNextStreamChunkRequest: {
+    return doPullNextStreamChunk(decoder);
+  }
+  default: {
+    RESPONSE_ON_ERROR(Status::Invalid(
+        "Got unexpected binary command: " +
+        std::to_string(static_cast<int>(decoder.Type()))));
+    return false;
+  }
+  }
+}
+
 bool SocketConnection::doRegister(const json& root) {
   auto self(shared_from_this());
   std::string client_version, message_out;
-  TRY_READ_REQUEST(ReadRegisterRequest, root, client_version);
+  bool binary_protocol = false, shared_pool = false, command_channel = false;
+  TRY_READ_REQUEST(ReadRegisterRequest, root, client_version, binary_protocol,
+                   shared_pool, command_channel);
+  binary_protocol_ = binary_protocol;
+  int shared_pool_fd = -1;
+  int64_t shared_pool_size = 0;
+  if (shared_pool) {
+    // see also: Notes [Shared Memory Pool]
+    auto bulk_store = server_ptr_->GetBulkStore();
+    shared_pool_ =
+        bulk_store->GetSharedPool(shared_pool_fd, shared_pool_size).ok();
+  }
+  if (!shared_pool_) {
+    shared_pool_fd = -1;
+  }
+  std::shared_ptr<CommandChannel> channel = nullptr;
+  size_t channel_capacity = 0;
+  if (command_channel) {
+    // see also: Notes [Command Channel]
+    auto const& ipc_spec = server_ptr_->GetSpec()["ipc_spec"];
+    channel_capacity = ipc_spec.value("command_channel_capacity",
+                                      static_cast<size_t>(0));
+    channel_spin_us_ =
+        ipc_spec.value("command_channel_spin_us", static_cast<int64_t>(0));
+    std::unique_ptr<CommandChannel> mapped = nullptr;
+    auto status = Status::OK();
+    if (channel_capacity == 0) {
+      status = Status::Invalid("The command channel has been disabled");
+    } else {
+      int fd = memory::create_buffer(
+          CommandChannel::SegmentSize(channel_capacity));
+      status = fd == -1 ? Status::IOError("Failed to create the buffer")
+                        : CommandChannel::Map(fd, channel_capacity, true,
+                                              mapped);
+    }
+    if (status.ok()) {
+      channel = std::move(mapped);
+    } else {
+      LOG(WARNING) << "Failed to setup the command channel: "
+                   << status.ToString();
+      channel_capacity = 0;
+    }
+  }
   WriteRegisterReply(server_ptr_->IPCSocket(), server_ptr_->RPCEndpoint(),
-                     server_ptr_->instance_id(), message_out);
-  doWrite(message_out);
+                     server_ptr_->instance_id(), binary_protocol_,
+                     shared_pool_fd, shared_pool_size, channel_capacity,
+                     message_out);
+  if (!shared_pool_ && channel == nullptr) {
+    doWrite(message_out);
+    return false;
+  }
+  this->doWrite(message_out, [self, shared_pool_fd,
+                              channel](const Status& status) {
+    if (self->shared_pool_) {
+      self->used_fds_.emplace(shared_pool_fd);
+      send_fd(self->nativeHandle(), shared_pool_fd);
+    }
+    if (channel != nullptr) {
+      // replies will go through the channel from now on
+      self->channel_ = channel;
+      send_fd(self->nativeHandle(), channel->fd());
+      // requests are served by a dedicated thread, see also Notes [Command
+      // Channel]
+      std::thread([self]() { self->pollChannel(); }).detach();
+    }
+    return Status::OK();
+  });
   return false;
 }
 
 bool SocketConnection::doGetBuffers(const json& root) {
   auto self(shared_from_this());
   std::vector<ObjectID> ids;
+  TRY_READ_REQUEST(ReadGetBuffersRequest, root, ids);
+  return doGetBuffersImpl(ids, false);
+}
+
+bool SocketConnection::doGetBuffers(BinaryDecoder& decoder) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> ids;
+  TRY_READ_BINARY_REQUEST(ReadGetBuffersRequestBinary, decoder, ids);
+  return doGetBuffersImpl(ids, true);
+}
+
+bool SocketConnection::doGetBuffersImpl(const std::vector<ObjectID>& ids,
+                                        const bool binary) {
+  auto self(shared_from_this());
   std::vector<std::shared_ptr<Payload>> objects;
   std::string message_out;
 
-  TRY_READ_REQUEST(ReadGetBuffersRequest, root, ids);
-  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Get(ids, objects));
-  WriteGetBuffersReply(objects, message_out);
+  // pin the blobs (and reload them if spilled) before sharing with the client
+  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Pin(ids, conn_id_, objects));
 
   /* NOTE: Here we send the file descriptor after the objects.
    *       We are using sendmsg to send the file descriptor
@@ -303,6 +506,23 @@ bool SocketConnection::doGetBuffers(const json& root) {
    *       We will examine other methods later, such as using
    *       explicit file descritors.
    */
+  if (binary) {
+    // all new fds go in a single message, see also
+    // Notes [Creating Buffers in Bulk]
+    std::vector<int> fds = newStoreFds(objects);
+    WriteGetBuffersReplyBinary(objects, fds, message_out);
+    this->doWrite(message_out, [self, fds](const Status& status) {
+      // the client would wait for the fds forever, drop the connection
+      if (!fds.empty() &&
+          send_fds(self->nativeHandle(), fds.data(), fds.size()) < 0) {
+        return Status::IOError("Failed to send fds to the client");
+      }
+      return Status::OK();
+    });
+    return false;
+  }
+  // clients of other languages expect an fd per message
+  WriteGetBuffersReply(objects, message_out);
   this->doWrite(message_out, [self, objects](const Status& status) {
     for (auto object : objects) {
       int store_fd = object->store_fd;
@@ -347,34 +567,65 @@ bool SocketConnection::doGetRemoteBuffers(const json& root) {
   std::string message_out;
 
   TRY_READ_REQUEST(ReadGetBuffersRequest, root, ids);
-  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Get(ids, objects));
+  // pin the blobs until the content has been sent
+  auto status = server_ptr_->GetBulkStore()->Pin(
+      ids, BulkStore::kAnonymousOwner, objects);
+  auto unpin = [self, objects]() {
+    for (auto const& object : objects) {
+      VINEYARD_SUPPRESS(self->server_ptr_->GetBulkStore()->Unpin(object));
+    }
+  };
+  if (!status.ok()) {
+    unpin();
+  }
+  RESPONSE_ON_ERROR(status);
   WriteGetBuffersReply(objects, message_out);
 
-  this->doWrite(message_out, [this, self, objects](const Status& status) {
-    boost::system::error_code ec;
-    sendBufferHelper(objects, 0, ec, [self](const Status& status) {
-      if (!status.ok()) {
-        LOG(ERROR) << "Failed to send buffers to remote client: "
-                   << status.ToString();
-      }
-      return Status::OK();
-    });
-    return Status::OK();
-  });
+  this->doWrite(
+      message_out, [this, self, objects, unpin](const Status& status) {
+        boost::system::error_code ec;
+        sendBufferHelper(objects, 0, ec, [self, unpin](const Status& status) {
+          if (!status.ok()) {
+            LOG(ERROR) << "Failed to send buffers to remote client: "
+                       << status.ToString();
+          }
+          unpin();
+          return Status::OK();
+        });
+        return Status::OK();
+      });
   return false;
 }
 
 bool SocketConnection::doCreateBuffer(const json& root) {
   auto self(shared_from_this());
   size_t size;
+  TRY_READ_REQUEST(ReadCreateBufferRequest, root, size);
+  return doCreateBufferImpl(size, false);
+}
+
+bool SocketConnection::doCreateBuffer(BinaryDecoder& decoder) {
+  auto self(shared_from_this());
+  size_t size;
+  TRY_READ_BINARY_REQUEST(ReadCreateBufferRequestBinary, decoder, size);
+  return doCreateBufferImpl(size, true);
+}
+
+bool SocketConnection::doCreateBufferImpl(const size_t size,
+                                          const bool binary) {
+  auto self(shared_from_this());
   std::shared_ptr<Payload> object;
   std::string message_out;
 
-  TRY_READ_REQUEST(ReadCreateBufferRequest, root, size);
   ObjectID object_id;
+  // the blob is pinned by the creator
   RESPONSE_ON_ERROR(
-      server_ptr_->GetBulkStore()->Create(size, object_id, object));
-  WriteCreateBufferReply(object_id, object, message_out);
+      server_ptr_->GetBulkStore()->Create(size, object_id, object, conn_id_));
+  if (binary) {
+    WriteCreateBufferReplyBinary(object_id, object, message_out);
+  } else {
+    WriteCreateBufferReply(object_id, object, message_out);
+  }
 
   int store_fd = object->store_fd;
   int data_size = object->data_size;
@@ -392,6 +643,77 @@ bool SocketConnection::doCreateBuffer(const json& root) {
   return false;
 }
 
+bool SocketConnection::doCreateBuffers(const json& root) {
+  auto self(shared_from_this());
+  std::vector<size_t> sizes;
+  TRY_READ_REQUEST(ReadCreateBuffersRequest, root, sizes);
+  return doCreateBuffersImpl(sizes, false);
+}
+
+bool SocketConnection::doCreateBuffers(BinaryDecoder& decoder) {
+  auto self(shared_from_this());
+  std::vector<size_t> sizes;
+  TRY_READ_BINARY_REQUEST(ReadCreateBuffersRequestBinary, decoder, sizes);
+  return doCreateBuffersImpl(sizes, true);
+}
+
+bool SocketConnection::doCreateBuffersImpl(const std::vector<size_t>& sizes,
+                                           const bool binary) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> ids;
+  std::vector<std::shared_ptr<Payload>> objects;
+  std::string message_out;
+
+  for (auto const size : sizes) {
+    ObjectID object_id = InvalidObjectID();
+    std::shared_ptr<Payload> object;
+    // the blobs are pinned by the creator
+    auto status = server_ptr_->GetBulkStore()->Create(size, object_id, object,
+                                                      conn_id_);
+    if (!status.ok()) {
+      // drop the blobs that have been created for this request
+      for (auto const id : ids) {
+        VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Delete(id));
+      }
+    }
+    RESPONSE_ON_ERROR(status);
+    ids.emplace_back(object_id);
+    objects.emplace_back(object);
+  }
+
+  // see also: Notes [Creating Buffers in Bulk]
+  std::vector<int> fds = newStoreFds(objects);
+  if (binary) {
+    WriteCreateBuffersReplyBinary(ids, objects, fds, message_out);
+  } else {
+    WriteCreateBuffersReply(ids, objects, fds, message_out);
+  }
+  this->doWrite(message_out, [this, self, fds](const Status& status) {
+    LOG_SUMMARY("instances_memory_usage_bytes", server_ptr_->instance_id(),
+                server_ptr_->GetBulkStore()->Footprint());
+    // the client would wait for the fds forever, drop the connection
+    if (!fds.empty() &&
+        send_fds(self->nativeHandle(), fds.data(), fds.size()) < 0) {
+      return Status::IOError("Failed to send fds to the client");
+    }
+    return Status::OK();
+  });
+  return false;
+}
+
+std::vector<int> SocketConnection::newStoreFds(
+    const std::vector<std::shared_ptr<Payload>>& objects) {
+  std::vector<int> fds;
+  for (auto const& object : objects) {
+    if (object->data_size > 0 &&
+        used_fds_.find(object->store_fd) == used_fds_.end()) {
+      used_fds_.emplace(object->store_fd);
+      fds.emplace_back(object->store_fd);
+    }
+  }
+  return fds;
+}
+
 bool SocketConnection::doCreateRemoteBuffer(const json& root) {
   auto self(shared_from_this());
   size_t size;
@@ -404,11 +726,13 @@ bool SocketConnection::doCreateRemoteBuffer(const json& root) {
 
   asio::async_read(
       socket_, asio::buffer(object->pointer, size),
-      [this, self, &object](boost::system::error_code ec, std::size_t size) {
+      [this, self, object](boost::system::error_code ec, std::size_t size) {
         std::string message_out;
         if (static_cast<size_t>(object->data_size) == size &&
             (!ec || ec == asio::error::eof)) {
           WriteCreateBufferReply(object->object_id, object, message_out);
+          // the content is held by the server, release the creator's pin
+          VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Unpin(object));
         } else {
           VINEYARD_DISCARD(
               server_ptr_->GetBulkStore()->Delete(object->object_id));
@@ -431,9 +755,26 @@ bool SocketConnection::doDropBuffer(const json& root) {
   auto self(shared_from_this());
   ObjectID object_id = InvalidObjectID();
   TRY_READ_REQUEST(ReadDropBufferRequest, root, object_id);
+  return doDropBufferImpl(object_id, false);
+}
+
+bool SocketConnection::doDropBuffer(BinaryDecoder& decoder) {
+  auto self(shared_from_this());
+  ObjectID object_id = InvalidObjectID();
+  TRY_READ_BINARY_REQUEST(ReadDropBufferRequestBinary, decoder, object_id);
+  return doDropBufferImpl(object_id, true);
+}
+
+bool SocketConnection::doDropBufferImpl(const ObjectID object_id,
+                                        const bool binary) {
   auto status = server_ptr_->GetBulkStore()->Delete(object_id);
-  std::string message_out;
   if (status.ok()) {
+    server_ptr_->RecordDeleted({object_id});
+  }
+  std::string message_out;
+  if (status.ok() && binary) {
+    WriteDropBufferReplyBinary(message_out);
+  } else if (status.ok()) {
     WriteDropBufferReply(message_out);
   } else {
     WriteErrorReply(status, message_out);
@@ -444,18 +785,49 @@ bool SocketConnection::doDropBuffer(const json& root) {
   return false;
 }
 
+bool SocketConnection::doReleaseBuffers(const json& root) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> ids;
+  TRY_READ_REQUEST(ReadReleaseBuffersRequest, root, ids);
+  for (auto const id : ids) {
+    // blobs that are not held by this connection are ignored
+    VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Unpin(id, conn_id_));
+  }
+  std::string message_out;
+  WriteReleaseBuffersReply(message_out);
+  this->doWrite(message_out);
+  return false;
+}
+
 bool SocketConnection::doGetData(const json& root) {
   auto self(shared_from_this());
   std::vector<ObjectID> ids;
   bool sync_remote = false, wait = false;
-  double startTime = GetCurrentTime();
   TRY_READ_REQUEST(ReadGetDataRequest, root, ids, sync_remote, wait);
-  json tree;
+  return doGetDataImpl(ids, sync_remote, wait, false);
+}
+
+bool SocketConnection::doGetData(BinaryDecoder& decoder) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> ids;
+  bool sync_remote = false, wait = false;
+  TRY_READ_BINARY_REQUEST(ReadGetDataRequestBinary, decoder, ids, sync_remote,
+                          wait);
+  return doGetDataImpl(ids, sync_remote, wait, true);
+}
+
+bool SocketConnection::doGetDataImpl(const std::vector<ObjectID>& ids,
+                                     const bool sync_remote, const bool wait,
+                                     const bool binary) {
+  auto self(shared_from_this());
+  double startTime = GetCurrentTime();
   RESPONSE_ON_ERROR(server_ptr_->GetData(
       ids, sync_remote, wait, [self]() { return self->running_.load(); },
-      [self, startTime](const Status& status, const json& tree) {
+      [self, startTime, binary](const Status& status, const json& tree) {
         std::string message_out;
-        if (status.ok()) {
+        if (status.ok() && binary) {
+          WriteGetDataReplyBinary(tree, message_out);
+        } else if (status.ok()) {
           WriteGetDataReply(tree, message_out);
         } else {
           LOG(ERROR) << status.ToString();
@@ -495,14 +867,28 @@ bool SocketConnection::doListData(const json& root) {
 bool SocketConnection::doCreateData(const json& root) {
   auto self(shared_from_this());
   json tree;
-  double startTime = GetCurrentTime();
   TRY_READ_REQUEST(ReadCreateDataRequest, root, tree);
+  return doCreateDataImpl(tree, false);
+}
+
+bool SocketConnection::doCreateData(BinaryDecoder& decoder) {
+  auto self(shared_from_this());
+  json tree;
+  TRY_READ_BINARY_REQUEST(ReadCreateDataRequestBinary, decoder, tree);
+  return doCreateDataImpl(tree, true);
+}
+
+bool SocketConnection::doCreateDataImpl(const json& tree, const bool binary) {
+  auto self(shared_from_this());
+  double startTime = GetCurrentTime();
   RESPONSE_ON_ERROR(server_ptr_->CreateData(
-      tree, [tree, self, startTime](const Status& status, const ObjectID id,
-                                    const Signature signature,
-                                    const InstanceID instance_id) {
+      tree, [tree, self, startTime, binary](
+                const Status& status, const ObjectID id,
+                const Signature signature, const InstanceID instance_id) {
         std::string message_out;
-        if (status.ok()) {
+        if (status.ok() && binary) {
+          WriteCreateDataReplyBinary(id, signature, instance_id, message_out);
+        } else if (status.ok()) {
           WriteCreateDataReply(id, signature, instance_id, message_out);
         } else {
           LOG(ERROR) << status.ToString();
@@ -666,7 +1052,18 @@ bool SocketConnection::doOpenStream(const json& root) {
   ObjectID stream_id;
   int64_t mode;
   TRY_READ_REQUEST(ReadOpenStreamRequest, root, stream_id, mode);
-  auto status = server_ptr_->GetStreamStore()->Open(stream_id, mode);
+  Status status;
+  size_t consumer = 0;
+  if ((mode & StreamStore::kReadMode) &&
+      stream_consumers_.find(stream_id) != stream_consumers_.end()) {
+    // each connection is a single consumer of the stream
+    status = Status::StreamOpened();
+  } else {
+    status = server_ptr_->GetStreamStore()->Open(stream_id, mode, consumer);
+  }
+  if (status.ok() && (mode & StreamStore::kReadMode)) {
+    stream_consumers_.emplace(stream_id, consumer);
+  }
   std::string message_out;
   if (status.ok()) {
     WriteOpenStreamReply(message_out);
@@ -683,28 +1080,82 @@ bool SocketConnection::doGetNextStreamChunk(const json& root) {
   ObjectID stream_id;
   size_t size;
   TRY_READ_REQUEST(ReadGetNextStreamChunkRequest, root, stream_id, size);
+  return doGetNextStreamChunkImpl(
+      stream_id, size, 1,
+      [](const std::vector<std::shared_ptr<Payload>>& objects,
+         std::string& message_out) {
+        auto object = objects[0];
+        WriteGetNextStreamChunkReply(object, message_out);
+      });
+}
+
+bool SocketConnection::doGetNextStreamChunk(BinaryDecoder& decoder) {
+  auto self(shared_from_this());
+  ObjectID stream_id;
+  size_t size;
+  TRY_READ_BINARY_REQUEST(ReadGetNextStreamChunkRequestBinary, decoder,
+                          stream_id, size);
+  return doGetNextStreamChunkImpl(
+      stream_id, size, 1,
+      [](const std::vector<std::shared_ptr<Payload>>& objects,
+         std::string& message_out) {
+        auto object = objects[0];
+        WriteGetNextStreamChunkReplyBinary(object, message_out);
+      });
+}
+
+bool SocketConnection::doGetNextStreamChunks(const json& root) {
+  auto self(shared_from_this());
+  ObjectID stream_id;
+  size_t size, count;
+  std::vector<size_t> used;
+  TRY_READ_REQUEST(ReadGetNextStreamChunksRequest, root, stream_id, size,
+                   count, used);
+  if (!used.empty()) {
+    RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Shrink(stream_id, used));
+  }
+  return doGetNextStreamChunkImpl(stream_id, size, count,
+                                  WriteGetNextStreamChunksReply);
+}
+
+bool SocketConnection::doGetNextStreamChunkImpl(
+    const ObjectID stream_id, const size_t size, const size_t count,
+    stream_chunks_reply_t write_reply) {
+  auto self(shared_from_this());
   RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Get(
-      stream_id, size, [self](const Status& status, const ObjectID chunk) {
+      stream_id, size, count,
+      [self, write_reply](const Status& status,
+                          const std::vector<ObjectID>& chunks) {
         std::string message_out;
-        if (status.ok()) {
-          std::shared_ptr<Payload> object;
-          RETURN_ON_ERROR(
-              self->server_ptr_->GetBulkStore()->Get(chunk, object));
-          WriteGetNextStreamChunkReply(object, message_out);
-          int store_fd = object->store_fd;
-          int data_size = object->data_size;
-          self->doWrite(
-              message_out, [self, store_fd, data_size](const Status& status) {
-                if (data_size > 0 &&
-                    self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-                  self->used_fds_.emplace(store_fd);
-                  send_fd(self->nativeHandle(), store_fd);
-                }
-                return Status::OK();
-              });
+        // the client is waiting for a reply, report failures rather than
+        // returning early from the callback
+        Status s = status;
+        std::vector<std::shared_ptr<Payload>> objects;
+        if (s.ok()) {
+          // pinned for the consumer, as the chunks may have been spilled
+          s = self->server_ptr_->GetBulkStore()->Pin(chunks, self->conn_id_,
+                                                     objects);
+        }
+        if (s.ok() && objects.size() != chunks.size()) {
+          s = Status::ObjectNotExists("Stream chunks have been deleted");
+        }
+        if (s.ok()) {
+          write_reply(objects, message_out);
+          self->doWrite(message_out, [self, objects](const Status& status) {
+            for (auto const& object : objects) {
+              int store_fd = object->store_fd;
+              int data_size = object->data_size;
+              if (data_size > 0 &&
+                  self->used_fds_.find(store_fd) == self->used_fds_.end()) {
+                self->used_fds_.emplace(store_fd);
+                send_fd(self->nativeHandle(), store_fd);
+              }
+            }
+            return Status::OK();
+          });
         } else {
-          LOG(ERROR) << status.ToString();
-          WriteErrorReply(status, message_out);
+          LOG(ERROR) << s.ToString();
+          WriteErrorReply(s, message_out);
           self->doWrite(message_out);
         }
         return Status::OK();
@@ -716,31 +1167,86 @@ bool SocketConnection::doPullNextStreamChunk(const json& root) {
   auto self(shared_from_this());
   ObjectID stream_id;
   TRY_READ_REQUEST(ReadPullNextStreamChunkRequest, root, stream_id);
-  this->associated_streams_.emplace(stream_id);
+  return doPullNextStreamChunkImpl(
+      stream_id, 1,
+      [](const std::vector<std::shared_ptr<Payload>>& objects,
+         std::string& message_out) {
+        auto object = objects[0];
+        WritePullNextStreamChunkReply(object, message_out);
+      });
+}
+
+bool SocketConnection::doPullNextStreamChunk(BinaryDecoder& decoder) {
+  auto self(shared_from_this());
+  ObjectID stream_id;
+  TRY_READ_BINARY_REQUEST(ReadPullNextStreamChunkRequestBinary, decoder,
+                          stream_id);
+  return doPullNextStreamChunkImpl(
+      stream_id, 1,
+      [](const std::vector<std::shared_ptr<Payload>>& objects,
+         std::string& message_out) {
+        auto object = objects[0];
+        WritePullNextStreamChunkReplyBinary(object, message_out);
+      });
+}
+
+bool SocketConnection::doPullNextStreamChunks(const json& root) {
+  auto self(shared_from_this());
+  ObjectID stream_id;
+  size_t count;
+  TRY_READ_REQUEST(ReadPullNextStreamChunksRequest, root, stream_id, count);
+  return doPullNextStreamChunkImpl(stream_id, count,
+                                   WritePullNextStreamChunksReply);
+}
+
+bool SocketConnection::doPullNextStreamChunkImpl(
+    const ObjectID stream_id, const size_t count,
+    stream_chunks_reply_t write_reply) {
+  auto self(shared_from_this());
+  auto consumer = stream_consumers_.find(stream_id);
+  if (consumer == stream_consumers_.end()) {
+    // pulling without opening the stream
+    size_t consumer_id = 0;
+    RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Open(
+        stream_id, StreamStore::kReadMode, consumer_id));
+    consumer = stream_consumers_.emplace(stream_id, consumer_id).first;
+  }
   RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Pull(
-      stream_id, [self](const Status& status, const ObjectID chunk) {
+      stream_id, consumer->second, count,
+      [self, write_reply](const Status& status,
+                          const std::vector<ObjectID>& chunks) {
         std::string message_out;
-        if (status.ok()) {
-          std::shared_ptr<Payload> object;
-          RETURN_ON_ERROR(
-              self->server_ptr_->GetBulkStore()->Get(chunk, object));
-          WritePullNextStreamChunkReply(object, message_out);
-          int store_fd = object->store_fd;
-          int data_size = object->data_size;
-          self->doWrite(
-              message_out, [self, store_fd, data_size](const Status& status) {
-                if (data_size > 0 &&
-                    self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-                  self->used_fds_.emplace(store_fd);
-                  send_fd(self->nativeHandle(), store_fd);
-                }
-                return Status::OK();
-              });
+        // the client is waiting for a reply, report failures rather than
+        // returning early from the callback
+        Status s = status;
+        std::vector<std::shared_ptr<Payload>> objects;
+        if (s.ok()) {
+          // pinned for the consumer, as the chunks may have been spilled
+          s = self->server_ptr_->GetBulkStore()->Pin(chunks, self->conn_id_,
+                                                     objects);
+        }
+        if (s.ok() && objects.size() != chunks.size()) {
+          s = Status::ObjectNotExists("Stream chunks have been deleted");
+        }
+        if (s.ok()) {
+          write_reply(objects, message_out);
+          self->doWrite(message_out, [self, objects](const Status& status) {
+            for (auto const& object : objects) {
+              int store_fd = object->store_fd;
+              int data_size = object->data_size;
+              if (data_size > 0 &&
+                  self->used_fds_.find(store_fd) == self->used_fds_.end()) {
+                self->used_fds_.emplace(store_fd);
+                send_fd(self->nativeHandle(), store_fd);
+              }
+            }
+            return Status::OK();
+          });
         } else {
-          if (!status.IsStreamDrained()) {
-            LOG(ERROR) << status.ToString();
+          if (!s.IsStreamDrained()) {
+            LOG(ERROR) << s.ToString();
           }
-          WriteErrorReply(status, message_out);
+          WriteErrorReply(s, message_out);
           self->doWrite(message_out);
         }
         return Status::OK();
@@ -752,7 +1258,11 @@ bool SocketConnection::doStopStream(const json& root) {
   auto self(shared_from_this());
   ObjectID stream_id;
   bool failed;
-  TRY_READ_REQUEST(ReadStopStreamRequest, root, stream_id, failed);
+  std::vector<size_t> used;
+  TRY_READ_REQUEST(ReadStopStreamRequest, root, stream_id, failed, used);
+  if (!used.empty()) {
+    RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Shrink(stream_id, used));
+  }
   // NB: don't erase the metadata from meta_service, since there's may
   // reader listen on this stream.
   RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Stop(stream_id, failed));
@@ -899,6 +1409,20 @@ bool SocketConnection::doInstanceStatus(const json& root) {
   return false;
 }
 
+bool SocketConnection::doGetDeletedObjects(const json& root) {
+  auto self(shared_from_this());
+  uint64_t since = 0, sequence = 0;
+  std::vector<ObjectID> ids;
+  bool overflow = false;
+  std::string message_out;
+
+  TRY_READ_REQUEST(ReadGetDeletedObjectsRequest, root, since);
+  server_ptr_->DeletedSince(since, sequence, ids, overflow);
+  WriteGetDeletedObjectsReply(sequence, ids, overflow, message_out);
+  this->doWrite(message_out);
+  return false;
+}
+
 bool SocketConnection::doMakeArena(const json& root) {
   auto self(shared_from_this());
   size_t size;
@@ -910,6 +1434,15 @@ bool SocketConnection::doMakeArena(const json& root) {
   }
   int store_fd = -1;
   uintptr_t base = reinterpret_cast<uintptr_t>(nullptr);
+  if (shared_pool_) {
+    // the arena lives in the shared pool that has been mapped by the client
+    ptrdiff_t offset = -1;
+    RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->MakeArenaInPool(
+        size, store_fd, base, offset));
+    WriteMakeArenaReply(store_fd, size, base, offset, message_out);
+    this->doWrite(message_out);
+    return false;
+  }
   RESPONSE_ON_ERROR(
       server_ptr_->GetBulkStore()->MakeArena(size, store_fd, base));
   WriteMakeArenaReply(store_fd, size, base, message_out);
@@ -947,7 +1480,28 @@ bool SocketConnection::doDebug(const json& root) {
   return false;
 }
 
+bool SocketConnection::doWriteChannel(const std::string& buf) {
+  // see also: Notes [Command Channel]
+  std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
+  auto& replies = channel_->replies();
+  bool pushed = replies.Push(buf.data(), buf.size());
+  // an empty message tells the client to read the reply from the socket
+  if (!pushed && !replies.Push(buf.data(), 0)) {
+    LOG(ERROR) << "The reply ring of the command channel is full, the client "
+                  "may have misbehaved";
+    doStop();
+    return true;
+  }
+  if (replies.ClearWaiting()) {
+    replies.Wake();
+  }
+  return pushed;
+}
+
 void SocketConnection::doWrite(const std::string& buf) {
+  if (channel_ != nullptr && doWriteChannel(buf)) {
+    return;
+  }
   std::string to_send;
   size_t length = buf.size();
   to_send.resize(length + sizeof(size_t));
@@ -963,6 +1517,11 @@ void SocketConnection::doWrite(const std::string& buf) {
 }
 
 void SocketConnection::doWrite(const std::string& buf, callback_t<> callback) {
+  if (channel_ != nullptr && doWriteChannel(buf)) {
+    // the callback (e.g., sending fds) still goes after pending writes
+    doAsyncWrite(callback);
+    return;
+  }
   std::string to_send;
   size_t length = buf.size();
   to_send.resize(length + sizeof(size_t));
@@ -978,6 +1537,10 @@ void SocketConnection::doWrite(const std::string& buf, callback_t<> callback) {
 }
 
 void SocketConnection::doWrite(std::string&& buf) {
+  if (channel_ != nullptr) {
+    // the message has already been framed, send it via the socket
+    doWriteChannel(std::string());
+  }
   {
     std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
     write_msgs_.push_back(std::move(buf));
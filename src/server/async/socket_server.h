@@ -17,7 +17,9 @@ limitations under the License.
 #define SRC_SERVER_ASYNC_SOCKET_SERVER_H_
 
 #include <atomic>
+#include <chrono>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -27,6 +29,7 @@ limitations under the License.
 
 #include "boost/asio.hpp"
 
+#include "common/memory/command_channel.h"
 #include "common/util/protocols.h"
 #include "server/async/socket_server.h"
 #include "server/server/vineyard_server.h"
@@ -61,6 +64,8 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doGetBuffers(const json& root);
 
+  bool doGetBuffers(BinaryDecoder& decoder);
+
   /**
    * @brief doGetRemoteBuffers differs from doGetRemoteBuffers, that the
    * content of blob is in the response body, rather than via memory sharing.
@@ -69,6 +74,12 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doCreateBuffer(const json& root);
 
+  bool doCreateBuffer(BinaryDecoder& decoder);
+
+  bool doCreateBuffers(const json& root);
+
+  bool doCreateBuffers(BinaryDecoder& decoder);
+
   /**
    * @brief doCreateBuffer differs from doCreateRemoteBuffer, that the content
    * of blob is in the request body, rather than via memory sharing.
@@ -77,12 +88,20 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doDropBuffer(const json& root);
 
+  bool doDropBuffer(BinaryDecoder& decoder);
+
+  bool doReleaseBuffers(const json& root);
+
   bool doGetData(const json& root);
 
+  bool doGetData(BinaryDecoder& decoder);
+
   bool doListData(const json& root);
 
   bool doCreateData(const json& root);
 
+  bool doCreateData(BinaryDecoder& decoder);
+
   bool doPersist(const json& root);
 
   bool doIfPersist(const json& root);
@@ -101,8 +120,16 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doGetNextStreamChunk(const json& root);
 
+  bool doGetNextStreamChunk(BinaryDecoder& decoder);
+
   bool doPullNextStreamChunk(const json& root);
 
+  bool doPullNextStreamChunk(BinaryDecoder& decoder);
+
+  bool doGetNextStreamChunks(const json& root);
+
+  bool doPullNextStreamChunks(const json& root);
+
   bool doStopStream(const json& root);
 
   bool doPutName(const json& root);
@@ -117,6 +144,8 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doInstanceStatus(const json& root);
 
+  bool doGetDeletedObjects(const json& root);
+
   bool doMakeArena(const json& root);
 
   bool doFinalizeArena(const json& root);
@@ -134,10 +163,66 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
    */
   bool processMessage(const std::string& message_in);
 
+  /**
+   * @brief Handle messages in the binary protocol, see also
+   * Notes [Binary Protocol].
+   */
+  bool processBinaryMessage(const std::string& message_in);
+
+  // The implementation of commands that shared by both JSON and the binary
+  // protocol, replies are encoded in the same way as the request.
+
+  bool doGetBuffersImpl(const std::vector<ObjectID>& ids, const bool binary);
+
+  bool doCreateBufferImpl(const size_t size, const bool binary);
+
+  bool doCreateBuffersImpl(const std::vector<size_t>& sizes,
+                           const bool binary);
+
+  /**
+   * @brief Collect the store fds of the payloads that haven't been sent to
+   * the client yet, and mark them as sent, see also Notes [Creating Buffers
+   * in Bulk] in "common/util/protocols.h".
+   */
+  std::vector<int> newStoreFds(
+      const std::vector<std::shared_ptr<Payload>>& objects);
+
+  bool doDropBufferImpl(const ObjectID object_id, const bool binary);
+
+  bool doGetDataImpl(const std::vector<ObjectID>& ids, const bool sync_remote,
+                     const bool wait, const bool binary);
+
+  bool doCreateDataImpl(const json& tree, const bool binary);
+
+  using stream_chunks_reply_t = std::function<void(
+      const std::vector<std::shared_ptr<Payload>>&, std::string&)>;
+
+  bool doGetNextStreamChunkImpl(const ObjectID stream_id, const size_t size,
+                                const size_t count,
+                                stream_chunks_reply_t write_reply);
+
+  bool doPullNextStreamChunkImpl(const ObjectID stream_id, const size_t count,
+                                 stream_chunks_reply_t write_reply);
+
   void doReadHeader();
 
   void doReadBody();
 
+  /**
+   * @brief Serve the request ring of the command channel, which runs in a
+   * dedicated thread until the connection is stopped, see also Notes [Command
+   * Channel].
+   */
+  void pollChannel();
+
+  /**
+   * @brief Push the reply into the reply ring of the command channel.
+   *
+   * @return Returns false if the reply doesn't fit into the ring and should
+   * be sent via the socket.
+   */
+  bool doWriteChannel(const std::string& buf);
+
   void doWrite(const std::string& buf);
 
   void doWrite(std::string&& buf);
@@ -165,14 +250,23 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
   SocketServer* socket_server_ptr_;
   int conn_id_;
   std::atomic_bool running_;
+  // whether the binary protocol has been negotiated with the client
+  bool binary_protocol_;
+  // whether the shared memory pool has been mapped by the client
+  bool shared_pool_;
+  // the request/reply rings, see also Notes [Command Channel]
+  std::shared_ptr<CommandChannel> channel_;
+  // how long the poller spins before waiting, in microseconds
+  int64_t channel_spin_us_;
 
   asio::streambuf buf_;
   socket_message_queue_t write_msgs_;
   std::recursive_mutex write_msgs_mutex_;  // protect the write_msgs
 
   std::unordered_set<int> used_fds_;
-  // the associated reader of the stream
-  std::unordered_set<ObjectID> associated_streams_;
+  // the consumers of streams registered by this connection, see also
+  // Notes [Stream Fan-out] in "server/memory/stream_store.h".
+  std::unordered_map<ObjectID, size_t> stream_consumers_;
 
   size_t read_msg_header_;
   std::string read_msg_body_;
@@ -91,6 +91,22 @@ void BulkAllocator::Free(void* mem, size_t bytes) {
   allocated_ -= bytes;
 }
 
+bool BulkAllocator::Shrink(void* mem, size_t bytes, size_t new_bytes) {
+  if (new_bytes >= bytes) {
+    return false;
+  }
+#if defined(WITH_DLMALLOC)
+  bool shrunk = Allocator::ReallocateInPlace(mem, new_bytes) == mem;
+#endif
+#if defined(WITH_JEMALLOC)
+  bool shrunk = allocator_.ReallocateInPlace(mem, new_bytes) < bytes;
+#endif
+  if (shrunk) {
+    allocated_ -= bytes - new_bytes;
+  }
+  return shrunk;
+}
+
 void BulkAllocator::SetFootprintLimit(size_t bytes) {
   footprint_limit_ = static_cast<int64_t>(bytes);
 }
@@ -59,6 +59,15 @@ class BulkAllocator {
   /// \param bytes Number of bytes to be freed.
   static void Free(void* mem, size_t bytes);
 
+  /// Shrinks the memory space pointed to by mem in place, the tail part is
+  /// given back to the allocator and the memory won't be moved.
+  ///
+  /// \param mem Pointer to memory to shrink.
+  /// \param bytes Number of bytes that has been allocated.
+  /// \param new_bytes Number of bytes to keep.
+  /// \return Whether the memory has been shrunk.
+  static bool Shrink(void* mem, size_t bytes, size_t new_bytes);
+
   /// Sets the memory footprint limit for Plasma.
   ///
   /// \param bytes Plasma memory footprint limit in bytes.
@@ -103,8 +103,6 @@ void* fake_mmap(size_t size) {
   // fake_mmap are never contiguous.
   size += kMmapRegionsGap;
 
-  int fd = create_buffer(size);
-  CHECK_GE(fd, 0) << "Failed to create buffer during mmap";
   // MAP_POPULATE can be used to pre-populate the page tables for this memory
   // region
   // which avoids work when accessing the pages later. However it causes long
@@ -118,10 +116,12 @@ void* fake_mmap(size_t size) {
 #endif
   }
 
-  void* pointer = mmap(NULL, size, PROT_READ | PROT_WRITE, mmap_flag, fd, 0);
-  if (pointer == MAP_FAILED) {
-    LOG(ERROR) << "mmap failed with error: " << strerror(errno);
-    return pointer;
+  // the mapped size may be rounded up to the huge page size.
+  int64_t mapped_size = size;
+  void* pointer = MAP_FAILED;
+  int fd = create_mapped_buffer(mapped_size, pointer, mmap_flag);
+  if (fd < 0) {
+    return MAP_FAILED;
   }
 
   // Increase dlmalloc's allocation granularity directly.
@@ -129,7 +129,7 @@ void* fake_mmap(size_t size) {
 
   MmapRecord& record = mmap_records[pointer];
   record.fd = fd;
-  record.size = size;
+  record.size = mapped_size;
 
   // We lie to dlmalloc about where mapped memory actually lives.
   pointer = pointer_advance(pointer, kMmapRegionsGap);
@@ -142,13 +142,15 @@ int fake_munmap(void* addr, int64_t size) {
 
   auto entry = mmap_records.find(addr);
 
-  if (entry == mmap_records.end() || entry->second.size != size) {
+  if (entry == mmap_records.end() ||
+      (entry->second.size != size &&
+       entry->second.size != buffer_mapped_size(size))) {
     // Reject requests to munmap that don't directly match previous
     // calls to mmap, to prevent dlmalloc from trimming.
     return -1;
   }
 
-  int r = munmap(addr, size);
+  int r = munmap(addr, entry->second.size);
   if (r == 0) {
     close(entry->second.fd);
   }
@@ -175,6 +177,10 @@ void* DLmallocAllocator::Allocate(const size_t bytes, const size_t alignment) {
 
 void DLmallocAllocator::Free(void* pointer, size_t) { dlfree(pointer); }
 
+void* DLmallocAllocator::ReallocateInPlace(void* pointer, const size_t size) {
+  return dlrealloc_in_place(pointer, size);
+}
+
 void DLmallocAllocator::SetMallocGranularity(int value) {
   change_mparam(M_GRANULARITY, value);
 }
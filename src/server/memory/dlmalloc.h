@@ -32,6 +32,8 @@ class DLmallocAllocator {
 
   static void Free(void* pointer, size_t = 0);
 
+  static void* ReallocateInPlace(void* pointer, const size_t size);
+
   static void SetMallocGranularity(int value);
 };
 
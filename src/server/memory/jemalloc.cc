@@ -26,15 +26,16 @@ namespace memory {
 
 void* JemallocAllocator::Init(const size_t size) {
   // create memory using mmap
-  int fd = create_buffer(size);
-  void* space = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-  if (space == nullptr) {
-    return space;
+  int64_t mapped_size = size;
+  void* space = nullptr;
+  int fd = create_mapped_buffer(mapped_size, space, MAP_SHARED);
+  if (fd < 0) {
+    return nullptr;
   }
 
   MmapRecord& record = mmap_records[space];
   record.fd = fd;
-  record.size = size;
+  record.size = mapped_size;
 
   return Jemalloc::Init(space, size);
 }
@@ -28,8 +28,18 @@
 
 #include "server/memory/malloc.h"
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#if defined(__linux__)
+#include <sys/vfs.h>
+#endif
+#include <unistd.h>
 
+#include <fstream>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -91,6 +101,168 @@ int create_buffer(int64_t size) {
   return fd;
 }
 
+enum class HugePages { kNone, kTransparent, kMemfd, kHugetlbfs };
+
+static HugePages huge_pages_mode = HugePages::kNone;
+static std::string huge_pages_dir;
+static size_t huge_pages_size = 0;
+
+#if defined(__linux__)
+constexpr int64_t kHugetlbfsMagic = 0x958458f6;
+
+// The default huge page size, from "Hugepagesize:" in /proc/meminfo.
+static size_t default_huge_page_size() {
+  std::ifstream meminfo("/proc/meminfo");
+  std::string key;
+  size_t value = 0;
+  while (meminfo >> key) {
+    if (key == "Hugepagesize:" && meminfo >> value) {
+      return value * 1024;  // in kB
+    }
+    meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  }
+  return 0;
+}
+#endif
+
+Status SetHugePages(const std::string& huge_pages) {
+  huge_pages_mode = HugePages::kNone;
+  huge_pages_dir.clear();
+  huge_pages_size = 0;
+  if (huge_pages.empty()) {
+    return Status::OK();
+  }
+#if defined(__linux__)
+  if (huge_pages == "thp") {
+#if defined(MADV_HUGEPAGE)
+    huge_pages_mode = HugePages::kTransparent;
+    LOG(INFO) << "Using transparent huge pages for the shared memory";
+    return Status::OK();
+#else
+    return Status::NotImplemented(
+        "transparent huge pages is not supported on this platform");
+#endif
+  }
+  if (huge_pages == "memfd") {
+#if defined(MFD_HUGETLB)
+    huge_pages_size = default_huge_page_size();
+    if (huge_pages_size == 0) {
+      return Status::Invalid("huge pages is not supported by the kernel");
+    }
+    huge_pages_mode = HugePages::kMemfd;
+    LOG(INFO) << "Using hugetlb pages (memfd) of size " << huge_pages_size
+              << " for the shared memory";
+    return Status::OK();
+#else
+    return Status::NotImplemented(
+        "memfd with huge pages is not supported on this platform");
+#endif
+  }
+  struct statfs stat;
+  if (statfs(huge_pages.c_str(), &stat) != 0) {
+    return Status::IOError("Failed to stat the hugetlbfs '" + huge_pages +
+                           "': " + strerror(errno));
+  }
+  if (static_cast<int64_t>(stat.f_type) != kHugetlbfsMagic) {
+    return Status::Invalid("'" + huge_pages +
+                           "' is not a mount point of hugetlbfs, expect "
+                           "'thp', 'memfd' or a hugetlbfs directory");
+  }
+  huge_pages_mode = HugePages::kHugetlbfs;
+  huge_pages_dir = huge_pages;
+  huge_pages_size = stat.f_bsize;
+  LOG(INFO) << "Using hugetlb pages of size " << huge_pages_size << " in '"
+            << huge_pages_dir << "' for the shared memory";
+  return Status::OK();
+#else
+  return Status::NotImplemented("huge pages is only supported on Linux");
+#endif
+}
+
+size_t huge_page_size() { return huge_pages_size; }
+
+size_t buffer_page_size() {
+  if (huge_pages_size != 0) {
+    return huge_pages_size;
+  }
+  return static_cast<size_t>(getpagesize());
+}
+
+int64_t buffer_mapped_size(int64_t size) {
+  if (huge_pages_size == 0) {
+    return size;
+  }
+  int64_t alignment = static_cast<int64_t>(huge_pages_size);
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+// Create a memory file in the hugetlb pool, returns -1 on failures.
+static int create_hugetlb_buffer(int64_t size) {
+  int fd = -1;
+#if defined(__linux__)
+  if (huge_pages_mode == HugePages::kMemfd) {
+#if defined(MFD_HUGETLB)
+    fd = memfd_create("vineyard-bulk", MFD_HUGETLB | MFD_CLOEXEC);
+#endif
+  } else if (huge_pages_mode == HugePages::kHugetlbfs) {
+    std::string file_template = huge_pages_dir + "/vineyard-bulk-XXXXXX";
+    std::vector<char> file_name(file_template.begin(), file_template.end());
+    file_name.push_back('\0');
+    fd = mkstemp(&file_name[0]);
+    if (fd >= 0 && unlink(&file_name[0]) != 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  if (fd >= 0 && ftruncate(fd, (off_t) size) != 0) {
+    close(fd);
+    fd = -1;
+  }
+#endif
+  return fd;
+}
+
+int create_mapped_buffer(int64_t& size, void*& pointer,
+                         const int mmap_flag) {
+  pointer = MAP_FAILED;
+  if (huge_pages_size != 0) {
+    int64_t mapped_size = buffer_mapped_size(size);
+    int fd = create_hugetlb_buffer(mapped_size);
+    if (fd >= 0) {
+      pointer = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, mmap_flag, fd,
+                     0);
+      if (pointer != MAP_FAILED) {
+        size = mapped_size;
+        return fd;
+      }
+      close(fd);
+    }
+    // the hugetlb pool is reserved at mmap, thus fails here if exhausted
+    LOG(WARNING) << "Failed to allocate " << mapped_size
+                 << " bytes of hugetlb pages (" << strerror(errno)
+                 << "), fallback to regular pages";
+  }
+
+  int fd = create_buffer(size);
+  if (fd < 0) {
+    return -1;
+  }
+  pointer = mmap(NULL, size, PROT_READ | PROT_WRITE, mmap_flag, fd, 0);
+  if (pointer == MAP_FAILED) {
+    LOG(ERROR) << "mmap failed with error: " << strerror(errno);
+    close(fd);
+    return -1;
+  }
+#if defined(MADV_HUGEPAGE)
+  if (huge_pages_mode == HugePages::kTransparent &&
+      madvise(pointer, size, MADV_HUGEPAGE) != 0) {
+    LOG(WARNING) << "Failed to enable transparent huge pages: "
+                 << strerror(errno);
+  }
+#endif
+  return fd;
+}
+
 void GetMallocMapinfo(void* addr, int* fd, int64_t* map_size,
                       ptrdiff_t* offset) {
   // About the efficiences: the records size usually small, thus linear search
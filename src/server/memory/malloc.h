@@ -32,8 +32,11 @@
 #include <inttypes.h>
 #include <stddef.h>
 
+#include <string>
 #include <unordered_map>
 
+#include "common/util/status.h"
+
 namespace vineyard {
 
 namespace memory {
@@ -60,6 +63,61 @@ extern std::unordered_map<void*, MmapRecord> mmap_records;
 // Returns a fd as expected.
 int create_buffer(int64_t size);
 
+/**
+ * Notes [Huge Pages]:
+ *
+ * The bulk shared memory pool and the arenas can be backed by huge pages to
+ * cut the TLB misses when scanning large blobs, selected by `--huge_pages`:
+ *
+ * - "thp": memory files in /dev/shm as before, and `madvise(MADV_HUGEPAGE)`
+ *   on the mapping, which takes effect when the shmem transparent huge pages
+ *   is enabled (/sys/kernel/mm/transparent_hugepage/shmem_enabled),
+ * - "memfd": `memfd_create(MFD_HUGETLB)`, with pages from the hugetlb pool
+ *   (vm.nr_hugepages) of the default huge page size,
+ * - otherwise, a directory where a hugetlbfs is mounted, e.g.,
+ *   "/dev/hugepages".
+ *
+ * For hugetlb pages, memory files and mappings must be multiples of the huge
+ * page size, thus the mapped sizes are rounded up, the granularity of the
+ * allocator and the alignment of arenas are raised to the huge page size as
+ * well. The hugetlb pool is only reserved when the file is mapped, if that
+ * fails (e.g., the pool is exhausted), the buffer falls back to regular pages
+ * with a warning.
+ *
+ * Clients map the memory files as before, the kernel places mappings of
+ * hugetlb files at addresses that are aligned to the huge page size.
+ */
+
+/**
+ * @brief Use huge pages for buffers that are created by
+ * `create_mapped_buffer` after that, see also Notes [Huge Pages].
+ */
+Status SetHugePages(const std::string& huge_pages);
+
+/**
+ * @brief The size of hugetlb pages that backs the buffers, or 0 if hugetlb
+ * isn't used.
+ */
+size_t huge_page_size();
+
+/**
+ * @brief The alignment of mapped regions of buffers, i.e., the size of
+ * hugetlb pages if enabled, otherwise the system page size.
+ */
+size_t buffer_page_size();
+
+/**
+ * @brief The size of the mapped region for a buffer of `size` bytes.
+ */
+int64_t buffer_mapped_size(int64_t size);
+
+// Create a buffer of at least `size` bytes and map it, with huge pages if
+// enabled. `size` is updated to the size of the mapped region.
+//
+// Returns a fd as expected, or -1 on failures.
+int create_mapped_buffer(int64_t& size, void*& pointer,
+                         const int mmap_flag);
+
 }  // namespace memory
 
 }  // namespace vineyard
@@ -28,18 +28,31 @@
 
 #include "server/memory/memory.h"
 
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+
 #include "server/memory/allocator.h"
 #include "server/memory/malloc.h"
 
+#if defined(WITH_DLMALLOC)
+#include "server/memory/dlmalloc.h"
+#endif
+
 namespace vineyard {
 
 using memory::GetMallocMapinfo;
@@ -47,10 +60,17 @@ using memory::kBlockSize;
 
 namespace memory {
 
-static inline size_t system_page_size() {
-  return (size_t) sysconf(_SC_PAGESIZE);
+// a special marker for obtaining the whole shared memory range, see also
+// BulkStore::PreAllocate().
+static inline ObjectID placeholder_blob_id() {
+  return GenerateBlobID(
+      reinterpret_cast<void*>(std::numeric_limits<uintptr_t>::max()));
 }
 
+// the huge page size if the shared memory is backed by hugetlb pages, as
+// madvise(...) requires such alignment, see also Notes [Huge Pages].
+static inline size_t system_page_size() { return buffer_page_size(); }
+
 static inline uintptr_t align_up(const uintptr_t address,
                                  const size_t alignment) {
   return (address + alignment - 1) & ~(alignment - 1);
@@ -124,10 +144,77 @@ static void recycle_arena(const uintptr_t base, const size_t size,
     head = next;
   }
 }
+
+static Status write_spill_file(const std::string& path, const uint8_t* data,
+                               const size_t size) {
+  int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+  if (fd == -1) {
+    return Status::IOError("Failed to open spill file '" + path +
+                           "': " + strerror(errno));
+  }
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t nbytes = write(fd, data + offset, size - offset);
+    if (nbytes == -1 && errno == EINTR) {
+      continue;
+    }
+    if (nbytes <= 0) {
+      int err = errno;
+      close(fd);
+      unlink(path.c_str());
+      return Status::IOError("Failed to write spill file '" + path +
+                             "': " + strerror(err));
+    }
+    offset += nbytes;
+  }
+  close(fd);
+  return Status::OK();
+}
+
+static Status read_spill_file(const std::string& path, uint8_t* data,
+                              const size_t size) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return Status::IOError("Failed to open spill file '" + path +
+                           "': " + strerror(errno));
+  }
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t nbytes = pread(fd, data + offset, size - offset, offset);
+    if (nbytes == -1 && errno == EINTR) {
+      continue;
+    }
+    if (nbytes <= 0) {
+      int err = nbytes == 0 ? EIO : errno;
+      close(fd);
+      return Status::IOError("Failed to read spill file '" + path +
+                             "': " + strerror(err));
+    }
+    offset += nbytes;
+  }
+  close(fd);
+  return Status::OK();
+}
 }  // namespace memory
 
 std::set<ObjectID> BulkStore::Arena::spans{};
 
+constexpr int BulkStore::kAnonymousOwner;
+constexpr size_t BulkStore::kReservedHeadSize;
+
+BulkStore::BulkStore()
+    : small_blobs_(
+          [this](const size_t size) -> uint8_t* {
+            int fd = -1;
+            int64_t map_size = 0;
+            ptrdiff_t offset = 0;
+            return AllocateAligned(size, memory::system_page_size(), &fd,
+                                   &map_size, &offset);
+          },
+          [](uint8_t* pointer, const size_t size) {
+            BulkAllocator::Free(pointer, size);
+          }) {}
+
 BulkStore::~BulkStore() {
   std::vector<ObjectID> object_ids;
   object_ids.reserve(objects_.size());
@@ -139,6 +226,18 @@ BulkStore::~BulkStore() {
   }
 }
 
+Status BulkStore::SetHugePages(const std::string& huge_pages) {
+  RETURN_ON_ERROR(memory::SetHugePages(huge_pages));
+#if defined(WITH_DLMALLOC)
+  if (memory::huge_page_size() != 0) {
+    // grow the pool in units of huge pages
+    memory::DLmallocAllocator::SetMallocGranularity(
+        static_cast<int>(memory::huge_page_size()));
+  }
+#endif
+  return Status::OK();
+}
+
 Status BulkStore::PreAllocate(const size_t size) {
   BulkAllocator::SetFootprintLimit(size);
   void* pointer = BulkAllocator::Init(size);
@@ -149,8 +248,7 @@ Status BulkStore::PreAllocate(const size_t size) {
   }
 
   // insert a special marker for obtaining the whole shared memory range
-  ObjectID object_id = GenerateBlobID(
-      reinterpret_cast<void*>(std::numeric_limits<uintptr_t>::max()));
+  ObjectID object_id = memory::placeholder_blob_id();
   int fd = -1;
   int64_t map_size = 0;
   ptrdiff_t offset = 0;
@@ -162,21 +260,113 @@ Status BulkStore::PreAllocate(const size_t size) {
   return Status::OK();
 }
 
+Status BulkStore::SetSpillPolicy(const std::string& spill_path,
+                                 const double spill_lower_rate) {
+  if (spill_path.empty()) {
+    spill_path_.clear();
+    return Status::OK();
+  }
+  if (spill_lower_rate < 0 || spill_lower_rate > 1) {
+    return Status::Invalid(
+        "The spill lower rate should be in [0, 1], but got " +
+        std::to_string(spill_lower_rate));
+  }
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(spill_path, ec);
+  if (ec || !boost::filesystem::is_directory(spill_path)) {
+    return Status::IOError("Failed to prepare the spill directory '" +
+                           spill_path + "': " + ec.message());
+  }
+  spill_path_ = spill_path;
+  spill_lower_rate_ = spill_lower_rate;
+  LOG(INFO) << "Cold blobs will be spilled to '" << spill_path_ << "'";
+  return Status::OK();
+}
+
+Status BulkStore::SetSmallBlobSize(const size_t size) {
+  small_blobs_.SetMaxSize(size);
+  if (small_blobs_.MaxSize() > 0) {
+    LOG(INFO) << "Blobs no larger than " << small_blobs_.MaxSize()
+              << " bytes will be allocated from slabs";
+  }
+  return Status::OK();
+}
+
 // Allocate memory
 uint8_t* BulkStore::AllocateMemory(size_t size, int* fd, int64_t* map_size,
                                    ptrdiff_t* offset) {
+  auto start = std::chrono::steady_clock::now();
   // Try to evict objects until there is enough space.
   uint8_t* pointer = nullptr;
-  pointer =
-      reinterpret_cast<uint8_t*>(BulkAllocator::Memalign(size, kBlockSize));
+  pointer = AllocateBlob(size, fd, map_size, offset);
+  while (pointer == nullptr && !spill_path_.empty()) {
+    size_t spilled = 0;
+    auto status = SpillColdObjects(size, spilled);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to spill cold objects: " << status.ToString();
+      break;
+    }
+    if (spilled == 0) {
+      break;
+    }
+    pointer = AllocateBlob(size, fd, map_size, offset);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  auto& latency =
+      small_blobs_.Fits(size) ? small_alloc_latency_ : large_alloc_latency_;
+  latency.count += 1;
+  latency.nanoseconds += elapsed;
+  return pointer;
+}
+
+uint8_t* BulkStore::AllocateBlob(const size_t size, int* fd,
+                                 int64_t* map_size, ptrdiff_t* offset) {
+  if (!small_blobs_.Fits(size)) {
+    return AllocateAligned(size, kBlockSize, fd, map_size, offset);
+  }
+  // see also: Notes [Small Blob Allocator] in "server/memory/slab_allocator.h"
+  uint8_t* pointer = small_blobs_.Allocate(size);
+  if (pointer != nullptr) {
+    GetMallocMapinfo(pointer, fd, map_size, offset);
+  }
+  return pointer;
+}
+
+void BulkStore::FreeBlob(uint8_t* pointer, const size_t size) {
+  if (small_blobs_.Fits(size) && small_blobs_.Free(pointer, size)) {
+    return;
+  }
+  BulkAllocator::Free(pointer, size);
+}
+
+bool BulkStore::ShrinkBlob(uint8_t* pointer, const size_t size,
+                           const size_t new_size) {
+  if (small_blobs_.Fits(size) && small_blobs_.Owns(pointer)) {
+    return small_blobs_.Shrink(pointer, size, new_size);
+  }
+  return BulkAllocator::Shrink(pointer, size, new_size);
+}
+
+uint8_t* BulkStore::AllocateAligned(const size_t size, const size_t alignment,
+                                    int* fd, int64_t* map_size,
+                                    ptrdiff_t* offset) {
+  uint8_t* pointer =
+      reinterpret_cast<uint8_t*>(BulkAllocator::Memalign(size, alignment));
   if (pointer) {
     GetMallocMapinfo(pointer, fd, map_size, offset);
+    // see also: Notes [Shared Memory Pool]
+    if (shared_pool_ && *fd != shared_pool_fd_) {
+      BulkAllocator::Free(pointer, size);
+      pointer = nullptr;
+    }
   }
   return pointer;
 }
 
 Status BulkStore::Create(const size_t data_size, ObjectID& object_id,
-                         std::shared_ptr<Payload>& object) {
+                         std::shared_ptr<Payload>& object, const int owner) {
   if (data_size == 0) {
     object_id = EmptyBlobID();
     object = Payload::MakeEmpty();
@@ -187,13 +377,43 @@ Status BulkStore::Create(const size_t data_size, ObjectID& object_id,
   ptrdiff_t offset = 0;
   uint8_t* pointer = nullptr;
   pointer = AllocateMemory(data_size, &fd, &map_size, &offset);
+  /**
+   * Notes [Blob ID of Spilled Blobs]:
+   *
+   * The blob id is derived from the address of the blob, while spilled (and
+   * reloaded) blobs keep their original ids after the memory has been freed.
+   * When a blob is spilled, its memory is shrunk in place to a tiny head
+   * rather than freed, and the head is kept until the blob is deleted, thus
+   * the address (and the id) won't be handed out again.
+   *
+   * The head cannot always be kept (e.g., blobs in slabs), hence the
+   * allocator may still return an address that would conflict with an
+   * existing blob, in which case we hold the memory aside and try again.
+   */
+  std::vector<uint8_t*> conflicts;
+  while (pointer != nullptr && objects_.count(GenerateBlobID(pointer))) {
+    conflicts.emplace_back(pointer);
+    pointer = AllocateMemory(data_size, &fd, &map_size, &offset);
+  }
+  for (auto conflict : conflicts) {
+    FreeBlob(conflict, data_size);
+  }
   if (pointer == nullptr) {
     return Status::NotEnoughMemory("size = " + std::to_string(data_size));
   }
   object_id = GenerateBlobID(pointer);
   object = std::make_shared<Payload>(object_id, data_size, pointer, fd,
                                      map_size, offset);
-  objects_.emplace(object_id, object);
+  // pinned by the creator
+  object->ref_cnt = 1;
+  pinned_size_ += data_size;
+  {
+    std::lock_guard<std::mutex> pin_guard(pin_mutex_);
+    objects_.emplace(object_id, object);
+    if (owner != kAnonymousOwner) {
+      pinned_blobs_[owner].emplace(object_id);
+    }
+  }
 #ifndef NDEBUG
   VLOG(10) << "after allocate: " << ObjectIDToString(object_id) << ": "
            << Footprint() << "(" << FootprintLimit() << ")";
@@ -234,19 +454,49 @@ Status BulkStore::Get(const std::vector<ObjectID>& ids,
 Status BulkStore::Delete(const ObjectID& object_id) {
   // see also: BulkStore::PreAllocate().
   if (object_id == EmptyBlobID() ||
-      object_id == GenerateBlobID(reinterpret_cast<void*>(
-                       std::numeric_limits<uintptr_t>::max()))) {
+      object_id == memory::placeholder_blob_id()) {
     return Status::OK();
   }
+  std::unique_lock<std::recursive_mutex> spill_guard(spill_mutex_,
+                                                     std::defer_lock);
+  if (!spill_path_.empty()) {
+    spill_guard.lock();
+    auto iter = cold_objects_index_.find(object_id);
+    if (iter != cold_objects_index_.end()) {
+      cold_objects_.erase(iter->second);
+      cold_objects_index_.erase(iter);
+    }
+  }
+  std::lock_guard<std::mutex> pin_guard(pin_mutex_);
   object_map_t::const_accessor accessor;
   if (!objects_.find(accessor, object_id)) {
     return Status::ObjectNotExists("delete: id = " +
                                    ObjectIDToString(object_id));
   }
   auto& object = accessor->second;
-  if (object->arena_fd == -1) {
+  if (object->ref_cnt > 0) {
+    pinned_size_ -= object->data_size;
+    // the id may be reused by a new blob at the same address, see also
+    // Notes [Blob Reference Counting]
+    for (auto& item : pinned_blobs_) {
+      item.second.erase(object_id);
+    }
+  }
+  auto head = reserved_heads_.find(object_id);
+  if (head != reserved_heads_.end()) {
+    FreeBlob(head->second, kReservedHeadSize);
+    reserved_heads_.erase(head);
+  }
+  if (object->is_spilled) {
+    auto spill_file = SpillFilePath(object_id);
+    if (unlink(spill_file.c_str()) != 0) {
+      LOG(WARNING) << "Failed to remove spill file '" << spill_file
+                   << "': " << strerror(errno);
+    }
+    spilled_size_ -= object->data_size;
+  } else if (object->arena_fd == -1) {
     auto buff_size = object->data_size;
-    BulkAllocator::Free(object->pointer, buff_size);
+    FreeBlob(object->pointer, buff_size);
 #ifndef NDEBUG
     VLOG(10) << "after free: " << ObjectIDToString(object_id) << ": "
              << Footprint() << "(" << FootprintLimit() << ")";
@@ -257,8 +507,12 @@ Status BulkStore::Delete(const ObjectID& object_id) {
     uintptr_t lower = memory::align_down(pointer, page_size),
               upper = memory::align_up(pointer, page_size);
     uintptr_t lower_bound = lower, upper_bound = upper;
+    std::lock_guard<std::mutex> arena_guard(arena_mutex_);
     {
       auto iter = Arena::spans.find(object_id);
+      if (iter == Arena::spans.end()) {
+        return Status::Invalid("Internal state error: arena span not found");
+      }
       if (iter != Arena::spans.begin()) {
         auto iter_prev = std::prev(iter);
         object_map_t::const_accessor accessor;
@@ -282,6 +536,7 @@ Status BulkStore::Delete(const ObjectID& object_id) {
         upper_bound = memory::align_down(
             reinterpret_cast<uintptr_t>(object_next->pointer), page_size);
       }
+      Arena::spans.erase(iter);
     }
     if (std::max(lower, lower_bound) < std::min(upper, upper_bound)) {
 #ifndef NDEBUG
@@ -292,32 +547,436 @@ Status BulkStore::Delete(const ObjectID& object_id) {
       memory::recycle_resident_memory(std::max(lower, lower_bound),
                                       std::min(upper, upper_bound));
     }
+    ReleasePooledArenaBlob(pointer);
   }
   objects_.erase(accessor);
   return Status::OK();
 }
 
+Status BulkStore::Shrink(const ObjectID id, const size_t size,
+                         ObjectID& shrunk_id) {
+  std::shared_ptr<Payload> object;
+  shrunk_id = id;
+  {
+    // the payload is modified in place, and must not be spilled meanwhile
+    object_map_t::accessor accessor;
+    if (!objects_.find(accessor, id)) {
+      return Status::ObjectNotExists("shrink: id = " + ObjectIDToString(id));
+    }
+    object = accessor->second;
+    if (size >= static_cast<size_t>(object->data_size)) {
+      return Status::OK();
+    }
+    if (object->is_spilled || object->arena_fd != -1) {
+      return Status::Invalid(
+          "shrink: the blob is not allocated by the store: " +
+          ObjectIDToString(id));
+    }
+    if (size > 0 && ShrinkBlob(object->pointer, object->data_size, size)) {
+      if (object->ref_cnt > 0) {
+        pinned_size_ -= object->data_size - size;
+      }
+      object->data_size = size;
+      return Status::OK();
+    }
+  }
+  // cannot be shrunk in place, move the used part to a new blob, the blob
+  // is pinned as creating the new blob may spill it
+  std::vector<std::shared_ptr<Payload>> objects;
+  RETURN_ON_ERROR(Pin({id}, kAnonymousOwner, objects));
+  if (objects.size() != 1 || objects[0] != object) {
+    return Status::ObjectNotExists("shrink: id = " + ObjectIDToString(id));
+  }
+  std::shared_ptr<Payload> target;
+  auto status = Create(size, shrunk_id, target);
+  if (!status.ok()) {
+    VINEYARD_DISCARD(Unpin(object));
+    return status;
+  }
+  if (size > 0) {
+    memcpy(target->pointer, object->pointer, size);
+  }
+  // deleting the blob drops the pin as well
+  return Delete(id);
+}
+
 bool BulkStore::Exists(const ObjectID& object_id) {
   object_map_t::const_accessor accessor;
   return objects_.find(accessor, object_id);
 }
 
+/**
+ * Notes [Blob Reference Counting]:
+ *
+ * Every blob counts the clients (connections) that hold it: a blob is pinned
+ * by the connection that creates it, and by every connection that gets it
+ * via `GetBuffers` or as a stream chunk. Spilled blobs are reloaded when
+ * being pinned, and are never handed out unpinned, otherwise they could be
+ * spilled again before the reply reaches the client. A connection pins a
+ * blob at most once, and releases its pins either explicitly
+ * (`Client::Release`, or dropping the blob) or when the connection is closed.
+ *
+ * The counts are maintained whether spilling is enabled or not:
+ *
+ * - only blobs that nobody holds are candidates for spilling, and
+ * - `PinnedSize()` tells the memory that is actually in use by clients from
+ *   the memory that is merely cached by the server, the difference is what
+ *   the server could reclaim by spilling (or evicting) blobs.
+ *
+ * The pins of every connection (the owner) are kept by the store rather than
+ * by the connection, as the id of a blob is derived from its address and is
+ * reused once the blob is deleted: deleting a blob drops the pins of all
+ * owners on it, otherwise a stale pin of one connection would be released on
+ * the new blob that happens to take the same address. Pins that are not held
+ * by any connection (e.g., stream chunks, or blobs in a remote transfer) are
+ * anonymous, and are released by the payload rather than the id for the same
+ * reason.
+ */
+Status BulkStore::Pin(const std::vector<ObjectID>& ids, const int owner,
+                      std::vector<std::shared_ptr<Payload>>& objects) {
+  std::unique_lock<std::recursive_mutex> spill_guard(spill_mutex_,
+                                                     std::defer_lock);
+  if (!spill_path_.empty()) {
+    spill_guard.lock();
+  }
+  std::lock_guard<std::mutex> pin_guard(pin_mutex_);
+  for (auto const id : ids) {
+    if (id == EmptyBlobID()) {
+      objects.push_back(Payload::MakeEmpty());
+      continue;
+    }
+    object_map_t::accessor accessor;
+    if (!objects_.find(accessor, id)) {
+      continue;
+    }
+    if (id == memory::placeholder_blob_id()) {
+      // not a blob, see also: BulkStore::PreAllocate()
+    } else if (owner == kAnonymousOwner) {
+      RETURN_ON_ERROR(PinObject(accessor->second));
+    } else {
+      auto& pins = pinned_blobs_[owner];
+      if (pins.find(id) == pins.end()) {
+        RETURN_ON_ERROR(PinObject(accessor->second));
+        pins.emplace(id);
+      }
+    }
+    objects.push_back(accessor->second);
+  }
+  return Status::OK();
+}
+
+Status BulkStore::Unpin(const ObjectID id, const int owner) {
+  std::unique_lock<std::recursive_mutex> spill_guard(spill_mutex_,
+                                                     std::defer_lock);
+  if (!spill_path_.empty()) {
+    spill_guard.lock();
+  }
+  std::lock_guard<std::mutex> pin_guard(pin_mutex_);
+  auto pins = pinned_blobs_.find(owner);
+  if (pins == pinned_blobs_.end() || pins->second.erase(id) == 0) {
+    return Status::OK();
+  }
+  object_map_t::accessor accessor;
+  if (!objects_.find(accessor, id)) {
+    return Status::ObjectNotExists("unpin: id = " + ObjectIDToString(id));
+  }
+  UnpinObject(accessor->second);
+  return Status::OK();
+}
+
+Status BulkStore::Unpin(const std::shared_ptr<Payload>& object) {
+  if (object->object_id == EmptyBlobID() ||
+      object->object_id == memory::placeholder_blob_id()) {
+    return Status::OK();
+  }
+  std::unique_lock<std::recursive_mutex> spill_guard(spill_mutex_,
+                                                     std::defer_lock);
+  if (!spill_path_.empty()) {
+    spill_guard.lock();
+  }
+  std::lock_guard<std::mutex> pin_guard(pin_mutex_);
+  object_map_t::accessor accessor;
+  if (!objects_.find(accessor, object->object_id) ||
+      accessor->second != object) {
+    return Status::OK();
+  }
+  UnpinObject(accessor->second);
+  return Status::OK();
+}
+
+void BulkStore::UnpinAll(const int owner) {
+  std::unique_lock<std::recursive_mutex> spill_guard(spill_mutex_,
+                                                     std::defer_lock);
+  if (!spill_path_.empty()) {
+    spill_guard.lock();
+  }
+  std::lock_guard<std::mutex> pin_guard(pin_mutex_);
+  auto pins = pinned_blobs_.find(owner);
+  if (pins == pinned_blobs_.end()) {
+    return;
+  }
+  for (auto const id : pins->second) {
+    object_map_t::accessor accessor;
+    if (objects_.find(accessor, id)) {
+      UnpinObject(accessor->second);
+    }
+  }
+  pinned_blobs_.erase(pins);
+}
+
+Status BulkStore::PinObject(std::shared_ptr<Payload>& object) {
+  if (object->is_spilled) {
+    RETURN_ON_ERROR(Reload(object));
+  }
+  if (object->ref_cnt++ == 0) {
+    pinned_size_ += object->data_size;
+  }
+  if (!spill_path_.empty()) {
+    auto iter = cold_objects_index_.find(object->object_id);
+    if (iter != cold_objects_index_.end()) {
+      cold_objects_.erase(iter->second);
+      cold_objects_index_.erase(iter);
+    }
+  }
+  return Status::OK();
+}
+
+void BulkStore::UnpinObject(std::shared_ptr<Payload>& object) {
+  if (object->ref_cnt > 0 && --object->ref_cnt == 0) {
+    pinned_size_ -= object->data_size;
+  }
+  // blobs in arenas are not allocated from the bulk allocator, and cannot
+  // be spilled.
+  if (!spill_path_.empty() && object->ref_cnt == 0 && !object->is_spilled &&
+      object->arena_fd == -1 &&
+      cold_objects_index_.find(object->object_id) ==
+          cold_objects_index_.end()) {
+    cold_objects_.emplace_front(object->object_id);
+    cold_objects_index_.emplace(object->object_id, cold_objects_.begin());
+  }
+}
+
 size_t BulkStore::Footprint() const { return BulkAllocator::Allocated(); }
 
 size_t BulkStore::FootprintLimit() const {
   return BulkAllocator::GetFootprintLimit();
 }
 
-Status BulkStore::MakeArena(size_t const size, int& fd, uintptr_t& base) {
-  fd = memory::create_buffer(size);
+size_t BulkStore::SpilledSize() const { return spilled_size_.load(); }
+
+size_t BulkStore::PinnedSize() const { return pinned_size_.load(); }
+
+json BulkStore::AllocatorStats() {
+  auto average = [](AllocationLatency const& latency) -> size_t {
+    size_t count = latency.count.load();
+    return count == 0 ? 0 : latency.nanoseconds.load() / count;
+  };
+  json stats;
+  stats["small_blobs"] = small_blobs_.Stats();
+  stats["small_allocations"] = small_alloc_latency_.count.load();
+  stats["small_allocation_avg_ns"] = average(small_alloc_latency_);
+  stats["large_allocations"] = large_alloc_latency_.count.load();
+  stats["large_allocation_avg_ns"] = average(large_alloc_latency_);
+  return stats;
+}
+
+Status BulkStore::SpillColdObjects(const size_t size, size_t& spilled) {
+  std::lock_guard<std::recursive_mutex> spill_guard(spill_mutex_);
+  size_t watermark = static_cast<size_t>(FootprintLimit() * spill_lower_rate_);
+  spilled = 0;
+  while (!cold_objects_.empty() &&
+         (spilled < size || Footprint() > watermark)) {
+    ObjectID id = cold_objects_.back();
+    object_map_t::accessor accessor;
+    if (!objects_.find(accessor, id)) {
+      cold_objects_.pop_back();
+      cold_objects_index_.erase(id);
+      continue;
+    }
+    auto& object = accessor->second;
+    if (object->ref_cnt == 0 && !object->is_spilled) {
+      RETURN_ON_ERROR(Spill(object));
+      spilled += object->data_size;
+    }
+    cold_objects_.pop_back();
+    cold_objects_index_.erase(id);
+  }
+  if (spilled > 0) {
+    VLOG(2) << "spilled " << spilled << " bytes, after spilling: "
+            << Footprint() << "(" << FootprintLimit() << "), "
+            << SpilledSize() << " bytes on disk";
+  }
+  return Status::OK();
+}
+
+Status BulkStore::Spill(std::shared_ptr<Payload>& object) {
+  RETURN_ON_ERROR(memory::write_spill_file(SpillFilePath(object->object_id),
+                                           object->pointer,
+                                           object->data_size));
+  // keep the head to reserve the id, see also Notes [Blob ID of Spilled Blobs]
+  if (GenerateBlobID(object->pointer) == object->object_id &&
+      ShrinkBlob(object->pointer, object->data_size, kReservedHeadSize)) {
+    reserved_heads_.emplace(object->object_id, object->pointer);
+  } else {
+    FreeBlob(object->pointer, object->data_size);
+  }
+  object->pointer = nullptr;
+  object->store_fd = -1;
+  object->data_offset = 0;
+  object->map_size = 0;
+  object->is_spilled = true;
+  spilled_size_ += object->data_size;
+#ifndef NDEBUG
+  VLOG(10) << "after spill: " << ObjectIDToString(object->object_id) << ": "
+           << Footprint() << "(" << FootprintLimit() << ")";
+#endif
+  return Status::OK();
+}
+
+Status BulkStore::Reload(std::shared_ptr<Payload>& object) {
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  uint8_t* pointer =
+      AllocateMemory(object->data_size, &fd, &map_size, &offset);
+  if (pointer == nullptr) {
+    return Status::NotEnoughMemory(
+        "reload: id = " + ObjectIDToString(object->object_id) +
+        ", size = " + std::to_string(object->data_size));
+  }
+  auto spill_file = SpillFilePath(object->object_id);
+  auto status =
+      memory::read_spill_file(spill_file, pointer, object->data_size);
+  if (!status.ok()) {
+    FreeBlob(pointer, object->data_size);
+    return status;
+  }
+  unlink(spill_file.c_str());
+  object->pointer = pointer;
+  object->store_fd = fd;
+  object->data_offset = offset;
+  object->map_size = map_size;
+  object->is_spilled = false;
+  spilled_size_ -= object->data_size;
+#ifndef NDEBUG
+  VLOG(10) << "after reload: " << ObjectIDToString(object->object_id) << ": "
+           << Footprint() << "(" << FootprintLimit() << ")";
+#endif
+  return Status::OK();
+}
+
+std::string BulkStore::SpillFilePath(const ObjectID id) const {
+  return spill_path_ + "/" + ObjectIDToString(id);
+}
+
+/**
+ * Notes [Shared Memory Pool]:
+ *
+ * By default every arena is backed by its own memory file, and the bulk pool
+ * may consist of many memory segments as well. A client needs to receive one
+ * fd and create one mapping for each of them, and with thousands of arenas
+ * created by `VineyardAllocator`, clients accumulate thousands of mappings
+ * and fds.
+ *
+ * In the shared pool mode, the bulk pool is restricted to the single memory
+ * region that is reserved by PreAllocate(), and arenas are carved out from
+ * the pool as well. The fd of the pool is handed to the client during
+ * registration and the pool is mapped only once, after that, blobs and arenas
+ * are resolved by their offsets in the pool without any further fd transfer.
+ *
+ * - allocations that the underlying allocator places outside the reserved
+ *   region are rejected, as if the memory has been exhausted.
+ * - an arena is a page-aligned chunk in the pool, when the arena is finalized
+ *   the unused tail is given back to the allocator, and the whole chunk is
+ *   freed once all blobs in it have been deleted.
+ * - the arena is still identified by a (duplicated) fd until finalized, to
+ *   keep the arena protocol unchanged.
+ */
+Status BulkStore::EnableSharedPool() {
+  object_map_t::const_accessor accessor;
+  if (!objects_.find(accessor, memory::placeholder_blob_id())) {
+    return Status::Invalid("The shared memory pool hasn't been allocated");
+  }
+  auto& pool = accessor->second;
+  if (pool->store_fd == -1) {
+    return Status::Invalid(
+        "The shared memory pool is not backed by a memory file");
+  }
+  shared_pool_fd_ = pool->store_fd;
+  shared_pool_size_ = pool->map_size;
+  shared_pool_ = true;
+  LOG(INFO) << "Serving blobs from the shared memory pool of size "
+            << shared_pool_size_;
+  return Status::OK();
+}
+
+Status BulkStore::GetSharedPool(int& fd, int64_t& map_size) const {
+  if (!shared_pool_) {
+    return Status::Invalid("The shared memory pool is not enabled");
+  }
+  fd = shared_pool_fd_;
+  map_size = shared_pool_size_;
+  return Status::OK();
+}
+
+Status BulkStore::MakeArena(size_t& size, int& fd, uintptr_t& base) {
+  int64_t mapped_size = size;
+  void* space = nullptr;
+  fd = memory::create_mapped_buffer(mapped_size, space, MAP_SHARED);
   if (fd == -1) {
     return Status::NotEnoughMemory("Failed to allocate a new arena");
   }
-  void* space = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  size = static_cast<size_t>(mapped_size);
   base = reinterpret_cast<uintptr_t>(space);
+  std::lock_guard<std::mutex> arena_guard(arena_mutex_);
   arenas_.emplace(fd, Arena{.fd = fd,
                             .size = size,
-                            .base = reinterpret_cast<uintptr_t>(space)});
+                            .base = reinterpret_cast<uintptr_t>(space),
+                            .offset = -1});
+  return Status::OK();
+}
+
+Status BulkStore::MakeArenaInPool(size_t& size, int& fd, uintptr_t& base,
+                                  ptrdiff_t& offset) {
+  if (!shared_pool_) {
+    return Status::Invalid("The shared memory pool is not enabled");
+  }
+  // the client side jemalloc manages the arena in extents of 1MB
+  static constexpr size_t minimum_arena_size = 1 * 1024 * 1024;
+  static size_t page_size = memory::system_page_size();
+
+  int pool_fd = -1;
+  int64_t map_size = 0;
+  uint8_t* pointer = nullptr;
+  if (size >= FootprintLimit()) {
+    // asks for the whole memory: try the largest chunk that is available
+    size = memory::align_down(
+        FootprintLimit() - std::min(Footprint(), FootprintLimit()), page_size);
+    while (size >= minimum_arena_size) {
+      pointer = AllocateAligned(size, page_size, &pool_fd, &map_size, &offset);
+      if (pointer != nullptr) {
+        break;
+      }
+      size = memory::align_down(size / 2, page_size);
+    }
+  } else {
+    pointer = AllocateAligned(size, page_size, &pool_fd, &map_size, &offset);
+  }
+  if (pointer == nullptr) {
+    return Status::NotEnoughMemory(
+        "Failed to allocate a new arena in the shared pool, size = " +
+        std::to_string(size));
+  }
+  fd = dup(shared_pool_fd_);
+  if (fd == -1) {
+    BulkAllocator::Free(pointer, size);
+    return Status::IOError("Failed to allocate a new arena: " +
+                           std::string(strerror(errno)));
+  }
+  base = reinterpret_cast<uintptr_t>(pointer);
+  std::lock_guard<std::mutex> arena_guard(arena_mutex_);
+  arenas_.emplace(fd, Arena{.fd = fd, .size = size, .base = base,
+                            .offset = offset});
   return Status::OK();
 }
 
@@ -325,6 +984,7 @@ Status BulkStore::FinalizeArena(const int fd,
                                 std::vector<size_t> const& offsets,
                                 std::vector<size_t> const& sizes) {
   VLOG(2) << "finalizing arena (fd) " << fd << "...";
+  std::lock_guard<std::mutex> arena_guard(arena_mutex_);
   auto arena = arenas_.find(fd);
   if (arena == arenas_.end()) {
     return Status::ObjectNotExists("arena for fd " + std::to_string(fd) +
@@ -336,22 +996,71 @@ Status BulkStore::FinalizeArena(const int fd,
   }
   size_t mmap_size = arena->second.size;
   uintptr_t mmap_base = arena->second.base;
+  // blobs in a pooled arena are addressed by offsets in the shared pool
+  bool pooled = arena->second.offset != -1;
+  int store_fd = pooled ? shared_pool_fd_ : fd;
+  int64_t map_size = pooled ? shared_pool_size_ : mmap_size;
+  ptrdiff_t base_offset = pooled ? arena->second.offset : 0;
+  // The blobs have been written by the client in place, thus a blob whose id
+  // conflicts with a spilled blob cannot be moved elsewhere as in `Create()`,
+  // see also Notes [Blob ID of Spilled Blobs]. The arena is then released as
+  // if none of its blobs were in use, and the finalization fails.
+  Status status = Status::OK();
+  std::set<ObjectID> object_ids;
   for (size_t idx = 0; idx < offsets.size(); ++idx) {
-    VLOG(2) << "blob in use: in " << fd << ", at " << offsets[idx]
-            << " of size " << sizes[idx];
+    ObjectID object_id = GenerateBlobID(mmap_base + offsets[idx]);
+    if (objects_.count(object_id) || !object_ids.emplace(object_id).second) {
+      status = Status::Invalid(
+          "Failed to finalize the arena: the blob at offset " +
+          std::to_string(offsets[idx]) + " conflicts with an existing blob " +
+          ObjectIDToString(object_id));
+      break;
+    }
+  }
+  static const std::vector<size_t> no_blobs;
+  auto const& used_offsets = status.ok() ? offsets : no_blobs;
+  auto const& used_sizes = status.ok() ? sizes : no_blobs;
+  size_t used_size = 0;
+  for (size_t idx = 0; idx < used_offsets.size(); ++idx) {
+    VLOG(2) << "blob in use: in " << fd << ", at " << used_offsets[idx]
+            << " of size " << used_sizes[idx];
     // make them available for blob pool
-    uintptr_t pointer = mmap_base + offsets[idx];
+    uintptr_t pointer = mmap_base + used_offsets[idx];
     ObjectID object_id = GenerateBlobID(pointer);
-    objects_.emplace(object_id, std::make_shared<Payload>(
-                                    object_id, sizes[idx],
-                                    reinterpret_cast<uint8_t*>(pointer), fd,
-                                    mmap_size, offsets[idx]));
+    objects_.emplace(object_id,
+                     std::make_shared<Payload>(
+                         object_id, used_sizes[idx],
+                         reinterpret_cast<uint8_t*>(pointer), store_fd,
+                         store_fd, map_size, base_offset + used_offsets[idx]));
     // record the span, will be used to release memory back to OS when deleting
     // blobs
     Arena::spans.emplace(object_id);
+    used_size = std::max(used_size, used_offsets[idx] + used_sizes[idx]);
+  }
+  if (pooled) {
+    // give the unused tail (or the whole arena) back to the shared pool
+    static size_t page_size = memory::system_page_size();
+    used_size = memory::align_up(used_size, page_size);
+    if (used_offsets.empty()) {
+      BulkAllocator::Free(reinterpret_cast<void*>(mmap_base), mmap_size);
+    } else {
+      if (used_size < mmap_size &&
+          BulkAllocator::Shrink(reinterpret_cast<void*>(mmap_base), mmap_size,
+                                used_size)) {
+        mmap_size = used_size;
+      }
+      memory::recycle_arena(mmap_base, mmap_size, used_offsets, used_sizes);
+      pooled_arenas_.emplace(
+          mmap_base,
+          PooledArena{.size = mmap_size, .blobs = used_offsets.size()});
+    }
+    // the fd is only used to identify the arena
+    close(fd);
+    arenas_.erase(arena);
+    return status;
   }
   // recycle memory
-  { memory::recycle_arena(mmap_base, mmap_size, offsets, sizes); }
+  { memory::recycle_arena(mmap_base, mmap_size, used_offsets, used_sizes); }
   // make it available for mmap record
   {
     memory::MmapRecord& record =
@@ -360,7 +1069,25 @@ Status BulkStore::FinalizeArena(const int fd,
     record.size = mmap_size;
     arenas_.erase(arena);
   }
-  return Status::OK();
+  return status;
+}
+
+void BulkStore::ReleasePooledArenaBlob(const uintptr_t pointer) {
+  // n.b.: the caller holds the `arena_mutex_`.
+  auto iter = pooled_arenas_.upper_bound(pointer);
+  if (iter == pooled_arenas_.begin()) {
+    return;
+  }
+  iter = std::prev(iter);
+  if (pointer >= iter->first + iter->second.size) {
+    return;
+  }
+  iter->second.blobs -= 1;
+  if (iter->second.blobs == 0) {
+    BulkAllocator::Free(reinterpret_cast<void*>(iter->first),
+                        iter->second.size);
+    pooled_arenas_.erase(iter);
+  }
 }
 
 }  // namespace vineyard
@@ -29,44 +29,185 @@
 #ifndef SRC_SERVER_MEMORY_MEMORY_H_
 #define SRC_SERVER_MEMORY_MEMORY_H_
 
+#include <atomic>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "oneapi/tbb/concurrent_hash_map.h"
 
 #include "common/memory/payload.h"
+#include "common/util/json.h"
 #include "common/util/status.h"
+#include "server/memory/slab_allocator.h"
 
 namespace vineyard {
 
 class BulkStore {
  public:
+  BulkStore();
+
   ~BulkStore();
 
+  /**
+   * @brief Back the shared memory (and arenas) with huge pages, must be
+   * called before PreAllocate(), see also Notes [Huge Pages] in
+   * "server/memory/malloc.h".
+   *
+   * @param huge_pages "thp", "memfd", or a directory of hugetlbfs, empty
+   *        means regular pages.
+   */
+  Status SetHugePages(const std::string& huge_pages);
+
   Status PreAllocate(const size_t size);
 
+  /**
+   * @brief Allocate blobs that are no larger than `size` from slabs, 0
+   * disables it, see also Notes [Small Blob Allocator] in
+   * "server/memory/slab_allocator.h".
+   */
+  Status SetSmallBlobSize(const size_t size);
+
+  /**
+   * @brief Enable spilling cold blobs to the local directory `spill_path`
+   * when the shared memory is exhausted.
+   *
+   * @param spill_path The directory where the spilled blobs are written to.
+   * @param spill_lower_rate Once spilling is triggered, cold blobs are spilled
+   *        until the footprint drops below `spill_lower_rate * limit`.
+   */
+  Status SetSpillPolicy(const std::string& spill_path,
+                        const double spill_lower_rate);
+
+  /**
+   * @brief Pins that are not held by any client, e.g., chunks of streams,
+   * see also Notes [Blob Reference Counting].
+   */
+  static constexpr int kAnonymousOwner = -1;
+
+  /**
+   * @brief Create a blob, which is pinned by its creator `owner`.
+   */
   Status Create(const size_t size, ObjectID& object_id,
-                std::shared_ptr<Payload>& object);
+                std::shared_ptr<Payload>& object,
+                const int owner = kAnonymousOwner);
 
+  /**
+   * @brief Get the payload of the blob, a spilled blob is returned as is,
+   * without being reloaded. Blobs that are handed to clients should be
+   * obtained by `Pin()` instead, otherwise they may be spilled while still
+   * in use.
+   */
   Status Get(const ObjectID id, std::shared_ptr<Payload>& object);
 
   /**
    * This methods only return available objects, and doesn't fail when object
-   * does not exists.
+   * does not exists. Spilled blobs are not reloaded, see also `Get(id)`.
    */
   Status Get(const std::vector<ObjectID>& ids,
              std::vector<std::shared_ptr<Payload>>& objects);
 
   Status Delete(const ObjectID& object_id);
 
+  /**
+   * @brief Shrink a blob that is still being written to its first `size`
+   * bytes. The tail is given back to the allocator in place when possible,
+   * otherwise the content is moved to a new blob, whose id is set to
+   * `shrunk_id`.
+   */
+  Status Shrink(const ObjectID id, const size_t size, ObjectID& shrunk_id);
+
   bool Exists(const ObjectID& object_id);
 
+  /**
+   * @brief Pin the blobs in shared memory for `owner` and return the blobs
+   * that exist: spilled blobs will be reloaded, and a pinned blob won't be
+   * chosen as the victim for spilling, see also Notes [Blob Reference
+   * Counting].
+   *
+   * An owner pins a blob at most once, except the anonymous owner, whose
+   * pins are released by `Unpin(object)`.
+   */
+  Status Pin(const std::vector<ObjectID>& ids, const int owner,
+             std::vector<std::shared_ptr<Payload>>& objects);
+
+  /**
+   * @brief Release the pin of `owner` on the blob, the blob becomes a
+   * candidate for spilling once all pins on it have been released. Blobs
+   * that are not pinned by `owner` are ignored.
+   */
+  Status Unpin(const ObjectID id, const int owner);
+
+  /**
+   * @brief Release an anonymous pin on the blob, it is ignored if the blob
+   * has been deleted since then, even if the id has been reused.
+   */
+  Status Unpin(const std::shared_ptr<Payload>& object);
+
+  /**
+   * @brief Release all pins of `owner`, e.g., when the client disconnects.
+   */
+  void UnpinAll(const int owner);
+
   size_t Footprint() const;
   size_t FootprintLimit() const;
 
-  Status MakeArena(const size_t size, int& fd, uintptr_t& base);
+  /**
+   * @brief The total size of blobs that have been spilled to disk.
+   */
+  size_t SpilledSize() const;
+
+  /**
+   * @brief The total size of blobs that are pinned by at least one client,
+   * the rest of the footprint is only cached by the server.
+   */
+  size_t PinnedSize() const;
+
+  /**
+   * @brief The usage and fragmentation of slabs, and the average latency of
+   * allocating small and large blobs.
+   */
+  json AllocatorStats();
+
+  /**
+   * @brief Serve blobs and arenas from the single shared memory region that
+   * has been mapped by PreAllocate(), see also Notes [Shared Memory Pool].
+   */
+  Status EnableSharedPool();
+
+  bool SharedPoolEnabled() const { return shared_pool_; }
+
+  /**
+   * @brief The memory file of the shared memory pool, clients could map the
+   * pool once and then address all blobs by offsets.
+   */
+  Status GetSharedPool(int& fd, int64_t& map_size) const;
+
+  /**
+   * @brief Make an arena in a new memory file, the `size` may be rounded up
+   * to the huge page size, and the actual size is returned.
+   */
+  Status MakeArena(size_t& size, int& fd, uintptr_t& base);
+
+  /**
+   * @brief Make an arena inside the shared memory pool.
+   *
+   * @param size The size of the arena. An arena that asks for the whole
+   *        memory (i.e., `size >= FootprintLimit()`) gets the largest chunk
+   *        that is available, and the actual size is returned.
+   * @param fd A fd that identifies the arena until it is finalized, the
+   *        memory of the arena should be mapped from the shared pool.
+   * @param base The address of the arena in the server.
+   * @param offset The offset of the arena in the shared pool.
+   */
+  Status MakeArenaInPool(size_t& size, int& fd, uintptr_t& base,
+                         ptrdiff_t& offset);
 
   Status FinalizeArena(const int fd, std::vector<size_t> const& offsets,
                        std::vector<size_t> const& sizes);
@@ -74,18 +215,98 @@ class BulkStore {
  private:
   uint8_t* AllocateMemory(size_t size, int* fd, int64_t* map_size,
                           ptrdiff_t* offset);
+
+  uint8_t* AllocateAligned(const size_t size, const size_t alignment, int* fd,
+                           int64_t* map_size, ptrdiff_t* offset);
+
+  uint8_t* AllocateBlob(const size_t size, int* fd, int64_t* map_size,
+                        ptrdiff_t* offset);
+
+  void FreeBlob(uint8_t* pointer, const size_t size);
+
+  bool ShrinkBlob(uint8_t* pointer, const size_t size, const size_t new_size);
+
+  /**
+   * @brief Release an arena blob in the shared pool, the arena will be freed
+   * once all blobs in it have been deleted.
+   */
+  void ReleasePooledArenaBlob(const uintptr_t pointer);
+
+  /**
+   * @brief Spill cold blobs in LRU order, until at least `size` bytes have
+   * been released and the footprint is below the lower watermark.
+   */
+  Status SpillColdObjects(const size_t size, size_t& spilled);
+
+  Status Spill(std::shared_ptr<Payload>& object);
+
+  Status Reload(std::shared_ptr<Payload>& object);
+
+  // n.b.: the caller holds the spill mutex (if spilling is enabled), and the
+  // pin mutex.
+  Status PinObject(std::shared_ptr<Payload>& object);
+
+  void UnpinObject(std::shared_ptr<Payload>& object);
+
+  std::string SpillFilePath(const ObjectID id) const;
+
   struct Arena {
     int fd;
     size_t size;
     uintptr_t base;
+    // offset in the shared pool, -1 for arenas with their own memory file
+    ptrdiff_t offset;
     static std::set<ObjectID> spans;
   };
 
   std::unordered_map<int /* fd */, Arena> arenas_;
 
+  struct PooledArena {
+    size_t size;
+    size_t blobs;  // number of blobs that are still alive
+  };
+
+  // protects arenas, as well as the arena spans
+  std::mutex arena_mutex_;
+  std::map<uintptr_t /* base */, PooledArena> pooled_arenas_;
+
+  bool shared_pool_ = false;
+  int shared_pool_fd_ = -1;
+  int64_t shared_pool_size_ = 0;
+
+  memory::SlabAllocator small_blobs_;
+
+  struct AllocationLatency {
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> nanoseconds{0};
+  };
+  AllocationLatency small_alloc_latency_;
+  AllocationLatency large_alloc_latency_;
+
   using object_map_t =
       tbb::concurrent_hash_map<ObjectID, std::shared_ptr<Payload>>;
   object_map_t objects_;
+
+  std::string spill_path_;
+  double spill_lower_rate_ = 1.0;
+  std::atomic<size_t> spilled_size_{0};
+  std::atomic<size_t> pinned_size_{0};
+  // protects the cold object list, and the spilling and reloading of blobs,
+  // it is recursive since reloading a blob may spill other blobs.
+  std::recursive_mutex spill_mutex_;
+  // unpinned blobs, the coldest one at the back
+  std::list<ObjectID> cold_objects_;
+  std::unordered_map<ObjectID, std::list<ObjectID>::iterator>
+      cold_objects_index_;
+  // the heads of spilled blobs that are kept to reserve their ids until the
+  // blobs are deleted, see also Notes [Blob ID of Spilled Blobs]
+  std::unordered_map<ObjectID, uint8_t*> reserved_heads_;
+  static constexpr size_t kReservedHeadSize = 1;
+  // protects the pins of owners, it is acquired after the spill mutex, and
+  // before the accessors of objects.
+  std::mutex pin_mutex_;
+  std::unordered_map<int /* owner */, std::unordered_set<ObjectID>>
+      pinned_blobs_;
 };
 
 }  // namespace vineyard
@@ -0,0 +1,174 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/memory/slab_allocator.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace vineyard {
+
+namespace memory {
+
+constexpr size_t SlabAllocator::kMaxSmallBlobSize;
+
+SlabAllocator::SlabAllocator(allocate_fn_t allocate_slab, free_fn_t free_slab)
+    : allocate_slab_(std::move(allocate_slab)),
+      free_slab_(std::move(free_slab)) {
+  // see also: Notes [Small Blob Allocator]
+  for (size_t size = 64; size <= kMaxSmallBlobSize;) {
+    class_sizes_.emplace_back(size);
+    size_t power = 512;
+    while (power * 2 <= size) {
+      power *= 2;
+    }
+    size += size < 512 ? 64 : power / 4;
+  }
+  available_slabs_.resize(class_sizes_.size());
+}
+
+void SlabAllocator::SetMaxSize(const size_t max_size) {
+  max_size_ = std::min(max_size, kMaxSmallBlobSize);
+}
+
+uint8_t* SlabAllocator::Allocate(const size_t size) {
+  size_t class_index = classIndex(size);
+  size_t class_size = class_sizes_[class_index];
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& available = available_slabs_[class_index];
+  if (available.empty()) {
+    size_t slab_size = slabSize(class_size);
+    uint8_t* base = allocate_slab_(slab_size);
+    if (base == nullptr) {
+      return nullptr;
+    }
+    Slab slab;
+    slab.class_index = class_index;
+    slab.size = slab_size;
+    uint32_t slots = static_cast<uint32_t>(slab_size / class_size);
+    slab.free_slots.reserve(slots);
+    for (uint32_t slot = slots; slot > 0; --slot) {
+      slab.free_slots.emplace_back(slot - 1);
+    }
+    uintptr_t address = reinterpret_cast<uintptr_t>(base);
+    slabs_.emplace(address, std::move(slab));
+    available.emplace(address);
+    slab_bytes_ += slab_size;
+  }
+  uintptr_t base = *available.begin();
+  Slab& slab = slabs_.at(base);
+  uint32_t slot = slab.free_slots.back();
+  slab.free_slots.pop_back();
+  slab.used += 1;
+  if (slab.free_slots.empty()) {
+    available.erase(available.begin());
+  }
+  used_bytes_ += class_size;
+  requested_bytes_ += size;
+  blobs_ += 1;
+  return reinterpret_cast<uint8_t*>(base + slot * class_size);
+}
+
+bool SlabAllocator::Free(uint8_t* pointer, const size_t size) {
+  uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = findSlab(address);
+  if (iter == slabs_.end()) {
+    return false;
+  }
+  Slab& slab = iter->second;
+  size_t class_size = class_sizes_[slab.class_index];
+  auto& available = available_slabs_[slab.class_index];
+  slab.free_slots.emplace_back(
+      static_cast<uint32_t>((address - iter->first) / class_size));
+  slab.used -= 1;
+  used_bytes_ -= class_size;
+  requested_bytes_ -= size;
+  blobs_ -= 1;
+  if (slab.used == 0) {
+    available.erase(iter->first);
+    slab_bytes_ -= slab.size;
+    free_slab_(reinterpret_cast<uint8_t*>(iter->first), slab.size);
+    slabs_.erase(iter);
+    return true;
+  }
+  available.emplace(iter->first);
+  return true;
+}
+
+bool SlabAllocator::Owns(const uint8_t* pointer) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return findSlab(reinterpret_cast<uintptr_t>(pointer)) != slabs_.end();
+}
+
+bool SlabAllocator::Shrink(uint8_t* pointer, const size_t size,
+                           const size_t new_size) {
+  if (new_size == 0 || new_size >= size) {
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = findSlab(reinterpret_cast<uintptr_t>(pointer));
+  if (iter == slabs_.end() ||
+      classIndex(new_size) != iter->second.class_index) {
+    return false;
+  }
+  requested_bytes_ -= size - new_size;
+  return true;
+}
+
+json SlabAllocator::Stats() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  json stats;
+  stats["max_size"] = max_size_;
+  stats["blobs"] = blobs_;
+  stats["slabs"] = slabs_.size();
+  stats["slab_bytes"] = slab_bytes_;
+  stats["used_bytes"] = used_bytes_;
+  stats["requested_bytes"] = requested_bytes_;
+  stats["fragmentation"] =
+      slab_bytes_ == 0 ? 0.0 : 1.0 - static_cast<double>(requested_bytes_) /
+                                         static_cast<double>(slab_bytes_);
+  return stats;
+}
+
+size_t SlabAllocator::classIndex(const size_t size) const {
+  return std::lower_bound(class_sizes_.begin(), class_sizes_.end(), size) -
+         class_sizes_.begin();
+}
+
+size_t SlabAllocator::slabSize(const size_t class_size) {
+  // 64 slots in a slab, bounded by [64 KiB, 1 MiB]
+  static constexpr size_t min_slab_size = 64 * 1024;
+  static constexpr size_t max_slab_size = 1024 * 1024;
+  return std::min(std::max(class_size * 64, min_slab_size), max_slab_size);
+}
+
+std::map<uintptr_t, SlabAllocator::Slab>::iterator SlabAllocator::findSlab(
+    const uintptr_t pointer) {
+  auto iter = slabs_.upper_bound(pointer);
+  if (iter == slabs_.begin()) {
+    return slabs_.end();
+  }
+  iter = std::prev(iter);
+  if (pointer >= iter->first + iter->second.size) {
+    return slabs_.end();
+  }
+  return iter;
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
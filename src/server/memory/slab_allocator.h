@@ -0,0 +1,136 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_MEMORY_SLAB_ALLOCATOR_H_
+#define SRC_SERVER_MEMORY_SLAB_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "common/util/json.h"
+
+namespace vineyard {
+
+namespace memory {
+
+/**
+ * Notes [Small Blob Allocator]:
+ *
+ * Allocating every blob from the bulk allocator on its own pays for the
+ * bookkeeping (and the alignment) of the underlying allocator for every
+ * scalar, short array, etc., and millions of them waste plenty of the shared
+ * memory as well as allocation time.
+ *
+ * Blobs that are no larger than `MaxSize()` (64 KiB at most) are instead
+ * allocated from slabs. The sizes are rounded up to size classes, which are
+ * multiples of 64 bytes (to keep the alignment of blobs), spaced by 64 bytes
+ * up to 512 bytes and then by a quarter of the power of two below, thus the
+ * internal waste is bounded by 25%. A slab is an extent of the bulk
+ * allocator that is carved into slots of a single size class, and
+ *
+ * - slots are taken from the slab with the lowest address first, so that
+ *   slabs at higher addresses drain and are given back to the bulk
+ *   allocator as soon as they become empty;
+ * - slots live in the same shared memory as other blobs, thus a small blob
+ *   is addressed by (fd, offset) as usual, and the client side is unaware
+ *   of slabs.
+ *
+ * `Stats()` reports the slabs in use and the fragmentation, i.e., the
+ * fraction of the slab memory that is not requested by blobs.
+ */
+class SlabAllocator {
+ public:
+  using allocate_fn_t = std::function<uint8_t*(const size_t size)>;
+  using free_fn_t = std::function<void(uint8_t* pointer, const size_t size)>;
+
+  static constexpr size_t kMaxSmallBlobSize = 64 * 1024;
+
+  /**
+   * @param allocate_slab Allocates a page-aligned extent for a slab from the
+   *        bulk allocator, returns nullptr on failure.
+   * @param free_slab Gives the extent of an empty slab back.
+   */
+  SlabAllocator(allocate_fn_t allocate_slab, free_fn_t free_slab);
+
+  /**
+   * @brief Blobs no larger than `max_size` are allocated from slabs, the
+   * size is capped by `kMaxSmallBlobSize`, and 0 disables slabs.
+   */
+  void SetMaxSize(const size_t max_size);
+
+  size_t MaxSize() const { return max_size_; }
+
+  bool Fits(const size_t size) const { return size > 0 && size <= max_size_; }
+
+  uint8_t* Allocate(const size_t size);
+
+  /**
+   * @brief Returns false if the pointer isn't allocated from slabs.
+   */
+  bool Free(uint8_t* pointer, const size_t size);
+
+  bool Owns(const uint8_t* pointer);
+
+  /**
+   * @brief The blob can be shrunk in place if the new size is still in the
+   * size class of its slot.
+   */
+  bool Shrink(uint8_t* pointer, const size_t size, const size_t new_size);
+
+  json Stats();
+
+ private:
+  struct Slab {
+    size_t class_index;
+    size_t size;
+    // a stack of the indices of free slots
+    std::vector<uint32_t> free_slots;
+    size_t used = 0;
+  };
+
+  size_t classIndex(const size_t size) const;
+
+  static size_t slabSize(const size_t class_size);
+
+  // n.b.: the caller holds the mutex.
+  std::map<uintptr_t, Slab>::iterator findSlab(const uintptr_t pointer);
+
+  allocate_fn_t allocate_slab_;
+  free_fn_t free_slab_;
+  size_t max_size_ = 0;
+
+  std::vector<size_t> class_sizes_;
+
+  std::mutex mutex_;
+  std::map<uintptr_t /* base */, Slab> slabs_;
+  // slabs that have free slots, for every size class
+  std::vector<std::set<uintptr_t>> available_slabs_;
+
+  size_t slab_bytes_ = 0;
+  size_t used_bytes_ = 0;
+  size_t requested_bytes_ = 0;
+  size_t blobs_ = 0;
+};
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_MEMORY_SLAB_ALLOCATOR_H_
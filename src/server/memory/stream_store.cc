@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "server/memory/stream_store.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "common/util/callback.h"
 #include "common/util/logging.h"
@@ -30,14 +33,14 @@ namespace vineyard {
     if (!(condition)) {                                                \
       LOG(ERROR) << "Stream state error(" __FILE__                     \
                     ":" VINEYARD_TO_STRING(__LINE__) "): " #condition; \
-      return callback(Status::InvalidStreamState(#condition),          \
-                      InvalidObjectID());                              \
+      return callback(Status::InvalidStreamState(#condition), {});     \
     }                                                                  \
   } while (0)
 #endif  // CHECK_STREAM_STATE
 
 // manage a pool of streams.
 Status StreamStore::Create(ObjectID const stream_id) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
   if (streams_.find(stream_id) != streams_.end()) {
     return Status::ObjectExists();
   }
@@ -45,127 +48,151 @@ Status StreamStore::Create(ObjectID const stream_id) {
   return Status::OK();
 }
 
-Status StreamStore::Open(ObjectID const stream_id, int64_t const mode) {
+Status StreamStore::Open(ObjectID const stream_id, int64_t const mode,
+                         size_t& consumer) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
     return Status::ObjectNotExists("stream cannot be open: " +
                                    ObjectIDToString(stream_id));
   }
-  if (streams_[stream_id]->open_mark & mode) {
+  auto stream = streams_.at(stream_id);
+  // the stream could be opened for reading many times, see also
+  // Notes [Stream Fan-out]
+  if (stream->open_mark & mode & ~kReadMode) {
     return Status::StreamOpened();
   }
-  streams_[stream_id]->open_mark |= mode;
+  stream->open_mark |= mode;
+  if (mode & kReadMode) {
+    consumer = stream->next_consumer_++;
+    stream->consumers_[consumer].cursor_ = stream->released_;
+  }
   return Status::OK();
 }
 
-// for producer: return the next chunk to write, and make current chunk
+// for producer: return the next chunks to write, and make current chunks
 // available for consumer to read
 Status StreamStore::Get(ObjectID const stream_id, size_t const size,
-                        callback_t<const ObjectID> callback) {
+                        size_t const count, stream_chunks_callback_t callback) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
-    return callback(Status::ObjectNotExists("failed to pull from stream"),
-                    InvalidObjectID());
+    return callback(Status::ObjectNotExists("failed to pull from stream"), {});
   }
   auto stream = streams_.at(stream_id);
 
   // precondition: there's no unsatistified writer, and still running
   CHECK_STREAM_STATE(!stream->writer_);
   CHECK_STREAM_STATE(!stream->drained && !stream->failed);
+  CHECK_STREAM_STATE(count > 0);
+  if (size != 0 && count > std::numeric_limits<size_t>::max() / size) {
+    return callback(
+        Status::Invalid("The requested stream chunks are too large"), {});
+  }
 
-  // seal current chunk
-  if (stream->current_writing_) {
-    stream->ready_chunks_.push(stream->current_writing_.get());
-    stream->current_writing_ = boost::none;
-  }
-  // weak up the pending reader
-  if (stream->reader_) {
-    // should be no reading chunk
-    CHECK_STREAM_STATE(!stream->current_reading_);
-    if (!stream->ready_chunks_.empty()) {
-      stream->current_reading_ = stream->ready_chunks_.front();
-      stream->ready_chunks_.pop();
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::OK(), stream->current_reading_.get()));
-      stream->reader_ = boost::none;
-    }
+  // seal current chunks
+  for (auto const chunk : stream->writing_) {
+    stream->ready_chunks_.push_back(chunk);
   }
+  stream->writing_.clear();
+  stream->window_ = std::max(stream->window_, count);
+  stream->chunk_size_ = size;
+  // weak up the pending readers
+  wakeupReaders(stream);
 
-  if (allocatable(stream, size)) {
+  if (allocatable(stream, size, count)) {
     // do allocation
-    ObjectID chunk;
-    std::shared_ptr<Payload> object;
-    auto status = store_->Create(size, chunk, object);
+    auto status = allocate(stream, size, count);
     if (!status.ok()) {
-      return callback(status, InvalidObjectID());
+      return callback(status, {});
     } else {
-      stream->current_writing_ = chunk;
-      return callback(Status::OK(), stream->current_writing_.get());
+      return callback(Status::OK(), stream->writing_);
     }
   } else {
     // pending the writer
-    stream->writer_ = std::make_pair(size, callback);
+    stream->writer_ = std::make_tuple(size, count, callback);
     return Status::OK();
   }
 }
 
-// for consumer: read current chunk
-Status StreamStore::Pull(ObjectID const stream_id,
-                         callback_t<const ObjectID> callback) {
+Status StreamStore::Shrink(ObjectID const stream_id,
+                           std::vector<size_t> const& used) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  if (streams_.find(stream_id) == streams_.end()) {
+    return Status::ObjectNotExists("failed to shrink stream chunks: " +
+                                   ObjectIDToString(stream_id));
+  }
+  auto stream = streams_.at(stream_id);
+  if (used.size() != stream->writing_.size()) {
+    return Status::InvalidStreamState(
+        "The number of used sizes doesn't match the writing chunks");
+  }
+  std::vector<ObjectID> writing;
+  for (size_t index = 0; index < used.size(); ++index) {
+    ObjectID chunk = stream->writing_[index];
+    if (used[index] == 0) {
+      RETURN_ON_ERROR(store_->Delete(chunk));
+      continue;
+    }
+    RETURN_ON_ERROR(store_->Shrink(chunk, used[index], chunk));
+    writing.emplace_back(chunk);
+  }
+  stream->writing_ = std::move(writing);
+  return Status::OK();
+}
+
+// for consumer: read next chunks
+Status StreamStore::Pull(ObjectID const stream_id, size_t const consumer,
+                         size_t const count,
+                         stream_chunks_callback_t callback) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
-    return callback(Status::ObjectNotExists("failed to put to stream"),
-                    InvalidObjectID());
+    return callback(Status::ObjectNotExists("failed to put to stream"), {});
   }
   auto stream = streams_.at(stream_id);
+  auto iter = stream->consumers_.find(consumer);
+  CHECK_STREAM_STATE(iter != stream->consumers_.end());
+  auto& reader = iter->second;
 
   // precondition: there's no unsatistified reader
-  CHECK_STREAM_STATE(!stream->reader_);
+  CHECK_STREAM_STATE(!reader.reader_);
+  CHECK_STREAM_STATE(count > 0);
 
-  // drop current reading
-  if (stream->current_reading_) {
-    auto status = store_->Delete(stream->current_reading_.get());
+  // drop current reading, if it has been read by every consumer
+  if (reader.reading_ > 0) {
+    reader.reading_ = 0;
+    auto status = release(stream);
     if (!status.ok()) {
-      return callback(status, InvalidObjectID());
+      return callback(status, {});
     }
-    stream->current_reading_ = boost::none;
   }
   // wake up the pending writer
-  if (stream->writer_) {
-    // should be no writing chunk
-    CHECK_STREAM_STATE(!stream->current_writing_);
-    auto writer = stream->writer_.get();
-    if (allocatable(stream, writer.first)) {
-      ObjectID chunk;
-      std::shared_ptr<Payload> object;
-      auto status = store_->Create(writer.first, chunk, object);
-      if (!status.ok()) {
-        VINEYARD_SUPPRESS(writer.second(status, InvalidObjectID()));
-      } else {
-        stream->current_writing_ = chunk;
-        VINEYARD_SUPPRESS(
-            writer.second(Status::OK(), stream->current_writing_.get()));
-        stream->writer_ = boost::none;
-      }
-    }
-  }
+  wakeupWriter(stream);
 
-  if (!stream->ready_chunks_.empty()) {
-    stream->current_reading_ = stream->ready_chunks_.front();
-    stream->ready_chunks_.pop();
-    return callback(Status::OK(), stream->current_reading_.get());
+  size_t sealed = stream->released_ + stream->ready_chunks_.size();
+  if (reader.cursor_ < sealed) {
+    std::vector<ObjectID> chunks;
+    while (reader.cursor_ < sealed && chunks.size() < count) {
+      chunks.emplace_back(
+          stream->ready_chunks_[reader.cursor_ - stream->released_]);
+      reader.cursor_ += 1;
+    }
+    reader.reading_ = chunks.size();
+    return callback(Status::OK(), chunks);
   } else {
     // if stream has been stoped, return a proper status.
     if (stream->drained) {
-      return callback(Status::StreamDrained(), InvalidObjectID());
+      return callback(Status::StreamDrained(), {});
     } else if (stream->failed) {
-      return callback(Status::StreamFailed(), InvalidObjectID());
+      return callback(Status::StreamFailed(), {});
     } else {
       // pending the reader
-      stream->reader_ = callback;
+      reader.reader_ = std::make_pair(count, callback);
       return Status::OK();
     }
   }
 }
 
 Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
     return Status::ObjectNotExists("failed to stop stream: " +
                                    ObjectIDToString(stream_id));
@@ -179,81 +206,189 @@ Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
   if (stream->writer_) {
     return Status::InvalidStreamState("Still pending writer on stream");
   }
-  // seal current writing chunk
-  if (stream->current_writing_) {
-    stream->ready_chunks_.push(stream->current_writing_.get());
-    stream->current_writing_ = boost::none;
+  // seal current writing chunks
+  for (auto const chunk : stream->writing_) {
+    stream->ready_chunks_.push_back(chunk);
   }
+  stream->writing_.clear();
   // stop
   if (failed) {
     stream->failed = true;
   } else {
     stream->drained = true;
   }
-  // weak up the pending reader
-  if (stream->reader_) {
-    // should be no reading chunk
-    if (stream->current_reading_) {
-      auto err =
-          Status::InvalidStreamState("Shouldn't exists a being read chunk");
-      VINEYARD_SUPPRESS(stream->reader_.get()(err, InvalidObjectID()));
-      stream->reader_ = boost::none;
-      return err;
-    }
-    if (stream->failed) {
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::StreamFailed(), InvalidObjectID()));
-      stream->reader_ = boost::none;
-    } else if (!stream->ready_chunks_.empty()) {
-      stream->current_reading_ = stream->ready_chunks_.front();
-      stream->ready_chunks_.pop();
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::OK(), stream->current_reading_.get()));
-      stream->reader_ = boost::none;
-    } else if (stream->drained) {
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::StreamFailed(), InvalidObjectID()));
-      stream->reader_ = boost::none;
-    } else {
-      RETURN_ON_ASSERT(false, "Impossible!");
-    }
-  }
+  // no more chunks will be written
+  RETURN_ON_ERROR(clear(stream, false));
+  // weak up the pending readers
+  wakeupReaders(stream);
   return Status::OK();
 }
 
-Status StreamStore::Drop(ObjectID const stream_id) {
+Status StreamStore::Drop(ObjectID const stream_id, size_t const consumer) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
     return Status::ObjectNotExists("failed to drop stream: " +
                                    ObjectIDToString(stream_id));
   }
   auto stream = streams_.at(stream_id);
+  // the pending reader belongs to the lost connection
+  stream->consumers_.erase(consumer);
+  if (!stream->consumers_.empty()) {
+    // the other consumers still work, and the chunks that are only held by
+    // the dropped consumer could be released
+    RETURN_ON_ERROR(release(stream));
+    wakeupWriter(stream);
+    return Status::OK();
+  }
   stream->failed = true;
-  // weakup pending reader
-  if (stream->reader_) {
-    // should be no reading chunk
-    if (stream->current_reading_) {
-      return Status::InvalidStreamState("Shouldn't exists a being read chunk");
+  // drop all memory chunks in ready queue, as no reader is left
+  return clear(stream, true);
+}
+
+bool StreamStore::allocatable(std::shared_ptr<StreamHolder> stream,
+                              size_t size, size_t count) {
+  // recycled chunks don't increase the footprint
+  for (auto const& chunk : stream->recycled_) {
+    if (count == 0) {
+      break;
+    }
+    if (chunk.first == size) {
+      count -= 1;
+    }
+  }
+  if (count == 0) {
+    return true;
+  }
+  if (size != 0 && count > std::numeric_limits<size_t>::max() / size) {
+    return false;
+  }
+  return store_->Footprint() + size * count <
+         store_->FootprintLimit() * threshold_ / 100.0;
+}
+
+Status StreamStore::allocate(std::shared_ptr<StreamHolder> stream,
+                             size_t size, size_t count) {
+  for (size_t index = 0; index < count; ++index) {
+    auto recycled =
+        std::find_if(stream->recycled_.begin(), stream->recycled_.end(),
+                     [size](const std::pair<size_t, ObjectID>& chunk) {
+                       return chunk.first == size;
+                     });
+    if (recycled != stream->recycled_.end()) {
+      stream->writing_.emplace_back(recycled->second);
+      stream->recycled_.erase(recycled);
+      continue;
+    }
+    ObjectID chunk;
+    std::shared_ptr<Payload> object;
+    auto status = store_->Create(size, chunk, object);
+    if (!status.ok()) {
+      // return the allocated chunks to the pool
+      for (auto const chunk : stream->writing_) {
+        stream->recycled_.emplace_back(size, chunk);
+      }
+      stream->writing_.clear();
+      return status;
+    }
+    stream->writing_.emplace_back(chunk);
+  }
+  return Status::OK();
+}
+
+Status StreamStore::release(std::shared_ptr<StreamHolder> stream) {
+  if (stream->consumers_.empty()) {
+    return Status::OK();
+  }
+  size_t lowest = std::numeric_limits<size_t>::max();
+  for (auto const& item : stream->consumers_) {
+    auto const& consumer = item.second;
+    lowest = std::min(lowest, consumer.cursor_ - consumer.reading_);
+  }
+  bool stopped = stream->drained || stream->failed;
+  while (stream->released_ < lowest && !stream->ready_chunks_.empty()) {
+    ObjectID chunk = stream->ready_chunks_.front();
+    std::shared_ptr<Payload> object;
+    if (!stopped && stream->recycled_.size() < 2 * stream->window_ &&
+        store_->Get(chunk, object).ok() &&
+        static_cast<size_t>(object->data_size) == stream->chunk_size_) {
+      stream->recycled_.emplace_back(object->data_size, chunk);
+    } else {
+      RETURN_ON_ERROR(store_->Delete(chunk));
     }
-    VINEYARD_SUPPRESS(
-        stream->reader_.get()(Status::StreamFailed(), InvalidObjectID()));
-    stream->reader_ = boost::none;
+    stream->ready_chunks_.pop_front();
+    stream->released_ += 1;
+  }
+  return Status::OK();
+}
+
+Status StreamStore::clear(std::shared_ptr<StreamHolder> stream, bool ready) {
+  while (!stream->recycled_.empty()) {
+    RETURN_ON_ERROR(store_->Delete(stream->recycled_.front().second));
+    stream->recycled_.pop_front();
   }
-  // drop all memory chunks in ready queue, but still keep the reading chunk
-  // to avoid crash the reader
-  while (!stream->ready_chunks_.empty()) {
+  while (ready && !stream->ready_chunks_.empty()) {
     RETURN_ON_ERROR(store_->Delete(stream->ready_chunks_.front()));
-    stream->ready_chunks_.pop();
+    stream->ready_chunks_.pop_front();
+    stream->released_ += 1;
   }
   return Status::OK();
 }
 
-bool StreamStore::allocatable(std::shared_ptr<StreamHolder> stream,
-                              size_t size) {
-  if (store_->Footprint() + size <
-      store_->FootprintLimit() * threshold_ / 100.0) {
-    return true;
-  } else {
-    return false;
+void StreamStore::wakeupReaders(std::shared_ptr<StreamHolder> stream) {
+  // invoke the callbacks after the cursors have been updated, as they may
+  // reach the stream again
+  std::vector<std::pair<stream_chunks_callback_t, std::vector<ObjectID>>>
+      ready;
+  std::vector<stream_chunks_callback_t> stopped;
+  size_t sealed = stream->released_ + stream->ready_chunks_.size();
+  for (auto& item : stream->consumers_) {
+    auto& consumer = item.second;
+    if (!consumer.reader_) {
+      continue;
+    }
+    size_t count = consumer.reader_->first;
+    if (consumer.cursor_ < sealed) {
+      std::vector<ObjectID> chunks;
+      while (consumer.cursor_ < sealed && chunks.size() < count) {
+        chunks.emplace_back(
+            stream->ready_chunks_[consumer.cursor_ - stream->released_]);
+        consumer.cursor_ += 1;
+      }
+      consumer.reading_ = chunks.size();
+      ready.emplace_back(consumer.reader_->second, std::move(chunks));
+      consumer.reader_ = boost::none;
+    } else if (stream->failed || stream->drained) {
+      stopped.emplace_back(consumer.reader_->second);
+      consumer.reader_ = boost::none;
+    }
+  }
+  for (auto& reader : ready) {
+    VINEYARD_SUPPRESS(reader.first(Status::OK(), reader.second));
+  }
+  for (auto& reader : stopped) {
+    if (stream->failed) {
+      VINEYARD_SUPPRESS(reader(Status::StreamFailed(), {}));
+    } else {
+      VINEYARD_SUPPRESS(reader(Status::StreamDrained(), {}));
+    }
+  }
+}
+
+void StreamStore::wakeupWriter(std::shared_ptr<StreamHolder> stream) {
+  if (!stream->writer_ || !stream->writing_.empty()) {
+    return;
+  }
+  size_t size = std::get<0>(stream->writer_.get());
+  size_t count = std::get<1>(stream->writer_.get());
+  auto writer = std::get<2>(stream->writer_.get());
+  if (allocatable(stream, size, count)) {
+    stream->writer_ = boost::none;
+    auto status = allocate(stream, size, count);
+    if (!status.ok()) {
+      VINEYARD_SUPPRESS(writer(status, {}));
+    } else {
+      VINEYARD_SUPPRESS(writer(Status::OK(), stream->writing_));
+    }
   }
 }
 
@@ -16,28 +16,89 @@ limitations under the License.
 #ifndef SRC_SERVER_MEMORY_STREAM_STORE_H_
 #define SRC_SERVER_MEMORY_STREAM_STORE_H_
 
+#include <deque>
+#include <map>
 #include <memory>
-#include <queue>
+#include <mutex>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common/util/callback.h"
 #include "server/memory/memory.h"
 
 namespace vineyard {
 
+using stream_chunks_callback_t = callback_t<const std::vector<ObjectID>&>;
+
+/**
+ * @brief StreamConsumer is the cursor of a consumer over the chunks of a
+ * stream, see also Notes [Stream Fan-out].
+ */
+struct StreamConsumer {
+  // the index of the next chunk to pull
+  size_t cursor_{0};
+  // the number of chunks before the cursor that are still being read
+  size_t reading_{0};
+  // the pending reader, and the number of chunks it pulls at most
+  boost::optional<std::pair<size_t, stream_chunks_callback_t>> reader_;
+};
+
 /**
  * @brief StreamHolder aims to maintain all chunks for a single stream.
  * "Stream" is a special kind of "Object" in vineyard, which represents
  * a stream (especially for I/O) that connects two drivers and avoids
  * the overhead of immediate temporary data structures and objects.
  *
+ * Notes [Stream Fan-out]:
+ *
+ * A stream has a single producer and could have many consumers, each of which
+ * is registered when a connection opens the stream for reading (or pulls from
+ * it for the first time). Chunks are indexed by the order they are sealed,
+ * and every consumer pulls them in order by its own cursor. A chunk is kept
+ * in `ready_chunks_` until every consumer has pulled it and moved to the next
+ * one, thus one copy of the stream in the shared memory feeds all consumers
+ * and the producer is blocked by the slowest consumer.
+ *
+ * A consumer registered later starts from the oldest chunk that is still
+ * kept, i.e., consumers that must see the whole stream should be registered
+ * before the first chunk is pulled.
+ *
+ * Notes [Stream Chunk Batches]:
+ *
+ * The producer could hold a window of chunks for writing, all of which are
+ * sealed by its next request (or when the stream is stopped), and a consumer
+ * could pull a batch of ready chunks at once, all of which are released by
+ * its next pull, thus the round trip is paid per window (or batch) rather
+ * than per chunk.
+ *
+ * Released chunks are not deleted but recycled for the following requests of
+ * the producer of the same chunk size, the stream keeps at most two windows
+ * of recycled chunks, and deletes them when the stream is stopped.
+ *
+ * The producer could also tell how many bytes it has written into each chunk
+ * of the window when sealing them, i.e., a writer could append records into
+ * the chunk directly and leave the tail unused. Such chunks are shrunk before
+ * being sealed (empty ones are dropped), and won't be recycled.
  */
 struct StreamHolder {
-  boost::optional<ObjectID> current_writing_, current_reading_;
-  std::queue<ObjectID> ready_chunks_;
-  boost::optional<callback_t<ObjectID>> reader_;
-  boost::optional<std::pair<size_t, callback_t<ObjectID>>> writer_;
+  // the chunks that are being written by the producer
+  std::vector<ObjectID> writing_;
+  // the front chunk has the index `released_`
+  std::deque<ObjectID> ready_chunks_;
+  size_t released_{0};
+  // released chunks that could be reused, and their sizes
+  std::deque<std::pair<size_t, ObjectID>> recycled_;
+  // the largest window that the producer has requested
+  size_t window_{1};
+  // the chunk size of the last request of the producer
+  size_t chunk_size_{0};
+  std::map<size_t, StreamConsumer> consumers_;
+  size_t next_consumer_{0};
+  // the pending writer, the size and number of chunks it requests
+  boost::optional<std::tuple<size_t, size_t, stream_chunks_callback_t>>
+      writer_;
   bool drained{false}, failed{false};
   int64_t open_mark{0};
 };
@@ -48,27 +109,45 @@ struct StreamHolder {
  */
 class StreamStore {
  public:
+  // see also `OpenStreamMode` in "basic/stream/stream_utils.h"
+  static constexpr int64_t kReadMode = 1;
+
   StreamStore(std::shared_ptr<BulkStore> store, size_t const stream_threshold)
       : store_(store), threshold_(stream_threshold) {}
 
   Status Create(ObjectID const stream_id);
 
-  Status Open(ObjectID const stream_id, int64_t const mode);
+  /**
+   * @brief Open the stream, a consumer is registered when opened for reading.
+   * The stream can only be opened for writing once.
+   *
+   * @param consumer The registered consumer, if opened for reading.
+   */
+  Status Open(ObjectID const stream_id, int64_t const mode, size_t& consumer);
 
   /**
    * @brief This is called by the producer of the steram and it makes current
-   * chunk available for the consumer to read
+   * chunks available for the consumer to read
    *
-   * @return the next chunk to write
+   * @return the next `count` chunks to write
    */
-  Status Get(ObjectID const stream_id, size_t const size,
-             callback_t<const ObjectID> callback);
+  Status Get(ObjectID const stream_id, size_t const size, size_t const count,
+             stream_chunks_callback_t callback);
 
   /**
-   * @brief The consumer invokes this function to read current chunk
+   * @brief Shrink the chunks that are being written to the sizes that have
+   * been used by the producer, before they are sealed by `Get` or `Stop`.
+   * Chunks that are empty are dropped. See also Notes [Stream Chunk Batches].
+   */
+  Status Shrink(ObjectID const stream_id, std::vector<size_t> const& used);
+
+  /**
+   * @brief The consumer invokes this function to release the chunks it has
+   * been reading, and read at most `count` chunks.
    *
    */
-  Status Pull(ObjectID const stream_id, callback_t<const ObjectID> callback);
+  Status Pull(ObjectID const stream_id, size_t const consumer,
+              size_t const count, stream_chunks_callback_t callback);
 
   /**
    * @brief Function stop is called by the vineyard clients.
@@ -78,17 +157,44 @@ class StreamStore {
 
   /**
    * @brief Function Drop is called by vineyard when the clients loose
-   * connections
+   * connections, it unregisters the consumer, and fails the stream if it is
+   * the last consumer.
    *
    */
-  Status Drop(ObjectID const stream_id);
+  Status Drop(ObjectID const stream_id, size_t const consumer);
 
  private:
-  bool allocatable(std::shared_ptr<StreamHolder> stream, size_t size);
+  bool allocatable(std::shared_ptr<StreamHolder> stream, size_t size,
+                   size_t count);
+
+  /**
+   * @brief Allocate the chunks to write, from the recycled chunks if
+   * possible.
+   */
+  Status allocate(std::shared_ptr<StreamHolder> stream, size_t size,
+                  size_t count);
+
+  /**
+   * @brief Recycle (or delete) the chunks that have been pulled by every
+   * consumer.
+   */
+  Status release(std::shared_ptr<StreamHolder> stream);
+
+  /**
+   * @brief Delete the recycled chunks, as well as the ready chunks if
+   * `ready` is true.
+   */
+  Status clear(std::shared_ptr<StreamHolder> stream, bool ready);
+
+  void wakeupReaders(std::shared_ptr<StreamHolder> stream);
+
+  void wakeupWriter(std::shared_ptr<StreamHolder> stream);
 
   std::shared_ptr<BulkStore> store_;
   size_t threshold_;
   std::unordered_map<ObjectID, std::shared_ptr<StreamHolder>> streams_;
+  // the streams are accessed by requests from all connections
+  std::recursive_mutex mutex_;
 };
 
 }  // namespace vineyard
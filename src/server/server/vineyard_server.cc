@@ -28,6 +28,7 @@ limitations under the License.
 #include "common/util/logging.h"
 #include "server/async/ipc_server.h"
 #include "server/async/rpc_server.h"
+#include "server/memory/slab_allocator.h"
 #include "server/services/meta_service.h"
 #include "server/util/kubectl.h"
 #include "server/util/meta_tree.h"
@@ -52,8 +53,9 @@ namespace vineyard {
 
 bool DeferredReq::Alive() const { return alive_fn_(); }
 
-bool DeferredReq::TestThenCall(const json& meta) const {
+bool DeferredReq::TestThenCall(const json& meta) {
   if (test_fn_(meta)) {
+    done_ = true;
     VINEYARD_SUPPRESS(call_fn_(meta));
     return true;
   }
@@ -91,8 +93,18 @@ Status VineyardServer::Serve() {
   RETURN_ON_ERROR(this->meta_service_ptr_->Start());
 
   bulk_store_ = std::make_shared<BulkStore>();
+  RETURN_ON_ERROR(bulk_store_->SetHugePages(
+      spec_["bulkstore_spec"].value("huge_pages", std::string(""))));
   RETURN_ON_ERROR(bulk_store_->PreAllocate(
       spec_["bulkstore_spec"]["memory_size"].get<size_t>()));
+  RETURN_ON_ERROR(bulk_store_->SetSmallBlobSize(spec_["bulkstore_spec"].value(
+      "small_blob_size", memory::SlabAllocator::kMaxSmallBlobSize)));
+  RETURN_ON_ERROR(bulk_store_->SetSpillPolicy(
+      spec_["bulkstore_spec"]["spill_path"].get_ref<std::string const&>(),
+      spec_["bulkstore_spec"]["spill_lower_rate"].get<double>()));
+  if (spec_["bulkstore_spec"].value("shared_memory_pool", false)) {
+    RETURN_ON_ERROR(bulk_store_->EnableSharedPool());
+  }
   stream_store_ = std::make_shared<StreamStore>(
       bulk_store_, spec_["bulkstore_spec"]["stream_threshold"].get<size_t>());
   BulkReady();
@@ -194,76 +206,82 @@ Status VineyardServer::GetData(const std::vector<ObjectID>& ids,
                                std::function<bool()> alive,
                                callback_t<const json&> callback) {
   ENSURE_VINEYARDD_READY();
-  meta_service_ptr_->RequestToGetData(
-      sync_remote, [this, ids, wait, alive, callback](const Status& status,
-                                                      const json& meta) {
-        if (status.ok()) {
+  auto handler = [this, ids, wait, alive, callback](const Status& status,
+                                                    const json& meta) {
+    if (status.ok()) {
       // When object not exists, we return an empty json, rather than
       // the status to indicate the error.
 #if !defined(NDEBUG)
-          if (VLOG_IS_ON(10)) {
-            VLOG(10) << "Got request from client to get data, dump json:";
-            std::cerr << meta.dump(4) << std::endl;
-            VLOG(10) << "=========================================";
-          }
+      if (VLOG_IS_ON(10)) {
+        VLOG(10) << "Got request from client to get data, dump json:";
+        std::cerr << meta.dump(4) << std::endl;
+        VLOG(10) << "=========================================";
+      }
 #endif
-          auto test_task = [this, ids](const json& meta) -> bool {
-            for (auto const& id : ids) {
-              bool exists = false;
-              if (IsBlob(id)) {
-                exists = this->bulk_store_->Exists(id);
-              } else {
-                VINEYARD_SUPPRESS(
-                    CATCH_JSON_ERROR(meta_tree::Exists(meta, id, exists)));
-              }
-              if (!exists) {
-                return exists;
-              }
+      auto test_task = [this, ids](const json& meta) -> bool {
+        for (auto const& id : ids) {
+          bool exists = false;
+          if (IsBlob(id)) {
+            exists = this->bulk_store_->Exists(id);
+          } else {
+            VINEYARD_SUPPRESS(
+                CATCH_JSON_ERROR(meta_tree::Exists(meta, id, exists)));
+          }
+          if (!exists) {
+            return exists;
+          }
+        }
+        return true;
+      };
+      auto eval_task = [this, ids, callback](const json& meta) -> Status {
+        json sub_tree_group;
+        for (auto const& id : ids) {
+          json sub_tree;
+          if (IsBlob(id)) {
+            std::shared_ptr<Payload> object;
+            if (this->bulk_store_->Get(id, object).ok()) {
+              sub_tree["id"] = VYObjectIDToString(id);
+              sub_tree["typename"] = "vineyard::Blob";
+              sub_tree["length"] = object->data_size;
+              sub_tree["nbytes"] = object->data_size;
+              sub_tree["transient"] = true;
+              sub_tree["instance_id"] = this->instance_id();
             }
-            return true;
-          };
-          auto eval_task = [this, ids, callback](const json& meta) -> Status {
-            json sub_tree_group;
-            for (auto const& id : ids) {
-              json sub_tree;
-              if (IsBlob(id)) {
-                std::shared_ptr<Payload> object;
-                if (this->bulk_store_->Get(id, object).ok()) {
-                  sub_tree["id"] = VYObjectIDToString(id);
-                  sub_tree["typename"] = "vineyard::Blob";
-                  sub_tree["length"] = object->data_size;
-                  sub_tree["nbytes"] = object->data_size;
-                  sub_tree["transient"] = true;
-                  sub_tree["instance_id"] = this->instance_id();
-                }
-              } else {
-                VINEYARD_SUPPRESS(CATCH_JSON_ERROR(meta_tree::GetData(
-                    meta, this->instance_name(), id, sub_tree, instance_id_)));
+          } else {
+            VINEYARD_SUPPRESS(CATCH_JSON_ERROR(meta_tree::GetData(
+                meta, this->instance_name(), id, sub_tree, instance_id_)));
 #if !defined(NDEBUG)
-                if (VLOG_IS_ON(10)) {
-                  VLOG(10) << "Got request response:";
-                  std::cerr << sub_tree.dump(4) << std::endl;
-                  VLOG(10) << "=========================================";
-                }
-#endif
-              }
-              if (sub_tree.is_object() && !sub_tree.empty()) {
-                sub_tree_group[VYObjectIDToString(id)] = sub_tree;
-              }
+            if (VLOG_IS_ON(10)) {
+              VLOG(10) << "Got request response:";
+              std::cerr << sub_tree.dump(4) << std::endl;
+              VLOG(10) << "=========================================";
             }
-            return callback(Status::OK(), sub_tree_group);
-          };
-          if (!wait || test_task(meta)) {
-            return eval_task(meta);
-          } else {
-            this->deferred_.emplace_back(alive, test_task, eval_task);
-            return Status::OK();
+#endif
+          }
+          if (sub_tree.is_object() && !sub_tree.empty()) {
+            sub_tree_group[VYObjectIDToString(id)] = sub_tree;
           }
-        } else {
-          LOG(ERROR) << status.ToString();
-          return status;
         }
-      });
+        return callback(Status::OK(), sub_tree_group);
+      };
+      if (!wait || test_task(meta)) {
+        return eval_task(meta);
+      } else {
+        this->deferRequest(
+            std::make_shared<DeferredReq>(alive, test_task, eval_task), ids);
+        return Status::OK();
+      }
+    } else {
+      LOG(ERROR) << status.ToString();
+      return status;
+    }
+  };
+  if (!sync_remote && !wait) {
+    // read-only, see also: Notes [Concurrent Metadata Queries]
+    meta_service_ptr_->RequestToQuery(handler);
+  } else {
+    meta_service_ptr_->RequestToGetData(sync_remote, handler);
+  }
   return Status::OK();
 }
 
@@ -271,8 +289,7 @@ Status VineyardServer::ListData(std::string const& pattern, bool const regex,
                                 size_t const limit,
                                 callback_t<const json&> callback) {
   ENSURE_VINEYARDD_READY();
-  meta_service_ptr_->RequestToGetData(
-      false,  // no need for sync from etcd
+  meta_service_ptr_->RequestToQuery(
       [this, pattern, regex, limit, callback](const Status& status,
                                               const json& meta) {
         if (status.ok()) {
@@ -392,8 +409,8 @@ Status VineyardServer::IfPersist(const ObjectID id,
     context_.post(boost::bind(callback, Status::OK(), false));
     return Status::OK();
   }
-  meta_service_ptr_->RequestToGetData(
-      false, [id, callback](const Status& status, const json& meta) {
+  meta_service_ptr_->RequestToQuery(
+      [id, callback](const Status& status, const json& meta) {
         if (status.ok()) {
           bool persist = false;
           auto s = CATCH_JSON_ERROR(meta_tree::IfPersist(meta, id, persist));
@@ -533,6 +550,7 @@ Status VineyardServer::DelData(const std::vector<ObjectID>& ids,
       for (auto const id : ids) {
         VINEYARD_DISCARD(bulk_store_->Delete(id));
       }
+      RecordDeleted(ids);
       VINEYARD_DISCARD(callback(Status::OK()));
     });
     return Status::OK();
@@ -563,6 +581,7 @@ Status VineyardServer::DeleteBlobBatch(const std::set<ObjectID>& ids) {
   for (auto object_id : ids) {
     VINEYARD_SUPPRESS(this->bulk_store_->Delete(object_id));
   }
+  RecordDeleted(std::vector<ObjectID>(ids.begin(), ids.end()));
   return Status::OK();
 }
 
@@ -613,9 +632,9 @@ Status VineyardServer::GetName(const std::string& name, const bool wait,
                                                 const json& meta) {
     if (status.ok()) {
       auto test_task = [name](const json& meta) -> bool {
-        auto names = meta.value("names", json(nullptr));
-        if (names.is_object()) {
-          return names.contains(name);
+        auto names = meta.find("names");
+        if (names != meta.end() && names->is_object()) {
+          return names->contains(name);
         }
         return false;
       };
@@ -633,7 +652,8 @@ Status VineyardServer::GetName(const std::string& name, const bool wait,
       if (!wait || test_task(meta)) {
         return eval_task(meta);
       } else {
-        deferred_.emplace_back(alive, test_task, eval_task);
+        this->deferRequest(
+            std::make_shared<DeferredReq>(alive, test_task, eval_task), name);
         return Status::OK();
       }
     } else {
@@ -844,7 +864,10 @@ Status VineyardServer::InstanceStatus(callback_t<const json&> callback) {
   status["deployment"] = GetDeployment();
   status["memory_usage"] = bulk_store_->Footprint();
   status["memory_limit"] = bulk_store_->FootprintLimit();
-  status["deferred_requests"] = deferred_.size();
+  status["memory_in_use"] = bulk_store_->PinnedSize();
+  status["memory_spilled"] = bulk_store_->SpilledSize();
+  status["allocator"] = bulk_store_->AllocatorStats();
+  status["deferred_requests"] = deferred_size_.load();
   if (ipc_server_ptr_) {
     status["ipc_connections"] = ipc_server_ptr_->AliveConnections();
   } else {
@@ -859,18 +882,153 @@ Status VineyardServer::InstanceStatus(callback_t<const json&> callback) {
   return callback(Status::OK(), status);
 }
 
-Status VineyardServer::ProcessDeferred(const json& meta) {
+/**
+ * Notes [Deferred Requests]:
+ *
+ * Deferred `GetData(wait=true)` and `GetName(wait=true)` requests are indexed
+ * by the object IDs and names they are waiting for, and a metadata update only
+ * tests the requests that wait on the objects or names it touches, rather than
+ * every deferred request.
+ *
+ * - A request that waits on several objects is indexed under each of them,
+ *   and once it has been called, the rest of its index entries are dropped
+ *   lazily when those objects are updated, or by the periodic sweep.
+ * - Blobs become available by being sealed in the bulk store rather than by
+ *   metadata updates, thus requests that wait on blobs are not indexed, and
+ *   are still tested on every metadata update.
+ * - Requests whose connections have gone are swept every
+ *   `kDeferredSweepInterval` updates.
+ */
+static constexpr size_t kDeferredSweepInterval = 1024;
+
+void VineyardServer::deferRequest(std::shared_ptr<DeferredReq> const& request,
+                                  const std::vector<ObjectID>& ids) {
+  deferred_size_ += 1;
+  for (auto const& id : ids) {
+    if (IsBlob(id)) {
+      deferred_.emplace_back(request);
+      return;
+    }
+  }
+  for (auto const& id : ids) {
+    deferred_by_object_.emplace(id, request);
+  }
+}
+
+void VineyardServer::deferRequest(std::shared_ptr<DeferredReq> const& request,
+                                  const std::string& name) {
+  deferred_size_ += 1;
+  deferred_by_name_.emplace(name, request);
+}
+
+template <typename Index, typename Key>
+static size_t process_deferred(const json& meta, Index& index, Key const& key) {
+  size_t finished = 0;
+  auto range = index.equal_range(key);
+  auto iter = range.first;
+  while (iter != range.second) {
+    auto& request = iter->second;
+    if (request->Done()) {
+      // has been finished via another index entry
+      iter = index.erase(iter);
+    } else if (!request->Alive()) {
+      request->Cancel();
+      finished += 1;
+      iter = index.erase(iter);
+    } else if (request->TestThenCall(meta)) {
+      finished += 1;
+      iter = index.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  return finished;
+}
+
+template <typename Index>
+static size_t sweep_deferred(Index& index) {
+  size_t finished = 0;
+  auto iter = index.begin();
+  while (iter != index.end()) {
+    auto& request = iter->second;
+    if (request->Done()) {
+      iter = index.erase(iter);
+    } else if (!request->Alive()) {
+      request->Cancel();
+      finished += 1;
+      iter = index.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  return finished;
+}
+
+Status VineyardServer::ProcessDeferred(const json& meta,
+                                       const std::set<ObjectID>& objects,
+                                       const std::set<std::string>& names) {
+  size_t finished = 0;
   auto iter = deferred_.begin();
   while (iter != deferred_.end()) {
-    if (!iter->Alive() || iter->TestThenCall(meta)) {
+    if (!(*iter)->Alive() || (*iter)->TestThenCall(meta)) {
+      finished += 1;
       deferred_.erase(iter++);
     } else {
       ++iter;
     }
   }
+  if (!deferred_by_object_.empty()) {
+    for (auto const& id : objects) {
+      finished += process_deferred(meta, deferred_by_object_, id);
+    }
+  }
+  if (!deferred_by_name_.empty()) {
+    for (auto const& name : names) {
+      finished += process_deferred(meta, deferred_by_name_, name);
+    }
+  }
+  if (++deferred_updates_ % kDeferredSweepInterval == 0) {
+    finished += sweep_deferred(deferred_by_object_);
+    finished += sweep_deferred(deferred_by_name_);
+  }
+  deferred_size_ -= finished;
   return Status::OK();
 }
 
+// the number of deletions that are kept for clients to catch up, a client
+// that falls further behind drops its whole metadata cache.
+static constexpr size_t kDeletedLogCapacity = 64 * 1024;
+
+void VineyardServer::RecordDeleted(const std::vector<ObjectID>& ids) {
+  if (ids.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(deleted_mutex_);
+  for (auto const id : ids) {
+    deleted_log_.emplace_back(id);
+  }
+  deleted_sequence_ += ids.size();
+  while (deleted_log_.size() > kDeletedLogCapacity) {
+    deleted_log_.pop_front();
+  }
+}
+
+void VineyardServer::DeletedSince(const uint64_t since, uint64_t& sequence,
+                                  std::vector<ObjectID>& ids, bool& overflow) {
+  std::lock_guard<std::mutex> guard(deleted_mutex_);
+  sequence = deleted_sequence_;
+  overflow = false;
+  if (since >= deleted_sequence_) {
+    return;
+  }
+  uint64_t oldest = deleted_sequence_ - deleted_log_.size();
+  if (since < oldest) {
+    overflow = true;
+    return;
+  }
+  ids.assign(deleted_log_.begin() + (since - oldest), deleted_log_.end());
+}
+
 const std::string VineyardServer::IPCSocket() {
   if (this->ipc_server_ptr_) {
     return ipc_server_ptr_->Socket();
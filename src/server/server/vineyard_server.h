@@ -17,11 +17,14 @@ limitations under the License.
 #define SRC_SERVER_SERVER_VINEYARD_SERVER_H_
 
 #include <atomic>
+#include <deque>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "boost/asio.hpp"
@@ -58,12 +61,21 @@ class DeferredReq {
 
   bool Alive() const;
 
-  bool TestThenCall(const json& meta) const;
+  bool TestThenCall(const json& meta);
+
+  /**
+   * @brief Whether the request has been called, or has been given up as the
+   * connection is gone.
+   */
+  bool Done() const { return done_; }
+
+  void Cancel() { done_ = true; }
 
  private:
   alive_t alive_fn_;
   test_t test_fn_;
   call_t call_fn_;
+  bool done_ = false;
 };
 
 /**
@@ -151,7 +163,27 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 
   Status InstanceStatus(callback_t<const json&> callback);
 
-  Status ProcessDeferred(const json& meta);
+  /**
+   * @brief Wake up the deferred requests that may be satisfied after the
+   * given objects or names have been updated in the metadata.
+   */
+  Status ProcessDeferred(const json& meta, const std::set<ObjectID>& objects,
+                         const std::set<std::string>& names);
+
+  /**
+   * @brief Record the objects (and blobs) that have been deleted, clients poll
+   * them to invalidate their metadata caches, see also
+   * Notes [Client Metadata Cache] in "client/meta_cache.h".
+   */
+  void RecordDeleted(const std::vector<ObjectID>& ids);
+
+  /**
+   * @brief The objects that have been deleted after the sequence number
+   * `since`, and the latest sequence number. `overflow` means some of those
+   * deletions have been dropped from the log.
+   */
+  void DeletedSince(const uint64_t since, uint64_t& sequence,
+                    std::vector<ObjectID>& ids, bool& overflow);
 
   inline InstanceID instance_id() { return instance_id_; }
   inline std::string instance_name() { return instance_name_; }
@@ -204,7 +236,25 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
   std::unique_ptr<IPCServer> ipc_server_ptr_;
   std::unique_ptr<RPCServer> rpc_server_ptr_;
 
-  std::list<DeferredReq> deferred_;
+  // see also: Notes [Deferred Requests]
+  void deferRequest(std::shared_ptr<DeferredReq> const& request,
+                    const std::vector<ObjectID>& ids);
+  void deferRequest(std::shared_ptr<DeferredReq> const& request,
+                    const std::string& name);
+
+  std::list<std::shared_ptr<DeferredReq>> deferred_;
+  std::unordered_multimap<ObjectID, std::shared_ptr<DeferredReq>>
+      deferred_by_object_;
+  std::unordered_multimap<std::string, std::shared_ptr<DeferredReq>>
+      deferred_by_name_;
+  std::atomic<size_t> deferred_size_{0};
+  size_t deferred_updates_ = 0;
+
+  // the log of recently deleted objects, the i-th entry has the sequence
+  // number `deleted_sequence_ - deleted_log_.size() + i + 1`.
+  std::mutex deleted_mutex_;
+  std::deque<ObjectID> deleted_log_;
+  uint64_t deleted_sequence_ = 0;
 
   std::shared_ptr<BulkStore> bulk_store_;
   std::shared_ptr<StreamStore> stream_store_;
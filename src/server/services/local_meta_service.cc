@@ -0,0 +1,377 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/services/local_meta_service.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/util/boost.h"
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+namespace wal {
+
+/**
+ * Every commit is a record in the log:
+ *
+ *    | payload size (uint64) | rev (uint32) | number of ops (uint32) | ops |
+ *
+ * and every op is encoded as
+ *
+ *    | op type (uint8) | key size (uint32) | key |
+ *    | value size (uint32) | value |
+ */
+
+template <typename T>
+static void encode(std::string& buffer, const T value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void encode(std::string& buffer, const std::string& value) {
+  encode(buffer, static_cast<uint32_t>(value.size()));
+  buffer.append(value);
+}
+
+template <typename T>
+static bool decode(const std::string& buffer, size_t& offset, T& value) {
+  if (offset + sizeof(T) > buffer.size()) {
+    return false;
+  }
+  memcpy(&value, buffer.data() + offset, sizeof(T));
+  offset += sizeof(T);
+  return true;
+}
+
+static bool decode(const std::string& buffer, size_t& offset,
+                   std::string& value) {
+  uint32_t size = 0;
+  if (!decode(buffer, offset, size) || offset + size > buffer.size()) {
+    return false;
+  }
+  value.assign(buffer.data() + offset, size);
+  offset += size;
+  return true;
+}
+
+static void encode_record(std::string& buffer,
+                          const std::vector<IMetaService::op_t>& ops,
+                          const unsigned rev) {
+  size_t head = buffer.size();
+  encode(buffer, static_cast<uint64_t>(0));  // placeholder of payload size
+  encode(buffer, static_cast<uint32_t>(rev));
+  encode(buffer, static_cast<uint32_t>(ops.size()));
+  for (auto const& op : ops) {
+    encode(buffer, static_cast<uint8_t>(op.op));
+    encode(buffer, op.kv.key);
+    encode(buffer, op.op == IMetaService::op_t::kPut ? op.kv.value : "");
+  }
+  uint64_t payload_size = buffer.size() - head - sizeof(uint64_t);
+  memcpy(&buffer[head], &payload_size, sizeof(uint64_t));
+}
+
+static bool decode_record(const std::string& buffer, size_t& offset,
+                          std::vector<IMetaService::op_t>& ops,
+                          unsigned& rev) {
+  uint64_t payload_size = 0;
+  if (!decode(buffer, offset, payload_size) ||
+      offset + payload_size > buffer.size()) {
+    return false;
+  }
+  uint32_t record_rev = 0, size = 0;
+  if (!decode(buffer, offset, record_rev) || !decode(buffer, offset, size)) {
+    return false;
+  }
+  for (uint32_t index = 0; index < size; ++index) {
+    uint8_t type = 0;
+    std::string key, value;
+    if (!decode(buffer, offset, type) || !decode(buffer, offset, key) ||
+        !decode(buffer, offset, value)) {
+      return false;
+    }
+    if (type == IMetaService::op_t::kPut) {
+      ops.emplace_back(IMetaService::op_t::Put(key, value, record_rev));
+    } else {
+      ops.emplace_back(IMetaService::op_t::Del(key, record_rev));
+    }
+  }
+  rev = record_rev;
+  return true;
+}
+
+static Status write_fully(const int fd, const std::string& path,
+                          const std::string& buffer) {
+  size_t offset = 0;
+  while (offset < buffer.size()) {
+    ssize_t nbytes = write(fd, buffer.data() + offset, buffer.size() - offset);
+    if (nbytes == -1 && errno == EINTR) {
+      continue;
+    }
+    if (nbytes <= 0) {
+      return Status::IOError("Failed to write the metadata log '" + path +
+                             "': " + strerror(errno));
+    }
+    offset += nbytes;
+  }
+  return Status::OK();
+}
+
+}  // namespace wal
+
+LocalMetaService::LocalMetaService(vs_ptr_t& server_ptr)
+    : IMetaService(server_ptr),
+      meta_spec_(server_ptr_->GetSpec()["metastore_spec"]),
+      wal_path_(meta_spec_.value("meta_wal_path", std::string())),
+      head_rev_(1) {}
+
+LocalMetaService::~LocalMetaService() {
+  if (wal_fd_ != -1) {
+    close(wal_fd_);
+    wal_fd_ = -1;
+  }
+}
+
+void LocalMetaService::Stop() {
+  std::lock_guard<std::mutex> scope_lock(mutex_);
+  if (wal_fd_ != -1) {
+    fsync(wal_fd_);
+  }
+}
+
+void LocalMetaService::requestLock(
+    std::string lock_name,
+    callback_t<std::shared_ptr<ILock>> callback_after_locked) {
+  std::lock_guard<std::mutex> scope_lock(mutex_);
+  auto& state = locks_[lock_name];
+  if (state.held) {
+    state.waiters.emplace_back(callback_after_locked);
+    return;
+  }
+  state.held = true;
+  grantLock(lock_name, callback_after_locked);
+}
+
+void LocalMetaService::grantLock(
+    const std::string& lock_name,
+    callback_t<std::shared_ptr<ILock>> callback_after_locked) {
+  auto lock_ptr = std::make_shared<LocalLock>(
+      [this, lock_name](const Status& status, unsigned& rev) {
+        return this->releaseLock(lock_name, rev);
+      },
+      head_rev_);
+  server_ptr_->GetMetaContext().post(
+      boost::bind(callback_after_locked, Status::OK(), lock_ptr));
+}
+
+Status LocalMetaService::releaseLock(const std::string& lock_name,
+                                     unsigned& rev) {
+  std::lock_guard<std::mutex> scope_lock(mutex_);
+  rev = head_rev_;
+  auto& state = locks_[lock_name];
+  if (state.waiters.empty()) {
+    state.held = false;
+    return Status::OK();
+  }
+  // hand over the lock to the next waiter
+  auto callback_after_locked = state.waiters.front();
+  state.waiters.pop_front();
+  grantLock(lock_name, callback_after_locked);
+  return Status::OK();
+}
+
+void LocalMetaService::commitUpdates(
+    const std::vector<op_t>& changes,
+    callback_t<unsigned> callback_after_updated) {
+  Status status;
+  unsigned rev = 0;
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex_);
+    status = appendLog(changes, head_rev_ + 1);
+    if (status.ok()) {
+      head_rev_ += 1;
+      applyOps(changes);
+    }
+    rev = head_rev_;
+  }
+  server_ptr_->GetMetaContext().post(
+      boost::bind(callback_after_updated, status, rev));
+}
+
+void LocalMetaService::requestAll(
+    const std::string& prefix, unsigned base_rev,
+    callback_t<const std::vector<IMetaService::op_t>&, unsigned> callback) {
+  std::vector<op_t> ops;
+  unsigned rev = 0;
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex_);
+    rev = head_rev_;
+    for (auto iter = kvs_.lower_bound(prefix); iter != kvs_.end(); ++iter) {
+      if (!boost::algorithm::starts_with(iter->first, prefix)) {
+        break;
+      }
+      ops.emplace_back(op_t::Put(iter->first, iter->second, rev));
+    }
+  }
+  server_ptr_->GetMetaContext().post(
+      boost::bind(callback, Status::OK(), ops, rev));
+}
+
+void LocalMetaService::requestUpdates(
+    const std::string& prefix, unsigned,
+    callback_t<const std::vector<op_t>&, unsigned> callback) {
+  // every committed op has been applied to the metadata tree before being
+  // committed, see also Notes [Local Meta Service].
+  unsigned rev = 0;
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex_);
+    rev = head_rev_;
+  }
+  server_ptr_->GetMetaContext().post(
+      boost::bind(callback, Status::OK(), std::vector<op_t>{}, rev));
+}
+
+void LocalMetaService::startDaemonWatch(
+    const std::string& prefix, unsigned since_rev,
+    callback_t<const std::vector<op_t>&, unsigned, callback_t<unsigned>>
+        callback) {
+  // there's no other writers of the local meta store, nothing to watch.
+  VLOG(10) << "local meta service doesn't need a daemon watch, since "
+           << since_rev;
+}
+
+Status LocalMetaService::preStart() {
+  if (wal_path_.empty()) {
+    LOG(INFO) << "local meta service is running without a write-ahead log, "
+                 "metadata won't be kept after restart";
+    return Status::OK();
+  }
+  std::lock_guard<std::mutex> scope_lock(mutex_);
+  RETURN_ON_ERROR(replayLog());
+  RETURN_ON_ERROR(compactLog());
+  LOG(INFO) << "local meta service recovered " << kvs_.size()
+            << " keys from '" << wal_path_ << "', at revision " << head_rev_;
+  return Status::OK();
+}
+
+void LocalMetaService::applyOps(const std::vector<op_t>& ops) {
+  for (auto const& op : ops) {
+    if (op.op == op_t::kPut) {
+      kvs_[op.kv.key] = op.kv.value;
+    } else if (op.op == op_t::kDel) {
+      kvs_.erase(op.kv.key);
+    }
+  }
+}
+
+Status LocalMetaService::replayLog() {
+  std::ifstream stream(wal_path_, std::ios::in | std::ios::binary);
+  if (!stream.is_open()) {
+    // start with an empty store
+    return Status::OK();
+  }
+  std::string buffer((std::istreambuf_iterator<char>(stream)),
+                     std::istreambuf_iterator<char>());
+  if (stream.bad()) {
+    return Status::IOError("Failed to read the metadata log '" + wal_path_ +
+                           "'");
+  }
+  size_t offset = 0, records = 0;
+  while (offset < buffer.size()) {
+    std::vector<op_t> ops;
+    unsigned rev = 0;
+    if (!wal::decode_record(buffer, offset, ops, rev)) {
+      LOG(WARNING) << "Discard the torn tail of the metadata log '"
+                   << wal_path_ << "' after " << records << " records";
+      break;
+    }
+    applyOps(ops);
+    head_rev_ = std::max(head_rev_, rev);
+    records += 1;
+  }
+  return Status::OK();
+}
+
+Status LocalMetaService::compactLog() {
+  // rewrite the log as a single snapshot record, then swap it in
+  std::vector<op_t> ops;
+  ops.reserve(kvs_.size());
+  for (auto const& kv : kvs_) {
+    ops.emplace_back(op_t::Put(kv.first, kv.second, head_rev_));
+  }
+  std::string buffer;
+  if (!ops.empty()) {
+    wal::encode_record(buffer, ops, head_rev_);
+  }
+
+  std::string snapshot_path = wal_path_ + ".snapshot";
+  int fd = open(snapshot_path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+  if (fd == -1) {
+    return Status::IOError("Failed to open the metadata log '" +
+                           snapshot_path + "': " + strerror(errno));
+  }
+  auto status = wal::write_fully(fd, snapshot_path, buffer);
+  if (status.ok() && fsync(fd) != 0) {
+    status = Status::IOError("Failed to sync the metadata log '" +
+                             snapshot_path + "': " + strerror(errno));
+  }
+  close(fd);
+  if (status.ok() && rename(snapshot_path.c_str(), wal_path_.c_str()) != 0) {
+    status = Status::IOError("Failed to replace the metadata log '" +
+                             wal_path_ + "': " + strerror(errno));
+  }
+  if (!status.ok()) {
+    unlink(snapshot_path.c_str());
+    return status;
+  }
+
+  wal_fd_ = open(wal_path_.c_str(), O_CREAT | O_WRONLY | O_APPEND, 0600);
+  if (wal_fd_ == -1) {
+    return Status::IOError("Failed to open the metadata log '" + wal_path_ +
+                           "': " + strerror(errno));
+  }
+  return Status::OK();
+}
+
+Status LocalMetaService::appendLog(const std::vector<op_t>& ops,
+                                   const unsigned rev) {
+  if (wal_fd_ == -1) {
+    return Status::OK();
+  }
+  // a single write per commit, the record survives a crash of vineyardd once
+  // the write returns.
+  std::string buffer;
+  wal::encode_record(buffer, ops, rev);
+  off_t tail = lseek(wal_fd_, 0, SEEK_END);
+  auto status = wal::write_fully(wal_fd_, wal_path_, buffer);
+  if (!status.ok() && tail != -1) {
+    // drop the partial record, otherwise it hides the following records
+    // when replaying.
+    VINEYARD_DISCARD(ftruncate(wal_fd_, tail));
+  }
+  return status;
+}
+
+}  // namespace vineyard
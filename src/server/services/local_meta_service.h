@@ -0,0 +1,140 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_SERVICES_LOCAL_META_SERVICE_H_
+#define SRC_SERVER_SERVICES_LOCAL_META_SERVICE_H_
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "server/services/meta_service.h"
+
+namespace vineyard {
+
+/**
+ * Notes [Local Meta Service]:
+ *
+ * `LocalMetaService` keeps the key-value pairs that would otherwise be stored
+ * in etcd in the memory of vineyardd itself, and is selected by `--meta=local`
+ * for single-host deployments that don't need to share metadata with other
+ * vineyardd instances.
+ *
+ * - The store has a single writer (this vineyardd), every commit bumps the
+ *   revision by one, like a etcd transaction.
+ * - Commits are always applied to the metadata tree before being committed
+ *   (see `IMetaService::RequestToPersist`), so there's nothing to watch and
+ *   `requestUpdates` only needs to report the latest revision.
+ * - With `--meta_wal_path`, every commit is appended to a write-ahead log
+ *   before being applied to the store, and the log is replayed (and then
+ *   compacted to a snapshot) when vineyardd restarts. A record that is torn
+ *   by a crash is discarded.
+ */
+
+/**
+ * @brief LocalLock is the in-process lock of the local meta service
+ *
+ */
+class LocalLock : public ILock {
+ public:
+  Status Release(unsigned& rev) override {
+    return callback_(Status::OK(), rev);
+  }
+  ~LocalLock() override {}
+
+  explicit LocalLock(const callback_t<unsigned&>& callback, unsigned rev)
+      : ILock(rev), callback_(callback) {}
+
+ protected:
+  const callback_t<unsigned&> callback_;
+};
+
+/**
+ * @brief LocalMetaService provides meta services with an in-memory key-value
+ * store, and optionally a write-ahead log, without etcd
+ *
+ */
+class LocalMetaService : public IMetaService {
+ public:
+  ~LocalMetaService() override;
+
+  void Stop() override;
+
+ protected:
+  explicit LocalMetaService(vs_ptr_t& server_ptr);
+
+  void requestLock(
+      std::string lock_name,
+      callback_t<std::shared_ptr<ILock>> callback_after_locked) override;
+
+  void requestAll(
+      const std::string& prefix, unsigned base_rev,
+      callback_t<const std::vector<op_t>&, unsigned> callback) override;
+
+  void requestUpdates(
+      const std::string& prefix, unsigned since_rev,
+      callback_t<const std::vector<op_t>&, unsigned> callback) override;
+
+  void commitUpdates(const std::vector<op_t>&,
+                     callback_t<unsigned> callback_after_updated) override;
+
+  void startDaemonWatch(
+      const std::string& prefix, unsigned since_rev,
+      callback_t<const std::vector<op_t>&, unsigned, callback_t<unsigned>>
+          callback) override;
+
+  Status probe() override { return Status::OK(); }
+
+  const json meta_spec_;
+  const std::string wal_path_;
+
+ private:
+  Status preStart() override;
+
+  // requires `mutex_` to be held
+  void grantLock(const std::string& lock_name,
+                 callback_t<std::shared_ptr<ILock>> callback_after_locked);
+
+  Status releaseLock(const std::string& lock_name, unsigned& rev);
+
+  void applyOps(const std::vector<op_t>& ops);
+
+  Status replayLog();
+
+  Status compactLog();
+
+  Status appendLog(const std::vector<op_t>& ops, const unsigned rev);
+
+  struct lock_state_t {
+    bool held = false;
+    std::deque<callback_t<std::shared_ptr<ILock>>> waiters;
+  };
+
+  std::mutex mutex_;
+  std::map<std::string, std::string> kvs_;
+  unsigned head_rev_;
+  std::unordered_map<std::string, lock_state_t> locks_;
+  int wal_fd_ = -1;
+
+  friend class IMetaService;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_SERVICES_LOCAL_META_SERVICE_H_
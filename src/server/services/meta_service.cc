@@ -16,19 +16,223 @@ limitations under the License.
 #include "server/services/meta_service.h"
 
 #include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "glog/logging.h"
 
 #include "server/services/etcd_meta_service.h"
+#include "server/services/local_meta_service.h"
 #include "server/util/meta_tree.h"
 
 namespace vineyard {
 
 std::shared_ptr<IMetaService> IMetaService::Get(vs_ptr_t ptr) {
+  auto const& spec = ptr->GetSpec()["metastore_spec"];
+  std::string meta = spec.value("meta", std::string("etcd"));
+  if (meta == "local") {
+    return std::shared_ptr<IMetaService>(new LocalMetaService(ptr));
+  }
+  if (meta != "etcd") {
+    LOG(WARNING) << "Unknown metadata storage '" << meta
+                 << "', fallback to etcd";
+  }
   return std::shared_ptr<IMetaService>(new EtcdMetaService(ptr));
 }
 
+/**
+ * Notes [Concurrent Metadata Queries]:
+ *
+ * The metadata tree is owned by the meta context: all writes (`metaUpdate`)
+ * and every request that needs to sync with etcd, defer itself, or commit
+ * changes are still processed there, one by one.
+ *
+ * Read-only queries (`RequestToQuery`, e.g., `ListData`, `IfPersist`, and
+ * `GetData` that doesn't sync or wait) run on the IPC worker threads instead,
+ * under a shared lock of the tree, thus a large `ListData` doesn't stall other
+ * clients' metadata requests:
+ *
+ * - `metaUpdate` applies the changes under the exclusive lock, and the tree
+ *   seen by a query is consistent (between two updates), the meta context
+ *   itself reads the tree without the lock as it is the only writer,
+ * - a writer holds `meta_writer_gate_` while waiting for the exclusive lock,
+ *   so new queries don't starve the writer,
+ * - at most `--meta_query_concurrency` queries run at the same time, the rest
+ *   queue up in arrival order. IPC clients have at most one outstanding
+ *   request each, so every connection gets its turn and a few clients that
+ *   issue expensive queries cannot occupy all worker threads.
+ *
+ * Setting `--meta_query_concurrency` to 0 processes queries on the meta
+ * context as before.
+ */
+void IMetaService::runQuery(callback_t<const json&> callback) {
+  server_ptr_->GetContext().post([this, callback]() {
+    {
+      { std::lock_guard<std::mutex> writer_gate(meta_writer_gate_); }
+      std::shared_lock<std::shared_timed_mutex> reader_lock(meta_mutex_);
+      VINEYARD_SUPPRESS(callback(Status::OK(), meta_));
+    }
+    callback_t<const json&> next;
+    {
+      std::lock_guard<std::mutex> scope_lock(query_mutex_);
+      if (pending_queries_.empty()) {
+        queries_in_flight_ -= 1;
+        return;
+      }
+      next = std::move(pending_queries_.front());
+      pending_queries_.pop_front();
+    }
+    this->runQuery(next);
+  });
+}
+
+/**
+ * Notes [Group Commit]:
+ *
+ * Every `RequestToPersist` (and `RequestToDelete` that needs to sync with
+ * remote) used to acquire the meta sync lock and issue its own transaction,
+ * so many clients that persist objects concurrently are bounded by the
+ * transaction rate of the meta service.
+ *
+ * Now the requests are queued in the meta context and committed in groups:
+ *
+ * - if there's no commit in flight, the queued requests are committed at
+ *   once, or after `--meta_group_commit_window_us` if it is set and the queue
+ *   is shorter than `--meta_group_commit_size`,
+ * - requests that arrive when a commit is in flight are queued and committed
+ *   together once it finishes,
+ * - a group holds the lock once, and the `callback_after_ready` of each
+ *   request is invoked in order and applied locally, so every request sees the
+ *   changes of the requests before it, exactly as if they were committed one
+ *   by one; the ops are then committed in a single `commitUpdates`,
+ * - a request that fails in its `callback_after_ready` doesn't contribute any
+ *   ops and fails alone, the others get the status of the commit.
+ *
+ * The size and latency of each group commit are reported as metrics.
+ */
+void IMetaService::schedulePersist() {
+  if (persist_in_flight_ || persist_queue_.empty()) {
+    return;
+  }
+  if (group_commit_window_us_ <= 0 ||
+      persist_queue_.size() >= group_commit_size_) {
+    flushPersist();
+    return;
+  }
+  if (persist_timer_armed_) {
+    return;
+  }
+  persist_timer_armed_ = true;
+  persist_timer_.reset(new asio::steady_timer(
+      server_ptr_->GetMetaContext(),
+      std::chrono::microseconds(group_commit_window_us_)));
+  persist_timer_->async_wait([this](const boost::system::error_code& error) {
+    persist_timer_armed_ = false;
+    if (error == asio::error::operation_aborted) {
+      return;
+    }
+    this->flushPersist();
+  });
+}
+
+void IMetaService::flushPersist() {
+  if (persist_in_flight_ || persist_queue_.empty()) {
+    return;
+  }
+  if (persist_timer_armed_) {
+    persist_timer_armed_ = false;
+    persist_timer_->cancel();
+  }
+  persist_in_flight_ = true;
+  auto start = std::chrono::steady_clock::now();
+
+  auto batch = std::make_shared<std::vector<persist_request_t>>();
+  size_t batch_size = std::min(group_commit_size_, persist_queue_.size());
+  batch->reserve(batch_size);
+  for (size_t index = 0; index < batch_size; ++index) {
+    batch->emplace_back(std::move(persist_queue_.front()));
+    persist_queue_.pop_front();
+  }
+  auto statuses = std::make_shared<std::vector<Status>>(batch->size());
+
+  // NB: when persist local meta to etcd, we needs the meta_sync_lock_ to
+  // avoid contention between other vineyard instances.
+  this->requestLock(meta_sync_lock_, [this, batch, statuses, start](
+                                         const Status& status,
+                                         std::shared_ptr<ILock> lock) {
+    if (!status.ok()) {
+      LOG(ERROR) << status.ToString();
+      this->finishPersist(batch, statuses, status, start);
+      return Status::OK();
+    }
+    requestValues("", [this, batch, statuses, start, lock](
+                          const Status& status, const json& meta,
+                          unsigned rev) {
+      std::vector<op_t> ops;
+      for (size_t index = 0; index < batch->size(); ++index) {
+        auto& request = (*batch)[index];
+        std::vector<op_t> request_ops;
+        auto s = request.callback_after_ready(status, meta, request_ops);
+        if (!s.ok()) {
+          (*statuses)[index] = s;
+          continue;
+        }
+        if (!request.applied) {
+          // apply changes locally before committing to etcd
+          this->metaUpdate(request_ops, false);
+        }
+        ops.insert(ops.end(), std::make_move_iterator(request_ops.begin()),
+                   std::make_move_iterator(request_ops.end()));
+      }
+      if (ops.empty()) {
+        unsigned rev_after_unlock = 0;
+        VINEYARD_DISCARD(lock->Release(rev_after_unlock));
+        this->finishPersist(batch, statuses, Status::OK(), start);
+        return Status::OK();
+      }
+      LOG_SUMMARY("meta_group_commit_ops", "", ops.size());
+      // commit to etcd
+      this->commitUpdates(ops, [this, batch, statuses, start, lock](
+                                   const Status& status, unsigned rev) {
+        // update rev_ to the revision after unlock.
+        unsigned rev_after_unlock = 0;
+        VINEYARD_DISCARD(lock->Release(rev_after_unlock));
+        this->finishPersist(batch, statuses, status, start);
+        return Status::OK();
+      });
+      return Status::OK();
+    });
+    return Status::OK();
+  });
+}
+
+void IMetaService::finishPersist(
+    std::shared_ptr<std::vector<persist_request_t>> batch,
+    std::shared_ptr<std::vector<Status>> statuses, const Status& status,
+    std::chrono::steady_clock::time_point start) {
+  auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  LOG_SUMMARY("meta_group_commit_size", "", batch->size());
+  LOG_SUMMARY("meta_group_commit_duration_microseconds", "", duration);
+  VLOG(10) << "group commit of " << batch->size() << " requests use "
+           << duration << " microseconds";
+
+  for (size_t index = 0; index < batch->size(); ++index) {
+    auto const& s = (*statuses)[index];
+    VINEYARD_SUPPRESS(
+        (*batch)[index].callback_after_finish(s.ok() ? status : s));
+  }
+  persist_in_flight_ = false;
+  this->schedulePersist();
+}
+
 /** Note [Deleting objects and blobs]
  *
  * Blob is special: suppose A -> B and A -> C, where A is an object, B is an
@@ -323,6 +527,7 @@ void IMetaService::putVal(const kv_t& kv, bool const from_remote) {
       }
     }
     meta_[json::json_pointer(kv.key)] = value;
+    indexUpdate(kv.key);
     return Status::OK();
   };
 
@@ -374,11 +579,37 @@ void IMetaService::delVal(std::string const& key) {
     if (meta_[ppath].empty()) {
       meta_[ppath.parent_pointer()].erase(ppath.back());
     }
+    indexUpdate(key);
   }
 }
 
 void IMetaService::delVal(const kv_t& kv) { delVal(kv.key); }
 
+void IMetaService::indexUpdate(std::string const& key) {
+  // see also: Notes [Metadata Index] in "server/util/meta_index.h"
+  std::vector<std::string> vs;
+  boost::algorithm::split(vs, key, [](const char c) { return c == '/'; });
+  if (vs[0].empty()) {
+    vs.erase(vs.begin());
+  }
+  if (vs.empty()) {
+    return;
+  }
+  if (vs[0] == "data") {
+    if (vs.size() >= 2) {
+      meta_index_.Refresh(vs[1]);
+    } else {
+      meta_index_.Rebuild();
+    }
+  } else if (vs[0] == "signatures") {
+    if (vs.size() >= 3) {
+      meta_index_.RefreshSignature(vs[1], vs[2]);
+    } else {
+      meta_index_.Rebuild();
+    }
+  }
+}
+
 void IMetaService::delVal(ObjectID const& target, std::set<ObjectID>& blobs) {
   if (target == InvalidObjectID()) {
     return;
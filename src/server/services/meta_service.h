@@ -16,11 +16,15 @@ limitations under the License.
 #ifndef SRC_SERVER_SERVICES_META_SERVICE_H_
 #define SRC_SERVER_SERVICES_META_SERVICE_H_
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
@@ -37,6 +41,7 @@ limitations under the License.
 #include "common/util/logging.h"
 #include "common/util/status.h"
 #include "server/server/vineyard_server.h"
+#include "server/util/meta_index.h"
 #include "server/util/metrics.h"
 
 #define HEARTBEAT_TIME 60
@@ -125,7 +130,18 @@ class IMetaService {
   };
   virtual ~IMetaService() {}
   explicit IMetaService(vs_ptr_t& server_ptr)
-      : server_ptr_(server_ptr), rev_(0), meta_sync_lock_("/meta_sync_lock") {}
+      : meta_index_(meta_),
+        server_ptr_(server_ptr),
+        rev_(0),
+        meta_sync_lock_("/meta_sync_lock") {
+    auto const& spec = server_ptr_->GetSpec()["metastore_spec"];
+    group_commit_size_ = std::max<size_t>(
+        1, spec.value("group_commit_size", static_cast<size_t>(1024)));
+    group_commit_window_us_ =
+        spec.value("group_commit_window_us", static_cast<int64_t>(0));
+    query_concurrency_ =
+        spec.value("query_concurrency", static_cast<size_t>(4));
+  }
 
   static std::shared_ptr<IMetaService> Get(vs_ptr_t);
 
@@ -187,47 +203,13 @@ class IMetaService {
   inline void RequestToPersist(
       callback_t<const json&, std::vector<op_t>&> callback_after_ready,
       callback_t<> callback_after_finish) {
-    // NB: when persist local meta to etcd, we needs the meta_sync_lock_ to
-    // avoid contention between other vineyard instances.
-    this->requestLock(
-        meta_sync_lock_,
-        [this, callback_after_ready, callback_after_finish](
-            const Status& status, std::shared_ptr<ILock> lock) {
-          if (status.ok()) {
-            requestValues(
-                "", [this, callback_after_ready, callback_after_finish, lock](
-                        const Status& status, const json& meta, unsigned rev) {
-                  std::vector<op_t> ops;
-                  auto s = callback_after_ready(status, meta, ops);
-                  if (s.ok()) {
-                    if (ops.empty()) {
-                      unsigned rev_after_unlock = 0;
-                      VINEYARD_DISCARD(lock->Release(rev_after_unlock));
-                      return callback_after_finish(Status::OK());
-                    }
-                    // apply changes locally before committing to etcd
-                    this->metaUpdate(ops, false);
-                    // commit to etcd
-                    this->commitUpdates(
-                        ops, [callback_after_finish, lock](const Status& status,
-                                                           unsigned rev) {
-                          // update rev_ to the revision after unlock.
-                          unsigned rev_after_unlock = 0;
-                          VINEYARD_DISCARD(lock->Release(rev_after_unlock));
-                          return callback_after_finish(status);
-                        });
-                    return Status::OK();
-                  } else {
-                    unsigned rev_after_unlock = 0;
-                    VINEYARD_DISCARD(lock->Release(rev_after_unlock));
-                    return callback_after_finish(s);  // propogate the error
-                  }
-                });
-            return Status::OK();
-          } else {
-            LOG(ERROR) << status.ToString();
-            return callback_after_finish(status);  // propogate the error
-          }
+    // see also: Notes [Group Commit]
+    server_ptr_->GetMetaContext().post(
+        [this, callback_after_ready, callback_after_finish]() {
+          persist_queue_.emplace_back(
+              persist_request_t{callback_after_ready, callback_after_finish,
+                                false /* applied */});
+          this->schedulePersist();
         });
   }
 
@@ -249,6 +231,30 @@ class IMetaService {
     }
   }
 
+  /**
+   * @brief Run a read-only query on the local metadata tree, concurrently with
+   * other queries, see also Notes [Concurrent Metadata Queries].
+   *
+   * The callback must not modify any state that is owned by the meta context,
+   * e.g., deferring requests.
+   */
+  inline void RequestToQuery(callback_t<const json&> callback) {
+    if (query_concurrency_ == 0) {
+      server_ptr_->GetMetaContext().post(
+          boost::bind(callback, Status::OK(), std::ref(meta_)));
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> scope_lock(query_mutex_);
+      if (queries_in_flight_ >= query_concurrency_) {
+        pending_queries_.emplace_back(callback);
+        return;
+      }
+      queries_in_flight_ += 1;
+    }
+    runQuery(callback);
+  }
+
   inline void RequestToDelete(
       const std::vector<ObjectID>& object_ids, const bool force,
       const bool deep,
@@ -289,30 +295,17 @@ class IMetaService {
         return;
       }
 
-      // apply remote updates
+      // apply remote updates, the ops have already been applied locally.
       //
-      // NB: when persist local meta to etcd, we needs the meta_sync_lock_ to
-      // avoid contention between other vineyard instances.
-      this->requestLock(
-          meta_sync_lock_,
-          [this, ops /* by copy */, callback_after_ready,
-           callback_after_finish](const Status& status,
-                                  std::shared_ptr<ILock> lock) {
-            if (status.ok()) {
-              // commit to etcd
-              this->commitUpdates(ops, [callback_after_finish, lock](
-                                           const Status& status, unsigned rev) {
-                // update rev_ to the revision after unlock.
-                unsigned rev_after_unlock = 0;
-                VINEYARD_DISCARD(lock->Release(rev_after_unlock));
-                return callback_after_finish(status);
-              });
-              return Status::OK();
-            } else {
-              LOG(ERROR) << status.ToString();
-              return callback_after_finish(status);  // propogate the error.
-            }
-          });
+      // see also: Notes [Group Commit]
+      persist_queue_.emplace_back(persist_request_t{
+          [ops /* by copy */](const Status& status, const json& meta,
+                              std::vector<op_t>& persist_ops) {
+            persist_ops.insert(persist_ops.end(), ops.begin(), ops.end());
+            return status;
+          },
+          callback_after_finish, true /* applied */});
+      this->schedulePersist();
     });
   }
 
@@ -453,7 +446,14 @@ class IMetaService {
           }
           VLOG(10) << "Instance size " << instances_list_.size()
                    << ", target instance is " << target_inst;
-          auto target = meta_["instances"]["i" + std::to_string(target_inst)];
+          // NB: don't touch the tree with the non-const `operator[]`, see
+          // also Notes [Concurrent Metadata Queries].
+          json target;
+          auto instances = meta_.find("instances");
+          if (instances != meta_.end() && instances->is_object()) {
+            target = instances->value("i" + std::to_string(target_inst),
+                                      json(nullptr));
+          }
           // The subtree might be empty, when the etcd been resumed with another
           // data directory but the same endpoint. that leads to a crash here
           // but we just let it crash to help us diagnosis the error.
@@ -575,6 +575,8 @@ class IMetaService {
   void printDepsGraph();
 
   json meta_;
+  // see also: Notes [Metadata Index]
+  meta_tree::MetaIndex meta_index_;
   vs_ptr_t server_ptr_;
 
   unsigned rev_;
@@ -585,6 +587,40 @@ class IMetaService {
  private:
   virtual Status preStart() { return Status::OK(); }
 
+  // see also: Notes [Concurrent Metadata Queries]
+  void runQuery(callback_t<const json&> callback);
+
+  std::shared_timed_mutex meta_mutex_;
+  std::mutex meta_writer_gate_;
+  size_t query_concurrency_;
+  std::mutex query_mutex_;
+  size_t queries_in_flight_ = 0;
+  std::deque<callback_t<const json&>> pending_queries_;
+
+  // see also: Notes [Group Commit]
+  struct persist_request_t {
+    callback_t<const json&, std::vector<op_t>&> callback_after_ready;
+    callback_t<> callback_after_finish;
+    // whether the ops has already been applied to the local meta tree
+    bool applied;
+  };
+
+  void schedulePersist();
+
+  void flushPersist();
+
+  void finishPersist(std::shared_ptr<std::vector<persist_request_t>> batch,
+                     std::shared_ptr<std::vector<Status>> statuses,
+                     const Status& status,
+                     std::chrono::steady_clock::time_point start);
+
+  std::deque<persist_request_t> persist_queue_;
+  bool persist_in_flight_ = false;
+  std::unique_ptr<asio::steady_timer> persist_timer_;
+  bool persist_timer_armed_ = false;
+  size_t group_commit_size_;
+  int64_t group_commit_window_us_;
+
   bool deleteable(ObjectID const object_id);
 
   void traverseToDelete(std::set<ObjectID>& initial_delete_set,
@@ -606,6 +642,8 @@ class IMetaService {
   void delVal(const kv_t& kv);
   void delVal(ObjectID const& target, std::set<ObjectID>& blobs);
 
+  void indexUpdate(std::string const& key);
+
   template <class RangeT>
   void metaUpdate(const RangeT& ops, bool const from_remote) {
     std::set<ObjectID> blobs_to_delete;
@@ -673,6 +711,11 @@ class IMetaService {
       }
     }
 
+    // block new queries until the tree has been updated, see also
+    // Notes [Concurrent Metadata Queries].
+    std::unique_lock<std::mutex> writer_gate(meta_writer_gate_);
+    std::unique_lock<std::shared_timed_mutex> writer_lock(meta_mutex_);
+
     // apply adding signature mappings first.
     for (const op_t& op : add_sigs) {
       putVal(op.kv, from_remote);
@@ -723,6 +766,9 @@ class IMetaService {
       for (auto const target : processed_delete_set) {
         delVal(target, blobs_to_delete);
       }
+
+      // 4. notify clients that cache the metadata of these objects
+      server_ptr_->RecordDeleted(processed_delete_set);
     }
 
     // apply drop others
@@ -745,8 +791,29 @@ class IMetaService {
     }
 #endif
 
+    writer_lock.unlock();
+    writer_gate.unlock();
+
     VINEYARD_SUPPRESS(server_ptr_->DeleteBlobBatch(blobs_to_delete));
-    VINEYARD_SUPPRESS(server_ptr_->ProcessDeferred(meta_));
+
+    // wake up the deferred requests that wait on the added objects and names,
+    // see also: Notes [Deferred Requests]
+    std::set<ObjectID> added_objects;
+    std::set<std::string> added_names;
+    for (const op_t& op : add_datas) {
+      // the key is "/data/<object name>/..."
+      size_t head = sizeof("/data/") - 1, tail = op.kv.key.find('/', head);
+      added_objects.emplace(ObjectIDFromString(
+          op.kv.key.substr(head, tail == std::string::npos ? std::string::npos
+                                                           : tail - head)));
+    }
+    for (const op_t& op : add_others) {
+      if (boost::algorithm::starts_with(op.kv.key, "/names/")) {
+        added_names.emplace(op.kv.key.substr(sizeof("/names/") - 1));
+      }
+    }
+    VINEYARD_SUPPRESS(
+        server_ptr_->ProcessDeferred(meta_, added_objects, added_names));
   }
 
   void instanceUpdate(const op_t& op) {
@@ -0,0 +1,262 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/meta_index.h"
+
+#include <fnmatch.h>
+
+#include <algorithm>
+#include <mutex>
+#include <regex>
+#include <shared_mutex>
+
+namespace vineyard {
+
+namespace meta_tree {
+
+// indexes are registered once per meta service, while looked up by every
+// query, thus lookups share the lock.
+static std::shared_timed_mutex& registry_mutex() {
+  static std::shared_timed_mutex mutex;
+  return mutex;
+}
+
+static std::unordered_map<const json*, const MetaIndex*>& registry() {
+  static std::unordered_map<const json*, const MetaIndex*> indexes;
+  return indexes;
+}
+
+MetaIndex::MetaIndex(const json& tree) : tree_(tree) {
+  std::unique_lock<std::shared_timed_mutex> lock(registry_mutex());
+  registry()[&tree_] = this;
+}
+
+MetaIndex::~MetaIndex() {
+  std::unique_lock<std::shared_timed_mutex> lock(registry_mutex());
+  registry().erase(&tree_);
+}
+
+const MetaIndex* MetaIndex::Of(const json& tree) {
+  std::shared_lock<std::shared_timed_mutex> lock(registry_mutex());
+  auto iter = registry().find(&tree);
+  if (iter == registry().end()) {
+    return nullptr;
+  }
+  return iter->second;
+}
+
+void MetaIndex::Rebuild() {
+  objects_.clear();
+  type_names_.clear();
+  type_ids_.clear();
+  objects_by_type_.clear();
+  objects_by_instance_.clear();
+  signatures_.clear();
+
+  auto data = tree_.find("data");
+  if (data != tree_.end() && data->is_object()) {
+    for (auto const& item : json::iterator_wrapper(*data)) {
+      Refresh(item.key());
+    }
+  }
+  auto signatures = tree_.find("signatures");
+  if (signatures != tree_.end() && signatures->is_object()) {
+    for (auto const& instance : json::iterator_wrapper(*signatures)) {
+      if (!instance.value().is_object()) {
+        continue;
+      }
+      for (auto const& item : json::iterator_wrapper(instance.value())) {
+        RefreshSignature(instance.key(), item.key());
+      }
+    }
+  }
+}
+
+void MetaIndex::Refresh(const std::string& name) {
+  if (name.empty() || name[0] != 'o') {
+    return;
+  }
+  ObjectID id = ObjectIDFromString(name);
+  const json* object = nullptr;
+  auto data = tree_.find("data");
+  if (data != tree_.end() && data->is_object()) {
+    auto iter = data->find(name);
+    if (iter != data->end() && iter->is_object() && !iter->empty()) {
+      object = &(*iter);
+    }
+  }
+  if (object == nullptr) {
+    erase(id);
+    return;
+  }
+
+  uint32_t type = kNoType;
+  auto type_iter = object->find("typename");
+  if (type_iter != object->end() && type_iter->is_string()) {
+    // values are encoded as "v<value>" in the tree
+    auto const& type_name = type_iter->get_ref<std::string const&>();
+    if (!type_name.empty() && type_name[0] == 'v') {
+      type = intern(type_name.substr(1));
+    }
+  }
+  bool has_instance_id = false;
+  InstanceID instance_id = UnspecifiedInstanceID();
+  auto instance_iter = object->find("instance_id");
+  if (instance_iter != object->end() && instance_iter->is_number()) {
+    has_instance_id = true;
+    instance_id = instance_iter->get<InstanceID>();
+  }
+
+  auto iter = objects_.find(id);
+  if (iter != objects_.end()) {
+    if (iter->second.type == type &&
+        iter->second.has_instance_id == has_instance_id &&
+        iter->second.instance_id == instance_id) {
+      return;
+    }
+    erase(id);
+  }
+  objects_.emplace(id, Entry{type, has_instance_id, instance_id});
+  if (type != kNoType) {
+    objects_by_type_[type].emplace(id);
+  }
+  if (has_instance_id) {
+    objects_by_instance_[instance_id].emplace(id);
+  }
+}
+
+void MetaIndex::RefreshSignature(const std::string& instance_name,
+                                 const std::string& signature) {
+  const json* value = nullptr;
+  auto signatures = tree_.find("signatures");
+  if (signatures != tree_.end() && signatures->is_object()) {
+    auto instance = signatures->find(instance_name);
+    if (instance != signatures->end() && instance->is_object()) {
+      auto iter = instance->find(signature);
+      if (iter != instance->end() && iter->is_string()) {
+        value = &(*iter);
+      }
+    }
+  }
+  if (value != nullptr) {
+    signatures_[signature][instance_name] =
+        value->get_ref<std::string const&>();
+    return;
+  }
+  auto iter = signatures_.find(signature);
+  if (iter != signatures_.end()) {
+    iter->second.erase(instance_name);
+    if (iter->second.empty()) {
+      signatures_.erase(iter);
+    }
+  }
+}
+
+bool MetaIndex::Exists(const ObjectID id) const {
+  return objects_.find(id) != objects_.end();
+}
+
+Status MetaIndex::Match(const std::string& pattern, const bool regex,
+                        const size_t limit,
+                        std::vector<ObjectID>& objects) const {
+  std::regex regex_pattern;
+  if (regex) {
+    // pre-compile regex pattern, and for invalid regex pattern, return nothing.
+    try {
+      regex_pattern = std::regex(pattern);
+    } catch (std::regex_error const&) { return Status::OK(); }
+  }
+
+  std::vector<ObjectID> matched;
+  for (uint32_t type = 0; type < type_names_.size(); ++type) {
+    auto const& candidates = objects_by_type_[type];
+    if (candidates.empty()) {
+      continue;
+    }
+    // match each distinct typename only once
+    auto const& type_name = type_names_[type];
+    bool type_matched = false;
+    if (regex) /* regex match */ {
+      std::cmatch __m;
+      type_matched = std::regex_match(type_name.c_str(), __m, regex_pattern);
+    } else /* wildcard match */ {
+      type_matched = fnmatch(pattern.c_str(), type_name.c_str(), 0) == 0;
+    }
+    if (type_matched) {
+      matched.insert(matched.end(), candidates.begin(), candidates.end());
+    }
+  }
+  // the tree is ordered by object names, which are fixed-length hex strings
+  if (matched.size() > limit) {
+    std::nth_element(matched.begin(), matched.begin() + limit, matched.end());
+    matched.resize(limit);
+  }
+  std::sort(matched.begin(), matched.end());
+  objects.insert(objects.end(), matched.begin(), matched.end());
+  return Status::OK();
+}
+
+void MetaIndex::FilterAtInstance(const InstanceID instance_id,
+                                 std::vector<ObjectID>& objects) const {
+  auto iter = objects_by_instance_.find(instance_id);
+  if (iter != objects_by_instance_.end()) {
+    objects.insert(objects.end(), iter->second.begin(), iter->second.end());
+  }
+}
+
+const std::map<std::string, std::string>* MetaIndex::Signatures(
+    const std::string& signature) const {
+  auto iter = signatures_.find(signature);
+  if (iter == signatures_.end()) {
+    return nullptr;
+  }
+  return &iter->second;
+}
+
+uint32_t MetaIndex::intern(const std::string& type_name) {
+  auto iter = type_ids_.find(type_name);
+  if (iter != type_ids_.end()) {
+    return iter->second;
+  }
+  uint32_t type = static_cast<uint32_t>(type_names_.size());
+  type_names_.emplace_back(type_name);
+  type_ids_.emplace(type_name, type);
+  objects_by_type_.emplace_back();
+  return type;
+}
+
+void MetaIndex::erase(const ObjectID id) {
+  auto iter = objects_.find(id);
+  if (iter == objects_.end()) {
+    return;
+  }
+  if (iter->second.type != kNoType) {
+    objects_by_type_[iter->second.type].erase(id);
+  }
+  auto instance = iter->second.has_instance_id
+                      ? objects_by_instance_.find(iter->second.instance_id)
+                      : objects_by_instance_.end();
+  if (instance != objects_by_instance_.end()) {
+    instance->second.erase(id);
+    if (instance->second.empty()) {
+      objects_by_instance_.erase(instance);
+    }
+  }
+  objects_.erase(iter);
+}
+
+}  // namespace meta_tree
+
+}  // namespace vineyard
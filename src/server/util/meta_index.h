@@ -0,0 +1,135 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_META_INDEX_H_
+#define SRC_SERVER_UTIL_META_INDEX_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flat_hash_map/flat_hash_map.hpp"
+
+#include "common/util/json.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+namespace meta_tree {
+
+/**
+ * Notes [Metadata Index]:
+ *
+ * The metadata tree (`IMetaService::meta_`) is still the store of record, as
+ * it mirrors the key-value layout in etcd. Queries that used to walk the
+ * whole tree are answered by `MetaIndex` instead:
+ *
+ * - an ObjectID-keyed hash index for existence tests,
+ * - interned typenames and a secondary index from typename to objects, thus
+ *   `ListData` matches the pattern against each distinct typename only once,
+ * - a secondary index from instance to objects, for `FilterAtInstance`,
+ * - a reverse index from signature to the objects on every instance.
+ *
+ * The index is maintained incrementally by `IMetaService` whenever a key under
+ * "/data" or "/signatures" changes, and registered for the tree it indexes,
+ * so the `meta_tree` functions pick it up by the `tree` argument and keep
+ * their interface. Trees without a registered index (e.g., a copy) are walked
+ * as before.
+ */
+class MetaIndex {
+ public:
+  explicit MetaIndex(const json& tree);
+
+  ~MetaIndex();
+
+  /**
+   * @brief The index registered for `tree`, or nullptr.
+   */
+  static const MetaIndex* Of(const json& tree);
+
+  /**
+   * @brief Rebuild the whole index from the tree.
+   */
+  void Rebuild();
+
+  /**
+   * @brief Refresh the entry of the object `name` after "/data/<name>" or
+   * keys below it have changed.
+   */
+  void Refresh(const std::string& name);
+
+  /**
+   * @brief Refresh after "/signatures/<instance_name>/<signature>" has
+   * changed.
+   */
+  void RefreshSignature(const std::string& instance_name,
+                        const std::string& signature);
+
+  bool Exists(const ObjectID id) const;
+
+  size_t Size() const { return objects_.size(); }
+
+  /**
+   * @brief Objects whose typename matches the pattern, at most `limit`
+   * objects with the smallest object IDs are returned, in order.
+   */
+  Status Match(const std::string& pattern, const bool regex,
+               const size_t limit, std::vector<ObjectID>& objects) const;
+
+  void FilterAtInstance(const InstanceID instance_id,
+                        std::vector<ObjectID>& objects) const;
+
+  /**
+   * @brief Objects that has the given signature, as a map from instance names
+   * to object names, or nullptr if there's no such signature.
+   */
+  const std::map<std::string, std::string>* Signatures(
+      const std::string& signature) const;
+
+ private:
+  struct Entry {
+    uint32_t type;
+    bool has_instance_id;
+    InstanceID instance_id;
+  };
+
+  static constexpr uint32_t kNoType = static_cast<uint32_t>(-1);
+
+  uint32_t intern(const std::string& type_name);
+
+  void erase(const ObjectID id);
+
+  const json& tree_;
+
+  ska::flat_hash_map<ObjectID, Entry> objects_;
+  // interned typenames
+  std::vector<std::string> type_names_;
+  std::unordered_map<std::string, uint32_t> type_ids_;
+  // secondary indexes
+  std::vector<std::set<ObjectID>> objects_by_type_;
+  std::unordered_map<InstanceID, std::set<ObjectID>> objects_by_instance_;
+  // signature -> {instance name -> object name}
+  std::unordered_map<std::string, std::map<std::string, std::string>>
+      signatures_;
+};
+
+}  // namespace meta_tree
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_META_INDEX_H_
@@ -21,10 +21,13 @@ limitations under the License.
 #include <regex>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "boost/lexical_cast.hpp"
 
+#include "server/util/meta_index.h"
+
 namespace boost {
 // Makes the behaviour of lexical_cast compatibile with boost::property_tree.
 template <>
@@ -165,6 +168,22 @@ static Status get_sub_tree(const json& tree, const std::string& prefix,
   return Status::MetaTreeSubtreeNotExists("get subtree failed: " + name);
 }
 
+/**
+ * Find the object "/data/<name>" without copying it, returns nullptr if the
+ * object doesn't exist.
+ */
+static const json* find_data(const json& tree, const std::string& name) {
+  auto data = tree.find("data");
+  if (data == tree.end() || !data->is_object()) {
+    return nullptr;
+  }
+  auto iter = data->find(name);
+  if (iter == data->end() || !iter->is_object() || iter->empty()) {
+    return nullptr;
+  }
+  return &(*iter);
+}
+
 static bool has_sub_tree(const json& tree, const std::string& prefix,
                          const std::string& name) {
   if (name.find('/') != std::string::npos) {
@@ -185,6 +204,15 @@ static std::string object_id_from_signature(const json& tree,
   if (tree.contains(signature_key)) {
     return tree[signature_key].get_ref<std::string const&>();
   }
+  if (auto index = MetaIndex::Of(tree)) {
+    auto objects = index->Signatures(signature);
+    if (objects != nullptr && !objects->empty()) {
+      return objects->begin()->second;
+    }
+    LOG(ERROR) << "Failed to resolve object ID from signature: for "
+               << signature;
+    return ObjectIDToString(InvalidObjectID());
+  }
   auto iter = tree.find("signatures");
   if (iter != tree.end()) {
     for (auto const& item : json::iterator_wrapper(*iter)) {
@@ -278,13 +306,18 @@ Status GetData(const json& tree, const std::string& instance_name,
 Status GetData(const json& tree, const std::string& instance_name,
                const std::string& name, json& sub_tree,
                InstanceID const& current_instance_id) {
-  json tmp_tree;
   sub_tree.clear();
-  Status status = get_sub_tree(tree, "/data", name, tmp_tree);
-  if (!status.ok()) {
-    return status;
+  if (name.find('/') != std::string::npos) {
+    LOG(ERROR) << "meta tree name invalid. " << name;
+    return Status::MetaTreeNameInvalid();
   }
-  for (auto const& item : json::iterator_wrapper(tmp_tree)) {
+  // avoid copying the subtree, as the members are resolved recursively
+  const json* data = find_data(tree, name);
+  if (data == nullptr) {
+    return Status::MetaTreeSubtreeNotExists("get subtree failed: " + name);
+  }
+  Status status;
+  for (auto const& item : json::iterator_wrapper(*data)) {
     if (!item.value().is_string()) {
       sub_tree[item.key()] = item.value();
       continue;
@@ -315,7 +348,7 @@ Status GetData(const json& tree, const std::string& instance_name,
       status = GetData(tree, instance_name, sub_sub_tree_name, sub_sub_tree,
                        current_instance_id);
       if (status.ok()) {
-        sub_tree[item.key()] = sub_sub_tree;
+        sub_tree[item.key()] = std::move(sub_sub_tree);
       } else {
         ObjectID sub_sub_tree_id = VYObjectIDFromString(sub_sub_tree_name);
         if (IsBlob(sub_sub_tree_id) && status.IsMetaTreeSubtreeNotExists()) {
@@ -347,6 +380,19 @@ Status ListData(const json& tree, const std::string& instance_name,
     return Status::OK();
   }
 
+  if (auto index = MetaIndex::Of(tree)) {
+    // see also: Notes [Metadata Index]
+    std::vector<ObjectID> objects;
+    RETURN_ON_ERROR(index->Match(pattern, regex, limit, objects));
+    for (auto const& object_id : objects) {
+      std::string name = ObjectIDToString(object_id);
+      json object_meta_tree;
+      RETURN_ON_ERROR(GetData(tree, instance_name, name, object_meta_tree));
+      tree_group[name] = std::move(object_meta_tree);
+    }
+    return Status::OK();
+  }
+
   size_t found = 0;
 
   std::regex regex_pattern;
@@ -851,6 +897,10 @@ Status PersistOps(const json& tree, const std::string& instance_name,
 }
 
 Status Exists(const json& tree, const ObjectID id, bool& exists) {
+  if (auto index = MetaIndex::Of(tree)) {
+    exists = index->Exists(id);
+    return Status::OK();
+  }
   std::string name = VYObjectIDToString(id);
   exists = has_sub_tree(tree, "/data", name);
   return Status::OK();
@@ -905,6 +955,10 @@ Status IfPersist(const json& tree, const ObjectID id, bool& persist) {
 
 Status FilterAtInstance(const json& tree, const InstanceID& instance_id,
                         std::vector<ObjectID>& objects) {
+  if (auto index = MetaIndex::Of(tree)) {
+    index->FilterAtInstance(instance_id, objects);
+    return Status::OK();
+  }
   if (tree.contains("data")) {
     for (auto const& item : json::iterator_wrapper(tree["data"])) {
       if (item.value().is_object() && !item.value().empty()) {
@@ -951,6 +1005,23 @@ bool HasEquivalent(const json& tree, ObjectID const object_id,
     return false;
   }
   std::string signature = SignatureToString(tree[path].get<Signature>());
+  if (auto index = MetaIndex::Of(tree)) {
+    auto objects = index->Signatures(signature);
+    if (objects == nullptr) {
+      return false;
+    }
+    bool found = false;
+    for (auto const& item : *objects) {
+      if (item.second != object_name) {
+        equivalent = ObjectIDFromString(item.second);
+      }
+      if (found) {
+        return true;
+      }
+      found = true;
+    }
+    return false;
+  }
   json::const_iterator signatures = tree.find("signatures");
   if (signatures == tree.end()) {
     return false;
@@ -20,11 +20,29 @@ limitations under the License.
 
 #include "common/util/env.h"
 #include "common/util/logging.h"
+#include "server/memory/slab_allocator.h"
 #include "server/util/spec_resolvers.h"
 
 namespace vineyard {
 
 // meta data
+DEFINE_string(meta, "etcd",
+              "metadata storage: etcd, local (in-process, for single-host "
+              "deployments without etcd)");
+DEFINE_string(meta_wal_path, "",
+              "write-ahead log of the local metadata storage, to recover "
+              "metadata after restart, no log is kept when it is empty");
+DEFINE_uint64(meta_group_commit_size, 1024,
+              "max number of persist requests that are committed to the "
+              "metadata storage in a single transaction");
+DEFINE_int64(meta_group_commit_window_us, 0,
+             "how long (in microseconds) an idle meta service waits for more "
+             "persist requests to commit them together, requests that arrive "
+             "during a commit are always grouped");
+DEFINE_uint64(meta_query_concurrency, 4,
+              "max number of read-only metadata queries that run "
+              "concurrently on the IPC worker threads, 0 means processing "
+              "them on the metadata thread");
 DEFINE_string(deployment, "local", "deployment mode: local, distributed");
 DEFINE_string(etcd_endpoint, "http://127.0.0.1:2379", "endpoint of etcd");
 DEFINE_string(etcd_prefix, "vineyard", "path prefix in etcd");
@@ -35,8 +53,32 @@ DEFINE_string(size, "256Mi",
               "1024000, 1G, or 1Gi");
 DEFINE_int64(stream_threshold, 80,
              "memory threshold of streams (percentage of total memory)");
+DEFINE_string(spill_path, "",
+              "path to spill cold blobs to when the shared memory is "
+              "exhausted, spilling is disabled when it is empty");
+DEFINE_double(spill_lower_rate, 0.8,
+              "once spilling is triggered, cold blobs are spilled until the "
+              "memory usage drops below this rate of the total memory");
+DEFINE_uint64(small_blob_size,
+              vineyard::memory::SlabAllocator::kMaxSmallBlobSize,
+              "blobs no larger than this size (at most 64KiB) are allocated "
+              "from slabs of size classes, 0 disables it");
+DEFINE_bool(shared_memory_pool, false,
+            "serve blobs and arenas from a single shared memory region, "
+            "which is mapped by IPC clients only once when connecting");
+DEFINE_string(huge_pages, "",
+              "back the shared memory with huge pages: 'thp' for transparent "
+              "huge pages, 'memfd' for hugetlb pages from memfd, or a "
+              "mount point of hugetlbfs, e.g., '/dev/hugepages'");
 // ipc
 DEFINE_string(socket, "/var/run/vineyard.sock", "IPC socket file location");
+DEFINE_uint64(command_channel_capacity, 1024 * 1024,
+              "capacity of the shared memory request/reply rings of an IPC "
+              "client that opts into the command channel, must be a power "
+              "of 2");
+DEFINE_int64(command_channel_spin_us, 50,
+             "how long (in microseconds) the server keeps polling the "
+             "command channel of an idle client before waiting on the socket");
 // rpc
 DEFINE_bool(rpc, true, "Enable RPC service by default");
 DEFINE_int32(rpc_socket_port, 9600, "port to listen in rpc server");
@@ -77,6 +119,11 @@ json EtcdSpecResolver::resolve() const {
   spec["prefix"] = FLAGS_etcd_prefix;
   spec["etcd_endpoint"] = FLAGS_etcd_endpoint;
   spec["etcd_cmd"] = FLAGS_etcd_cmd;
+  spec["meta"] = FLAGS_meta;
+  spec["meta_wal_path"] = FLAGS_meta_wal_path;
+  spec["group_commit_size"] = FLAGS_meta_group_commit_size;
+  spec["group_commit_window_us"] = FLAGS_meta_group_commit_window_us;
+  spec["query_concurrency"] = FLAGS_meta_query_concurrency;
   return spec;
 }
 
@@ -85,6 +132,11 @@ json BulkstoreSpecResolver::resolve() const {
   size_t bulkstore_limit = parseMemoryLimit(FLAGS_size);
   spec["memory_size"] = bulkstore_limit;
   spec["stream_threshold"] = FLAGS_stream_threshold;
+  spec["spill_path"] = FLAGS_spill_path;
+  spec["spill_lower_rate"] = FLAGS_spill_lower_rate;
+  spec["shared_memory_pool"] = FLAGS_shared_memory_pool;
+  spec["huge_pages"] = FLAGS_huge_pages;
+  spec["small_blob_size"] = FLAGS_small_blob_size;
   return spec;
 }
 
@@ -134,6 +186,8 @@ size_t BulkstoreSpecResolver::parseMemoryLimit(
 json IpcSpecResolver::resolve() const {
   json spec;
   spec["socket"] = FLAGS_socket;
+  spec["command_channel_capacity"] = FLAGS_command_channel_capacity;
+  spec["command_channel_spin_us"] = FLAGS_command_channel_spin_us;
   return spec;
 }
 
@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -52,6 +53,25 @@ int main(int argc, char** argv) {
   void* p2 = allocator.Allocate(1026);
   allocator.Freeze(p2);
 
+  VINEYARD_CHECK_OK(allocator.Release());
+  // the released space is never used again
+  CHECK(allocator.Allocate(1024) == nullptr);
+
+  // renewals don't use up the arenas of jemalloc quickly
+  for (int round = 0; round < 64; ++round) {
+    VINEYARD_CHECK_OK(allocator.Renew());
+    std::vector<std::thread> threads;
+    for (int index = 0; index < 4; ++index) {
+      threads.emplace_back([&allocator]() {
+        void* pointer = allocator.Allocate(1024);
+        CHECK(pointer != nullptr);
+        allocator.Free(pointer);
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
   VINEYARD_CHECK_OK(allocator.Release());
 
   LOG(INFO) << "Passed allocator tests...";
@@ -0,0 +1,102 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t file_size = 3 * 1024 * 1024 + 123;
+
+static void check_blob(Client& client, std::unique_ptr<BlobWriter>& writer,
+                       std::vector<char> const& content, size_t const offset,
+                       size_t const size) {
+  CHECK_EQ(writer->size(), size);
+  auto blob = std::dynamic_pointer_cast<Blob>(writer->Seal(client));
+  CHECK(blob != nullptr);
+  auto fetched = client.GetObject<Blob>(blob->id());
+  CHECK_EQ(fetched->size(), size);
+  CHECK_EQ(memcmp(fetched->data(), content.data() + offset, size), 0);
+}
+
+// the file is loaded into the shared memory without being staged in the
+// client, see also Notes [Importing Files into Blobs] in
+// "client/client.cc".
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./blob_import_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<char> content(file_size);
+  for (size_t index = 0; index < file_size; ++index) {
+    content[index] = static_cast<char>(index * 31 + index / 4096);
+  }
+  char path[] = "/tmp/vineyard-blob-import-XXXXXX";
+  int fd = mkstemp(path);
+  CHECK_NE(fd, -1);
+  CHECK_EQ(write(fd, content.data(), file_size),
+           static_cast<ssize_t>(file_size));
+  close(fd);
+
+  {
+    // import the whole file
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlobFromFile(path, writer));
+    check_blob(client, writer, content, 0, file_size);
+  }
+
+  {
+    // import a range of the file
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlobFromFile(path, 4097, 65536, writer));
+    check_blob(client, writer, content, 4097, 65536);
+  }
+
+  {
+    // the range exceeds the end of file
+    std::unique_ptr<BlobWriter> writer;
+    CHECK(client.CreateBlobFromFile(path, file_size - 10, 20, writer)
+              .IsIOError());
+    CHECK(client.CreateBlobFromFile("/not/exists", writer).IsIOError());
+  }
+
+  unlink(path);
+  LOG(INFO) << "Passed blob import tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t blob_size = 1024 * 1024;
+
+static size_t memory_in_use(Client& client) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  CHECK_LE(status->memory_in_use, status->memory_usage);
+  return status->memory_in_use;
+}
+
+// blobs are held by the clients that create or get them, until released, see
+// also Notes [Blob Reference Counting] in "server/memory/memory.cc".
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./blob_release_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client1, client2;
+  VINEYARD_CHECK_OK(client1.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(client2.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  size_t in_use_before = memory_in_use(client1);
+
+  // held by the creator
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client1.CreateBlob(blob_size, writer));
+  memset(writer->data(), 'x', blob_size);
+  ObjectID blob_id = writer->Seal(client1)->id();
+  CHECK_EQ(memory_in_use(client1), in_use_before + blob_size);
+
+  // held by both clients
+  auto blob = client2.GetObject<Blob>(blob_id);
+  CHECK(blob != nullptr);
+  CHECK_EQ(blob->data()[blob_size - 1], 'x');
+  CHECK_EQ(memory_in_use(client1), in_use_before + blob_size);
+
+  VINEYARD_CHECK_OK(client1.Release(blob_id));
+  CHECK_EQ(memory_in_use(client1), in_use_before + blob_size);
+
+  // released by all clients, the blob is only cached
+  blob = nullptr;
+  VINEYARD_CHECK_OK(client2.Release(blob_id));
+  CHECK_EQ(memory_in_use(client1), in_use_before);
+  bool exists = false;
+  VINEYARD_CHECK_OK(client1.Exists(blob_id, exists));
+  CHECK(exists);
+
+  // releasing again is a no-op
+  VINEYARD_CHECK_OK(client2.Release(blob_id));
+  CHECK_EQ(memory_in_use(client1), in_use_before);
+
+  // getting the blob again holds it again
+  blob = client2.GetObject<Blob>(blob_id);
+  CHECK(blob != nullptr);
+  CHECK_EQ(blob->data()[0], 'x');
+  CHECK_EQ(memory_in_use(client1), in_use_before + blob_size);
+
+  blob = nullptr;
+  VINEYARD_CHECK_OK(client1.DelData(blob_id));
+  CHECK_EQ(memory_in_use(client1), in_use_before);
+
+  // the pins of a blob are dropped when it is deleted by another client, the
+  // id may be reused by a new blob at the same address, which shouldn't be
+  // released when the former holder disconnects.
+  {
+    constexpr size_t small_blob_size = 1024;
+    // keeps the slab alive, thus the slot of the deleted blob is reused
+    std::unique_ptr<BlobWriter> filler;
+    VINEYARD_CHECK_OK(client2.CreateBlob(small_blob_size, filler));
+    size_t in_use = memory_in_use(client1);
+
+    Client client3;
+    VINEYARD_CHECK_OK(client3.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(client2.CreateBlob(small_blob_size, writer));
+    ObjectID deleted_id = writer->Seal(client2)->id();
+    auto held = client3.GetObject<Blob>(deleted_id);
+    CHECK(held != nullptr);
+    held = nullptr;
+    VINEYARD_CHECK_OK(client2.DelData(deleted_id));
+    CHECK_EQ(memory_in_use(client1), in_use);
+
+    VINEYARD_CHECK_OK(client2.CreateBlob(small_blob_size, writer));
+    CHECK_EQ(writer->id(), deleted_id);
+    CHECK_EQ(memory_in_use(client1), in_use + small_blob_size);
+
+    client3.Disconnect();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK_EQ(memory_in_use(client1), in_use + small_blob_size);
+
+    VINEYARD_CHECK_OK(client2.Release(writer->id()));
+    CHECK_EQ(memory_in_use(client1), in_use);
+    VINEYARD_CHECK_OK(client2.Release(filler->id()));
+  }
+
+  LOG(INFO) << "Passed blob release tests...";
+
+  client1.Disconnect();
+  client2.Disconnect();
+
+  return 0;
+}
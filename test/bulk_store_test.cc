@@ -0,0 +1,222 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <memory>
+#include <vector>
+
+#include "common/memory/payload.h"
+#include "common/util/logging.h"
+#include "common/util/uuid.h"
+#include "server/memory/memory.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The bulk store is tested in-process with both spilling and the shared
+// memory pool enabled, see also Notes [Shared Memory Pool] in
+// "server/memory/memory.cc".
+constexpr size_t pool_size = 64 * 1024 * 1024;
+constexpr size_t blob_size = 8 * 1024 * 1024;
+constexpr size_t small_blob_size = 1000;
+constexpr size_t page_size = 4096;
+
+int main(int argc, char** argv) {
+  char directory_template[] = "/tmp/vineyard-spill-XXXXXX";
+  char* spill_path = mkdtemp(directory_template);
+  CHECK(spill_path != nullptr);
+
+  BulkStore store;
+  VINEYARD_CHECK_OK(store.PreAllocate(pool_size));
+  VINEYARD_CHECK_OK(store.SetSpillPolicy(spill_path, 0.5));
+  VINEYARD_CHECK_OK(store.SetSmallBlobSize(64 * 1024));
+  VINEYARD_CHECK_OK(store.EnableSharedPool());
+
+  // the head of a blob in a slab cannot be kept, and its address may be
+  // taken by an arena once the slab has been given back, the blob that the
+  // client places at the same address is rejected
+  {
+    ObjectID id = InvalidObjectID();
+    std::shared_ptr<Payload> object;
+    VINEYARD_CHECK_OK(store.Create(small_blob_size, id, object));
+    CHECK_EQ(store.AllocatorStats()["small_blobs"]["blobs"].get<size_t>(), 1);
+    memset(object->pointer, 'x', small_blob_size);
+    VINEYARD_CHECK_OK(store.Unpin(object));
+    size_t spilled = 0;
+    VINEYARD_CHECK_OK(store.SpillColdObjects(small_blob_size, spilled));
+    CHECK_EQ(spilled, small_blob_size);
+    CHECK(object->is_spilled);
+    CHECK_EQ(store.AllocatorStats()["small_blobs"]["slabs"].get<size_t>(), 0);
+    size_t footprint = store.Footprint();
+
+    size_t size = store.FootprintLimit();
+    int fd = -1;
+    uintptr_t base = 0;
+    ptrdiff_t offset = 0;
+    VINEYARD_CHECK_OK(store.MakeArenaInPool(size, fd, base, offset));
+    uintptr_t address = static_cast<uintptr_t>(id ^ EmptyBlobID());
+    CHECK_GE(address, base);
+    CHECK_LE(address + page_size, base + size);
+    auto status = store.FinalizeArena(fd, {address - base + page_size,
+                                           address - base},
+                                      {page_size, page_size});
+    CHECK(!status.ok());
+    LOG(INFO) << "Finalizing the arena failed as expected: "
+              << status.ToString();
+    // the whole arena has been released, none of its blobs is registered
+    CHECK_EQ(store.Footprint(), footprint);
+    CHECK(!store.Exists(GenerateBlobID(address + page_size)));
+
+    // the spilled blob is intact
+    std::vector<std::shared_ptr<Payload>> objects;
+    VINEYARD_CHECK_OK(
+        store.Pin({id}, BulkStore::kAnonymousOwner, objects));
+    CHECK_EQ(objects.size(), 1);
+    CHECK(objects[0] == object);
+    CHECK(!object->is_spilled);
+    for (size_t index = 0; index < small_blob_size; ++index) {
+      CHECK_EQ(object->pointer[index], 'x');
+    }
+    VINEYARD_CHECK_OK(store.Unpin(object));
+    VINEYARD_CHECK_OK(store.Delete(id));
+  }
+  LOG(INFO) << "Passed rejecting arena blobs that conflict with spilled blobs";
+
+  // blobs that don't conflict with others are registered, and blobs at the
+  // same offset are rejected
+  {
+    size_t footprint = store.Footprint();
+    size_t size = 1024 * 1024;
+    int fd = -1;
+    uintptr_t base = 0;
+    ptrdiff_t offset = 0;
+    VINEYARD_CHECK_OK(store.MakeArenaInPool(size, fd, base, offset));
+    CHECK(!store.FinalizeArena(fd, {0, 0}, {page_size, page_size}).ok());
+    CHECK_EQ(store.Footprint(), footprint);
+
+    VINEYARD_CHECK_OK(store.MakeArenaInPool(size, fd, base, offset));
+    VINEYARD_CHECK_OK(
+        store.FinalizeArena(fd, {0, page_size}, {page_size, page_size}));
+    CHECK(store.Exists(GenerateBlobID(base)));
+    CHECK(store.Exists(GenerateBlobID(base + page_size)));
+    VINEYARD_CHECK_OK(store.Delete(GenerateBlobID(base)));
+    VINEYARD_CHECK_OK(store.Delete(GenerateBlobID(base + page_size)));
+    CHECK_EQ(store.Footprint(), footprint);
+  }
+  LOG(INFO) << "Passed finalizing arenas in the shared pool";
+
+  // spilled blobs keep their ids, and the heads of the blobs are kept in the
+  // shared memory to reserve the ids, thus creating blobs beyond the memory
+  // limit doesn't run into conflicts
+  {
+    size_t footprint = store.Footprint();
+    std::vector<ObjectID> ids;
+    for (size_t index = 0; index < 2 * pool_size / blob_size; ++index) {
+      ObjectID id = InvalidObjectID();
+      std::shared_ptr<Payload> object;
+      VINEYARD_CHECK_OK(store.Create(blob_size, id, object));
+      memset(object->pointer, static_cast<int>(index), blob_size);
+      VINEYARD_CHECK_OK(store.Unpin(object));
+      ids.emplace_back(id);
+    }
+    CHECK_GT(store.SpilledSize(), 0);
+    for (size_t index = 0; index < ids.size(); ++index) {
+      std::vector<std::shared_ptr<Payload>> objects;
+      VINEYARD_CHECK_OK(
+          store.Pin({ids[index]}, BulkStore::kAnonymousOwner, objects));
+      CHECK_EQ(objects.size(), 1);
+      CHECK_EQ(objects[0]->pointer[blob_size - 1], static_cast<int>(index));
+      VINEYARD_CHECK_OK(store.Unpin(objects[0]));
+    }
+    for (auto const& id : ids) {
+      VINEYARD_CHECK_OK(store.Delete(id));
+    }
+    CHECK_EQ(store.Footprint(), footprint);
+    CHECK_EQ(store.SpilledSize(), 0);
+  }
+  LOG(INFO) << "Passed spilling blobs beyond the memory limit";
+
+  // spilled blobs are reloaded by pinning rather than by getting, and the
+  // pinned blob is kept under the memory pressure right after the reload
+  {
+    ObjectID id = InvalidObjectID();
+    std::shared_ptr<Payload> object;
+    VINEYARD_CHECK_OK(store.Create(blob_size, id, object));
+    memset(object->pointer, 'y', blob_size);
+    VINEYARD_CHECK_OK(store.Unpin(object));
+    size_t spilled = 0;
+    VINEYARD_CHECK_OK(store.SpillColdObjects(blob_size, spilled));
+    CHECK(object->is_spilled);
+
+    std::shared_ptr<Payload> spilled_object;
+    VINEYARD_CHECK_OK(store.Get(id, spilled_object));
+    CHECK(spilled_object->is_spilled);
+
+    const int owner = 1;
+    std::vector<std::shared_ptr<Payload>> objects;
+    VINEYARD_CHECK_OK(store.Pin({id}, owner, objects));
+    CHECK(!object->is_spilled);
+
+    std::vector<ObjectID> ids;
+    for (size_t index = 0; index < pool_size / blob_size; ++index) {
+      ObjectID pressure_id = InvalidObjectID();
+      std::shared_ptr<Payload> pressure;
+      VINEYARD_CHECK_OK(store.Create(blob_size, pressure_id, pressure));
+      VINEYARD_CHECK_OK(store.Unpin(pressure));
+      ids.emplace_back(pressure_id);
+    }
+    CHECK(!object->is_spilled);
+    for (size_t index = 0; index < blob_size; index += page_size) {
+      CHECK_EQ(object->pointer[index], 'y');
+    }
+    store.UnpinAll(owner);
+    ids.emplace_back(id);
+    for (auto const& blob_id : ids) {
+      VINEYARD_CHECK_OK(store.Delete(blob_id));
+    }
+  }
+  LOG(INFO) << "Passed keeping reloaded blobs under memory pressure";
+
+  // shrinking updates the pinned size, and spilled blobs cannot be shrunk
+  {
+    ObjectID id = InvalidObjectID(), shrunk_id = InvalidObjectID();
+    std::shared_ptr<Payload> object;
+    size_t pinned_size = store.PinnedSize();
+    VINEYARD_CHECK_OK(store.Create(blob_size, id, object));
+    CHECK_EQ(store.PinnedSize(), pinned_size + blob_size);
+    VINEYARD_CHECK_OK(store.Shrink(id, blob_size / 2, shrunk_id));
+    std::shared_ptr<Payload> shrunk;
+    VINEYARD_CHECK_OK(store.Get(shrunk_id, shrunk));
+    CHECK_EQ(shrunk->data_size, blob_size / 2);
+    CHECK_EQ(store.PinnedSize(), pinned_size + blob_size / 2);
+
+    VINEYARD_CHECK_OK(store.Unpin(shrunk));
+    size_t spilled = 0;
+    VINEYARD_CHECK_OK(store.SpillColdObjects(blob_size / 2, spilled));
+    CHECK(shrunk->is_spilled);
+    CHECK(!store.Shrink(shrunk_id, blob_size / 4, id).ok());
+    VINEYARD_CHECK_OK(store.Delete(shrunk_id));
+    CHECK_EQ(store.PinnedSize(), pinned_size);
+  }
+  LOG(INFO) << "Passed shrinking blobs";
+
+  CHECK_EQ(rmdir(spill_path), 0);
+
+  LOG(INFO) << "Passed bulk store tests...";
+
+  return 0;
+}
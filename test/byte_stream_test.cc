@@ -0,0 +1,151 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t num_lines = 10000;
+constexpr size_t chunk_size = 4096;
+
+static std::string make_line(size_t index) {
+  // some lines are longer than a chunk
+  size_t length = index % 997 == 0 ? chunk_size * 2 : index % 113;
+  return std::to_string(index) + ":" +
+         std::string(length, static_cast<char>('a' + index % 26));
+}
+
+static ObjectID create_stream(Client& client) {
+  ByteStreamBuilder builder(client);
+  builder.SetParams(std::unordered_map<std::string, std::string>{
+      {"kind", "test"}, {"test_name", "byte_stream_test"}});
+  auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+  CHECK(bstream != nullptr);
+  return bstream->id();
+}
+
+static void write_lines(const std::string& ipc_socket,
+                        const ObjectID stream_id) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  auto byte_stream = client.GetObject<ByteStream>(stream_id);
+  std::unique_ptr<ByteStreamWriter> writer;
+  VINEYARD_CHECK_OK(byte_stream->OpenWriter(client, writer));
+  writer->SetBufferSizeLimit(chunk_size);
+  for (size_t index = 0; index < num_lines; ++index) {
+    VINEYARD_CHECK_OK(writer->WriteLine(make_line(index) + "\n"));
+  }
+  VINEYARD_CHECK_OK(writer->Finish());
+  client.Disconnect();
+}
+
+// the writer appends lines into the mapped chunks, and the reader reads them
+// from the mapped chunks, see also Notes [Zero-copy Byte Stream] in
+// "basic/stream/byte_stream.vineyard-mod".
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./byte_stream_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  {
+    // read lines
+    ObjectID stream_id = create_stream(client);
+    auto byte_stream = client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamReader> reader;
+    VINEYARD_CHECK_OK(byte_stream->OpenReader(client, reader));
+
+    std::thread send_thrd(write_lines, ipc_socket, stream_id);
+    size_t index = 0;
+    arrow::util::string_view line;
+    while (reader->ReadLine(line).ok()) {
+      CHECK_EQ(std::string(line.data(), line.size()), make_line(index));
+      index += 1;
+    }
+    send_thrd.join();
+    CHECK_EQ(index, num_lines);
+  }
+
+  {
+    // read chunks, every chunk consists of complete lines
+    ObjectID stream_id = create_stream(client);
+    auto byte_stream = client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamReader> reader;
+    VINEYARD_CHECK_OK(byte_stream->OpenReader(client, reader));
+
+    std::thread send_thrd(write_lines, ipc_socket, stream_id);
+    size_t index = 0, chunks = 0;
+    arrow::util::string_view chunk;
+    while (reader->ReadChunk(chunk).ok()) {
+      CHECK(!chunk.empty());
+      CHECK_EQ(chunk.back(), '\n');
+      std::string expected;
+      while (expected.size() < chunk.size()) {
+        expected += make_line(index++) + "\n";
+      }
+      CHECK_EQ(std::string(chunk.data(), chunk.size()), expected);
+      chunks += 1;
+    }
+    send_thrd.join();
+    CHECK_EQ(index, num_lines);
+    CHECK_GT(chunks, 1U);
+  }
+
+  {
+    // write whole chunks
+    ObjectID stream_id = create_stream(client);
+    auto byte_stream = client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamReader> reader;
+    std::unique_ptr<ByteStreamWriter> writer;
+    VINEYARD_CHECK_OK(byte_stream->OpenReader(client, reader));
+    VINEYARD_CHECK_OK(byte_stream->OpenWriter(client, writer));
+
+    std::string content = "vineyard\n";
+    VINEYARD_CHECK_OK(writer->WriteChunk(content.data(), content.size()));
+    VINEYARD_CHECK_OK(writer->WriteLine(content));
+    VINEYARD_CHECK_OK(writer->Finish());
+
+    std::unique_ptr<arrow::Buffer> buffer;
+    VINEYARD_CHECK_OK(reader->GetNext(buffer));
+    CHECK_EQ(static_cast<size_t>(buffer->size()), content.size());
+    VINEYARD_CHECK_OK(reader->GetNext(buffer));
+    CHECK_EQ(static_cast<size_t>(buffer->size()), content.size());
+    CHECK(reader->GetNext(buffer).IsStreamDrained());
+  }
+
+  LOG(INFO) << "Passed byte stream tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,100 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t blob_size = 1024;
+constexpr size_t blob_num = 16;
+// larger than the default capacity of the rings
+constexpr size_t large_value_size = 4 * 1024 * 1024;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./command_channel_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  setenv("VINEYARD_ENABLE_COMMAND_CHANNEL", "1", 1);
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+  CHECK(client.channel_ != nullptr);
+
+  // fds still follow the replies on the socket
+  std::vector<ObjectID> blob_ids;
+  for (size_t index = 0; index < blob_num; ++index) {
+    std::unique_ptr<BlobWriter> blob_writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(blob_size, blob_writer));
+    memset(blob_writer->data(), static_cast<int>(index), blob_size);
+    blob_ids.emplace_back(blob_writer->Seal(client)->id());
+  }
+  for (size_t index = 0; index < blob_num; ++index) {
+    std::shared_ptr<arrow::Buffer> buffer;
+    VINEYARD_CHECK_OK(client.GetBuffer(blob_ids[index], buffer));
+    CHECK_EQ(buffer->size(), blob_size);
+    CHECK_EQ(buffer->data()[blob_size - 1], static_cast<uint8_t>(index));
+  }
+  LOG(INFO) << "Passed blobs tests via the command channel";
+
+  // the server sleeps on the futex after being idle, and is woken up by the
+  // client
+  for (size_t index = 0; index < blob_num; ++index) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    bool exists = false;
+    VINEYARD_CHECK_OK(client.Exists(blob_ids[index], exists));
+    CHECK(exists);
+  }
+  LOG(INFO) << "Passed waking up the server via the command channel";
+
+  // messages that don't fit into the rings go through the socket
+  ObjectMeta meta;
+  meta.SetTypeName("vineyard::CommandChannelTest");
+  meta.SetNBytes(0);
+  meta.AddKeyValue("value", std::string(large_value_size, 'x'));
+  ObjectID id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(meta, id));
+  ObjectMeta meta_get;
+  VINEYARD_CHECK_OK(client.GetMetaData(id, meta_get));
+  CHECK_EQ(meta_get.GetKeyValue("value").size(), large_value_size);
+  LOG(INFO) << "Passed large messages tests via the command channel";
+
+  VINEYARD_CHECK_OK(client.DelData(id));
+  VINEYARD_CHECK_OK(client.DelData(blob_ids));
+  client.Disconnect();
+
+  LOG(INFO) << "Passed command channel tests...";
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t num_threads = 16;
+constexpr size_t num_objects = 64;
+
+static std::string name_of(const size_t index, const size_t i) {
+  return "concurrent_persist_" + std::to_string(index) + "_" +
+         std::to_string(i);
+}
+
+// persist requests from many connections are committed in groups, see also
+// Notes [Group Commit] in "server/services/meta_service.cc".
+void persist_objects(const std::string& ipc_socket, const size_t index,
+                     std::vector<ObjectID>& objects) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  for (size_t i = 0; i < num_objects; ++i) {
+    std::vector<int64_t> values = {static_cast<int64_t>(index),
+                                   static_cast<int64_t>(i)};
+    ArrayBuilder<int64_t> builder(client, values);
+    auto array = builder.Seal(client);
+    VINEYARD_CHECK_OK(array->Persist(client));
+    CHECK(array->IsPersist());
+    VINEYARD_CHECK_OK(client.PutName(array->id(), name_of(index, i)));
+    objects.emplace_back(array->id());
+  }
+  client.Disconnect();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./concurrent_persist_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  std::vector<std::vector<ObjectID>> objects(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t index = 0; index < num_threads; ++index) {
+    threads.emplace_back(persist_objects, ipc_socket, index,
+                         std::ref(objects[index]));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+  for (size_t index = 0; index < num_threads; ++index) {
+    CHECK_EQ(objects[index].size(), num_objects);
+    for (size_t i = 0; i < num_objects; ++i) {
+      ObjectID id = InvalidObjectID();
+      VINEYARD_CHECK_OK(client.GetName(name_of(index, i), id));
+      CHECK_EQ(id, objects[index][i]);
+      auto array =
+          std::dynamic_pointer_cast<Array<int64_t>>(client.GetObject(id));
+      CHECK(array->IsPersist());
+      CHECK_EQ(array->size(), 2);
+      CHECK_EQ((*array)[0], static_cast<int64_t>(index));
+      CHECK_EQ((*array)[1], static_cast<int64_t>(i));
+      VINEYARD_CHECK_OK(client.DropName(name_of(index, i)));
+    }
+    VINEYARD_CHECK_OK(client.DelData(objects[index]));
+  }
+
+  LOG(INFO) << "Passed concurrent persist tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
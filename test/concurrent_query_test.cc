@@ -0,0 +1,111 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t num_readers = 8;
+constexpr size_t num_writers = 4;
+constexpr size_t num_rounds = 256;
+
+// read-only queries run concurrently with the updates, see also
+// Notes [Concurrent Metadata Queries] in "server/services/meta_service.cc".
+void write_objects(const std::string& ipc_socket) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  for (size_t round = 0; round < num_rounds; ++round) {
+    std::vector<int64_t> values = {static_cast<int64_t>(round)};
+    ArrayBuilder<int64_t> builder(client, values);
+    auto array = builder.Seal(client);
+    if (round % 2 == 0) {
+      VINEYARD_CHECK_OK(client.DelData(array->id()));
+    }
+  }
+  client.Disconnect();
+}
+
+void read_objects(const std::string& ipc_socket, std::atomic<bool>& stopped) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  while (!stopped.load()) {
+    std::unordered_map<ObjectID, json> meta_trees;
+    VINEYARD_CHECK_OK(
+        client.ListData("vineyard::Array*", false, 1000, meta_trees));
+    for (auto const& item : meta_trees) {
+      auto type_name = item.second["typename"].get<std::string>();
+      CHECK(type_name.find("vineyard::Array") == 0);
+
+      // the object may have been deleted by writers
+      json tree;
+      auto status = client.GetData(item.first, tree);
+      CHECK(status.ok() || status.IsObjectNotExists());
+    }
+  }
+  client.Disconnect();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./concurrent_query_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  std::atomic<bool> stopped(false);
+  std::vector<std::thread> readers, writers;
+  for (size_t index = 0; index < num_readers; ++index) {
+    readers.emplace_back(read_objects, ipc_socket, std::ref(stopped));
+  }
+  for (size_t index = 0; index < num_writers; ++index) {
+    writers.emplace_back(write_objects, ipc_socket);
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  stopped.store(true);
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+  std::unordered_map<ObjectID, json> meta_trees;
+  VINEYARD_CHECK_OK(client.ListData("vineyard::Array*", false,
+                                    num_writers * num_rounds, meta_trees));
+  CHECK_GE(meta_trees.size(), num_writers * num_rounds / 2);
+
+  LOG(INFO) << "Passed concurrent query tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,158 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/arrow.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+static void create_and_check(Client& creator, Client& reader) {
+  std::vector<size_t> sizes = {0, 1, 64, 4096, 1024 * 1024, 0, 8};
+  for (size_t index = 0; index < 1000; ++index) {
+    sizes.emplace_back(index % 7 * 64 + 1);
+  }
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  VINEYARD_CHECK_OK(creator.CreateBlobs(sizes, writers));
+  CHECK_EQ(writers.size(), sizes.size());
+
+  std::vector<ObjectID> ids;
+  for (size_t index = 0; index < sizes.size(); ++index) {
+    CHECK_EQ(writers[index]->size(), sizes[index]);
+    memset(writers[index]->data(), static_cast<int>(index % 128),
+           sizes[index]);
+    ids.emplace_back(writers[index]->Seal(creator)->id());
+  }
+
+  for (size_t index = 0; index < sizes.size(); ++index) {
+    auto blob = std::dynamic_pointer_cast<Blob>(reader.GetObject(ids[index]));
+    CHECK(blob != nullptr);
+    CHECK_EQ(blob->allocated_size(), sizes[index]);
+    for (size_t offset = 0; offset < sizes[index]; ++offset) {
+      CHECK_EQ(blob->data()[offset], static_cast<char>(index % 128));
+    }
+  }
+
+  // an empty request creates nothing
+  VINEYARD_CHECK_OK(creator.CreateBlobs({}, writers));
+  CHECK(writers.empty());
+}
+
+static std::shared_ptr<arrow::Table> make_wide_table(const int num_columns,
+                                                     const int num_rows) {
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::Array>> columns;
+  for (int column = 0; column < num_columns; ++column) {
+    std::shared_ptr<arrow::Array> array;
+    if (column % 2 == 0) {
+      arrow::Int64Builder builder;
+      for (int row = 0; row < num_rows; ++row) {
+        if (row % 5 == column % 5) {
+          CHECK_ARROW_ERROR(builder.AppendNull());
+        } else {
+          CHECK_ARROW_ERROR(builder.Append(row * column));
+        }
+      }
+      CHECK_ARROW_ERROR(builder.Finish(&array));
+    } else {
+      arrow::StringBuilder builder;
+      for (int row = 0; row < num_rows; ++row) {
+        CHECK_ARROW_ERROR(builder.Append(std::to_string(row * column)));
+      }
+      CHECK_ARROW_ERROR(builder.Finish(&array));
+    }
+    fields.emplace_back(
+        arrow::field("f" + std::to_string(column), array->type()));
+    columns.emplace_back(array);
+  }
+  return arrow::Table::Make(arrow::schema(fields), columns);
+}
+
+// blobs are created in bulk, see also Notes [Creating Buffers in Bulk] in
+// "common/util/protocols.h".
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./create_blobs_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client1, client2;
+  VINEYARD_CHECK_OK(client1.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(client2.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  create_and_check(client1, client2);
+  LOG(INFO) << "Passed creating blobs in bulk tests...";
+
+  {
+    // a wide table, whose blobs are created in a single request
+    auto table = make_wide_table(256, 100);
+    TableBuilder builder(client1, table);
+    auto sealed = std::dynamic_pointer_cast<Table>(builder.Seal(client1));
+    VINEYARD_CHECK_OK(client1.Persist(sealed->id()));
+
+    auto table_get =
+        std::dynamic_pointer_cast<Table>(client2.GetObject(sealed->id()));
+    CHECK(table_get != nullptr);
+    CHECK(table_get->GetTable()->Equals(*table));
+
+    // extending a table shares the blob batch as well
+    TableExtender extender(client2, table_get);
+    auto extra = make_wide_table(16, 100);
+    for (int column = 0; column < extra->num_columns(); ++column) {
+      VINEYARD_CHECK_OK(
+          extender.AddColumn(client2, "extra" + std::to_string(column),
+                             extra->column(column)));
+    }
+    auto extended = std::dynamic_pointer_cast<Table>(extender.Seal(client2));
+    auto extended_get =
+        std::dynamic_pointer_cast<Table>(client1.GetObject(extended->id()));
+    CHECK_EQ(extended_get->GetTable()->num_columns(), 256 + 16);
+    CHECK(extended_get->GetTable()->column(256 + 3)->Equals(
+        *extra->column(3)));
+  }
+  LOG(INFO) << "Passed sealing wide tables tests...";
+
+  {
+    // the JSON protocol
+    setenv("VINEYARD_DISABLE_BINARY_PROTOCOL", "1", 1);
+    Client client3;
+    VINEYARD_CHECK_OK(client3.Connect(ipc_socket));
+    unsetenv("VINEYARD_DISABLE_BINARY_PROTOCOL");
+    create_and_check(client3, client1);
+    create_and_check(client1, client3);
+    client3.Disconnect();
+  }
+  LOG(INFO) << "Passed creating blobs in bulk with JSON protocol tests...";
+
+  client1.Disconnect();
+  client2.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,241 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/status.h"
+#include "arrow/util/config.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "basic/stream/dataframe_stream.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr int64_t num_batches = 100;
+constexpr int64_t batch_rows = 16;
+
+static std::shared_ptr<arrow::RecordBatch> make_batch(int64_t index) {
+  arrow::Int64Builder ids;
+  arrow::StringBuilder names;
+  for (int64_t row = 0; row < batch_rows; ++row) {
+    int64_t value = index * batch_rows + row;
+    CHECK_ARROW_ERROR(ids.Append(value));
+    CHECK_ARROW_ERROR(names.Append("name-" + std::to_string(value)));
+  }
+  std::shared_ptr<arrow::Array> id_array, name_array;
+  CHECK_ARROW_ERROR(ids.Finish(&id_array));
+  CHECK_ARROW_ERROR(names.Finish(&name_array));
+  auto schema = arrow::schema({arrow::field("id", arrow::int64()),
+                               arrow::field("name", arrow::utf8())});
+  return arrow::RecordBatch::Make(schema, batch_rows, {id_array, name_array});
+}
+
+// a dictionary column, the dictionary is shared by all batches (thus written
+// once), or grows with the batches (thus written as deltas)
+static std::shared_ptr<arrow::RecordBatch> make_dictionary_batch(
+    int64_t index, bool const growing) {
+  static std::shared_ptr<arrow::Array> dictionary = [] {
+    arrow::StringBuilder builder;
+    for (int64_t value = 0; value < num_batches + batch_rows; ++value) {
+      CHECK_ARROW_ERROR(builder.Append("category-" + std::to_string(value)));
+    }
+    std::shared_ptr<arrow::Array> array;
+    CHECK_ARROW_ERROR(builder.Finish(&array));
+    return array;
+  }();
+  int64_t dictionary_size =
+      growing ? index + batch_rows : dictionary->length();
+  arrow::Int32Builder indices;
+  for (int64_t row = 0; row < batch_rows; ++row) {
+    CHECK_ARROW_ERROR(
+        indices.Append(static_cast<int32_t>(dictionary_size - 1 - row)));
+  }
+  std::shared_ptr<arrow::Array> index_array;
+  CHECK_ARROW_ERROR(indices.Finish(&index_array));
+  auto type = arrow::dictionary(arrow::int32(), arrow::utf8());
+  auto array = std::make_shared<arrow::DictionaryArray>(
+      type, index_array,
+      growing ? dictionary->Slice(0, dictionary_size) : dictionary);
+  auto schema = arrow::schema({arrow::field("category", type)});
+  return arrow::RecordBatch::Make(schema, batch_rows, {array});
+}
+
+enum class BatchKind { kPlain, kDictionary, kDictionaryDelta };
+
+static std::shared_ptr<arrow::RecordBatch> make_batch(int64_t index,
+                                                      BatchKind const kind) {
+  switch (kind) {
+  case BatchKind::kDictionary:
+    return make_dictionary_batch(index, false);
+  case BatchKind::kDictionaryDelta:
+    return make_dictionary_batch(index, true);
+  default:
+    return make_batch(index);
+  }
+}
+
+static void check_batch(std::shared_ptr<arrow::RecordBatch> const& batch,
+                        int64_t index,
+                        BatchKind const kind = BatchKind::kPlain) {
+  CHECK_EQ(batch->num_rows(), batch_rows);
+  CHECK(batch->Equals(*make_batch(index, kind)));
+}
+
+static ObjectID create_stream(Client& client,
+                              BatchKind const kind = BatchKind::kPlain) {
+  DataframeStreamBuilder builder(client);
+  builder.SetParams(std::unordered_map<std::string, std::string>{
+      {"kind", "test"},
+      {"test_name", "dataframe_stream_test"},
+      {"schema_once", "1"},
+      {"dictionary_deltas",
+       kind == BatchKind::kDictionaryDelta ? "1" : "0"}});
+  auto stream =
+      std::dynamic_pointer_cast<DataframeStream>(builder.Seal(client));
+  CHECK(stream != nullptr);
+  return stream->id();
+}
+
+static void write_batches(const std::string& ipc_socket,
+                          const ObjectID stream_id,
+                          BatchKind const kind = BatchKind::kPlain,
+                          int64_t const batches = num_batches) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  auto stream = client.GetObject<DataframeStream>(stream_id);
+  std::unique_ptr<DataframeStreamWriter> writer;
+  VINEYARD_CHECK_OK(stream->OpenWriter(client, writer));
+  for (int64_t index = 0; index < batches; ++index) {
+    auto batch = make_batch(index, kind);
+    VINEYARD_CHECK_OK(writer->WriteBatch(batch));
+  }
+  VINEYARD_CHECK_OK(writer->Finish());
+  client.Disconnect();
+}
+
+// the schema is written once, and the following chunks contain only record
+// batches, see also Notes [Schema-once Dataframe Stream] in
+// "basic/stream/dataframe_stream.vineyard-mod".
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./dataframe_stream_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  {
+    // read batches from the mapped chunks
+    ObjectID stream_id = create_stream(client);
+    auto stream = client.GetObject<DataframeStream>(stream_id);
+    std::unique_ptr<DataframeStreamReader> reader;
+    VINEYARD_CHECK_OK(stream->OpenReader(client, reader));
+
+    std::thread send_thrd(write_batches, ipc_socket, stream_id);
+    int64_t index = 0;
+    while (true) {
+      std::shared_ptr<arrow::RecordBatch> batch;
+      auto status = reader->ReadBatch(batch, false);
+      if (!status.ok()) {
+        CHECK(status.IsStreamDrained());
+        break;
+      }
+      check_batch(batch, index);
+      CHECK(batch->schema()->metadata() != nullptr);
+      index += 1;
+    }
+    send_thrd.join();
+    CHECK_EQ(index, num_batches);
+  }
+
+  {
+    // read the whole table
+    ObjectID stream_id = create_stream(client);
+    auto stream = client.GetObject<DataframeStream>(stream_id);
+    std::unique_ptr<DataframeStreamReader> reader;
+    VINEYARD_CHECK_OK(stream->OpenReader(client, reader));
+
+    std::thread send_thrd(write_batches, ipc_socket, stream_id);
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    VINEYARD_CHECK_OK(reader->ReadRecordBatches(batches));
+    send_thrd.join();
+    CHECK_EQ(static_cast<int64_t>(batches.size()), num_batches);
+    for (int64_t index = 0; index < num_batches; ++index) {
+      check_batch(batches[index], index);
+    }
+  }
+
+  std::vector<BatchKind> dictionary_kinds = {BatchKind::kDictionary};
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 4000000
+  dictionary_kinds.emplace_back(BatchKind::kDictionaryDelta);
+#endif
+  for (auto const kind : dictionary_kinds) {
+    // dictionaries are kept across the (recycled) chunks
+    ObjectID stream_id = create_stream(client, kind);
+    auto stream = client.GetObject<DataframeStream>(stream_id);
+    std::unique_ptr<DataframeStreamReader> reader;
+    VINEYARD_CHECK_OK(stream->OpenReader(client, reader));
+
+    std::thread send_thrd(write_batches, ipc_socket, stream_id, kind,
+                          num_batches);
+    int64_t index = 0;
+    while (true) {
+      std::shared_ptr<arrow::RecordBatch> batch;
+      auto status = reader->ReadBatch(batch, false);
+      if (!status.ok()) {
+        CHECK(status.IsStreamDrained());
+        break;
+      }
+      check_batch(batch, index, kind);
+      index += 1;
+    }
+    send_thrd.join();
+    CHECK_EQ(index, num_batches);
+  }
+
+  {
+    // the stream is finished without any batch
+    ObjectID stream_id = create_stream(client);
+    auto stream = client.GetObject<DataframeStream>(stream_id);
+    std::unique_ptr<DataframeStreamReader> reader;
+    VINEYARD_CHECK_OK(stream->OpenReader(client, reader));
+    write_batches(ipc_socket, stream_id, BatchKind::kPlain, 0);
+
+    std::shared_ptr<arrow::RecordBatch> batch;
+    CHECK(reader->ReadBatch(batch, false).IsStreamDrained());
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    VINEYARD_CHECK_OK(reader->ReadRecordBatches(batches));
+    CHECK(batches.empty());
+  }
+
+  LOG(INFO) << "Passed dataframe stream tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
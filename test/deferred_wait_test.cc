@@ -0,0 +1,132 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using clock_type = std::chrono::high_resolution_clock;
+
+constexpr size_t num_names = 100;
+constexpr size_t num_updates = 1000;
+
+static std::string name_of(const size_t index) {
+  return "deferred_wait_test_" + std::to_string(index);
+}
+
+// every waiter holds a connection, thus an fd on both sides.
+static size_t max_waiters(const size_t num_waiters) {
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+    return num_waiters;
+  }
+  limit.rlim_cur = limit.rlim_max;
+  setrlimit(RLIMIT_NOFILE, &limit);
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur < 512) {
+    return std::min<size_t>(num_waiters, 256);
+  }
+  return std::min<size_t>(num_waiters, limit.rlim_cur - 256);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./deferred_wait_test <ipc_socket> [num_waiters]");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  size_t num_waiters = 10000;
+  if (argc > 2) {
+    num_waiters = std::strtoull(argv[2], nullptr, 10);
+  }
+  num_waiters = max_waiters(num_waiters);
+
+  std::vector<ObjectID> ids;
+  for (size_t index = 0; index < num_names; ++index) {
+    ids.emplace_back(GenerateObjectID());
+  }
+
+  std::atomic<size_t> connected(0), woken(0);
+  std::vector<std::thread> waiters;
+  for (size_t index = 0; index < num_waiters; ++index) {
+    waiters.emplace_back([&, index]() {
+      Client client;
+      VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+      connected += 1;
+      ObjectID id = InvalidObjectID();
+      VINEYARD_CHECK_OK(client.GetName(name_of(index % num_names), id, true));
+      CHECK_EQ(id, ids[index % num_names]);
+      woken += 1;
+      client.Disconnect();
+    });
+  }
+  while (connected.load() < num_waiters) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  // wait until the requests have been deferred
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  LOG(INFO) << num_waiters << " waiters are blocked";
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // updates that no waiter is interested in
+  auto start = clock_type::now();
+  for (size_t index = 0; index < num_updates; ++index) {
+    VINEYARD_CHECK_OK(client.PutName(GenerateObjectID(),
+                                     "deferred_wait_test_unrelated"));
+  }
+  auto end = clock_type::now();
+  CHECK_EQ(woken.load(), 0);
+  LOG(INFO) << "Unrelated updates with " << num_waiters << " waiters use "
+            << std::chrono::duration<double, std::micro>(end - start).count() /
+                   num_updates
+            << " us on average";
+
+  for (size_t index = 0; index < num_names; ++index) {
+    VINEYARD_CHECK_OK(client.PutName(ids[index], name_of(index)));
+  }
+  for (auto& waiter : waiters) {
+    waiter.join();
+  }
+  CHECK_EQ(woken.load(), num_waiters);
+
+  for (size_t index = 0; index < num_names; ++index) {
+    VINEYARD_CHECK_OK(client.DropName(name_of(index)));
+  }
+  VINEYARD_CHECK_OK(client.DropName("deferred_wait_test_unrelated"));
+
+  LOG(INFO) << "Passed deferred wait tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,300 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/io/api.h"
+#include "arrow/ipc/api.h"
+#include "arrow/util/config.h"
+#if defined(ORC_ENABLED) && defined(ARROW_VERSION) && \
+    ARROW_VERSION >= 4000000
+#include "arrow/adapters/orc/adapter.h"
+#endif
+#if defined(PARQUET_ENABLED)
+#include "parquet/arrow/writer.h"
+#endif
+
+#include "basic/ds/arrow_utils.h"
+#include "common/util/logging.h"
+#include "io/io/io_factory.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Small parquet, ORC and arrow files are written to a temporary directory,
+// and read back by the local io adaptor, see also Notes [Columnar File
+// Formats] in "io/io/local_io_adaptor.cc".
+
+constexpr int64_t num_rows = 30;
+// rows in each row group (parquet) or record batch (arrow)
+constexpr int64_t chunk_rows = 10;
+
+std::shared_ptr<arrow::RecordBatch> make_batch(const int64_t offset) {
+  arrow::Int64Builder id_builder;
+  arrow::DoubleBuilder weight_builder;
+  arrow::StringBuilder label_builder;
+  for (int64_t row = offset; row < offset + chunk_rows; ++row) {
+    CHECK_ARROW_ERROR(id_builder.Append(row));
+    CHECK_ARROW_ERROR(weight_builder.Append(row / 10.0));
+    CHECK_ARROW_ERROR(label_builder.Append(row % 2 == 0 ? "a" : "b"));
+  }
+  std::shared_ptr<arrow::Array> ids, weights, labels;
+  CHECK_ARROW_ERROR(id_builder.Finish(&ids));
+  CHECK_ARROW_ERROR(weight_builder.Finish(&weights));
+  CHECK_ARROW_ERROR(label_builder.Finish(&labels));
+  auto schema = arrow::schema({arrow::field("id", arrow::int64()),
+                               arrow::field("weight", arrow::float64()),
+                               arrow::field("label", arrow::utf8())});
+  return arrow::RecordBatch::Make(schema, chunk_rows, {ids, weights, labels});
+}
+
+std::vector<std::shared_ptr<arrow::RecordBatch>> make_batches() {
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  for (int64_t offset = 0; offset < num_rows; offset += chunk_rows) {
+    batches.emplace_back(make_batch(offset));
+  }
+  return batches;
+}
+
+std::shared_ptr<arrow::io::FileOutputStream> open_file(
+    const std::string& path) {
+  std::shared_ptr<arrow::io::FileOutputStream> stream;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  CHECK_ARROW_ERROR(arrow::io::FileOutputStream::Open(path, &stream));
+#else
+  CHECK_ARROW_ERROR_AND_ASSIGN(stream, arrow::io::FileOutputStream::Open(path));
+#endif
+  return stream;
+}
+
+void write_arrow_file(const std::string& path) {
+  auto batches = make_batches();
+  auto stream = open_file(path);
+  std::shared_ptr<arrow::ipc::RecordBatchWriter> writer;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  CHECK_ARROW_ERROR(arrow::ipc::RecordBatchFileWriter::Open(
+      stream.get(), batches[0]->schema(), &writer));
+#elif defined(ARROW_VERSION) && ARROW_VERSION < 2000000
+  CHECK_ARROW_ERROR_AND_ASSIGN(
+      writer, arrow::ipc::NewFileWriter(stream.get(), batches[0]->schema()));
+#else
+  CHECK_ARROW_ERROR_AND_ASSIGN(
+      writer, arrow::ipc::MakeFileWriter(stream.get(), batches[0]->schema()));
+#endif
+  for (auto const& batch : batches) {
+    CHECK_ARROW_ERROR(writer->WriteRecordBatch(*batch));
+  }
+  CHECK_ARROW_ERROR(writer->Close());
+  CHECK_ARROW_ERROR(stream->Close());
+}
+
+std::shared_ptr<arrow::Table> make_table() {
+  auto batches = make_batches();
+  std::shared_ptr<arrow::Table> table;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  CHECK_ARROW_ERROR(
+      arrow::Table::FromRecordBatches(batches[0]->schema(), batches, &table));
+#else
+  CHECK_ARROW_ERROR_AND_ASSIGN(
+      table, arrow::Table::FromRecordBatches(batches[0]->schema(), batches));
+#endif
+  return table;
+}
+
+bool write_parquet_file(const std::string& path) {
+#if defined(PARQUET_ENABLED)
+  auto stream = open_file(path);
+  CHECK_ARROW_ERROR(parquet::arrow::WriteTable(
+      *make_table(), arrow::default_memory_pool(), stream, chunk_rows));
+  CHECK_ARROW_ERROR(stream->Close());
+  return true;
+#else
+  return false;
+#endif
+}
+
+// int64 values that are not exact in double
+bool write_large_ids_parquet_file(const std::string& path) {
+#if defined(PARQUET_ENABLED)
+  arrow::Int64Builder id_builder;
+  CHECK_ARROW_ERROR(id_builder.Append(int64_t{1} << 53));
+  std::shared_ptr<arrow::Array> ids;
+  CHECK_ARROW_ERROR(id_builder.Finish(&ids));
+  auto table = arrow::Table::Make(
+      arrow::schema({arrow::field("id", arrow::int64())}), {ids});
+  auto stream = open_file(path);
+  CHECK_ARROW_ERROR(parquet::arrow::WriteTable(
+      *table, arrow::default_memory_pool(), stream, chunk_rows));
+  CHECK_ARROW_ERROR(stream->Close());
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool write_orc_file(const std::string& path) {
+#if defined(ORC_ENABLED) && defined(ARROW_VERSION) && \
+    ARROW_VERSION >= 4000000
+  auto stream = open_file(path);
+  std::unique_ptr<arrow::adapters::orc::ORCFileWriter> writer;
+  CHECK_ARROW_ERROR_AND_ASSIGN(
+      writer, arrow::adapters::orc::ORCFileWriter::Open(stream.get()));
+  CHECK_ARROW_ERROR(writer->Write(*make_table()));
+  CHECK_ARROW_ERROR(writer->Close());
+  CHECK_ARROW_ERROR(stream->Close());
+  return true;
+#else
+  return false;
+#endif
+}
+
+std::shared_ptr<arrow::Table> read_table(const std::string& location,
+                                         const int index = 0,
+                                         const int total_parts = 1) {
+  auto io = IOFactory::CreateIOAdaptor(location);
+  CHECK(io != nullptr);
+  VINEYARD_CHECK_OK(io->SetPartialRead(index, total_parts));
+  VINEYARD_CHECK_OK(io->Open());
+  std::shared_ptr<arrow::Table> table;
+  VINEYARD_CHECK_OK(io->ReadTable(&table));
+  VINEYARD_CHECK_OK(io->Close());
+  CHECK(table != nullptr);
+  return table;
+}
+
+std::vector<int64_t> read_ids(const std::shared_ptr<arrow::Table>& table) {
+  std::vector<int64_t> ids;
+  auto column = table->GetColumnByName("id");
+  CHECK(column != nullptr);
+  for (auto const& chunk : column->chunks()) {
+    auto array = std::dynamic_pointer_cast<arrow::Int64Array>(chunk);
+    for (int64_t i = 0; i < array->length(); ++i) {
+      ids.emplace_back(array->Value(i));
+    }
+  }
+  return ids;
+}
+
+void check_columnar_file(const std::string& path, const bool prunable) {
+  LOG(INFO) << "Reading " << path;
+
+  // the whole file, and parts of it
+  {
+    auto table = read_table(path);
+    CHECK_EQ(table->num_rows(), num_rows);
+    CHECK_EQ(table->num_columns(), 3);
+    CHECK(table->Equals(*make_table()));
+
+    std::vector<int64_t> ids;
+    for (int index = 0; index < 3; ++index) {
+      auto part = read_ids(read_table(path, index, 3));
+      ids.insert(ids.end(), part.begin(), part.end());
+    }
+    CHECK_EQ(static_cast<int64_t>(ids.size()), num_rows);
+    for (int64_t row = 0; row < num_rows; ++row) {
+      CHECK_EQ(ids[row], row);
+    }
+  }
+
+  // column selection, by names and by indices
+  {
+    auto table = read_table(path + "#schema=label,id");
+    CHECK_EQ(table->num_rows(), num_rows);
+    CHECK_EQ(table->num_columns(), 2);
+    CHECK_EQ(table->field(0)->name(), "label");
+    CHECK_EQ(table->field(1)->name(), "id");
+
+    table = read_table(path + "#schema=1");
+    CHECK_EQ(table->num_columns(), 1);
+    CHECK_EQ(table->field(0)->name(), "weight");
+  }
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 1000000
+  // filters, the columns in predicates are not returned unless selected
+  {
+    auto table = read_table(path + "#schema=id&filter=id>=12,label==a");
+    CHECK_EQ(table->num_columns(), 1);
+    auto ids = read_ids(table);
+    CHECK_EQ(ids.size(), 9);
+    for (size_t i = 0; i < ids.size(); ++i) {
+      CHECK_EQ(ids[i], 12 + 2 * static_cast<int64_t>(i));
+    }
+
+    table = read_table(path + "#schema=weight&filter=weight<0.5");
+    CHECK_EQ(table->num_rows(), 5);
+    CHECK_EQ(table->num_columns(), 1);
+  }
+
+  // the first row group doesn't match, and is pruned without being read
+  if (prunable) {
+    auto table = read_table(path + "#filter=id>=20", 0, 3);
+    CHECK_EQ(table->num_rows(), 0);
+    CHECK_EQ(table->num_columns(), 3);
+    CHECK_EQ(table->column(0)->num_chunks(), 0);
+  }
+
+  // empty results keep the schema
+  {
+    auto table = read_table(path + "#filter=id>100");
+    CHECK_EQ(table->num_rows(), 0);
+    CHECK_EQ(table->num_columns(), 3);
+    CHECK(table->schema()->Equals(*make_table()->schema()));
+
+    table = read_table(path + "#schema=label&filter=label==c");
+    CHECK_EQ(table->num_rows(), 0);
+    CHECK_EQ(table->num_columns(), 1);
+  }
+#endif
+}
+
+int main(int argc, char** argv) {
+  char directory_template[] = "/tmp/vineyard-local-io-XXXXXX";
+  char* directory = mkdtemp(directory_template);
+  CHECK(directory != nullptr);
+  std::string prefix = std::string(directory) + "/table";
+
+  write_arrow_file(prefix + ".arrow");
+  check_columnar_file(prefix + ".arrow", false);
+
+  if (write_parquet_file(prefix + ".parquet")) {
+    check_columnar_file(prefix + ".parquet", true);
+  } else {
+    LOG(INFO) << "Skipped parquet tests: built without parquet";
+  }
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 1000000
+  // 2^53 + 1 is rounded to 2^53 in double, the row group must not be pruned
+  if (write_large_ids_parquet_file(prefix + "-large.parquet")) {
+    std::string path = prefix + "-large.parquet";
+    CHECK_EQ(read_table(path + "#filter=id<9007199254740993")->num_rows(), 1);
+    CHECK_EQ(read_table(path + "#filter=id!=9007199254740993")->num_rows(), 1);
+    CHECK_EQ(read_table(path + "#filter=id>9007199254740992")->num_rows(), 0);
+  }
+#endif
+
+  if (write_orc_file(prefix + ".orc")) {
+    check_columnar_file(prefix + ".orc", false);
+  } else {
+    LOG(INFO) << "Skipped ORC tests: built without arrow's ORC adapter";
+  }
+
+  LOG(INFO) << "Passed local io adaptor tests...";
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// see also Notes [Client Metadata Cache] in "client/meta_cache.h".
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./meta_cache_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client1, client2;
+  VINEYARD_CHECK_OK(client1.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(client2.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<double> values = {1.0, 7.0, 3.0, 4.0, 2.0};
+  ArrayBuilder<double> builder(client1, values);
+  auto sealed = std::dynamic_pointer_cast<Array<double>>(builder.Seal(client1));
+  ObjectID id = sealed->id();
+  ObjectID buffer_id = sealed->meta().GetMemberMeta("buffer_").GetId();
+
+  // repeated gets are served by the cache
+  auto& cache = client2.GetMetaCache();
+  for (int round = 0; round < 3; ++round) {
+    auto array = client2.GetObject<Array<double>>(id);
+    CHECK_EQ(array->size(), values.size());
+    for (size_t index = 0; index < values.size(); ++index) {
+      CHECK_EQ((*array)[index], values[index]);
+    }
+  }
+  CHECK_EQ(cache.Misses(), 1U);
+  CHECK_EQ(cache.Hits(), 2U);
+  CHECK_EQ(cache.Size(), 1U);
+
+  // the blob is cached as well, and deleted by another client, the deletions
+  // are polled before every lookup
+  cache.SetSyncInterval(0);
+  auto blob = client2.GetObject<Blob>(buffer_id);
+  CHECK_EQ(cache.Size(), 2U);
+  VINEYARD_CHECK_OK(client1.DelData(id, false, false));
+  {
+    std::shared_ptr<Object> object;
+    CHECK(client2.GetObject(id, object).IsObjectNotExists());
+    CHECK_EQ(cache.Size(), 1U);
+  }
+  VINEYARD_CHECK_OK(client1.DelData(buffer_id));
+  {
+    std::shared_ptr<Object> object;
+    CHECK(client2.GetObject(buffer_id, object).IsObjectNotExists());
+    CHECK_EQ(cache.Size(), 0U);
+  }
+
+  // hits within the sync interval are served without any round trip, thus
+  // the deletion by another client is observed only after the interval
+  {
+    ArrayBuilder<double> builder3(client1, values);
+    ObjectID id3 = builder3.Seal(client1)->id();
+    cache.SetSyncInterval(60 * 1000);
+    auto array = client2.GetObject<Array<double>>(id3);
+    CHECK_EQ(array->size(), values.size());
+    VINEYARD_CHECK_OK(client1.DelData(id3, false, true));
+    size_t hits = cache.Hits();
+    std::shared_ptr<Object> object;
+    VINEYARD_CHECK_OK(client2.GetObject(id3, object));
+    CHECK_EQ(cache.Hits(), hits + 1);
+
+    cache.SetSyncInterval(0);
+    CHECK(client2.GetObject(id3, object).IsObjectNotExists());
+    CHECK_EQ(cache.Size(), 0U);
+  }
+
+  // the cache can be disabled
+  cache.SetCapacity(0);
+  ArrayBuilder<double> builder2(client1, values);
+  auto sealed2 = builder2.Seal(client1);
+  size_t misses = cache.Misses();
+  auto array = client2.GetObject<Array<double>>(sealed2->id());
+  CHECK_EQ(array->size(), values.size());
+  CHECK_EQ(cache.Size(), 0U);
+  CHECK_EQ(cache.Misses(), misses);
+  VINEYARD_CHECK_OK(client1.DelData(sealed2->id(), false, true));
+
+  LOG(INFO) << "Passed metadata cache tests...";
+
+  client1.Disconnect();
+  client2.Disconnect();
+
+  return 0;
+}
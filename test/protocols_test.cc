@@ -0,0 +1,242 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/memory/payload.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+#include "common/util/protocols.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  {
+    std::set<ObjectID> ids;
+    for (ObjectID id = 1; id <= 1024; ++id) {
+      ids.emplace(GenerateBlobID(id * 64));
+    }
+    std::string message;
+    WriteGetBuffersRequestBinary(ids, message);
+    CHECK(IsBinaryMessage(message));
+
+    BinaryDecoder decoder(message);
+    std::vector<ObjectID> ids_get;
+    VINEYARD_CHECK_OK(ReadGetBuffersRequestBinary(decoder, ids_get));
+    CHECK(std::vector<ObjectID>(ids.begin(), ids.end()) == ids_get);
+  }
+
+  {
+    std::vector<std::shared_ptr<Payload>> objects;
+    for (int index = 1; index <= 16; ++index) {
+      objects.emplace_back(std::make_shared<Payload>(
+          GenerateBlobID(index * 64), index * 64, nullptr, index,
+          1024 * 1024, index * 128));
+    }
+    std::vector<int> fds = {3, 5};
+    std::string message;
+    WriteGetBuffersReplyBinary(objects, fds, message);
+
+    BinaryDecoder decoder(message);
+    std::vector<Payload> objects_get;
+    std::vector<int> fds_get;
+    VINEYARD_CHECK_OK(
+        ReadGetBuffersReplyBinary(decoder, objects_get, fds_get));
+    CHECK_EQ(objects.size(), objects_get.size());
+    for (size_t index = 0; index < objects.size(); ++index) {
+      CHECK(*objects[index] == objects_get[index]);
+      CHECK_EQ(objects[index]->map_size, objects_get[index].map_size);
+    }
+    CHECK(fds == fds_get);
+  }
+
+  {
+    std::vector<size_t> sizes = {0, 64, 1024 * 1024};
+    std::string message;
+    WriteCreateBuffersRequestBinary(sizes, message);
+
+    BinaryDecoder decoder(message);
+    std::vector<size_t> sizes_get;
+    VINEYARD_CHECK_OK(ReadCreateBuffersRequestBinary(decoder, sizes_get));
+    CHECK(sizes == sizes_get);
+  }
+
+  {
+    std::vector<ObjectID> ids;
+    std::vector<std::shared_ptr<Payload>> objects;
+    for (int index = 1; index <= 16; ++index) {
+      ids.emplace_back(GenerateBlobID(index * 64));
+      objects.emplace_back(std::make_shared<Payload>(
+          ids.back(), index * 64, nullptr, index % 2 + 3, 1024 * 1024,
+          index * 128));
+    }
+    std::vector<int> fds = {3, 4};
+    for (bool binary : {true, false}) {
+      std::string message;
+      std::vector<ObjectID> ids_get;
+      std::vector<Payload> objects_get;
+      std::vector<int> fds_get;
+      if (binary) {
+        WriteCreateBuffersReplyBinary(ids, objects, fds, message);
+        BinaryDecoder decoder(message);
+        VINEYARD_CHECK_OK(ReadCreateBuffersReplyBinary(decoder, ids_get,
+                                                       objects_get, fds_get));
+      } else {
+        WriteCreateBuffersReply(ids, objects, fds, message);
+        VINEYARD_CHECK_OK(ReadCreateBuffersReply(json::parse(message), ids_get,
+                                                 objects_get, fds_get));
+      }
+      CHECK(ids == ids_get);
+      CHECK_EQ(objects.size(), objects_get.size());
+      for (size_t index = 0; index < objects.size(); ++index) {
+        CHECK(*objects[index] == objects_get[index]);
+        CHECK_EQ(objects[index]->map_size, objects_get[index].map_size);
+      }
+      CHECK(fds == fds_get);
+    }
+  }
+
+  LOG(INFO) << "Passed buffer commands in binary protocol tests...";
+
+  {
+    json tree;
+    tree["o0000000000000001"]["typename"] = "vineyard::Blob";
+    tree["o0000000000000001"]["length"] = 1024;
+    std::string message;
+    WriteGetDataReplyBinary(tree, message);
+
+    BinaryDecoder decoder(message);
+    std::unordered_map<ObjectID, json> content;
+    VINEYARD_CHECK_OK(ReadGetDataReplyBinary(decoder, content));
+    CHECK_EQ(content.size(), 1);
+    CHECK(content.at(1) == tree["o0000000000000001"]);
+  }
+
+  {
+    ObjectID id = GenerateObjectID(), id_get = InvalidObjectID();
+    Signature signature = GenerateSignature(), signature_get = 0;
+    InstanceID instance_id = 42, instance_id_get = 0;
+    std::string message;
+    WriteCreateDataReplyBinary(id, signature, instance_id, message);
+
+    BinaryDecoder decoder(message);
+    VINEYARD_CHECK_OK(ReadCreateDataReplyBinary(decoder, id_get, signature_get,
+                                                instance_id_get));
+    CHECK_EQ(id, id_get);
+    CHECK_EQ(signature, signature_get);
+    CHECK_EQ(instance_id, instance_id_get);
+  }
+
+  LOG(INFO) << "Passed metadata commands in binary protocol tests...";
+
+  {
+    // mismatched command type
+    std::string message;
+    WritePullNextStreamChunkRequestBinary(GenerateObjectID(), message);
+    BinaryDecoder decoder(message);
+    ObjectID id = InvalidObjectID();
+    CHECK(!ReadDropBufferRequestBinary(decoder, id).ok());
+  }
+
+  {
+    // truncated message
+    std::string message;
+    WriteGetNextStreamChunkRequestBinary(GenerateObjectID(), 1024, message);
+    message.resize(message.size() - 1);
+    BinaryDecoder decoder(message);
+    ObjectID stream_id = InvalidObjectID();
+    size_t size = 0;
+    CHECK(!ReadGetNextStreamChunkRequestBinary(decoder, stream_id, size).ok());
+  }
+
+  {
+    // the number of elements exceeds the message
+    std::string message;
+    BinaryEncoder encoder(message, CommandType::GetBuffersRequest);
+    encoder.Put<uint64_t>(std::numeric_limits<uint64_t>::max());
+    BinaryDecoder decoder(message);
+    std::vector<ObjectID> ids;
+    CHECK(!ReadGetBuffersRequestBinary(decoder, ids).ok());
+    CHECK(ids.empty());
+  }
+
+  {
+    std::string message;
+    BinaryEncoder encoder(message, CommandType::GetDataRequest);
+    encoder.Put<uint64_t>(uint64_t(1) << 61);
+    encoder.Put<ObjectID>(GenerateObjectID());
+    BinaryDecoder decoder(message);
+    std::vector<ObjectID> ids;
+    bool sync_remote = false, wait = false;
+    CHECK(!ReadGetDataRequestBinary(decoder, ids, sync_remote, wait).ok());
+    CHECK(ids.empty());
+  }
+
+  {
+    std::string message;
+    BinaryEncoder encoder(message, CommandType::GetBuffersRequest);
+    encoder.Put<uint64_t>(2);
+    encoder.Put(Payload());
+    BinaryDecoder decoder(message);
+    std::vector<Payload> objects;
+    std::vector<int> fds;
+    CHECK(!ReadGetBuffersReplyBinary(decoder, objects, fds).ok());
+  }
+
+  {
+    std::string message;
+    BinaryEncoder encoder(message, CommandType::CreateBuffersRequest);
+    encoder.Put<uint64_t>(std::numeric_limits<uint64_t>::max() / 2);
+    encoder.Put<uint64_t>(1024);
+    BinaryDecoder decoder(message);
+    std::vector<size_t> sizes;
+    CHECK(!ReadCreateBuffersRequestBinary(decoder, sizes).ok());
+    CHECK(sizes.empty());
+  }
+
+  {
+    // the number of fds exceeds the message
+    std::string message;
+    BinaryEncoder encoder(message, CommandType::CreateBuffersRequest);
+    encoder.Put<uint64_t>(1);
+    encoder.Put<ObjectID>(GenerateBlobID(64));
+    encoder.Put(Payload());
+    encoder.Put<uint64_t>(std::numeric_limits<uint64_t>::max());
+    encoder.Put<int32_t>(3);
+    BinaryDecoder decoder(message);
+    std::vector<ObjectID> ids;
+    std::vector<Payload> objects;
+    std::vector<int> fds;
+    CHECK(!ReadCreateBuffersReplyBinary(decoder, ids, objects, fds).ok());
+    CHECK(fds.empty());
+  }
+
+  {
+    // JSON messages are not binary
+    std::string message;
+    WriteGetBuffersRequest({GenerateBlobID(64)}, message);
+    CHECK(!IsBinaryMessage(message));
+  }
+
+  LOG(INFO) << "Passed malformed messages in binary protocol tests...";
+
+  LOG(INFO) << "Passed binary protocol tests...";
+  return 0;
+}
@@ -6,8 +6,11 @@ import contextlib
 import importlib
 import os
 import platform
+import resource
+import shutil
 import socket
 import subprocess
+import tempfile
 import time
 
 
@@ -71,12 +74,14 @@ def start_etcd():
 @contextlib.contextmanager
 def start_vineyardd(etcd_endpoints, etcd_prefix, size=4 * 1024 * 1024 * 1024,
                     default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
-                    idx=None, **kw):
+                    idx=None, extra_args=None, **kw):
     rpc_socket_port = find_port()
     if idx is not None:
         socket = '%s.%d' % (default_ipc_socket, idx)
     else:
         socket = default_ipc_socket
+    if extra_args is None:
+        extra_args = []
     with contextlib.ExitStack() as stack:
         proc = start_program('vineyardd',
                              '--size', str(size),
@@ -84,6 +89,7 @@ def start_vineyardd(etcd_endpoints, etcd_prefix, size=4 * 1024 * 1024 * 1024,
                              '--rpc_socket_port', str(rpc_socket_port),
                              '--etcd_endpoint', etcd_endpoints,
                              '--etcd_prefix', etcd_prefix,
+                             *extra_args,
                              verbose=True, **kw)
         yield stack.enter_context(proc), rpc_socket_port
 
@@ -213,7 +219,16 @@ def run_single_vineyardd_tests():
         # FIXME: cannot be safely dtor after #350 and #354.
         # run_test('allocator_test')
         run_test('arrow_data_structure_test')
+        run_test('blob_import_test')
+        run_test('blob_release_test')
+        run_test('bulk_store_test')
+        run_test('byte_stream_test')
+        run_test('command_channel_test')
+        run_test('concurrent_persist_test')
+        run_test('concurrent_query_test')
+        run_test('create_blobs_test')
         run_test('dataframe_test')
+        run_test('dataframe_stream_test')
         run_test('delete_test')
         run_test('get_wait_test')
         run_test('get_object_test')
@@ -223,18 +238,24 @@ def run_single_vineyardd_tests():
         run_test('invalid_connect_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('large_meta_test')
         run_test('list_object_test')
+        run_test('local_io_adaptor_test')
+        run_test('meta_cache_test')
         run_test('name_test')
         run_test('pair_test')
         run_test('persist_test')
+        run_test('protocols_test')
         run_test('rpc_delete_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('rpc_get_object_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('rpc_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('scalar_test')
         run_test('server_status_test')
         run_test('signature_test')
+        run_test('slab_allocator_test')
         run_test('shallow_copy_test')
         run_test('deep_copy_test')
         run_test('stream_test')
+        run_test('stream_batch_test')
+        run_test('stream_fanout_test')
         run_test('tensor_test')
         run_test('tuple_test')
         run_test('typename_test')
@@ -243,6 +264,65 @@ def run_single_vineyardd_tests():
         run_invalid_client_test('127.0.0.1', rpc_socket_port)
 
 
+def run_spill_tests():
+    etcd_port = find_port()
+    [find_port() for _ in range(10)]  # skip some ports
+    spill_path = tempfile.mkdtemp(prefix='vineyard-spill-')
+    with start_vineyardd('http://localhost:%d' % etcd_port,
+                         'vineyard_test_%s' % time.time(),
+                         size=64 * 1024 * 1024,
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+                         extra_args=['--spill_path', spill_path]):
+        run_test('spill_test')
+    shutil.rmtree(spill_path, ignore_errors=True)
+
+
+def run_shared_pool_tests():
+    etcd_port = find_port()
+    [find_port() for _ in range(10)]  # skip some ports
+    with start_vineyardd('http://localhost:%d' % etcd_port,
+                         'vineyard_test_%s' % time.time(),
+                         size=256 * 1024 * 1024,
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+                         extra_args=['--shared_memory_pool']):
+        run_test('shared_pool_test')
+        run_test('array_test')
+        run_test('stream_test')
+
+
+def run_deferred_wait_tests():
+    # every waiter holds a connection, on both sides
+    _, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+    resource.setrlimit(resource.RLIMIT_NOFILE, (hard, hard))
+    with start_vineyardd('http://localhost:%d' % find_port(),
+                         'vineyard_test_%s' % time.time(),
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+        run_test('deferred_wait_test')
+
+
+def run_local_meta_tests():
+    wal_dir = tempfile.mkdtemp(prefix='vineyard-meta-')
+    extra_args = ['--meta', 'local',
+                  '--meta_wal_path', os.path.join(wal_dir, 'meta.wal')]
+    with start_vineyardd('http://localhost:%d' % find_port(),
+                         'vineyard_test_%s' % time.time(),
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+                         extra_args=extra_args):
+        run_test('delete_test')
+        run_test('global_object_test')
+        run_test('name_test')
+        run_test('persist_test')
+        run_test('signature_test')
+    # restart from the write-ahead log
+    with start_vineyardd('http://localhost:%d' % find_port(),
+                         'vineyard_test_%s' % time.time(),
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+                         extra_args=extra_args):
+        run_test('persist_test')
+        run_test('name_test')
+    shutil.rmtree(wal_dir, ignore_errors=True)
+
+
 def run_scale_in_out_tests(etcd_endpoints, instance_size=4):
     etcd_prefix = 'vineyard_test_%s' % time.time()
     with start_multiple_vineyardd(etcd_endpoints,
@@ -403,6 +483,10 @@ def main():
 
     if args.with_cpp:
         run_single_vineyardd_tests()
+        run_spill_tests()
+        run_shared_pool_tests()
+        run_local_meta_tests()
+        run_deferred_wait_tests()
         with start_etcd() as (_, etcd_endpoints):
             run_scale_in_out_tests(etcd_endpoints, instance_size=4)
 
@@ -0,0 +1,133 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The vineyardd is expected to be launched with `--shared_memory_pool`.
+constexpr size_t blob_size = 1024 * 1024;
+constexpr size_t blob_num = 16;
+constexpr size_t arena_size = 4 * 1024 * 1024;
+constexpr size_t arena_num = 16;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./shared_pool_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the shared pool is mapped during connecting
+  CHECK_NE(client.shared_pool_fd_, -1);
+  CHECK_EQ(client.mmap_table_.size(), 1);
+
+  std::vector<ObjectID> blob_ids;
+  for (size_t index = 0; index < blob_num; ++index) {
+    std::unique_ptr<BlobWriter> blob_writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(blob_size, blob_writer));
+    memset(blob_writer->data(), static_cast<int>(index), blob_size);
+    blob_ids.emplace_back(blob_writer->id());
+  }
+  LOG(INFO) << "Passed creating blobs in the shared pool";
+
+  // blobs are sealed in arenas inside the shared pool
+  std::vector<ObjectID> arena_blob_ids;
+  for (size_t index = 0; index < arena_num; ++index) {
+    int fd = -1;
+    size_t available_size = 0;
+    uintptr_t base = 0, space = 0;
+    VINEYARD_CHECK_OK(
+        client.CreateArena(arena_size, fd, available_size, base, space));
+    CHECK_EQ(available_size, arena_size);
+    memset(reinterpret_cast<void*>(space), static_cast<int>(index),
+           blob_size);
+    VINEYARD_CHECK_OK(client.ReleaseArena(fd, {0}, {blob_size}));
+    arena_blob_ids.emplace_back(GenerateBlobID(base));
+  }
+  LOG(INFO) << "Passed creating arenas in the shared pool";
+
+  // no more fds and mappings
+  CHECK_EQ(client.mmap_table_.size(), 1);
+
+  for (size_t index = 0; index < blob_num; ++index) {
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    VINEYARD_CHECK_OK(client.GetBuffers({blob_ids[index]}, buffers));
+    CHECK_EQ(buffers.size(), 1);
+    auto buffer = buffers.at(blob_ids[index]);
+    CHECK_EQ(static_cast<size_t>(buffer->size()), blob_size);
+    for (size_t offset = 0; offset < blob_size; offset += 4096) {
+      CHECK_EQ(buffer->data()[offset], static_cast<uint8_t>(index));
+    }
+  }
+  for (size_t index = 0; index < arena_num; ++index) {
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    VINEYARD_CHECK_OK(client.GetBuffers({arena_blob_ids[index]}, buffers));
+    CHECK_EQ(buffers.size(), 1);
+    auto buffer = buffers.at(arena_blob_ids[index]);
+    CHECK_EQ(static_cast<size_t>(buffer->size()), blob_size);
+    for (size_t offset = 0; offset < blob_size; offset += 4096) {
+      CHECK_EQ(buffer->data()[offset], static_cast<uint8_t>(index));
+    }
+  }
+  CHECK_EQ(client.mmap_table_.size(), 1);
+  LOG(INFO) << "Passed getting blobs from the shared pool";
+
+  // dropping blobs doesn't unmap the shared pool, and the memory of arenas
+  // is given back to the pool
+  size_t usage_before = 0, usage_after = 0;
+  {
+    std::shared_ptr<InstanceStatus> status;
+    VINEYARD_CHECK_OK(client.InstanceStatus(status));
+    usage_before = status->memory_usage;
+  }
+  for (auto const& blob_id : blob_ids) {
+    VINEYARD_CHECK_OK(client.DropBuffer(blob_id, client.shared_pool_fd_));
+  }
+  for (auto const& blob_id : arena_blob_ids) {
+    VINEYARD_CHECK_OK(client.DropBuffer(blob_id, client.shared_pool_fd_));
+  }
+  {
+    std::shared_ptr<InstanceStatus> status;
+    VINEYARD_CHECK_OK(client.InstanceStatus(status));
+    usage_after = status->memory_usage;
+  }
+  CHECK_LE(usage_after + blob_size * blob_num + blob_size * arena_num,
+           usage_before);
+  CHECK_EQ(client.mmap_table_.size(), 1);
+  LOG(INFO) << "Passed deleting blobs in the shared pool";
+
+  client.Disconnect();
+
+  LOG(INFO) << "Passed shared pool tests...";
+  return 0;
+}
@@ -0,0 +1,168 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+
+#include <map>
+#include <memory>
+
+#include "common/memory/payload.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+#include "server/memory/memory.h"
+#include "server/memory/slab_allocator.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using memory::SlabAllocator;
+
+// The slabs are taken from the system allocator, see also Notes [Small Blob
+// Allocator] in "server/memory/slab_allocator.h".
+static std::map<uint8_t*, size_t> extents;
+
+static uint8_t* allocate_slab(const size_t size) {
+  void* pointer = nullptr;
+  if (posix_memalign(&pointer, 4096, size) != 0) {
+    return nullptr;
+  }
+  extents.emplace(static_cast<uint8_t*>(pointer), size);
+  return static_cast<uint8_t*>(pointer);
+}
+
+static void free_slab(uint8_t* pointer, const size_t size) {
+  auto extent = extents.find(pointer);
+  CHECK(extent != extents.end());
+  CHECK_EQ(extent->second, size);
+  extents.erase(extent);
+  free(pointer);
+}
+
+int main(int argc, char** argv) {
+  // size classes: multiples of 64 bytes, and the waste is bounded by 25%
+  // above 256 bytes
+  {
+    SlabAllocator slabs(allocate_slab, free_slab);
+    slabs.SetMaxSize(1024 * 1024);
+    CHECK_EQ(slabs.MaxSize(), SlabAllocator::kMaxSmallBlobSize);
+    CHECK(!slabs.Fits(0));
+    CHECK(slabs.Fits(SlabAllocator::kMaxSmallBlobSize));
+    CHECK(!slabs.Fits(SlabAllocator::kMaxSmallBlobSize + 1));
+
+    for (size_t size = 1; size <= SlabAllocator::kMaxSmallBlobSize;
+         size += (size < 4096 ? 1 : 61)) {
+      uint8_t* pointer = slabs.Allocate(size);
+      CHECK(pointer != nullptr);
+      CHECK_EQ(reinterpret_cast<uintptr_t>(pointer) % 64, 0);
+      size_t class_size = slabs.Stats()["used_bytes"].get<size_t>();
+      CHECK_EQ(class_size % 64, 0);
+      CHECK_GE(class_size, size);
+      if (size > 256) {
+        CHECK_LE((class_size - size) * 4, size);
+      } else {
+        CHECK_LT(class_size - size, 64);
+      }
+      CHECK(slabs.Free(pointer, size));
+    }
+    CHECK(extents.empty());
+    CHECK_EQ(slabs.Stats()["slabs"].get<size_t>(), 0);
+  }
+
+  // the slab is given back on its last free, and `Owns` respects the bounds
+  // of the slab
+  {
+    SlabAllocator slabs(allocate_slab, free_slab);
+    slabs.SetMaxSize(SlabAllocator::kMaxSmallBlobSize);
+    uint8_t* first = slabs.Allocate(1000);
+    uint8_t* second = slabs.Allocate(1000);
+    CHECK_EQ(extents.size(), 1);
+    uint8_t* base = extents.begin()->first;
+    size_t slab_size = extents.begin()->second;
+    CHECK(first == base);
+    CHECK(second == base + 1024);
+
+    CHECK(slabs.Owns(base));
+    CHECK(slabs.Owns(base + slab_size - 1));
+    CHECK(!slabs.Owns(base - 1));
+    CHECK(!slabs.Owns(base + slab_size));
+
+    CHECK(!slabs.Free(base + slab_size, 1000));
+    CHECK(slabs.Free(first, 1000));
+    CHECK_EQ(extents.size(), 1);
+    CHECK_EQ(slabs.Stats()["blobs"].get<size_t>(), 1);
+    CHECK(slabs.Free(second, 1000));
+    CHECK(extents.empty());
+    CHECK_EQ(slabs.Stats()["slabs"].get<size_t>(), 0);
+    CHECK(!slabs.Owns(base));
+  }
+
+  // shrinking in place only happens within the size class of the slot
+  {
+    SlabAllocator slabs(allocate_slab, free_slab);
+    slabs.SetMaxSize(SlabAllocator::kMaxSmallBlobSize);
+    uint8_t* pointer = slabs.Allocate(1000);
+    CHECK(slabs.Shrink(pointer, 1000, 980));
+    CHECK_EQ(slabs.Stats()["requested_bytes"].get<size_t>(), 980);
+    CHECK(!slabs.Shrink(pointer, 980, 880));
+    CHECK(!slabs.Shrink(pointer, 980, 0));
+    CHECK(!slabs.Shrink(pointer, 980, 1000));
+    CHECK_EQ(slabs.Stats()["requested_bytes"].get<size_t>(), 980);
+
+    uint8_t* outside = nullptr;
+    CHECK_EQ(posix_memalign(reinterpret_cast<void**>(&outside), 4096, 4096),
+             0);
+    CHECK(!slabs.Shrink(outside, 1000, 980));
+    free(outside);
+
+    CHECK(slabs.Free(pointer, 980));
+    CHECK_EQ(slabs.Stats()["requested_bytes"].get<size_t>(), 0);
+    CHECK(extents.empty());
+  }
+
+  // a large blob that is shrunk below the small blob size is still freed
+  // to the bulk allocator
+  {
+    BulkStore store;
+    VINEYARD_CHECK_OK(store.PreAllocate(64 * 1024 * 1024));
+    VINEYARD_CHECK_OK(store.SetSmallBlobSize(64 * 1024));
+    size_t footprint = store.Footprint();
+
+    ObjectID small_id = InvalidObjectID();
+    std::shared_ptr<Payload> small;
+    VINEYARD_CHECK_OK(store.Create(1000, small_id, small));
+    CHECK_EQ(store.AllocatorStats()["small_blobs"]["blobs"].get<size_t>(), 1);
+
+    ObjectID id = InvalidObjectID(), shrunk_id = InvalidObjectID();
+    std::shared_ptr<Payload> object;
+    VINEYARD_CHECK_OK(store.Create(256 * 1024, id, object));
+    CHECK_EQ(store.AllocatorStats()["small_blobs"]["blobs"].get<size_t>(), 1);
+    VINEYARD_CHECK_OK(store.Shrink(id, 1000, shrunk_id));
+    if (shrunk_id == id) {
+      // shrunk in place, the blob is still owned by the bulk allocator
+      CHECK_EQ(object->data_size, 1000);
+      CHECK_EQ(store.AllocatorStats()["small_blobs"]["blobs"].get<size_t>(),
+               1);
+    }
+    VINEYARD_CHECK_OK(store.Delete(shrunk_id));
+    CHECK_EQ(store.AllocatorStats()["small_blobs"]["blobs"].get<size_t>(), 1);
+
+    VINEYARD_CHECK_OK(store.Delete(small_id));
+    CHECK_EQ(store.AllocatorStats()["small_blobs"]["slabs"].get<size_t>(), 0);
+    CHECK_EQ(store.Footprint(), footprint);
+  }
+
+  LOG(INFO) << "Passed slab allocator tests...";
+
+  return 0;
+}
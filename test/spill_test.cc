@@ -0,0 +1,121 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The vineyardd is expected to be launched with `--size=64Mi` and with
+// `--spill_path` enabled.
+constexpr size_t blob_size = 8 * 1024 * 1024;
+constexpr size_t blob_num = 32;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./spill_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  // the working set is 4x larger than the shared memory
+  std::vector<ObjectID> blob_ids;
+  for (size_t index = 0; index < blob_num; ++index) {
+    Client client;
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+    std::unique_ptr<BlobWriter> blob_writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(blob_size, blob_writer));
+    memset(blob_writer->data(), static_cast<int>(index), blob_size);
+    blob_ids.emplace_back(blob_writer->id());
+    // releases the pin on the blob
+    client.Disconnect();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  LOG(INFO) << "Passed creating blobs larger than the shared memory";
+
+  // the spilled blobs are reloaded when being accessed
+  for (size_t index = 0; index < blob_num; ++index) {
+    Client client;
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    VINEYARD_CHECK_OK(client.GetBuffers({blob_ids[index]}, buffers));
+    CHECK_EQ(buffers.size(), 1);
+    auto buffer = buffers.at(blob_ids[index]);
+    CHECK_EQ(static_cast<size_t>(buffer->size()), blob_size);
+    for (size_t offset = 0; offset < blob_size; offset += 4096) {
+      CHECK_EQ(buffer->data()[offset], static_cast<uint8_t>(index));
+    }
+    client.Disconnect();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  LOG(INFO) << "Passed reloading spilled blobs";
+
+  // the reloaded blob is pinned by the reader, thus it is not spilled again
+  // by the memory pressure right after the reload
+  {
+    Client reader;
+    VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    VINEYARD_CHECK_OK(reader.GetBuffers({blob_ids[0]}, buffers));
+    auto buffer = buffers.at(blob_ids[0]);
+    for (size_t index = 0; index < blob_num / 4; ++index) {
+      Client client;
+      VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+      std::unique_ptr<BlobWriter> blob_writer;
+      VINEYARD_CHECK_OK(client.CreateBlob(blob_size, blob_writer));
+      memset(blob_writer->data(), 0xff, blob_size);
+      blob_ids.emplace_back(blob_writer->id());
+      client.Disconnect();
+    }
+    for (size_t offset = 0; offset < blob_size; offset += 4096) {
+      CHECK_EQ(buffer->data()[offset], 0);
+    }
+    reader.Disconnect();
+  }
+  LOG(INFO) << "Passed keeping reloaded blobs under memory pressure";
+
+  // delete both spilled and resident blobs
+  {
+    Client client;
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+    for (auto const& blob_id : blob_ids) {
+      VINEYARD_CHECK_OK(client.DropBuffer(blob_id, -1));
+    }
+    for (auto const& blob_id : blob_ids) {
+      std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+      VINEYARD_CHECK_OK(client.GetBuffers({blob_id}, buffers));
+      CHECK(buffers.empty());
+    }
+    client.Disconnect();
+  }
+  LOG(INFO) << "Passed deleting spilled blobs";
+
+  LOG(INFO) << "Passed spill tests...";
+  return 0;
+}
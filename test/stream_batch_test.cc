@@ -0,0 +1,108 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t num_windows = 64;
+constexpr size_t window = 4;
+constexpr size_t batch = 3;
+constexpr size_t chunk_size = 4096;
+
+// the producer writes windows of chunks and the consumer pulls batches of
+// chunks, see also Notes [Stream Chunk Batches] in
+// "server/memory/stream_store.h".
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./stream_batch_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_batch_test"}});
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+  VINEYARD_CHECK_OK(client.OpenStream(stream_id, OpenStreamMode::read));
+
+  std::thread send_thrd([&]() {
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(
+        writer_client.OpenStream(stream_id, OpenStreamMode::write));
+    for (size_t round = 0; round < num_windows; ++round) {
+      std::vector<std::unique_ptr<arrow::MutableBuffer>> buffers;
+      VINEYARD_CHECK_OK(writer_client.GetNextStreamChunks(
+          stream_id, chunk_size, window, buffers));
+      CHECK_EQ(buffers.size(), window);
+      for (size_t index = 0; index < window; ++index) {
+        CHECK_EQ(static_cast<size_t>(buffers[index]->size()), chunk_size);
+        memset(buffers[index]->mutable_data(),
+               static_cast<uint8_t>(round * window + index), chunk_size);
+      }
+    }
+    VINEYARD_CHECK_OK(writer_client.StopStream(stream_id, false));
+  });
+
+  size_t recv_chunks = 0;
+  while (true) {
+    std::vector<std::unique_ptr<arrow::Buffer>> buffers;
+    auto status = client.PullNextStreamChunks(stream_id, batch, buffers);
+    if (!status.ok()) {
+      CHECK(status.IsStreamDrained());
+      break;
+    }
+    CHECK(!buffers.empty() && buffers.size() <= batch);
+    for (auto const& buffer : buffers) {
+      CHECK_EQ(static_cast<size_t>(buffer->size()), chunk_size);
+      for (size_t offset = 0; offset < chunk_size; ++offset) {
+        CHECK_EQ(buffer->data()[offset], static_cast<uint8_t>(recv_chunks));
+      }
+      recv_chunks += 1;
+    }
+  }
+  send_thrd.join();
+  CHECK_EQ(recv_chunks, num_windows * window);
+
+  LOG(INFO) << "Passed stream batch tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
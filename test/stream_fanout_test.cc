@@ -0,0 +1,127 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t num_readers = 3;
+constexpr size_t num_chunks = 32;
+
+// every reader reads the whole stream, see also Notes [Stream Fan-out] in
+// "server/memory/stream_store.h".
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./stream_fanout_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_fanout_test"}});
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  // register all readers before the first chunk is pulled
+  std::vector<std::unique_ptr<Client>> reader_clients;
+  std::vector<std::unique_ptr<ByteStreamReader>> readers;
+  for (size_t index = 0; index < num_readers; ++index) {
+    reader_clients.emplace_back(new Client());
+    VINEYARD_CHECK_OK(reader_clients.back()->Connect(ipc_socket));
+    auto byte_stream =
+        reader_clients.back()->GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamReader> reader;
+    VINEYARD_CHECK_OK(byte_stream->OpenReader(*reader_clients.back(), reader));
+    readers.emplace_back(std::move(reader));
+  }
+
+  std::vector<size_t> recv_chunks(num_readers, 0);
+  std::vector<std::thread> recv_thrds;
+  for (size_t index = 0; index < num_readers; ++index) {
+    recv_thrds.emplace_back([&, index]() {
+      while (true) {
+        std::unique_ptr<arrow::Buffer> buffer = nullptr;
+        auto status = readers[index]->GetNext(buffer);
+        if (status.ok()) {
+          CHECK(buffer != nullptr);
+          size_t chunk = recv_chunks[index];
+          CHECK_EQ(static_cast<size_t>(buffer->size()), chunk + 1);
+          for (int64_t offset = 0; offset < buffer->size(); ++offset) {
+            CHECK_EQ(buffer->data()[offset], static_cast<uint8_t>(chunk));
+          }
+          recv_chunks[index] += 1;
+        } else {
+          CHECK(status.IsStreamDrained());
+          break;
+        }
+      }
+    });
+  }
+
+  std::thread send_thrd([&]() {
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+
+    auto byte_stream = writer_client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamWriter> writer;
+    VINEYARD_CHECK_OK(byte_stream->OpenWriter(writer_client, writer));
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(writer->GetNext(chunk + 1, buffer));
+      memset(buffer->mutable_data(), static_cast<uint8_t>(chunk), chunk + 1);
+    }
+    VINEYARD_CHECK_OK(writer->Finish());
+  });
+
+  send_thrd.join();
+  for (auto& thrd : recv_thrds) {
+    thrd.join();
+  }
+  for (size_t index = 0; index < num_readers; ++index) {
+    CHECK_EQ(recv_chunks[index], num_chunks);
+  }
+
+  LOG(INFO) << "Passed stream fan-out tests...";
+
+  for (auto& reader_client : reader_clients) {
+    reader_client->Disconnect();
+  }
+  client.Disconnect();
+
+  return 0;
+}